@@ -0,0 +1,137 @@
+// 客户端流水线压测：同步逐个往返 vs 异步客户端多连接流水线（Wire 与 HTTP keep-alive 各一组）
+//
+// 用法: bench_client_pipeline [requests] [connections] [depth]
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <string>
+#include <cstdlib>
+#include "../include/hwp.hpp"
+
+namespace {
+
+double elapsed_seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(const char* name, size_t completed, double seconds) {
+    std::cout << std::setw(24) << name
+              << std::setw(16) << std::fixed << std::setprecision(0) << completed / seconds << " req/s\n";
+}
+
+// 保持 window 个在途请求直到完成 requests 个；issue(done) 发出一个请求，完成时调用 done(ok)
+template <typename Issue>
+size_t run_pipelined(boost::asio::io_context& io, hwp::client::AsyncClient& client,
+                     size_t requests, size_t window, Issue issue) {
+    std::atomic<size_t> sent{0};
+    std::atomic<size_t> completed{0};
+    auto next = std::make_shared<std::function<void()>>();
+    *next = [&, next]() {
+        if (sent.fetch_add(1) >= requests) {
+            return;
+        }
+        issue([&, next](bool ok) {
+            if (ok && ++completed == requests) {
+                client.close();
+                return;
+            }
+            (*next)();
+        });
+    };
+
+    client.async_connect([&](boost::system::error_code ec) {
+        if (ec) {
+            std::cerr << "connect failed: " << ec.message() << "\n";
+            return;
+        }
+        for (size_t i = 0; i < window; ++i) {
+            (*next)();
+        }
+    });
+    io.run();
+    *next = nullptr;
+    return completed.load();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t requests = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    size_t connections = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 4;
+    size_t depth = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 64;
+
+    hwp::server::ServerOptions options;
+    options.port = 0;
+    hwp::server::Server server(options);
+    server.set_message_handler([](const std::shared_ptr<hwp::server::Connection>& connection, hwp::Message& msg) {
+        connection->send(hwp::ProtocolHandler::create_reply(msg, msg.session_header.msg_type,
+                                                            std::move(msg.payload)));
+    });
+    server.run();
+
+    std::vector<uint8_t> payload(64, 'x');
+
+    // 同步客户端：每个请求一个完整往返
+    {
+        hwp::client::Client client("127.0.0.1", server.port());
+        client.connect();
+        auto start = std::chrono::steady_clock::now();
+        hwp::Message reply;
+        for (size_t i = 0; i < requests; ++i) {
+            client.sendBinaryMessage(payload, hwp::MessageType::DATA);
+            client.receiveBinaryMessage(reply);
+        }
+        report("sync round-trip", requests, elapsed_seconds(start));
+    }
+
+    // 异步客户端：connections 个连接，每个窗口保持 depth 个在途请求
+    {
+        boost::asio::io_context io;
+        hwp::client::AsyncClientOptions client_options;
+        client_options.connections = connections;
+        hwp::client::AsyncClient client(io, "127.0.0.1", server.port(), client_options);
+        auto start = std::chrono::steady_clock::now();
+        size_t completed = run_pipelined(io, client, requests, connections * depth, [&](auto done) {
+            client.async_request(hwp::MessageType::DATA, payload,
+                [done](boost::system::error_code ec, hwp::Message /*reply*/) { done(!ec); });
+        });
+        report("async pipelined", completed, elapsed_seconds(start));
+    }
+
+    // HTTP keep-alive：同一连接上逐个往返
+    const std::string http_request =
+            "GET / HTTP/1.1\r\n"
+            "Host: 127.0.0.1\r\n"
+            "\r\n";
+    {
+        hwp::client::Client client("127.0.0.1", server.port());
+        client.connect();
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < requests; ++i) {
+            client.sendHttpRequest(http_request);
+        }
+        report("http keep-alive", requests, elapsed_seconds(start));
+    }
+
+    // HTTP 流水线：每个连接上连续发送多个请求，响应按顺序返回
+    {
+        boost::asio::io_context io;
+        hwp::client::AsyncClientOptions client_options;
+        client_options.connections = connections;
+        hwp::client::AsyncClient client(io, "127.0.0.1", server.port(), client_options);
+        auto start = std::chrono::steady_clock::now();
+        size_t completed = run_pipelined(io, client, requests, connections * depth, [&](auto done) {
+            client.async_http_request(http_request,
+                [done](boost::system::error_code ec, std::string /*response*/) { done(!ec); });
+        });
+        report("http pipelined", completed, elapsed_seconds(start));
+    }
+
+    std::cout << "(connections=" << connections << ", depth=" << depth << ")\n";
+
+    server.stop();
+    return 0;
+}
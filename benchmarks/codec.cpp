@@ -0,0 +1,99 @@
+// 编解码微基准：create_message（拷贝 / 移入负载）、serialize_message、parse 在不同负载长度下的耗时
+// 每项自动校准迭代次数，运行约 min_ms 毫秒；结果以 JSON 输出到标准输出
+//
+// 用法: bench_codec [min_ms]
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+#include "../include/hwp.hpp"
+#include "hdr_histogram.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const size_t PAYLOAD_SIZES[] = {0, 64, 512, 4096, 65536, 1024 * 1024};
+
+// 防止编译器把结果当作无用代码删掉
+volatile size_t sink;
+
+struct Result {
+    const char* op;
+    size_t payload;
+    uint64_t iterations;
+    double ns_per_op;
+};
+
+// 批量运行 body 直到超过 min_ms：每批次数翻倍，避免计时开销占比过大
+template <typename Body>
+Result measure(const char* op, size_t payload, double min_ms, Body&& body) {
+    for (int i = 0; i < 16; ++i) {
+        body();     // 预热：分配器与缓存
+    }
+    uint64_t batch = 1;
+    uint64_t iterations = 0;
+    double elapsed_ns = 0;
+    while (elapsed_ns < min_ms * 1e6) {
+        auto start = Clock::now();
+        for (uint64_t i = 0; i < batch; ++i) {
+            body();
+        }
+        elapsed_ns += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        iterations += batch;
+        batch *= 2;
+    }
+    return Result{op, payload, iterations, elapsed_ns / iterations};
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    double min_ms = argc > 1 ? std::strtod(argv[1], nullptr) : 200.0;
+    const uint8_t flags = static_cast<uint8_t>(hwp::Flags::BINARY_MODE);
+    std::vector<Result> results;
+
+    for (size_t size : PAYLOAD_SIZES) {
+        std::vector<uint8_t> payload(size, 0x5a);
+
+        results.push_back(measure("create_message", size, min_ms, [&]() {
+            hwp::Message msg = hwp::ProtocolHandler::create_message(hwp::MessageType::DATA, 1, payload, flags);
+            sink = msg.payload.size();
+        }));
+
+        // 移入负载：零拷贝路径，负载在每次迭代后移回复用
+        std::vector<uint8_t> moving = payload;
+        results.push_back(measure("create_message_move", size, min_ms, [&]() {
+            hwp::Message msg = hwp::ProtocolHandler::create_message(hwp::MessageType::DATA, 1, std::move(moving), flags);
+            sink = msg.payload.size();
+            moving = std::move(msg.payload);
+        }));
+
+        hwp::Message msg = hwp::ProtocolHandler::create_message(hwp::MessageType::DATA, 1, payload, flags);
+        results.push_back(measure("serialize_message", size, min_ms, [&]() {
+            std::vector<uint8_t> wire = hwp::ProtocolHandler::serialize_message(msg);
+            sink = wire.size();
+        }));
+
+        // 完整帧已在缓冲区中：解析帧头并确认负载齐全
+        std::vector<uint8_t> wire = hwp::ProtocolHandler::serialize_message(msg);
+        hwp::ProtocolHandler parser;
+        results.push_back(measure("parse", size, min_ms, [&]() {
+            sink = static_cast<size_t>(parser.parse(wire.data(), wire.size())) + parser.required_bytes();
+        }));
+    }
+
+    std::cout << "{\"benchmark\":\"codec\",\"results\":[";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        double bytes = static_cast<double>(r.payload + hwp::FRAME_HEADER_SIZE);
+        std::cout << (i ? "," : "") << "\n  {\"op\":" << bench::json_string(r.op)
+                  << ",\"payload\":" << r.payload
+                  << ",\"iterations\":" << r.iterations
+                  << ",\"ns_per_op\":" << r.ns_per_op
+                  << ",\"ops_per_s\":" << 1e9 / r.ns_per_op
+                  << ",\"mib_per_s\":" << bytes / r.ns_per_op * 1e9 / (1024.0 * 1024.0) << "}";
+    }
+    std::cout << "\n]}\n";
+    return 0;
+}
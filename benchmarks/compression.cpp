@@ -0,0 +1,203 @@
+// 消息压缩压测
+// 1. 编解码：小 JSON 消息、大块日志、随机数据在不压缩 / 无字典 / 共享字典下的压缩率与速度
+// 2. 端到端：服务器回显小消息，对比双向压缩开关下的吞吐、节省的字节与花费的 CPU 时间
+//
+// 用法: bench_compression [messages]
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include "../include/hwp.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Payloads = std::vector<std::vector<uint8_t>>;
+
+std::vector<uint8_t> bytes(const std::string& text) {
+    return std::vector<uint8_t>(text.begin(), text.end());
+}
+
+// 结构相同、字段值不同的小消息：单条压缩收益有限，共享字典后收益明显
+Payloads json_messages(size_t count, std::mt19937& rng) {
+    static const char* actions[] = {"create", "update", "delete", "login", "logout", "purchase"};
+    static const char* regions[] = {"cn-north-1", "cn-east-2", "us-west-1", "eu-central-1"};
+    Payloads out;
+    for (size_t i = 0; i < count; ++i) {
+        std::string text = "{\"id\":" + std::to_string(rng() % 1000000) +
+            ",\"user\":\"user-" + std::to_string(rng() % 5000) +
+            "\",\"action\":\"" + actions[rng() % 6] +
+            "\",\"region\":\"" + regions[rng() % 4] +
+            "\",\"timestamp\":" + std::to_string(1700000000 + rng() % 100000) +
+            ",\"client\":{\"version\":\"2.3." + std::to_string(rng() % 10) +
+            "\",\"platform\":\"linux\"},\"status\":\"ok\",\"latency_ms\":" + std::to_string(rng() % 500) + "}";
+        out.push_back(bytes(text));
+    }
+    return out;
+}
+
+Payloads log_chunks(size_t count, std::mt19937& rng) {
+    static const char* levels[] = {"INFO", "WARN", "DEBUG", "ERROR"};
+    Payloads out;
+    for (size_t i = 0; i < count; ++i) {
+        std::string text;
+        while (text.size() < 64 * 1024) {
+            text += "2024-05-01T12:" + std::to_string(10 + rng() % 50) + ":" + std::to_string(10 + rng() % 50) +
+                " " + levels[rng() % 4] + " worker-" + std::to_string(rng() % 16) +
+                " session=" + std::to_string(rng() % 100000) + " processed request in " +
+                std::to_string(rng() % 1000) + "us\n";
+        }
+        out.push_back(bytes(text));
+    }
+    return out;
+}
+
+Payloads random_blocks(size_t count, std::mt19937& rng) {
+    Payloads out;
+    for (size_t i = 0; i < count; ++i) {
+        std::vector<uint8_t> block(4096);
+        for (auto& b : block) {
+            b = static_cast<uint8_t>(rng());
+        }
+        out.push_back(std::move(block));
+    }
+    return out;
+}
+
+// 压缩全部负载（含字典通告），再逐条解压校验
+void codec_run(const char* corpus, const char* mode, const Payloads& payloads,
+               const hwp::compress::CompressionOptions& options) {
+    hwp::compress::Compressor compressor(options);
+    hwp::compress::Decompressor decompressor;
+    uint32_t announced = 0;
+    std::vector<hwp::Message> control;
+    size_t bytes_in = 0;
+    size_t bytes_out = 0;
+    size_t mismatches = 0;
+
+    auto before = hwp::compress::compression_stats();
+    for (const auto& payload : payloads) {
+        hwp::Message msg = hwp::ProtocolHandler::create_message(hwp::MessageType::DATA, 1, payload,
+                                                                static_cast<uint8_t>(hwp::Flags::BINARY_MODE));
+        control.clear();
+        compressor.compress(msg, announced, control);
+        for (const auto& dictionary : control) {
+            bool ok = true;
+            decompressor.on_control(dictionary, ok);
+            bytes_out += dictionary.payload.size();
+        }
+        bytes_in += payload.size();
+        bytes_out += msg.payload.size();
+        if (!decompressor.decompress(msg) || msg.payload != payload) {
+            ++mismatches;
+        }
+    }
+    auto after = hwp::compress::compression_stats();
+
+    double compress_s = (after.compress_ns - before.compress_ns) / 1e9;
+    double decompress_s = (after.decompress_ns - before.decompress_ns) / 1e9;
+    auto rate = [&](double seconds) { return seconds > 0 ? bytes_in / (1024.0 * 1024.0) / seconds : 0.0; };
+    std::cout << std::setw(12) << corpus << std::setw(12) << mode
+              << std::fixed << std::setprecision(3)
+              << "  ratio " << std::setw(6) << static_cast<double>(bytes_out) / bytes_in
+              << std::setprecision(0)
+              << "  compressed " << std::setw(6) << after.compressed - before.compressed << "/" << payloads.size()
+              << "  comp " << std::setw(6) << rate(compress_s) << " MiB/s"
+              << "  decomp " << std::setw(6) << rate(decompress_s) << " MiB/s"
+              << (mismatches ? "  MISMATCH" : "") << "\n";
+}
+
+void codec_bench(const char* corpus, const Payloads& payloads) {
+    hwp::compress::CompressionOptions off;
+    hwp::compress::CompressionOptions plain;
+    plain.enabled = true;
+    plain.dictionary_size = 0;
+    hwp::compress::CompressionOptions shared = plain;
+    shared.dictionary_size = hwp::compress::CompressionOptions().dictionary_size;
+    codec_run(corpus, "off", payloads, off);
+    codec_run(corpus, "deflate", payloads, plain);
+    codec_run(corpus, "dictionary", payloads, shared);
+}
+
+// 客户端一次提交全部请求，服务器原样回显
+void echo_run(const char* mode, unsigned short port, const Payloads& payloads,
+              const hwp::compress::CompressionOptions& options) {
+    boost::asio::io_context io;
+    hwp::client::AsyncClientOptions client_options;
+    client_options.connections = 1;
+    client_options.compression = options;
+    hwp::client::AsyncClient client(io, "127.0.0.1", port, client_options);
+
+    size_t replies = 0;
+    size_t mismatches = 0;
+    auto before = hwp::compress::compression_stats();
+    auto start = Clock::now();
+    auto stop = start;
+    client.async_connect([&](boost::system::error_code ec) {
+        if (ec) {
+            std::cerr << "connect failed: " << ec.message() << "\n";
+            return;
+        }
+        start = Clock::now();
+        for (size_t i = 0; i < payloads.size(); ++i) {
+            client.async_request(hwp::MessageType::DATA, payloads[i],
+                [&, i](boost::system::error_code ec, hwp::Message reply) {
+                    if (ec) {
+                        return;
+                    }
+                    mismatches += reply.payload != payloads[i];
+                    if (++replies == payloads.size()) {
+                        stop = Clock::now();
+                        client.close();
+                    }
+                });
+        }
+    });
+    io.run();
+    auto after = hwp::compress::compression_stats();
+
+    double seconds = std::chrono::duration<double>(stop - start).count();
+    double saved = static_cast<double>(after.bytes_in - before.bytes_in) - (after.bytes_out - before.bytes_out);
+    double cpu_ms = (after.compress_ns - before.compress_ns + after.decompress_ns - before.decompress_ns) / 1e6;
+    std::cout << std::setw(12) << mode
+              << std::fixed << std::setprecision(0)
+              << "  " << std::setw(8) << replies / seconds << " msg/s"
+              << std::setprecision(2)
+              << "  saved " << std::setw(7) << saved / (1024.0 * 1024.0) << " MiB"
+              << "  cpu " << std::setw(7) << cpu_ms << " ms"
+              << std::setprecision(1)
+              << "  " << std::setw(6) << (saved > 0 ? cpu_ms * 1e6 / saved : 0.0) << " ns/saved byte"
+              << (mismatches ? "  MISMATCH" : "") << "\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t messages = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    std::mt19937 rng(42);
+
+    auto json = json_messages(messages, rng);
+    codec_bench("json", json);
+    codec_bench("log 64KiB", log_chunks(64, rng));
+    codec_bench("random 4KiB", random_blocks(1024, rng));
+
+    for (bool enabled : {false, true}) {
+        hwp::server::ServerOptions options;
+        options.port = 0;
+        options.compression.enabled = enabled;
+        hwp::server::Server server(options);
+        server.set_message_handler([](const std::shared_ptr<hwp::server::Connection>& connection, hwp::Message& msg) {
+            connection->send(hwp::ProtocolHandler::create_reply(msg, msg.session_header.msg_type,
+                                                                std::move(msg.payload)));
+        });
+        server.run();
+        hwp::compress::CompressionOptions client;
+        client.enabled = enabled;
+        echo_run(enabled ? "echo on" : "echo off", server.port(), json, client);
+        server.stop();
+    }
+    return 0;
+}
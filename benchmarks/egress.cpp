@@ -0,0 +1,155 @@
+// 出口调度：同一连接上持续下载大块 DATA 时，控制面往返（HANDSHAKE 会话恢复）的延迟。
+// 按提交顺序写出时握手回复排在积压的 DATA 之后；开启优先级后只需等待正在写出的一批。
+// 关闭写队列高水位，使服务器不因积压暂停读取（否则探测请求本身会被延后）
+//
+// 用法: bench_egress [seconds] [reply_kib] [outstanding]
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "../include/hwp.hpp"
+#include "hdr_histogram.hpp"
+
+using namespace boost::asio;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// 探测间隔
+constexpr auto PROBE_INTERVAL = std::chrono::milliseconds(1);
+
+struct Result {
+    const char* mode;
+    double bulk_mib_per_s = 0;
+    bench::HdrHistogram latency;    // 纳秒
+};
+
+std::vector<uint8_t> frame_of(hwp::MessageType type, uint32_t session_id, uint32_t seq, size_t payload) {
+    hwp::Message msg = hwp::ProtocolHandler::create_message(type, session_id, std::vector<uint8_t>(payload, 'x'),
+                                                            static_cast<uint8_t>(hwp::Flags::BINARY_MODE));
+    msg.session_header.seq_num = seq;
+    return hwp::ProtocolHandler::serialize_message(msg);
+}
+
+// 读出一帧，返回解码后的会话头
+bool read_frame(ip::tcp::socket& socket, std::vector<uint8_t>& buffer, hwp::FrameView& frame) {
+    boost::system::error_code ec;
+    buffer.resize(hwp::FRAME_HEADER_SIZE);
+    read(socket, boost::asio::buffer(buffer), ec);
+    if (ec || !hwp::FrameDecoder::decode_header(buffer.data(), frame)) {
+        return false;
+    }
+    buffer.resize(hwp::FRAME_HEADER_SIZE + frame.session.payload_len);
+    read(socket, boost::asio::buffer(buffer.data() + hwp::FRAME_HEADER_SIZE, frame.session.payload_len), ec);
+    return !ec;
+}
+
+Result run(bool priority, double seconds, size_t reply_size, int outstanding_limit) {
+    hwp::server::ServerOptions options;
+    options.port = 0;
+    options.threads = 1;
+    options.egress.priority = priority;
+    options.backpressure.high_watermark = 0;
+    hwp::server::Server server(options);
+    server.set_message_handler([reply_size](const std::shared_ptr<hwp::server::Connection>& connection,
+                                            hwp::Message& msg) {
+        connection->send(hwp::ProtocolHandler::create_reply(msg, hwp::MessageType::DATA,
+                                                            hwp::pool::acquire_buffer(reply_size)));
+    });
+    server.run();
+
+    Result result;
+    result.mode = priority ? "priority" : "fifo";
+    io_context io;
+    ip::tcp::socket socket(io);
+    socket.connect(ip::tcp::endpoint(ip::address_v4::loopback(), server.port()));
+    socket.set_option(ip::tcp::no_delay(true));
+
+    // 建立会话，之后的探测是对该会话的恢复握手
+    std::vector<uint8_t> buffer;
+    hwp::FrameView frame{};
+    write(socket, boost::asio::buffer(frame_of(hwp::MessageType::HANDSHAKE, 0, 0, 0)));
+    if (!read_frame(socket, buffer, frame)) {
+        return result;
+    }
+    uint32_t session_id = frame.session.session_id;
+
+    std::vector<Clock::time_point> sent(static_cast<size_t>(seconds * 1000 / PROBE_INTERVAL.count()) + 16);
+    std::atomic<int> outstanding{0};
+    std::atomic<bool> done{false};
+    uint64_t bulk_bytes = 0;
+
+    std::thread reader([&]() {
+        std::vector<uint8_t> rx;
+        hwp::FrameView reply{};
+        while (read_frame(socket, rx, reply)) {
+            if (reply.session.msg_type == hwp::MessageType::HANDSHAKE) {
+                auto latency = Clock::now() - sent[reply.session.ack_num];
+                result.latency.record(static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count()));
+            } else if (reply.session.msg_type == hwp::MessageType::DATA) {
+                bulk_bytes += reply.session.payload_len;
+                outstanding.fetch_sub(1, std::memory_order_relaxed);
+            }
+            if (done.load(std::memory_order_relaxed) && outstanding.load(std::memory_order_relaxed) == 0) {
+                break;
+            }
+        }
+    });
+
+    // 发送线程：保持 outstanding_limit 个大块请求在途，每个探测间隔发一次握手
+    const std::vector<uint8_t> bulk = frame_of(hwp::MessageType::DATA, session_id, 0, 64);
+    auto start = Clock::now();
+    auto end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    auto next_probe = start;
+    uint32_t probes = 0;
+    boost::system::error_code ec;
+    while (!ec && Clock::now() < end) {
+        if (Clock::now() >= next_probe && probes + 1 < sent.size()) {
+            ++probes;
+            sent[probes] = Clock::now();
+            write(socket, boost::asio::buffer(frame_of(hwp::MessageType::HANDSHAKE, session_id, probes, 0)), ec);
+            next_probe += PROBE_INTERVAL;
+        } else if (outstanding.load(std::memory_order_relaxed) < outstanding_limit) {
+            outstanding.fetch_add(1, std::memory_order_relaxed);
+            write(socket, boost::asio::buffer(bulk), ec);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    done = true;
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    // 最后一批回复读完后读线程退出；仍在途的握手回复不计
+    socket.shutdown(ip::tcp::socket::shutdown_send, ec);
+    reader.join();
+    result.bulk_mib_per_s = static_cast<double>(bulk_bytes) / (1 << 20) / elapsed;
+    server.stop();
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    double seconds = argc > 1 ? std::strtod(argv[1], nullptr) : 2.0;
+    size_t reply_size = (argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 256) * 1024;
+    int outstanding = argc > 3 ? std::atoi(argv[3]) : 128;
+
+    std::cout << "{\"benchmark\":\"egress\",\"reply_bytes\":" << reply_size
+              << ",\"outstanding\":" << outstanding << ",\"results\":[";
+    bool first = true;
+    for (bool priority : {false, true}) {
+        Result r = run(priority, seconds, reply_size, outstanding);
+        std::cout << (first ? "" : ",") << "\n  {\"mode\":" << bench::json_string(r.mode)
+                  << ",\"bulk_mib_per_s\":" << r.bulk_mib_per_s
+                  << ",\"probes\":" << r.latency.count()
+                  << ",\"control_latency_us\":";
+        bench::write_latency_json(std::cout, r.latency);
+        std::cout << "}";
+        first = false;
+    }
+    std::cout << "\n]}\n";
+    return 0;
+}
@@ -0,0 +1,114 @@
+// 压测共用：HDR 风格的延迟直方图与 JSON 输出
+#ifndef HWP_BENCH_HDR_HISTOGRAM_HPP
+#define HWP_BENCH_HDR_HISTOGRAM_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// 对数分桶、桶内线性细分：任意量级下相对误差不超过 1/2^(PRECISION_BITS-1)（约 0.8%），
+// 记录为 O(1)，内存固定，不保存样本
+class HdrHistogram {
+public:
+    static constexpr unsigned PRECISION_BITS = 8;
+
+    HdrHistogram() : counts_(index_of(UINT64_MAX) + 1, 0) {}
+
+    void record(uint64_t value, uint64_t count = 1) {
+        counts_[index_of(value)] += count;
+        total_ += count;
+        sum_ += static_cast<double>(value) * count;
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+    }
+
+    void merge(const HdrHistogram& other) {
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            counts_[i] += other.counts_[i];
+        }
+        total_ += other.total_;
+        sum_ += other.sum_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+
+    uint64_t count() const { return total_; }
+    uint64_t min() const { return total_ ? min_ : 0; }
+    uint64_t max() const { return max_; }
+    double mean() const { return total_ ? sum_ / total_ : 0.0; }
+
+    // 第 p 百分位（0 < p <= 100）所在桶的上界，与 HdrHistogram 的 highest equivalent value 一致
+    uint64_t percentile(double p) const {
+        if (total_ == 0) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(p / 100.0 * total_ + 0.5);
+        rank = std::max<uint64_t>(1, std::min(rank, total_));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            seen += counts_[i];
+            if (seen >= rank) {
+                return std::min(highest_equivalent(i), max_);
+            }
+        }
+        return max_;
+    }
+
+private:
+    static constexpr uint64_t SUB_BUCKETS = uint64_t(1) << PRECISION_BITS;
+    static constexpr uint64_t HALF = SUB_BUCKETS / 2;
+
+    static size_t index_of(uint64_t value) {
+        if (value < SUB_BUCKETS) {
+            return static_cast<size_t>(value);
+        }
+        unsigned msb = 63 - static_cast<unsigned>(__builtin_clzll(value));
+        unsigned shift = msb - PRECISION_BITS + 1;
+        return static_cast<size_t>(shift * HALF + (value >> shift));
+    }
+
+    static uint64_t highest_equivalent(size_t index) {
+        if (index < SUB_BUCKETS) {
+            return index;
+        }
+        uint64_t shift = index / HALF - 1;
+        uint64_t sub = index - shift * HALF;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    std::vector<uint64_t> counts_;
+    uint64_t total_ = 0;
+    double sum_ = 0;
+    uint64_t min_ = UINT64_MAX;
+    uint64_t max_ = 0;
+};
+
+// 以纳秒记录的直方图输出为微秒的延迟摘要：{"mean":..,"p50":..,...,"max":..}
+inline void write_latency_json(std::ostream& out, const HdrHistogram& histogram) {
+    static const std::pair<const char*, double> points[] = {
+        {"p50", 50.0}, {"p90", 90.0}, {"p99", 99.0}, {"p999", 99.9}, {"p9999", 99.99}};
+    out << "{\"mean\":" << histogram.mean() / 1e3;
+    for (const auto& point : points) {
+        out << ",\"" << point.first << "\":" << histogram.percentile(point.second) / 1e3;
+    }
+    out << ",\"max\":" << histogram.max() / 1e3 << "}";
+}
+
+inline std::string json_string(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += c;
+    }
+    return out + "\"";
+}
+
+} // namespace bench
+
+#endif // HWP_BENCH_HDR_HISTOGRAM_HPP
@@ -0,0 +1,311 @@
+// I/O 后端对比压测：epoll（Asio 反应器）与 io_uring
+// 1. 延迟：多条连接各自闭环往返 64 字节消息，统计吞吐与 p50/p99 往返延迟（客户端与服务器用同一后端）
+// 2. 系统调用：服务器运行在被 ptrace 跟踪的子进程中，统计每条消息服务器侧的系统调用次数
+//    （跟踪使系统调用本身变慢，该轮不计延迟）
+//
+// 用法: bench_io_backend [messages] [connections]
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <csignal>
+#include <unistd.h>
+#include <sys/ptrace.h>
+#include <sys/syscall.h>
+#include <sys/user.h>
+#include <sys/wait.h>
+#include "../include/hwp.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* backend_name(hwp::IoBackend backend) {
+    return backend == hwp::IoBackend::IO_URING ? "io_uring" : "epoll";
+}
+
+struct LoopResult {
+    size_t completed = 0;
+    double seconds = 0;
+    std::vector<double> latencies_us;
+};
+
+// connections 条并发闭环：每条收到回复后立即发出下一条，直到共完成 messages 条
+LoopResult run_closed_loop(unsigned short port, hwp::IoBackend backend, size_t messages, size_t connections) {
+    boost::asio::io_context io;
+    hwp::client::AsyncClientOptions options;
+    options.connections = connections;
+    options.backend = backend;
+    hwp::client::AsyncClient client(io, "127.0.0.1", port, options);
+    std::vector<uint8_t> payload(64, 'x');
+
+    LoopResult result;
+    result.latencies_us.reserve(messages);
+    size_t sent = 0;
+    auto start = Clock::now();
+    auto next = std::make_shared<std::function<void()>>();
+    *next = [&, next]() {
+        if (sent >= messages) {
+            return;
+        }
+        ++sent;
+        auto issued = Clock::now();
+        client.async_request(hwp::MessageType::DATA, payload,
+            [&, next, issued](boost::system::error_code ec, hwp::Message /*reply*/) {
+                if (ec) {
+                    return;
+                }
+                result.latencies_us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - issued).count());
+                if (++result.completed == messages) {
+                    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+                    client.close();
+                    return;
+                }
+                (*next)();
+            });
+    };
+    client.async_connect([&](boost::system::error_code ec) {
+        if (ec) {
+            std::cerr << "connect failed: " << ec.message() << "\n";
+            return;
+        }
+        start = Clock::now();
+        for (size_t i = 0; i < connections; ++i) {
+            (*next)();
+        }
+    });
+    io.run();
+    *next = nullptr;
+    return result;
+}
+
+hwp::server::ServerOptions echo_options(hwp::IoBackend backend) {
+    hwp::server::ServerOptions options;
+    options.port = 0;
+    options.threads = 1;
+    options.backend = backend;
+    return options;
+}
+
+void set_echo(hwp::server::Server& server) {
+    server.set_message_handler([](const std::shared_ptr<hwp::server::Connection>& connection, hwp::Message& msg) {
+        connection->send(hwp::ProtocolHandler::create_reply(msg, msg.session_header.msg_type, std::move(msg.payload)));
+    });
+}
+
+void latency_run(hwp::IoBackend backend, size_t messages, size_t connections) {
+    hwp::server::Server server(echo_options(backend));
+    set_echo(server);
+    server.run();
+    run_closed_loop(server.port(), backend, messages / 10 + 1, connections);  // 预热
+    LoopResult result = run_closed_loop(server.port(), backend, messages, connections);
+    server.stop();
+
+    auto& samples = result.latencies_us;
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&](double p) {
+        return samples.empty() ? 0.0 : samples[std::min(samples.size() - 1, static_cast<size_t>(p * samples.size()))];
+    };
+    std::cout << std::setw(10) << backend_name(backend)
+              << std::fixed << std::setprecision(0)
+              << "  " << std::setw(8) << (result.seconds > 0 ? result.completed / result.seconds : 0.0) << " msg/s"
+              << std::setprecision(1)
+              << "  p50 " << std::setw(7) << percentile(0.50) << " us"
+              << "  p99 " << std::setw(7) << percentile(0.99) << " us"
+              << (result.completed != messages ? "  INCOMPLETE" : "") << "\n";
+}
+
+#if defined(__x86_64__)
+const char* syscall_name(long number) {
+    switch (number) {
+    case SYS_read: return "read";
+    case SYS_write: return "write";
+    case SYS_readv: return "readv";
+    case SYS_writev: return "writev";
+    case SYS_sendmsg: return "sendmsg";
+    case SYS_recvmsg: return "recvmsg";
+    case SYS_recvfrom: return "recvfrom";
+    case SYS_sendto: return "sendto";
+    case SYS_epoll_wait: return "epoll_wait";
+    case SYS_epoll_ctl: return "epoll_ctl";
+    case SYS_io_uring_enter: return "io_uring_enter";
+    case SYS_io_uring_register: return "io_uring_register";
+    case SYS_futex: return "futex";
+    case SYS_accept: return "accept";
+    case SYS_accept4: return "accept4";
+    case SYS_ioctl: return "ioctl";
+    case SYS_setsockopt: return "setsockopt";
+    default: return nullptr;
+    }
+}
+#endif
+
+// 服务器子进程：停在 SIGSTOP 等待跟踪就绪，之后启动服务器并通过 ready 管道报告端口，
+// 读到 quit 管道的字节后退出，并回传本进程的 io_uring 统计
+[[noreturn]] void server_child(hwp::IoBackend backend, int ready_fd, int quit_fd) {
+    ptrace(PTRACE_TRACEME, 0, nullptr, nullptr);
+    raise(SIGSTOP);
+    // fork 继承了父进程之前各轮的累计统计
+    hwp::uring::UringStats before = hwp::uring::stats();
+    {
+        hwp::server::Server server(echo_options(backend));
+        set_echo(server);
+        server.run();
+        unsigned short port = server.port();
+        if (write(ready_fd, &port, sizeof(port)) != sizeof(port)) {
+            _exit(1);
+        }
+        char byte;
+        while (read(quit_fd, &byte, 1) < 0 && errno == EINTR) {
+        }
+        server.stop();
+    }
+    hwp::uring::UringStats stats = hwp::uring::stats();
+    stats.enter_calls -= before.enter_calls;
+    stats.submitted -= before.submitted;
+    stats.fixed_reads -= before.fixed_reads;
+    stats.accepted -= before.accepted;
+    if (write(ready_fd, &stats, sizeof(stats)) != sizeof(stats)) {
+        _exit(1);
+    }
+    _exit(0);
+}
+
+void syscall_run(hwp::IoBackend backend, size_t messages, size_t connections) {
+    int ready[2];
+    int quit[2];
+    if (pipe(ready) != 0 || pipe(quit) != 0) {
+        std::cerr << "pipe failed\n";
+        return;
+    }
+    pid_t child = fork();
+    if (child == 0) {
+        close(ready[0]);
+        close(quit[1]);
+        server_child(backend, ready[1], quit[0]);
+    }
+    close(ready[1]);
+    close(quit[0]);
+
+    int status = 0;
+    waitpid(child, &status, 0);
+    ptrace(PTRACE_SETOPTIONS, child, nullptr,
+           PTRACE_O_TRACECLONE | PTRACE_O_TRACESYSGOOD | PTRACE_O_EXITKILL);
+    ptrace(PTRACE_SYSCALL, child, nullptr, nullptr);
+
+    // 跟踪者只能是 fork 出子进程的线程，客户端放到另一个线程
+    std::atomic<uint64_t> syscalls{0};
+    std::atomic<bool> measuring{false};
+    uint64_t measured = 0;
+    LoopResult result;
+    std::thread client([&]() {
+        unsigned short port = 0;
+        if (read(ready[0], &port, sizeof(port)) != sizeof(port)) {
+            return;
+        }
+        run_closed_loop(port, hwp::IoBackend::EPOLL, messages / 10 + 1, connections);
+        measuring = true;
+        uint64_t before = syscalls.load();
+        result = run_closed_loop(port, hwp::IoBackend::EPOLL, messages, connections);
+        measured = syscalls.load() - before;
+        measuring = false;
+        char byte = 0;
+        if (write(quit[1], &byte, 1) != 1) {
+            std::cerr << "quit failed\n";
+        }
+    });
+
+    std::map<pid_t, bool> in_syscall;
+    std::map<long, uint64_t> breakdown;
+    for (;;) {
+        pid_t pid = waitpid(-1, &status, __WALL);
+        if (pid < 0) {
+            break;      // 所有被跟踪的线程都已退出
+        }
+        if (WIFEXITED(status) || WIFSIGNALED(status)) {
+            in_syscall.erase(pid);
+            continue;
+        }
+        int signal = 0;
+        if (WIFSTOPPED(status)) {
+            int stop = WSTOPSIG(status);
+            if (stop == (SIGTRAP | 0x80)) {
+                bool& inside = in_syscall[pid];
+                if (!inside) {
+                    syscalls.fetch_add(1, std::memory_order_relaxed);
+#if defined(__x86_64__)
+                    if (measuring) {
+                        user_regs_struct regs{};
+                        ptrace(PTRACE_GETREGS, pid, nullptr, &regs);
+                        ++breakdown[static_cast<long>(regs.orig_rax)];
+                    }
+#endif
+                }
+                inside = !inside;
+            } else if (stop != SIGTRAP && stop != SIGSTOP) {
+                signal = stop;  // 转发真实信号
+            }
+        }
+        ptrace(PTRACE_SYSCALL, pid, nullptr, signal);
+    }
+    client.join();
+
+    hwp::uring::UringStats stats;
+    bool have_stats = read(ready[0], &stats, sizeof(stats)) == sizeof(stats);
+    close(ready[0]);
+    close(quit[1]);
+
+    double per_message = result.completed ? static_cast<double>(measured) / result.completed : 0.0;
+    std::cout << std::setw(10) << backend_name(backend)
+              << std::fixed << std::setprecision(2)
+              << "  " << std::setw(6) << per_message << " syscalls/msg";
+    if (have_stats && stats.enter_calls > 0) {
+        std::cout << "  " << std::setprecision(1) << static_cast<double>(stats.submitted) / stats.enter_calls
+                  << " sqe/enter  fixed reads " << stats.fixed_reads << "  accepted " << stats.accepted;
+    }
+    std::cout << (result.completed != messages ? "  INCOMPLETE" : "") << "\n";
+#if defined(__x86_64__)
+    std::vector<std::pair<uint64_t, long>> top;
+    for (const auto& entry : breakdown) {
+        top.emplace_back(entry.second, entry.first);
+    }
+    std::sort(top.rbegin(), top.rend());
+    for (size_t i = 0; i < top.size() && i < 5; ++i) {
+        const char* name = syscall_name(top[i].second);
+        std::cout << std::setw(24) << (name ? name : std::to_string(top[i].second).c_str())
+                  << std::setprecision(2) << "  " << std::setw(6)
+                  << (result.completed ? static_cast<double>(top[i].first) / result.completed : 0.0) << "/msg\n";
+    }
+#endif
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t messages = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    size_t connections = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 8;
+
+    std::vector<hwp::IoBackend> backends = {hwp::IoBackend::EPOLL};
+    if (hwp::uring::supported()) {
+        backends.push_back(hwp::IoBackend::IO_URING);
+    } else {
+        std::cout << "io_uring not supported by this kernel, only epoll is measured\n";
+    }
+
+    std::cout << "latency (" << connections << " connections, 64 B ping-pong)\n";
+    for (auto backend : backends) {
+        latency_run(backend, messages, connections);
+    }
+    std::cout << "server syscalls (traced, epoll client)\n";
+    for (auto backend : backends) {
+        syscall_run(backend, messages / 10, connections);
+    }
+    return 0;
+}
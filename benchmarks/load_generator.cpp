@@ -0,0 +1,269 @@
+// 回环负载生成器：以 HTTP 或 Wire 模式压测服务器，报告吞吐与 HDR 延迟百分位（JSON 输出到标准输出）
+// - 闭环（rate 为 0）：保持 connections * depth 个在途请求，收到回复立即发出下一个
+// - 开环（rate > 0）：按固定速率发出请求，不等待回复；延迟从计划发出时刻算起，
+//   服务器变慢时排队时间计入延迟（避免 coordinated omission）
+// 未指定 --port 时在进程内启动回显服务器
+//
+// 用法: bench_load [--mode wire|http] [--connections N] [--depth N] [--size BYTES] [--rate REQ/S]
+//                  [--duration SECONDS] [--warmup SECONDS] [--host ADDR] [--port PORT]
+//                  [--threads N] [--backend epoll|io_uring] [--handler callback|session]
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../include/hwp.hpp"
+#include "hdr_histogram.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Config {
+    std::string mode = "wire";
+    size_t connections = 4;
+    size_t depth = 1;               // 闭环时每条连接的在途请求数
+    size_t size = 64;               // 负载（Wire）或请求体（HTTP）字节数
+    double rate = 0;                // 开环的总请求速率，0 为闭环
+    double duration = 5;
+    double warmup = 1;
+    std::string host = "127.0.0.1";
+    unsigned short port = 0;        // 0：进程内启动服务器
+    size_t threads = 1;             // 进程内服务器的线程数
+    hwp::IoBackend backend = hwp::IoBackend::EPOLL;
+    bool session = false;           // 进程内服务器用协程会话代替消息回调
+};
+
+bool parse_args(int argc, char* argv[], Config& config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "missing value for " << arg << "\n";
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--mode") {
+            config.mode = value;
+        } else if (arg == "--connections") {
+            config.connections = std::strtoul(value.c_str(), nullptr, 10);
+        } else if (arg == "--depth") {
+            config.depth = std::strtoul(value.c_str(), nullptr, 10);
+        } else if (arg == "--size") {
+            config.size = std::strtoul(value.c_str(), nullptr, 10);
+        } else if (arg == "--rate") {
+            config.rate = std::strtod(value.c_str(), nullptr);
+        } else if (arg == "--duration") {
+            config.duration = std::strtod(value.c_str(), nullptr);
+        } else if (arg == "--warmup") {
+            config.warmup = std::strtod(value.c_str(), nullptr);
+        } else if (arg == "--host") {
+            config.host = value;
+        } else if (arg == "--port") {
+            config.port = static_cast<unsigned short>(std::strtoul(value.c_str(), nullptr, 10));
+        } else if (arg == "--threads") {
+            config.threads = std::strtoul(value.c_str(), nullptr, 10);
+        } else if (arg == "--backend") {
+            config.backend = value == "io_uring" ? hwp::IoBackend::IO_URING : hwp::IoBackend::EPOLL;
+        } else if (arg == "--handler") {
+            config.session = value == "session";
+        } else {
+            std::cerr << "unknown option " << arg << "\n";
+            return false;
+        }
+    }
+    if (config.mode != "wire" && config.mode != "http") {
+        std::cerr << "mode must be wire or http\n";
+        return false;
+    }
+    config.connections = std::max<size_t>(1, config.connections);
+    config.depth = std::max<size_t>(1, config.depth);
+    return true;
+}
+
+std::string http_request(size_t size) {
+    return "POST /echo HTTP/1.1\r\nHost: localhost\r\nContent-Type: application/octet-stream\r\nContent-Length: " +
+           std::to_string(size) + "\r\n\r\n" + std::string(size, 'x');
+}
+
+// 发出请求并记录延迟；预热期间完成的请求不计入统计
+class LoadGenerator {
+public:
+    LoadGenerator(boost::asio::io_context& io, const Config& config)
+        : config_(config), timer_(io),
+          payload_(config.size, 'x'), request_(http_request(config.size)) {
+        hwp::client::AsyncClientOptions options;
+        options.connections = config.connections;
+        options.backend = config.backend;
+        client_ = std::make_unique<hwp::client::AsyncClient>(io, config.host, config.port, options);
+    }
+
+    void start() {
+        client_->async_connect([this](boost::system::error_code ec) {
+            if (ec) {
+                std::cerr << "connect failed: " << ec.message() << "\n";
+                connect_failed_ = true;
+                return;
+            }
+            begin_ = Clock::now();
+            measure_from_ = begin_ + to_duration(config_.warmup);
+            stop_at_ = measure_from_ + to_duration(config_.duration);
+            if (config_.rate > 0) {
+                next_due_ = begin_;
+                tick();
+            } else {
+                for (size_t i = 0; i < config_.connections * config_.depth; ++i) {
+                    issue(Clock::now(), true);
+                }
+            }
+        });
+    }
+
+    void report(std::ostream& out) const {
+        double seconds = config_.duration;
+        out << "{\"benchmark\":\"load\""
+            << ",\"mode\":" << bench::json_string(config_.mode)
+            << ",\"loop\":" << bench::json_string(config_.rate > 0 ? "open" : "closed")
+            << ",\"backend\":" << bench::json_string(config_.backend == hwp::IoBackend::IO_URING ? "io_uring" : "epoll")
+            << ",\"handler\":" << bench::json_string(config_.session ? "session" : "callback")
+            << ",\"connections\":" << config_.connections
+            << ",\"depth\":" << config_.depth
+            << ",\"size\":" << config_.size
+            << ",\"target_rate\":" << config_.rate
+            << ",\"duration_s\":" << seconds
+            << ",\"requests\":" << histogram_.count()
+            << ",\"errors\":" << errors_
+            << ",\"unfinished\":" << outstanding_
+            << ",\"throughput_rps\":" << histogram_.count() / seconds
+            << ",\"throughput_mib_s\":" << histogram_.count() * config_.size / seconds / (1024.0 * 1024.0)
+            << ",\"latency_us\":";
+        bench::write_latency_json(out, histogram_);
+        out << "}\n";
+    }
+
+    bool failed() const { return connect_failed_; }
+
+private:
+    static Clock::duration to_duration(double seconds) {
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    }
+
+    // 开环：补发所有已到计划时刻的请求，再等到下一个计划时刻
+    void tick() {
+        auto interval = to_duration(1.0 / config_.rate);
+        auto now = Clock::now();
+        while (next_due_ <= now && next_due_ < stop_at_) {
+            issue(next_due_, false);
+            next_due_ += interval;
+        }
+        if (next_due_ >= stop_at_) {
+            finish_if_drained();
+            return;
+        }
+        timer_.expires_at(next_due_);
+        timer_.async_wait([this](boost::system::error_code ec) {
+            if (!ec) {
+                tick();
+            }
+        });
+    }
+
+    void issue(Clock::time_point intended, bool closed_loop) {
+        ++outstanding_;
+        auto done = [this, intended, closed_loop](boost::system::error_code ec) {
+            --outstanding_;
+            auto now = Clock::now();
+            if (ec) {
+                ++errors_;
+            } else if (intended >= measure_from_ && intended < stop_at_) {
+                histogram_.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    now - intended).count()));
+            }
+            if (closed_loop && !ec && now < stop_at_) {
+                issue(now, true);
+                return;
+            }
+            finish_if_drained();
+        };
+        if (config_.mode == "http") {
+            client_->async_http_request(request_, [done](boost::system::error_code ec, std::string /*response*/) {
+                done(ec);
+            });
+        } else {
+            client_->async_request(hwp::MessageType::DATA, payload_,
+                [done](boost::system::error_code ec, hwp::Message /*reply*/) { done(ec); });
+        }
+    }
+
+    void finish_if_drained() {
+        if (outstanding_ == 0 && (config_.rate <= 0 || next_due_ >= stop_at_)) {
+            client_->close();
+        }
+    }
+
+    Config config_;
+    boost::asio::steady_timer timer_;
+    std::unique_ptr<hwp::client::AsyncClient> client_;
+    std::vector<uint8_t> payload_;
+    std::string request_;
+    bench::HdrHistogram histogram_;
+    Clock::time_point begin_;
+    Clock::time_point measure_from_;
+    Clock::time_point stop_at_;
+    Clock::time_point next_due_;
+    size_t outstanding_ = 0;
+    uint64_t errors_ = 0;
+    bool connect_failed_ = false;
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Config config;
+    if (!parse_args(argc, argv, config)) {
+        return 2;
+    }
+
+    std::unique_ptr<hwp::server::Server> server;
+    if (config.port == 0) {
+        hwp::server::ServerOptions options;
+        options.port = 0;
+        options.threads = config.threads;
+        options.backend = config.backend;
+        server = std::make_unique<hwp::server::Server>(options);
+        if (config.session) {
+            server->set_session_handler([](hwp::server::Session& session) -> hwp::Task<void> {
+                while (auto msg = co_await session.read_message()) {
+                    co_await session.send(hwp::ProtocolHandler::create_reply(*msg, msg->session_header.msg_type,
+                                                                             std::move(msg->payload)));
+                }
+            });
+        } else {
+            server->set_message_handler([](const std::shared_ptr<hwp::server::Connection>& connection, hwp::Message& msg) {
+                connection->send(hwp::ProtocolHandler::create_reply(msg, msg.session_header.msg_type,
+                                                                    std::move(msg.payload)));
+            });
+        }
+        server->set_http_handler([](const hwp::http::Request& request, hwp::http::Response& response) {
+            response.content_type = "application/octet-stream";
+            response.body.assign(request.body.data(), request.body.size());
+        });
+        server->run();
+        config.port = server->port();
+    }
+
+    boost::asio::io_context io;
+    LoadGenerator generator(io, config);
+    generator.start();
+    io.run();
+    if (server) {
+        server->stop();
+    }
+    if (generator.failed()) {
+        return 1;
+    }
+    generator.report(std::cout);
+    return 0;
+}
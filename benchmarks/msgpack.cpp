@@ -0,0 +1,137 @@
+// 类型化负载微基准：msgpack 编码后拷贝进消息、解码为自有类型（std::string / std::vector），
+// 对比直接编码进消息的负载缓冲区、解码为指向负载的视图并在 arena 中分配数组
+// 每项自动校准迭代次数，运行约 min_ms 毫秒；结果以 JSON 输出到标准输出
+//
+// 用法: bench_msgpack [min_ms]
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "../include/hwp.hpp"
+#include "hdr_histogram.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// 负载中二进制字段的长度
+const size_t BLOB_SIZES[] = {0, 64, 512, 4096, 65536};
+
+// 防止编译器把结果当作无用代码删掉
+volatile size_t sink;
+
+// 自有类型：解码时拷贝字符串与二进制
+struct Order {
+    uint64_t id = 0;
+    std::string symbol;
+    double price = 0;
+    int32_t quantity = 0;
+    std::vector<std::string> tags;
+    std::vector<uint8_t> blob;
+    HWP_MSGPACK(id, symbol, price, quantity, tags, blob)
+};
+
+// 视图类型：与 Order 编码相同，字符串与二进制指向负载，数组在 arena 中
+struct OrderView {
+    uint64_t id = 0;
+    std::string_view symbol;
+    double price = 0;
+    int32_t quantity = 0;
+    std::span<const std::string_view> tags;
+    hwp::msgpack::Bytes blob;
+    HWP_MSGPACK(id, symbol, price, quantity, tags, blob)
+};
+
+struct Result {
+    const char* op;
+    size_t payload;
+    uint64_t iterations;
+    double ns_per_op;
+};
+
+// 批量运行 body 直到超过 min_ms：每批次数翻倍，避免计时开销占比过大
+template <typename Body>
+Result measure(const char* op, size_t payload, double min_ms, Body&& body) {
+    for (int i = 0; i < 16; ++i) {
+        body();     // 预热：分配器与缓存
+    }
+    uint64_t batch = 1;
+    uint64_t iterations = 0;
+    double elapsed_ns = 0;
+    while (elapsed_ns < min_ms * 1e6) {
+        auto start = Clock::now();
+        for (uint64_t i = 0; i < batch; ++i) {
+            body();
+        }
+        elapsed_ns += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        iterations += batch;
+        batch *= 2;
+    }
+    return Result{op, payload, iterations, elapsed_ns / iterations};
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    double min_ms = argc > 1 ? std::strtod(argv[1], nullptr) : 200.0;
+    const uint8_t flags = static_cast<uint8_t>(hwp::Flags::BINARY_MODE);
+    std::vector<Result> results;
+
+    for (size_t blob_size : BLOB_SIZES) {
+        Order order;
+        order.id = 0x1234567890ull;
+        order.symbol = "HWP-EXCHANGE-SYMBOL-0001";
+        order.price = 1234.5;
+        order.quantity = -42;
+        order.tags = {"limit", "good-till-cancelled", "post-only-routing-tag", "venue-a"};
+        order.blob.assign(blob_size, 0x5a);
+        size_t size = hwp::msgpack::encoded_size(order);
+
+        // 现有做法：编码到临时 vector，再拷贝进消息
+        results.push_back(measure("encode_copy", size, min_ms, [&]() {
+            std::vector<uint8_t> payload(hwp::msgpack::encoded_size(order));
+            hwp::msgpack::encode(order, payload.data());
+            hwp::Message msg = hwp::ProtocolHandler::create_message(hwp::MessageType::DATA, 1, payload, flags);
+            sink = msg.payload.size();
+            hwp::pool::release_buffer(std::move(msg.payload));
+        }));
+
+        // 直接编码进消息的负载缓冲区（负载随后交给写出路径，这里归还内存池模拟写完）
+        results.push_back(measure("encode_direct", size, min_ms, [&]() {
+            hwp::Message msg = hwp::msgpack::make_message(hwp::MessageType::DATA, 1, order, flags);
+            sink = msg.payload.size();
+            hwp::pool::release_buffer(std::move(msg.payload));
+        }));
+
+        hwp::Message msg = hwp::msgpack::make_message(hwp::MessageType::DATA, 1, order, flags);
+
+        results.push_back(measure("decode_copy", size, min_ms, [&]() {
+            hwp::msgpack::Arena arena;
+            Order decoded;
+            bool ok = hwp::msgpack::decode(msg, decoded, arena);
+            sink = ok + decoded.blob.size() + decoded.tags.size();
+        }));
+
+        // 每条消息一个 arena：首块内联在栈上，四个标签不需要堆分配
+        results.push_back(measure("decode_view", size, min_ms, [&]() {
+            hwp::msgpack::Arena arena;
+            OrderView decoded;
+            bool ok = hwp::msgpack::decode(msg, decoded, arena);
+            sink = ok + decoded.blob.size() + decoded.tags.size();
+        }));
+    }
+
+    std::cout << "{\"benchmark\":\"msgpack\",\"results\":[";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        std::cout << (i ? "," : "") << "\n  {\"op\":" << bench::json_string(r.op)
+                  << ",\"payload\":" << r.payload
+                  << ",\"iterations\":" << r.iterations
+                  << ",\"ns_per_op\":" << r.ns_per_op
+                  << ",\"ops_per_s\":" << 1e9 / r.ns_per_op
+                  << ",\"mib_per_s\":" << static_cast<double>(r.payload) / r.ns_per_op * 1e9 / (1024.0 * 1024.0) << "}";
+    }
+    std::cout << "\n]}\n";
+    return 0;
+}
@@ -0,0 +1,109 @@
+// 可靠消息压测：不同发送窗口下的吞吐与 ACK 合并情况，以及连接中途断开后的补发
+// 窗口 1 即停等确认，作为对照
+//
+// 用法: bench_reliable [messages] [payload_bytes]
+#include <iostream>
+#include <iomanip>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <cstdlib>
+#include "../include/hwp.hpp"
+
+namespace {
+
+struct Result {
+    double seconds = 0;
+    size_t acked = 0;
+    hwp::ReliableStats stats;
+};
+
+// 握手后一次性提交全部消息，超出窗口的部分在客户端排队，全部确认后结束
+Result run(unsigned short port, const hwp::ReliableOptions& reliable, size_t messages, size_t payload_size) {
+    boost::asio::io_context io;
+    hwp::client::AsyncClientOptions options;
+    options.connections = 1;
+    options.reliable = reliable;
+    hwp::client::AsyncClient client(io, "127.0.0.1", port, options);
+
+    Result result;
+    auto start = std::chrono::steady_clock::now();
+    client.async_handshake("bench", [&](boost::system::error_code ec) {
+        if (ec) {
+            std::cerr << "handshake failed: " << ec.message() << "\n";
+            return;
+        }
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < messages; ++i) {
+            client.async_send_reliable(hwp::MessageType::DATA, std::vector<uint8_t>(payload_size, 'r'),
+                [&](boost::system::error_code ec) {
+                    if (!ec && ++result.acked == messages) {
+                        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                        result.stats = client.reliable_stats();
+                        client.close();
+                    }
+                });
+        }
+    });
+    io.run();
+    return result;
+}
+
+void report(const std::string& name, const Result& result, size_t messages) {
+    std::cout << std::setw(24) << name
+              << std::fixed << std::setprecision(0)
+              << std::setw(10) << messages / result.seconds << " msg/s"
+              << std::setw(8) << result.stats.acks_received << " acks"
+              << std::setprecision(1)
+              << std::setw(8) << static_cast<double>(messages) / std::max<uint64_t>(result.stats.acks_received, 1)
+              << " msg/ack"
+              << std::setw(8) << result.stats.retransmitted << " retx\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t messages = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    size_t payload_size = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 256;
+
+    // 统计交付给应用的消息数；drop_at 非 0 时在收到第 drop_at 条后断开一次连接
+    std::atomic<size_t> delivered{0};
+    std::atomic<size_t> drop_at{0};
+    hwp::server::ServerOptions options;
+    options.port = 0;
+    hwp::server::Server server(options);
+    server.set_message_handler([&](const std::shared_ptr<hwp::server::Connection>& connection, hwp::Message& /*msg*/) {
+        size_t count = ++delivered;
+        size_t expected = drop_at.load();
+        if (expected != 0 && count == expected && drop_at.compare_exchange_strong(expected, 0)) {
+            connection->close();
+        }
+    });
+    server.run();
+
+    // 停等：窗口 1，每条立即确认
+    {
+        hwp::ReliableOptions reliable;
+        reliable.window = 1;
+        reliable.ack_every = 1;
+        size_t count = std::min<size_t>(messages, 20000);
+        report("stop-and-wait", run(server.port(), reliable, count, payload_size), count);
+    }
+    for (uint32_t window : {16u, 128u, 1024u, 8192u}) {
+        hwp::ReliableOptions reliable;
+        reliable.window = window;
+        report("window " + std::to_string(window), run(server.port(), reliable, messages, payload_size), messages);
+    }
+
+    // 中途断开：服务器收到一半消息后关闭连接，客户端重连恢复会话后只补发未确认部分
+    delivered = 0;
+    drop_at = messages / 2;
+    Result dropped = run(server.port(), hwp::ReliableOptions(), messages, payload_size);
+    report("window 1024, drop once", dropped, messages);
+    std::cout << std::setw(24) << "" << "  delivered " << delivered.load() << " of " << messages
+              << (delivered.load() == messages ? " (exactly once)" : " MISMATCH") << "\n";
+
+    server.stop();
+    return delivered.load() == messages ? 0 : 1;
+}
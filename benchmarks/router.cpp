@@ -0,0 +1,154 @@
+// 路由压测：单个 I/O 线程上同时有耗 CPU 的请求和普通小消息
+// 对比耗时处理函数内联执行与卸载到工作线程池时，小消息的往返延迟与两类请求的吞吐
+//
+// 用法: bench_router [seconds] [heavy_us] [workers]
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "../include/hwp.hpp"
+#include "hdr_histogram.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr hwp::MessageType HEAVY = static_cast<hwp::MessageType>(0x20);
+constexpr size_t HEAVY_DEPTH = 4;       // 耗时请求的在途数
+
+volatile uint64_t sink;
+
+// 占用 CPU 约 micros 微秒
+void burn(double micros) {
+    auto until = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::micro>(micros));
+    uint64_t x = 1;
+    while (Clock::now() < until) {
+        for (int i = 0; i < 256; ++i) {
+            x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+        }
+    }
+    sink = x;
+}
+
+struct Result {
+    bench::HdrHistogram ping;
+    uint64_t heavy = 0;
+};
+
+Result run(hwp::server::Dispatch mode, double seconds, double heavy_us, size_t workers) {
+    hwp::server::ServerOptions options;
+    options.port = 0;
+    options.threads = 1;
+    hwp::server::Server server(options);
+    hwp::server::RouterOptions router_options;
+    router_options.workers.threads = workers;
+    hwp::server::Router router(router_options);
+
+    router.on<hwp::MessageType::DATA>([](const std::shared_ptr<hwp::server::Connection>& connection, hwp::Message& msg) {
+        connection->send(hwp::ProtocolHandler::create_reply(msg, msg.session_header.msg_type, std::move(msg.payload)));
+    });
+    if (mode == hwp::server::Dispatch::INLINE) {
+        router.on<HEAVY>([heavy_us](const std::shared_ptr<hwp::server::Connection>& connection, hwp::Message& msg) {
+            burn(heavy_us);
+            connection->send(hwp::ProtocolHandler::create_reply(msg, HEAVY, std::move(msg.payload)));
+        });
+    } else {
+        router.on<HEAVY, hwp::server::Dispatch::OFFLOAD>([heavy_us](hwp::Message& msg) -> std::optional<hwp::Message> {
+            burn(heavy_us);
+            return hwp::ProtocolHandler::create_reply(msg, HEAVY, std::move(msg.payload));
+        });
+    }
+    server.set_message_handler(router.handler());
+    server.run();
+
+    Result result;
+    boost::asio::io_context io;
+    hwp::client::AsyncClientOptions client_options;
+    client_options.connections = 1;
+    hwp::client::AsyncClient pings(io, "127.0.0.1", server.port(), client_options);
+    hwp::client::AsyncClient heavy(io, "127.0.0.1", server.port(), client_options);
+    std::vector<uint8_t> payload(64, 'x');
+    Clock::time_point stop_at;
+    size_t open = 2;
+
+    auto finish = [&]() {
+        if (--open == 0) {
+            pings.close();
+            heavy.close();
+        }
+    };
+    std::function<void()> ping;
+    ping = [&]() {
+        auto start = Clock::now();
+        pings.async_request(hwp::MessageType::DATA, payload, [&, start](boost::system::error_code ec, hwp::Message) {
+            auto now = Clock::now();
+            result.ping.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count()));
+            if (ec || now >= stop_at) {
+                finish();
+                return;
+            }
+            ping();
+        });
+    };
+    size_t heavy_outstanding = 0;
+    std::function<void()> issue_heavy;
+    issue_heavy = [&]() {
+        ++heavy_outstanding;
+        heavy.async_request(HEAVY, payload, [&](boost::system::error_code ec, hwp::Message) {
+            --heavy_outstanding;
+            if (!ec) {
+                ++result.heavy;
+            }
+            if (!ec && Clock::now() < stop_at) {
+                issue_heavy();
+            } else if (heavy_outstanding == 0) {
+                finish();
+            }
+        });
+    };
+
+    size_t connected = 0;
+    auto start_load = [&](boost::system::error_code ec) {
+        if (ec) {
+            std::cerr << "connect failed: " << ec.message() << "\n";
+            return;
+        }
+        if (++connected < 2) {
+            return;
+        }
+        stop_at = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+        for (size_t i = 0; i < HEAVY_DEPTH; ++i) {
+            issue_heavy();
+        }
+        ping();
+    };
+    pings.async_connect(start_load);
+    heavy.async_connect(start_load);
+    io.run();
+    server.stop();
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    double seconds = argc > 1 ? std::strtod(argv[1], nullptr) : 3.0;
+    double heavy_us = argc > 2 ? std::strtod(argv[2], nullptr) : 2000.0;
+    size_t workers = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 0;
+
+    std::cout << "heavy handler " << heavy_us << " us, " << HEAVY_DEPTH << " in flight; 64 B ping on the same I/O thread\n";
+    std::cout << std::fixed << std::setprecision(1);
+    for (auto mode : {hwp::server::Dispatch::INLINE, hwp::server::Dispatch::OFFLOAD}) {
+        Result r = run(mode, seconds, heavy_us, workers);
+        std::cout << std::setw(8) << (mode == hwp::server::Dispatch::INLINE ? "inline" : "offload")
+                  << "  ping " << std::setw(8) << r.ping.count() / seconds << " msg/s"
+                  << "  p50 " << std::setw(8) << r.ping.percentile(50) / 1e3 << " us"
+                  << "  p99 " << std::setw(8) << r.ping.percentile(99) / 1e3 << " us"
+                  << "  heavy " << std::setw(7) << r.heavy / seconds << " req/s\n";
+    }
+    return 0;
+}
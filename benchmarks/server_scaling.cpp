@@ -0,0 +1,178 @@
+// 回环压测：服务器线程数从 1 扩展到 N 时的连接速率与消息速率
+//
+// 用法: bench_server_scaling [max_threads] [clients] [seconds]
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <algorithm>
+#include "../include/hwp.hpp"
+
+using namespace boost::asio;
+using namespace std::chrono_literals;
+
+namespace {
+
+// 单个压测阶段
+enum class Phase {
+    CONNECT,    // 建连后立即关闭，测 accept 吞吐
+    REQUEST,    // 建连 + 一次 HTTP 请求/响应
+    WIRE        // Wire 模式长连接上的回显往返
+};
+
+const std::string& http_request() {
+    static const std::string request = [] {
+        hwp::BaseHeader header{};
+        header.magic[0] = 'H';
+        header.magic[1] = 'W';
+        header.magic[2] = 'P';
+        header.magic[3] = '\0';
+        header.version = hwp::PROTOCOL_VERSION;
+        header.flags = static_cast<uint8_t>(hwp::Flags::HTTP_MODE);
+        header.head_len = htons(sizeof(hwp::BaseHeader));
+        std::string data(reinterpret_cast<const char*>(&header), sizeof(header));
+        data += "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n";
+        return data;
+    }();
+    return request;
+}
+
+// 单连接上持续发送 64 字节消息并等待回显，返回完成的往返次数
+uint64_t run_wire_client(io_context& io, const ip::tcp::endpoint& endpoint, const std::atomic<bool>& done) {
+    boost::system::error_code ec;
+    ip::tcp::socket socket(io);
+    socket.connect(endpoint, ec);
+    if (ec) {
+        return 0;
+    }
+    socket.set_option(ip::tcp::no_delay(true));
+
+    auto msg = hwp::ProtocolHandler::create_message(hwp::MessageType::DATA, 1, std::vector<uint8_t>(64, 'x'),
+                                                    static_cast<uint8_t>(hwp::Flags::BINARY_MODE));
+    auto frame = hwp::ProtocolHandler::serialize_message(msg);
+    std::vector<uint8_t> reply(frame.size());
+
+    uint64_t count = 0;
+    while (!done.load(std::memory_order_relaxed)) {
+        write(socket, buffer(frame), ec);
+        read(socket, buffer(reply), ec);
+        if (ec) {
+            break;
+        }
+        ++count;
+    }
+    return count;
+}
+
+// 返回每秒完成的操作数
+double run_phase(unsigned short port, Phase phase, std::size_t clients, std::chrono::seconds duration) {
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> completed{0};
+    std::vector<std::thread> threads;
+
+    for (std::size_t i = 0; i < clients; ++i) {
+        threads.emplace_back([&]() {
+            io_context io;
+            ip::tcp::endpoint endpoint(ip::address_v4::loopback(), port);
+            std::vector<char> response(4096);
+            uint64_t local = 0;
+            if (phase == Phase::WIRE) {
+                local = run_wire_client(io, endpoint, done);
+            }
+            while (phase != Phase::WIRE && !done.load(std::memory_order_relaxed)) {
+                boost::system::error_code ec;
+                ip::tcp::socket socket(io);
+                socket.connect(endpoint, ec);
+                if (ec) {
+                    continue;
+                }
+                if (phase == Phase::REQUEST) {
+                    write(socket, buffer(http_request()), ec);
+                    // 服务器写完响应后关闭连接，读到 EOF 为止
+                    while (!ec) {
+                        socket.read_some(buffer(response), ec);
+                    }
+                    if (ec != error::eof) {
+                        continue;
+                    }
+                }
+                ++local;
+            }
+            completed += local;
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(duration);
+    done = true;
+    for (auto& t : threads) {
+        t.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return completed.load() / elapsed.count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::size_t hw = std::max(1u, std::thread::hardware_concurrency());
+    std::size_t max_threads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : hw;
+    std::size_t clients = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2 * hw;
+    std::chrono::seconds duration(argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 2);
+
+    std::cout << "clients=" << clients << " duration=" << duration.count() << "s\n";
+    std::cout << std::setw(8) << "threads"
+              << std::setw(16) << "mode"
+              << std::setw(16) << "conns/sec"
+              << std::setw(16) << "http msgs/sec"
+              << std::setw(16) << "wire msgs/sec" << "\n";
+
+    // 1, 2, 4, ... 直到 max_threads（末项总是 max_threads）
+    std::vector<std::size_t> steps;
+    for (std::size_t threads = 1; threads < max_threads; threads *= 2) {
+        steps.push_back(threads);
+    }
+    steps.push_back(std::max<std::size_t>(max_threads, 1));
+
+    for (std::size_t threads : steps) {
+        for (bool reuse_port : {true, false}) {
+            if (threads == 1 && !reuse_port) {
+                continue;
+            }
+            hwp::server::ServerOptions options;
+            options.port = 0;
+            options.threads = threads;
+            options.reuse_port = reuse_port;
+            hwp::server::Server server(options);
+            server.set_message_handler([](const std::shared_ptr<hwp::server::Connection>& connection,
+                                          hwp::Message& msg) {
+                connection->send(hwp::ProtocolHandler::create_reply(msg, msg.session_header.msg_type,
+                                                                        std::move(msg.payload)));
+            });
+            server.run();
+
+            double conns = run_phase(server.port(), Phase::CONNECT, clients, duration);
+            double msgs = run_phase(server.port(), Phase::REQUEST, clients, duration);
+            double wire = run_phase(server.port(), Phase::WIRE, clients, duration);
+            server.stop();
+
+            std::cout << std::setw(8) << threads
+                      << std::setw(16) << (reuse_port ? "reuseport" : "handoff")
+                      << std::setw(16) << std::fixed << std::setprecision(0) << conns
+                      << std::setw(16) << msgs
+                      << std::setw(16) << wire << "\n";
+        }
+    }
+
+    auto stats = hwp::server::Server::pool_stats();
+    std::cout << "pool: block hits=" << stats.block_hits << " misses=" << stats.block_misses
+              << " cached=" << stats.blocks_cached
+              << " | buffer hits=" << stats.buffer_hits << " misses=" << stats.buffer_misses
+              << " cached=" << stats.buffers_cached
+              << " | handler inline=" << stats.handler_inline << " fallback=" << stats.handler_fallback << "\n";
+    return 0;
+}
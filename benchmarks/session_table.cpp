@@ -0,0 +1,92 @@
+// 会话表压测：预填充大量空闲会话后，多线程随机 touch 的吞吐与内存占用
+//
+// 用法: bench_session_table [sessions] [max_threads] [seconds]
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <vector>
+#include <random>
+#include <string>
+#include <cstdlib>
+#include <algorithm>
+#include "../include/hwp/session_table.hpp"
+
+namespace {
+
+// 当前进程常驻内存（KiB），读取失败返回 0
+long resident_kib() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmRSS:", 0) == 0) {
+            return std::strtol(line.c_str() + 6, nullptr, 10);
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t sessions = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    size_t max_threads = argc > 2 ? std::strtoul(argv[2], nullptr, 10)
+                                  : std::max(1u, std::thread::hardware_concurrency());
+    std::chrono::seconds duration(argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1);
+
+    long rss_before = resident_kib();
+    hwp::SessionTableOptions options;
+    options.max_sessions = sessions;
+    hwp::SessionTable table(options);
+
+    std::vector<uint32_t> ids;
+    ids.reserve(sessions);
+    auto fill_start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < sessions; ++i) {
+        ids.push_back(table.create("client").session_id);
+    }
+    std::chrono::duration<double> fill = std::chrono::steady_clock::now() - fill_start;
+    long rss_after = resident_kib();
+
+    std::cout << "sessions=" << table.size()
+              << " fill=" << std::fixed << std::setprecision(2) << fill.count() << "s"
+              << " rss=" << (rss_after - rss_before) / 1024 << "MiB"
+              << " (" << (rss_after - rss_before) * 1024.0 / std::max<size_t>(sessions, 1) << " B/session)\n";
+    std::cout << std::setw(8) << "threads" << std::setw(20) << "touches/sec" << std::setw(20) << "per thread" << "\n";
+
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        std::atomic<bool> done{false};
+        std::atomic<uint64_t> total{0};
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t]() {
+                std::mt19937 rng(static_cast<uint32_t>(t + 1));
+                std::uniform_int_distribution<size_t> pick(0, ids.size() - 1);
+                uint64_t count = 0;
+                while (!done.load(std::memory_order_relaxed)) {
+                    for (int i = 0; i < 1024; ++i) {
+                        table.touch(ids[pick(rng)]);
+                    }
+                    count += 1024;
+                }
+                total += count;
+            });
+        }
+        std::this_thread::sleep_for(duration);
+        done = true;
+        for (auto& w : workers) {
+            w.join();
+        }
+        double rate = total.load() / static_cast<double>(duration.count());
+        std::cout << std::setw(8) << threads
+                  << std::setw(20) << std::setprecision(0) << rate
+                  << std::setw(20) << rate / threads << "\n";
+    }
+
+    auto stats = table.stats();
+    std::cout << "hits=" << stats.hits << " misses=" << stats.misses
+              << " evicted=" << stats.evicted << " expired=" << stats.expired << "\n";
+    return 0;
+}
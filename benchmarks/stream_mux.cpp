@@ -0,0 +1,128 @@
+// 流复用压测：同一连接上大块传输与小消息并发时，小消息的往返延迟
+// 对比大块数据走默认流（整帧发送，不受流控）与走独立流（分帧交错 + 流控）
+//
+// 用法: bench_stream_mux [bulk_mib] [message_kib]
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <memory>
+#include <functional>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include "../include/hwp.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+    double bulk_seconds = 0;
+    std::vector<double> ping_us;
+};
+
+// 在一条连接上发送 bulk_messages 条大消息，期间不断发送串行小请求
+Result run(unsigned short port, bool bulk_on_stream, size_t bulk_messages, size_t message_size) {
+    boost::asio::io_context io;
+    hwp::client::AsyncClientOptions options;
+    options.connections = 1;
+    hwp::client::AsyncClient client(io, "127.0.0.1", port, options);
+
+    Result result;
+    uint16_t bulk_stream = bulk_on_stream ? client.open_stream() : 0;
+    uint16_t ping_stream = client.open_stream();
+    size_t bulk_done = 0;
+    bool ping_outstanding = false;
+    auto bulk_start = Clock::now();
+
+    auto finish = [&]() {
+        if (bulk_done == bulk_messages && !ping_outstanding) {
+            client.close();
+        }
+    };
+
+    auto ping = std::make_shared<std::function<void()>>();
+    *ping = [&, ping]() {
+        auto start = Clock::now();
+        ping_outstanding = true;
+        client.async_request(ping_stream, hwp::MessageType::DATA, std::vector<uint8_t>(64, 'p'),
+            [&, ping, start](boost::system::error_code ec, hwp::Message /*reply*/) {
+                if (ec) {
+                    return;
+                }
+                result.ping_us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+                ping_outstanding = false;
+                if (bulk_done < bulk_messages) {
+                    (*ping)();
+                }
+                finish();
+            });
+    };
+
+    client.async_connect([&](boost::system::error_code ec) {
+        if (ec) {
+            std::cerr << "connect failed: " << ec.message() << "\n";
+            return;
+        }
+        bulk_start = Clock::now();
+        for (size_t i = 0; i < bulk_messages; ++i) {
+            client.async_request(bulk_stream, hwp::MessageType::DATA, std::vector<uint8_t>(message_size, 'b'),
+                [&](boost::system::error_code ec, hwp::Message /*reply*/) {
+                    if (!ec && ++bulk_done == bulk_messages) {
+                        result.bulk_seconds = std::chrono::duration<double>(Clock::now() - bulk_start).count();
+                    }
+                    finish();
+                });
+        }
+        (*ping)();
+    });
+    io.run();
+    *ping = nullptr;
+    return result;
+}
+
+void report(const char* name, Result& result, size_t bulk_bytes) {
+    auto& samples = result.ping_us;
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&](double p) {
+        return samples.empty() ? 0.0 : samples[std::min(samples.size() - 1, static_cast<size_t>(p * samples.size()))];
+    };
+    std::cout << std::setw(18) << name
+              << std::fixed << std::setprecision(0)
+              << "  pings " << std::setw(6) << samples.size()
+              << "  p50 " << std::setw(8) << percentile(0.50) << " us"
+              << "  p99 " << std::setw(8) << percentile(0.99) << " us"
+              << "  max " << std::setw(8) << (samples.empty() ? 0.0 : samples.back()) << " us"
+              << std::setprecision(1)
+              << "  bulk " << std::setw(7) << bulk_bytes / (1024.0 * 1024.0) / result.bulk_seconds << " MiB/s\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t bulk_mib = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 256;
+    size_t message_kib = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1024;
+    size_t message_size = message_kib * 1024;
+    size_t bulk_messages = std::max<size_t>(1, bulk_mib * 1024 / message_kib);
+
+    // 小消息回显，大消息只回一个空确认
+    hwp::server::ServerOptions options;
+    options.port = 0;
+    hwp::server::Server server(options);
+    server.set_message_handler([](const std::shared_ptr<hwp::server::Connection>& connection, hwp::Message& msg) {
+        std::vector<uint8_t> payload;
+        if (msg.payload.size() <= 1024) {
+            payload = std::move(msg.payload);
+        }
+        connection->send(hwp::ProtocolHandler::create_reply(msg, msg.session_header.msg_type, std::move(payload)));
+    });
+    server.run();
+
+    Result unsplit = run(server.port(), false, bulk_messages, message_size);
+    report("bulk on stream 0", unsplit, bulk_messages * message_size);
+    Result multiplexed = run(server.port(), true, bulk_messages, message_size);
+    report("bulk on own stream", multiplexed, bulk_messages * message_size);
+
+    server.stop();
+    return 0;
+}
@@ -0,0 +1,138 @@
+// 大消息上传：整条消息在内存中发送与重组，对比从数据源逐帧发送、服务器逐帧处理
+// 两种方式各上传一条 size MiB 的消息，报告耗时与进程峰值内存的增长（先测流式，峰值只增不减）
+//
+// 用法: bench_streaming [size_mib] [frame_kib]
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+#include <sys/resource.h>
+#include "../include/hwp.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double peak_rss_mib() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<double>(usage.ru_maxrss) / 1024.0;
+}
+
+uint8_t pattern(uint64_t offset) {
+    return static_cast<uint8_t>(offset * 131 + (offset >> 12));
+}
+
+struct Result {
+    double seconds = 0;
+    double rss_growth = 0;
+    bool ok = false;
+};
+
+Result run(bool streaming, uint64_t size, uint32_t frame) {
+    hwp::server::ServerOptions options;
+    options.port = 0;
+    options.threads = 1;
+    options.flow.max_frame_payload = frame;
+    hwp::server::Server server(options);
+
+    // 服务器校验内容后回复收到的字节数（回复走默认流，按请求匹配）
+    auto checked = std::make_shared<uint64_t>(0);
+    auto reply = [](const std::shared_ptr<hwp::server::Connection>& connection, const hwp::SessionHeader& header,
+                    uint64_t bytes) {
+        hwp::Message request;
+        request.session_header = header;
+        hwp::Message msg = hwp::ProtocolHandler::create_reply(request, hwp::MessageType::DATA,
+                                                              std::vector<uint8_t>(sizeof(bytes)));
+        std::memcpy(msg.payload.data(), &bytes, sizeof(bytes));
+        msg.session_header.stream_id = 0;
+        connection->send(std::move(msg));
+    };
+    if (streaming) {
+        server.set_chunk_handler([checked, reply](const std::shared_ptr<hwp::server::Connection>& connection,
+                                                  hwp::PayloadChunk& chunk) {
+            for (size_t i = 0; i < chunk.data.size(); ++i) {
+                *checked += chunk.data[i] == pattern(chunk.offset + i) ? 1 : 0;
+            }
+            if (chunk.last) {
+                reply(connection, chunk.header, *checked);
+            }
+        });
+    } else {
+        server.set_message_handler([checked, reply](const std::shared_ptr<hwp::server::Connection>& connection,
+                                                    hwp::Message& msg) {
+            for (size_t i = 0; i < msg.payload.size(); ++i) {
+                *checked += msg.payload[i] == pattern(i) ? 1 : 0;
+            }
+            reply(connection, msg.session_header, *checked);
+        });
+    }
+    server.run();
+
+    double rss_before = peak_rss_mib();
+    boost::asio::io_context io;
+    hwp::client::AsyncClientOptions client_options;
+    client_options.connections = 1;
+    client_options.flow.max_frame_payload = frame;
+    hwp::client::AsyncClient client(io, "127.0.0.1", server.port(), client_options);
+
+    Result result;
+    auto start = Clock::now();
+    auto done = [&](boost::system::error_code ec, hwp::Message msg) {
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        uint64_t bytes = 0;
+        if (!ec && msg.payload.size() == sizeof(bytes)) {
+            std::memcpy(&bytes, msg.payload.data(), sizeof(bytes));
+        }
+        result.ok = bytes == size;
+        client.close();
+    };
+    uint16_t stream = client.open_stream();
+    if (streaming) {
+        auto offset = std::make_shared<uint64_t>(0);
+        client.async_request_stream(stream, [offset, size](uint8_t* data, size_t capacity) {
+            size_t length = static_cast<size_t>(std::min<uint64_t>(capacity, size - *offset));
+            for (size_t i = 0; i < length; ++i) {
+                data[i] = pattern(*offset + i);
+            }
+            *offset += length;
+            return length;
+        }, done);
+    } else {
+        std::vector<uint8_t> payload(size);
+        for (uint64_t i = 0; i < size; ++i) {
+            payload[i] = pattern(i);
+        }
+        client.async_request(stream, hwp::MessageType::DATA, std::move(payload), done);
+    }
+    io.run();
+    result.rss_growth = peak_rss_mib() - rss_before;
+    server.stop();
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    uint64_t size_mib = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 48;
+    uint32_t frame_kib = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 64;
+    uint64_t size = size_mib << 20;
+    uint32_t frame = frame_kib << 10;
+
+    std::cout << size_mib << " MiB upload, " << frame_kib << " KiB frames\n";
+    std::cout << std::fixed << std::setprecision(1);
+    for (bool streaming : {true, false}) {
+        if (!streaming && size > hwp::MAX_PAYLOAD_LEN) {
+            std::cout << "  buffered  skipped: larger than MAX_PAYLOAD_LEN\n";
+            continue;
+        }
+        Result r = run(streaming, size, frame);
+        std::cout << std::setw(10) << (streaming ? "streaming" : "buffered")
+                  << "  " << std::setw(8) << static_cast<double>(size) / (1 << 20) / r.seconds << " MiB/s"
+                  << "  peak RSS +" << std::setw(7) << r.rss_growth << " MiB"
+                  << (r.ok ? "" : "  (verification failed)") << "\n";
+    }
+    return 0;
+}
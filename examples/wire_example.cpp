@@ -0,0 +1,60 @@
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <string>
+#include "../include/hwp.hpp"
+
+using namespace std::chrono_literals;
+
+int main() {
+    try {
+        // 多线程模式服务器，每条连接一个协程会话，Wire 消息原样回显
+        hwp::server::ServerOptions options;
+        options.port = 8081;
+        options.threads = 2;
+        hwp::server::Server server(options);
+        server.set_session_handler([](hwp::server::Session& session) -> hwp::Task<void> {
+            while (auto msg = co_await session.read_message()) {
+                co_await session.send(hwp::ProtocolHandler::create_reply(*msg, msg->session_header.msg_type,
+                                                                         std::move(msg->payload)));
+            }
+        });
+        server.run();
+        std::cout << "服务器启动在 " << server.port() << " 端口...\n";
+
+        hwp::client::Client client("127.0.0.1", server.port());
+        if (!client.connect()) {
+            std::cerr << "无法连接到服务器\n";
+            return 1;
+        }
+
+        if (!client.handshake("wire_example")) {
+            std::cerr << "握手失败\n";
+            return 1;
+        }
+        std::cout << "会话ID: " << client.sessionId()
+                  << "，服务器会话数: " << server.sessions().size() << "\n";
+
+        // 同一连接上连续收发多条消息
+        for (int i = 0; i < 3; ++i) {
+            std::string text = "Hello, Wire Mode #" + std::to_string(i);
+            std::vector<uint8_t> payload(text.begin(), text.end());
+            if (!client.sendBinaryMessage(payload, hwp::MessageType::DATA)) {
+                return 1;
+            }
+
+            hwp::Message reply;
+            if (!client.receiveBinaryMessage(reply)) {
+                return 1;
+            }
+            std::cout << "收到回显: " << std::string(reply.payload.begin(), reply.payload.end()) << "\n";
+        }
+
+        client.close();
+        server.stop();
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "错误: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -2,8 +2,30 @@
 #define HWP_HPP
 
 #include "hwp/protocol.hpp"
+#include "hwp/http.hpp"
+#include "hwp/file_transfer.hpp"
+#include "hwp/pool.hpp"
+#include "hwp/capture.hpp"
+#include "hwp/msgpack.hpp"
+#include "hwp/stream.hpp"
+#include "hwp/backpressure.hpp"
+#include "hwp/egress.hpp"
+#include "hwp/admission.hpp"
+#include "hwp/reliable.hpp"
+#include "hwp/compression.hpp"
+#include "hwp/uring.hpp"
+#include "hwp/metrics.hpp"
+#include "hwp/session_store.hpp"
+#include "hwp/session_table.hpp"
+#include "hwp/connection.hpp"
+#include "hwp/task.hpp"
+#include "hwp/session.hpp"
+#include "hwp/work_pool.hpp"
+#include "hwp/router.hpp"
 #include "hwp/server.hpp"
 #include "hwp/client.hpp"
+#include "hwp/async_client.hpp"
+#include "hwp/proxy.hpp"
 
 namespace hwp {
 // Common functionality, types, and constants are defined in protocol.hpp
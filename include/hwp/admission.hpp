@@ -0,0 +1,77 @@
+#ifndef HWP_ADMISSION_HPP
+#define HWP_ADMISSION_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace hwp {
+
+// 排队延迟与令牌桶使用的单调时钟（纳秒），不受指标开关影响
+inline uint64_t steady_now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// 准入控制的统计，不受指标开关影响
+struct AdmissionStats {
+    uint64_t rejected_limit = 0;        // 达到最大连接数而拒绝的连接
+    uint64_t rejected_rate = 0;         // 超过接受速率而拒绝的连接
+    uint64_t rejected_overload = 0;     // 接受连接的线程过载而拒绝的连接
+    uint64_t shed = 0;                  // 过载时以 ERROR(OVERLOADED) 或 503 拒绝的请求
+};
+
+// 按排队延迟丢弃工作（CoDel）的参数
+struct CoDelOptions {
+    std::chrono::microseconds target{0};        // 可接受的排队延迟（常用 5 ms），0 表示从不丢弃
+    std::chrono::milliseconds interval{100};    // 观测窗口：窗口内最小延迟超过 target 才算持续过载
+};
+
+// 服务器的准入控制：在 accept 时限制连接，过载时以廉价的拒绝代替排队
+struct AdmissionOptions {
+    std::size_t max_connections = 0;    // 同时打开的连接数上限，0 表示不限
+    double accept_rate = 0;             // 每秒接受的新连接数（令牌桶），0 表示不限
+    std::size_t accept_burst = 64;      // 令牌桶容量，允许的突发连接数
+    CoDelOptions queue_delay;           // 事件循环的排队延迟，过载时拒绝新连接与新请求
+};
+
+// CoDel 的请求版本：不按递增频率丢包，而是在过载期间丢弃排队超过 2 * target 的工作。
+// 上一个观测窗口内的最小延迟超过 target 时进入过载——短暂的突发会在窗口内被排空，不会触发；
+// 持续的积压才会。线程安全，可由多个线程同时记录样本
+class CoDel {
+public:
+    explicit CoDel(const CoDelOptions& options = CoDelOptions());
+
+    // 记录一项工作的排队延迟（纳秒），返回 true 表示应丢弃它
+    bool shed(uint64_t delay_ns, uint64_t now_ns);
+    bool overloaded() const { return overloaded_.load(std::memory_order_relaxed); }
+
+private:
+    uint64_t target_;
+    uint64_t interval_;
+    std::atomic<uint64_t> interval_end_{0};
+    std::atomic<uint64_t> min_delay_{0};
+    std::atomic<bool> overloaded_{false};
+};
+
+// 令牌桶：每秒补充 rate 个令牌，最多积累 burst 个。线程安全
+class RateLimiter {
+public:
+    RateLimiter(double rate, std::size_t burst);
+
+    // 取一个令牌；rate 为 0 时总是成功
+    bool acquire(uint64_t now_ns);
+
+private:
+    double rate_;
+    double burst_;
+    std::mutex mutex_;
+    double tokens_;
+    uint64_t last_ns_ = 0;
+};
+
+} // namespace hwp
+
+#endif // HWP_ADMISSION_HPP
@@ -0,0 +1,99 @@
+#ifndef HWP_ASYNC_CLIENT_HPP
+#define HWP_ASYNC_CLIENT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <utility>
+#include <boost/asio.hpp>
+#include "compression.hpp"
+#include "protocol.hpp"
+#include "reliable.hpp"
+#include "stream.hpp"
+#include "uring.hpp"
+
+namespace hwp {
+namespace client {
+
+// 异步客户端配置
+struct AsyncClientOptions {
+    size_t connections = 4;     // 每种模式（Wire/HTTP）保持的热连接数
+    FlowControlOptions flow;    // 流复用的窗口与分帧参数（每条连接）
+    ReliableOptions reliable;   // 可靠消息的发送窗口与延迟确认参数（整个会话）
+    compress::CompressionOptions compression;   // 发往服务器的 DATA 消息是否压缩（整个会话共用字典）
+    IoBackend backend = IoBackend::EPOLL;       // Wire 连接读写的 I/O 后端（与 io_context 共用一个 ring）
+};
+
+// 异步客户端：运行在调用方的 io_context 上，一个实例对应一个服务端端点
+// 每个连接可同时有多个在途请求：Wire 模式按 seq_num/ack_num 匹配回复（序列号在会话内唯一），
+// HTTP 模式按发送顺序匹配响应。连接断开后在下一次请求时自动重连，已握手时重连后自动恢复会话。
+// 回调在客户端内部 strand 上执行，不应阻塞。
+class AsyncClient {
+public:
+    using ConnectHandler = std::function<void(boost::system::error_code)>;
+    using MessageCallback = std::function<void(boost::system::error_code, Message)>;
+    using HttpCallback = std::function<void(boost::system::error_code, std::string)>;
+    // 未匹配到请求的服务器消息（服务器主动推送）
+    using PushHandler = std::function<void(Message)>;
+    // 可靠消息被对端确认（或客户端关闭）时回调
+    using AckHandler = std::function<void(boost::system::error_code)>;
+    // 服务器流式消息的一段
+    using ChunkCallback = std::function<void(PayloadChunk&)>;
+
+    AsyncClient(boost::asio::io_context& io, const std::string& host, unsigned short port,
+                const AsyncClientOptions& options = AsyncClientOptions());
+    ~AsyncClient();
+
+    // 禁用拷贝
+    AsyncClient(const AsyncClient&) = delete;
+    AsyncClient& operator=(const AsyncClient&) = delete;
+
+    // 预热：建立全部 Wire 连接，全部成功或首个失败时回调
+    void async_connect(ConnectHandler handler);
+    // 握手建立会话，之后的消息都携带该会话ID
+    void async_handshake(const std::string& client_id, ConnectHandler handler);
+    // 发送请求并等待回复；服务器过载拒绝时以 error::try_again 回调（消息为 ERROR 回复）
+    void async_request(MessageType type, std::vector<uint8_t> payload, MessageCallback callback);
+    // 单向发送，不等待回复
+    void async_send(MessageType type, std::vector<uint8_t> payload);
+
+    // 分配一个逻辑流ID；同一流上的消息固定走一条连接并按序到达，
+    // 流上的 DATA 消息受流控并与其他流交错分帧，大块传输不会阻塞其他流
+    uint16_t open_stream();
+    void async_request(uint16_t stream_id, MessageType type, std::vector<uint8_t> payload,
+                       MessageCallback callback);
+    void async_send(uint16_t stream_id, MessageType type, std::vector<uint8_t> payload);
+    // 流式发送一条 DATA 消息：负载在流窗口允许时逐帧从 source 读取（每次最多 flow.max_frame_payload 字节），
+    // 不需要整条消息在内存中，总长也不受 payload_len 限制。source 在客户端 strand 上调用；
+    // 连接断开时消息随之中止，不会重发。stream_id 须来自 open_stream()
+    void async_request_stream(uint16_t stream_id, ByteSource source, MessageCallback callback);
+    void async_send_stream(uint16_t stream_id, ByteSource source);
+    // 可靠发送（REQUIRES_ACK），需先握手建立会话。未确认的消息最多 options.reliable.window 条，
+    // 超出后排队；连接断开后自动重连并恢复会话，只补发对端未确认的部分。
+    // 对端确认后以成功回调，close() 时未确认的消息以 operation_aborted 结束
+    void async_send_reliable(MessageType type, std::vector<uint8_t> payload, AckHandler handler = AckHandler());
+    // 在 HTTP 模式连接上流水线发送 HTTP 请求
+    void async_http_request(std::string request, HttpCallback callback);
+
+    void set_push_handler(PushHandler handler);
+    // 服务器在流上发来的 DATA 消息不再重组，逐帧交给 handler（不匹配请求、不经 push handler）；
+    // 需在建立连接之前调用
+    void set_chunk_handler(ChunkCallback handler);
+    uint32_t session_id() const;
+    // 会话的可靠传输统计（可从任意线程调用）
+    ReliableStats reliable_stats() const;
+    // 关闭所有连接，在途请求以 operation_aborted 结束
+    void close();
+
+private:
+    class Impl;
+    std::shared_ptr<Impl> impl_;
+};
+
+} // namespace client
+} // namespace hwp
+
+#endif // HWP_ASYNC_CLIENT_HPP
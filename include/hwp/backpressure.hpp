@@ -0,0 +1,48 @@
+#ifndef HWP_BACKPRESSURE_HPP
+#define HWP_BACKPRESSURE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "protocol.hpp"
+
+namespace hwp {
+
+// 写队列的水位与服务器级缓冲预算。
+// 连接写队列（已排队未写出的帧，含帧头）达到高水位时暂停读取该连接，并用 CONTROL PAUSE
+// 通知对端暂停发送新请求；降到低水位时恢复读取并发送 RESUME。
+// 所有连接写队列的合计超过预算时，写队列高于低水位的连接也暂停读取，
+// 积压最多的连接先被限制，积压少的连接不受影响。
+// 受流控的流数据由窗口约束，不计入写队列：暂停读取会收不到 WINDOW_UPDATE
+struct BackpressureOptions {
+    std::size_t high_watermark = 4 * 1024 * 1024;   // 单连接写队列字节数，0 表示不限
+    std::size_t low_watermark = 1024 * 1024;
+    std::size_t memory_budget = 256 * 1024 * 1024;  // 所有连接合计，0 表示不限
+};
+
+// 服务器内所有连接共享的写队列字节计数
+class BufferBudget {
+public:
+    explicit BufferBudget(std::size_t limit) : limit_(limit) {}
+
+    void add(std::size_t bytes) { used_.fetch_add(bytes, std::memory_order_relaxed); }
+    void release(std::size_t bytes) { used_.fetch_sub(bytes, std::memory_order_relaxed); }
+
+    std::size_t used() const { return used_.load(std::memory_order_relaxed); }
+    bool exceeded() const { return limit_ != 0 && used() > limit_; }
+
+private:
+    std::size_t limit_;
+    std::atomic<std::size_t> used_{0};
+};
+
+namespace backpressure {
+
+// CONTROL PAUSE 消息：pause 为 false 时表示恢复
+Message make_signal(uint32_t session_id, bool pause);
+bool parse_signal(const Message& msg, bool& pause);
+
+} // namespace backpressure
+} // namespace hwp
+
+#endif // HWP_BACKPRESSURE_HPP
@@ -0,0 +1,110 @@
+#ifndef HWP_CAPTURE_HPP
+#define HWP_CAPTURE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include "protocol.hpp"
+
+namespace hwp {
+namespace capture {
+
+// 抓包文件格式（多字节字段均为网络字节序）：
+//     文件头 16 字节: "HWPCAP" | u16 版本 | u64 开始时刻（系统时钟的 Unix 纳秒）
+//     记录   24 字节: u64 相对开始时刻的纳秒 | u64 连接ID | u32 记录的帧字节数 | u32 保留
+//            之后是帧的线上字节：BaseHeader + SessionHeader + 负载
+// 帧头与线上格式相同，会话ID、消息类型、负载长度都从帧头读出。
+// 记录的帧字节数小于帧长时（服务器直接 splice 落盘的文件数据），负载只保留了前面一段。
+// 各线程的记录按缓冲区成块写入：同一连接的记录保持顺序，不同线程的记录之间时刻不保证递增
+constexpr char FILE_MAGIC[6] = {'H', 'W', 'P', 'C', 'A', 'P'};
+constexpr uint16_t FILE_VERSION = 1;
+constexpr std::size_t FILE_HEADER_SIZE = 16;
+constexpr std::size_t RECORD_HEADER_SIZE = 24;
+
+// 抓包配置
+struct CaptureOptions {
+    std::string path;                   // 非空时记录 Wire 模式收到的每一帧
+    uint64_t max_bytes = 0;             // 文件长度上限，达到后不再记录；0 不限
+    std::size_t buffer_size = 1 << 20;  // 记录先写入所在线程的内存缓冲区，写满后交给后台线程写文件
+    std::size_t max_pending = 8;        // 等待写文件的缓冲区上限：磁盘跟不上时丢弃记录，不阻塞事件循环
+};
+
+// 抓包统计
+struct CaptureStats {
+    uint64_t records = 0;   // 已记录的帧
+    uint64_t bytes = 0;     // 已写入文件的字节（含文件头）
+    uint64_t dropped = 0;   // 缓冲区积压或达到 max_bytes 而丢弃的帧
+};
+
+// 抓包写入：record 可从任意线程调用，只在本线程的缓冲区里做一次内存拷贝，缓冲区写满时才取共享锁；
+// 文件写入在后台线程
+class CaptureWriter {
+public:
+    CaptureWriter();
+    ~CaptureWriter();   // 写出缓冲区中剩余的记录并关闭文件
+
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    // 创建（截断）文件并写入文件头，无法创建时返回 false
+    bool open(const CaptureOptions& options);
+    bool is_open() const;
+
+    // 记录收到的一帧；payload 为已收到的负载字节（length 可小于 session.payload_len）
+    void record(uint64_t connection_id, const BaseHeader& base, const SessionHeader& session,
+                const uint8_t* payload, std::size_t length);
+
+    // 写出全部记录并关闭，之后的 record 被忽略
+    void close();
+
+    CaptureStats stats() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// 抓包中的一条记录
+struct CaptureRecord {
+    uint64_t time_ns = 0;           // 相对抓包开始的纳秒
+    uint64_t connection_id = 0;
+    BaseHeader base{};              // 主机字节序
+    SessionHeader session{};        // 主机字节序
+    std::vector<uint8_t> frame;     // 线上字节（帧头 + 负载），截断的负载已补零到 payload_len
+    bool truncated = false;         // 负载没有完整记录
+};
+
+// 抓包读取：按写入顺序逐条读出
+class CaptureReader {
+public:
+    enum class Status {
+        OK,
+        END,        // 文件结束
+        ERROR       // 格式错误或文件在记录中间截断
+    };
+
+    CaptureReader() = default;
+    ~CaptureReader();
+
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+
+    // 打开文件并校验文件头
+    bool open(const std::string& path);
+
+    Status next(CaptureRecord& record);
+
+    uint64_t start_unix_ns() const { return start_unix_ns_; }
+
+private:
+    std::FILE* file_ = nullptr;
+    uint64_t start_unix_ns_ = 0;
+};
+
+} // namespace capture
+} // namespace hwp
+
+#endif // HWP_CAPTURE_HPP
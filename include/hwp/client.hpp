@@ -4,6 +4,7 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include <utility>
 #include <boost/asio.hpp>
 #include <cstdint>
 
@@ -11,6 +12,8 @@ namespace hwp {
 
 // 前向声明
 enum class MessageType : uint8_t;
+struct Message;
+struct FileTransferState;
 
 namespace client {
 
@@ -26,8 +29,15 @@ public:
     
     // 公共接口
     bool connect();
+    // 握手建立（或恢复）会话，之后发送的消息都携带该会话ID
+    bool handshake(const std::string& client_id);
+    uint32_t sessionId() const;
     std::string sendHttpRequest(const std::string& http_request);
     bool sendBinaryMessage(const std::vector<uint8_t>& payload, MessageType type);
+    bool receiveBinaryMessage(Message& msg);
+    // 上传文件：服务器回复已有字节数后从该偏移续传，文件内容用 sendfile 发送
+    // state 非空时写入最终的传输状态（失败时 bytes_transferred 为已发送的字节数）
+    bool sendFile(const std::string& path, const std::string& remote_name, FileTransferState* state = nullptr);
     void close();
     
     // Add client-specific methods here
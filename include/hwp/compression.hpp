@@ -0,0 +1,108 @@
+#ifndef HWP_COMPRESSION_HPP
+#define HWP_COMPRESSION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+#include "protocol.hpp"
+
+namespace hwp {
+namespace compress {
+
+// 压缩负载的编码方式，写在负载首字节
+enum class Codec : uint8_t {
+    NONE = 0x00,
+    DEFLATE_FAST = 0x01,    // raw deflate 级别 1：小消息，延迟优先
+    DEFLATE = 0x02          // raw deflate 级别 6：大块数据，压缩率优先
+};
+
+// 压缩负载前缀：u8 编码 + u32 字典ID（0 为不用字典）+ u32 原始长度，均为大端
+constexpr std::size_t HEADER_SIZE = 9;
+
+// 接收端为每条连接保留的字典数（发送端更换字典时，旧字典压缩的消息可能仍在途）
+constexpr std::size_t MAX_DICTIONARIES = 4;
+
+struct CompressionOptions {
+    bool enabled = false;                   // 发送方向是否压缩；接收方向始终能解压
+    std::size_t min_size = 64;              // 小于此长度的负载不压缩
+    std::size_t bulk_size = 16 * 1024;      // 不小于此长度的负载用 DEFLATE，否则 DEFLATE_FAST
+    double max_ratio = 0.9;                 // 压缩后长度 / 原始长度超过此值视为不可压缩
+    uint32_t probe_interval = 64;           // 近期不可压缩时跳过的消息数，之后重新试探
+    std::size_t dictionary_size = 4 * 1024;     // 共享字典大小上限（<= 32 KiB），0 禁用字典；
+                                            // zlib 每条消息都要重新载入字典，越大越慢
+    uint32_t dictionary_samples = 256;      // 每收集这么多条小消息样本训练一次字典
+};
+
+// 压缩统计（所有线程汇总）
+struct CompressionStats {
+    uint64_t messages = 0;          // 经过压缩阶段的消息
+    uint64_t compressed = 0;        // 以压缩形式发送的消息
+    uint64_t bytes_in = 0;          // 压缩消息的原始字节
+    uint64_t bytes_out = 0;         // 压缩消息的线上字节（含前缀）
+    uint64_t compress_ns = 0;       // 压缩耗时（含放弃的尝试）
+    uint64_t decompressed = 0;
+    uint64_t decompress_ns = 0;
+    uint64_t dictionaries = 0;      // 训练出的字典
+    uint64_t errors = 0;            // 解压失败
+};
+
+CompressionStats compression_stats();
+
+// 对端可以共享的字典，内容只读
+struct Dictionary {
+    uint32_t id = 0;
+    std::vector<uint8_t> bytes;
+};
+
+// 发送端：按负载长度与近期压缩率逐条选择编码，用近期的小消息训练字典。
+// zlib 上下文按线程复用，不随消息创建；对象本身非线程安全（每个会话或每条连接一个）
+class Compressor {
+public:
+    explicit Compressor(const CompressionOptions& options = CompressionOptions());
+
+    const CompressionOptions& options() const { return options_; }
+
+    // 只压缩 DATA 消息；不值得压缩时负载保持原样。
+    // 使用了该连接尚未通告的字典时（announced 为连接已通告的字典ID），
+    // DICTIONARY 控制消息追加到 control，调用方须先于 msg 写出。
+    // self_contained 时不用字典：可靠消息可能在重连后的新连接上补发，对端的字典已随旧连接丢失
+    void compress(Message& msg, uint32_t& announced, std::vector<Message>& control,
+                  bool self_contained = false);
+
+private:
+    enum SizeClass { SMALL, BULK, SIZE_CLASSES };
+
+    void sample(const std::vector<uint8_t>& payload);
+    void train();
+
+    CompressionOptions options_;
+    double ratio_[SIZE_CLASSES] = {0, 0};   // 压缩率的指数滑动平均
+    uint32_t skip_[SIZE_CLASSES] = {0, 0};
+    std::shared_ptr<const Dictionary> dictionary_;
+    std::deque<std::vector<uint8_t>> samples_;
+    uint32_t since_training_ = 0;
+    uint32_t sample_tick_ = 0;
+    uint32_t next_dictionary_id_ = 1;
+};
+
+// 接收端：保存对端通告的字典并解压。非线程安全（每条连接一个）
+class Decompressor {
+public:
+    // 处理 DICTIONARY 控制消息；是则返回 true（格式错误时 ok 置 false）
+    bool on_control(const Message& msg, bool& ok);
+    // 解压带 COMPRESSED 的消息并清除该标志；格式错误或字典未知时返回 false
+    bool decompress(Message& msg);
+
+private:
+    std::deque<std::shared_ptr<const Dictionary>> dictionaries_;
+};
+
+// 构造字典通告
+Message dictionary_message(uint32_t session_id, const Dictionary& dictionary);
+
+} // namespace compress
+} // namespace hwp
+
+#endif // HWP_COMPRESSION_HPP
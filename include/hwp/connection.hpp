@@ -0,0 +1,53 @@
+#ifndef HWP_CONNECTION_HPP
+#define HWP_CONNECTION_HPP
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <boost/asio/any_io_executor.hpp>
+#include "http.hpp"
+#include "protocol.hpp"
+#include "stream.hpp"
+
+namespace hwp {
+namespace server {
+
+// 服务器端的一条长连接（Wire 模式）
+// 所有 I/O 都在接受该连接的线程上执行；send/close 可从任意线程调用
+class Connection : public std::enable_shared_from_this<Connection> {
+public:
+    virtual ~Connection() = default;
+
+    // 异步发送一条消息；负载所有权移入，不拷贝。
+    // stream_id 非 0 的 DATA 消息受流控，按帧与其他流交错发送；其余消息按调用顺序直接写出
+    virtual void send(Message msg) { send(OutgoingFrame(std::move(msg))); }
+    // 异步发送已编码的帧，不受流控；借用负载时调用方需保证写完成前数据有效
+    virtual void send(OutgoingFrame frame) = 0;
+    // 可靠发送（REQUIRES_ACK）：序列号由消息所属会话分配，负载保留到对端确认；
+    // 连接断开后，客户端恢复会话时补发未确认的部分。session_id 为 0 时等同 send
+    virtual void send_reliable(Message msg) = 0;
+    // 流式发送：header 须为 stream_id 非 0 的 DATA 消息（负载被忽略），负载在流控窗口允许时
+    // 逐帧从 source 读取，不需要整条消息在内存中；source 在连接所属线程上调用。
+    // header 不受流控时返回 false
+    virtual bool send_stream(Message header, ByteSource source) = 0;
+    // 关闭连接，已排队的消息会被丢弃
+    virtual void close() = 0;
+    // 连接所属事件循环的执行器
+    virtual boost::asio::any_io_executor get_executor() = 0;
+    // 进程内唯一的连接编号
+    virtual uint64_t id() const = 0;
+};
+
+// Wire 模式消息回调，在连接所属线程上调用
+using MessageHandler = std::function<void(const std::shared_ptr<Connection>&, Message&)>;
+
+// 流式消息回调，在连接所属线程上调用：流上的 DATA 消息逐段交付（见 Server::set_chunk_handler）
+using ChunkHandler = std::function<void(const std::shared_ptr<Connection>&, PayloadChunk&)>;
+
+// HTTP 模式请求回调，在连接所属线程上同步调用；同一连接上的响应按请求顺序写出
+using HttpHandler = std::function<void(const http::Request&, http::Response&)>;
+
+} // namespace server
+} // namespace hwp
+
+#endif // HWP_CONNECTION_HPP
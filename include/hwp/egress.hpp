@@ -0,0 +1,83 @@
+#ifndef HWP_EGRESS_HPP
+#define HWP_EGRESS_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "pool.hpp"
+#include "protocol.hpp"
+
+namespace hwp {
+
+// 出口优先级，数值小的先写出
+enum class EgressClass : uint8_t {
+    CONTROL = 0,    // CONTROL、HANDSHAKE、ERROR：窗口更新、确认、PAUSE、握手与拒绝
+    DATA = 1,       // DATA（含流上切分的帧）
+    BULK = 2        // 文件传输：FILE_TRANSFER_START / DATA / END，保持三者之间的顺序
+};
+
+constexpr std::size_t EGRESS_CLASSES = 3;
+
+// 出口调度配置（每条连接）
+struct EgressOptions {
+    bool priority = true;                   // false 时按提交顺序写出
+    std::size_t batch_bytes = 256 * 1024;   // 一次聚合写的字节上限（至少一帧），高优先级帧最多等待一批
+    std::function<uint32_t(uint32_t session_id)> session_weight;    // 同一优先级内各会话的权重（会话的帧首次排队时查询），为空时均为 1
+};
+
+// 连接的出口调度器：高优先级的帧总是先于低优先级的帧写出；同一优先级内按会话做加权公平排队
+// （自计时公平排队：每帧的结束标签为 max(虚拟时间, 本会话上一帧的标签) + 帧长 / 权重，标签小者先出），
+// 会话内保持提交顺序。调度以帧为单位，大消息需在流上切分成多帧（见 StreamMux）才能让出带宽；
+// stream 0 上的消息接收端不重组，整帧写出。
+// 非线程安全，由所属连接在其执行器上调用
+class EgressScheduler {
+public:
+    explicit EgressScheduler(const EgressOptions& options = EgressOptions());
+
+    static EgressClass classify(MessageType type);
+
+    void push(OutgoingFrame&& frame);
+    // 取出下一帧，队列为空时返回 false
+    bool pop(OutgoingFrame& frame);
+
+    bool empty() const { return size_ == 0; }
+    std::size_t size() const { return size_; }
+    std::size_t batch_bytes() const { return options_.batch_bytes; }
+
+    void clear();
+
+private:
+    struct Entry {
+        OutgoingFrame frame;
+        uint64_t finish;
+    };
+
+    struct Flow {
+        std::deque<Entry, PoolAllocator<Entry>> queue;
+        uint64_t last_finish = 0;
+        uint32_t weight = 1;
+    };
+
+    // 活跃会话按队首帧的结束标签组成最小堆
+    using HeadTag = std::pair<uint64_t, uint32_t>;
+
+    struct Class {
+        std::unordered_map<uint32_t, Flow, std::hash<uint32_t>, std::equal_to<uint32_t>,
+                           PoolAllocator<std::pair<const uint32_t, Flow>>> flows;
+        std::vector<HeadTag> heads;
+        uint64_t virtual_time = 0;  // 最近写出的帧的结束标签
+    };
+
+    EgressOptions options_;
+    std::array<Class, EGRESS_CLASSES> classes_;
+    std::size_t size_ = 0;
+};
+
+} // namespace hwp
+
+#endif // HWP_EGRESS_HPP
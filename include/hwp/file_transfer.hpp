@@ -0,0 +1,92 @@
+#ifndef HWP_FILE_TRANSFER_HPP
+#define HWP_FILE_TRANSFER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+#include "protocol.hpp"
+
+namespace hwp {
+namespace transfer {
+
+// FILE_TRANSFER_* 负载格式（整数均为大端）：
+//   START 请求: u64 total_size | 文件名
+//   START 回复: u8 status | u64 续传偏移
+//   DATA:       u64 文件偏移 | 文件内容
+//   END 请求:   u64 total_size
+//   END 回复:   u8 status | u64 已接收字节数
+constexpr std::size_t DATA_PREFIX_SIZE = 8;
+constexpr uint32_t DEFAULT_CHUNK_SIZE = 4 * 1024 * 1024;
+
+enum class TransferStatus : uint8_t {
+    OK = 0,
+    REJECTED = 1,       // 文件名非法、未开启接收或已有同名传输
+    IO_ERROR = 2,
+    SIZE_MISMATCH = 3
+};
+
+void put_u64(uint8_t* out, uint64_t value);
+uint64_t get_u64(const uint8_t* in);
+
+// 文件名只允许单级名称，不能包含路径分隔符或 ".."
+bool valid_name(const std::string& name);
+
+// 发送端：帧头和偏移前缀用 writev 写出，文件内容用 sendfile 由内核直接送入 socket
+class FileSource {
+public:
+    FileSource() = default;
+    ~FileSource();
+
+    FileSource(const FileSource&) = delete;
+    FileSource& operator=(const FileSource&) = delete;
+
+    bool open(const std::string& path);
+    uint64_t size() const { return size_; }
+
+    // 在阻塞 socket 上写出覆盖 [offset, offset + length) 的一条 DATA 帧，header_source 提供会话字段
+    bool send_chunk(int socket_fd, const Message& header_source, uint64_t offset, uint32_t length);
+
+private:
+    int fd_ = -1;
+    uint64_t size_ = 0;
+};
+
+// 接收端：目标文件为 <dir>/<name>.part，按 total_size 预分配磁盘空间但不改变文件长度，
+// 数据只顺序追加，因此文件长度就是已落盘的字节数，重新打开时从该位置续传。
+// 完成后改名为 <dir>/<name>。
+class FileSink {
+public:
+    FileSink() = default;
+    ~FileSink();
+
+    FileSink(const FileSink&) = delete;
+    FileSink& operator=(const FileSink&) = delete;
+
+    TransferStatus open(const std::string& dir, const std::string& name, uint64_t total_size);
+
+    // 从非阻塞 socket 经管道 splice 最多 max 字节到文件末尾，数据不经过用户态。
+    // 返回写入的字节数；0 表示对端关闭；-1 表示出错，errno 为 EAGAIN 时应等待可读后重试。
+    // max 超出声明的文件大小时不读取，返回 -1 且 errno 为 EFBIG
+    ssize_t splice_from(int socket_fd, std::size_t max);
+    // 追加已在用户态的数据（例如读帧头时多读到的部分）；超出声明的文件大小时拒绝，errno 为 EFBIG
+    bool write(const uint8_t* data, std::size_t length);
+    // 核对长度并改名为最终文件
+    TransferStatus finish(uint64_t total_size);
+
+    const FileTransferState& state() const { return state_; }
+
+private:
+    ssize_t read_into_file(int socket_fd, std::size_t max);
+
+    std::string dir_;
+    int fd_ = -1;
+    int pipe_[2] = {-1, -1};
+    bool use_splice_ = true;
+    FileTransferState state_;
+};
+
+} // namespace transfer
+} // namespace hwp
+
+#endif // HWP_FILE_TRANSFER_HPP
@@ -0,0 +1,101 @@
+#ifndef HWP_HTTP_HPP
+#define HWP_HTTP_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace hwp {
+namespace http {
+
+// 单个请求最多的头部数量与头部总字节数
+constexpr std::size_t MAX_HEADERS = 32;
+constexpr std::size_t MAX_HEADER_BYTES = 64 * 1024;
+// 请求体上限，与 Wire 模式单帧负载上限一致
+constexpr std::size_t MAX_BODY_BYTES = 64 * 1024 * 1024;
+
+struct Header {
+    std::string_view name;
+    std::string_view value;
+};
+
+// 解析后的请求：所有字段都指向连接缓冲区，不拷贝，缓冲区改动后失效
+struct Request {
+    std::string_view method;
+    std::string_view target;
+    int version_minor = 1;          // HTTP/1.x 的 x
+    std::array<Header, MAX_HEADERS> headers;
+    std::size_t header_count = 0;
+    std::string_view body;          // chunked 请求体已在缓冲区内原地解码
+    bool keep_alive = true;
+
+    // 按名字查找头部（不区分大小写），不存在时返回空
+    std::string_view header(std::string_view name) const;
+};
+
+// 响应：由处理器填写，连接负责序列化；连接内复用同一对象，字符串容量不释放
+struct Response {
+    int status = 200;
+    std::string content_type = "text/plain";
+    std::string headers;            // 额外头部，每行以 \r\n 结尾
+    std::string body;
+    bool close = false;             // 发送后关闭连接
+
+    void set_header(std::string_view name, std::string_view value);
+    void reset();
+};
+
+enum class ParseStatus {
+    COMPLETE,
+    NEED_MORE,
+    ERROR
+};
+
+// 增量请求解析器：同一条请求可分多次调用 parse，每次传入从请求开头起的全部已收数据，
+// 已扫描过的字节不会重复扫描。缓冲区搬移时只需保持请求开头对齐，偏移量仍然有效。
+// 完成后 consumed() 为整条请求在缓冲区中占用的字节数，解析下一条前调用 reset()。
+class RequestParser {
+public:
+    // chunked 请求体会在 data 中原地解码，因此需要可写缓冲区
+    ParseStatus parse(char* data, std::size_t length, Request& request);
+    std::size_t consumed() const { return consumed_; }
+    void reset();
+
+private:
+    enum class Stage { HEAD, BODY, CHUNK_SIZE, CHUNK_DATA, TRAILER };
+
+    bool parse_head(const char* data, Request& request);
+    ParseStatus parse_chunks(char* data, std::size_t length);
+
+    Stage stage_ = Stage::HEAD;
+    std::size_t scanned_ = 0;       // 头部结束符搜索的起点
+    std::size_t head_length_ = 0;
+    std::size_t content_length_ = 0;
+    bool chunked_ = false;
+    std::size_t chunk_in_ = 0;      // 下一段原始 chunk 数据的位置
+    std::size_t chunk_out_ = 0;     // 已解码请求体的末尾
+    std::size_t chunk_left_ = 0;    // 当前 chunk 未处理的字节数
+    std::size_t consumed_ = 0;
+    const char* head_data_ = nullptr; // parse_head 时的缓冲区，搬移后重新解析头部
+};
+
+// 在 [begin, end) 中查找第一个 "\r\n"，返回指向 '\r' 的指针，找不到返回 end
+// 支持 SSE2 时每次比较 16 字节
+const char* find_crlf(const char* begin, const char* end);
+
+// 状态码对应的原因短语
+std::string_view reason_phrase(int status);
+
+// 将响应头和响应体追加到 out（HEAD 请求不带响应体）
+void serialize_response(const Response& response, bool head_only, std::string& out);
+
+// 计算缓冲区开头一条完整 HTTP 报文（头部 + Content-Length 指定的负载）的长度
+// 报文尚不完整时返回 0；没有 Content-Length 时视为无负载
+std::size_t message_length(const char* data, std::size_t length);
+
+} // namespace http
+} // namespace hwp
+
+#endif // HWP_HTTP_HPP
@@ -0,0 +1,115 @@
+#ifndef HWP_METRICS_HPP
+#define HWP_METRICS_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "protocol.hpp"
+
+// 编译期开关：为 0 时所有埋点都是空的内联函数，热路径上不留任何代码
+#ifndef HWP_METRICS
+#define HWP_METRICS 1
+#endif
+
+namespace hwp {
+namespace metrics {
+
+// 延迟直方图
+enum class Histogram : uint8_t {
+    PARSE,      // 一次读取后批量解码缓冲区内所有帧
+    DISPATCH,   // 一帧交给回调及连接内处理的耗时
+    WRITE,      // 一次聚合写从发起到完成
+    COUNT
+};
+
+// 准入控制拒绝连接的原因
+enum class Rejection : uint8_t {
+    LIMIT,      // 达到最大连接数
+    RATE,       // 超过接受速率
+    OVERLOAD,   // 接受连接的线程过载
+    COUNT
+};
+
+// 桶上界按 2 的幂从 1 µs 到约 1 s，另加 +Inf
+constexpr std::size_t HISTOGRAM_BUCKETS = 21;
+
+struct HistogramSnapshot {
+    std::array<uint64_t, HISTOGRAM_BUCKETS + 1> buckets{};  // 非累计，最后一个为 +Inf
+    uint64_t count = 0;
+    uint64_t sum_ns = 0;
+};
+
+// 所有线程的汇总
+struct MetricsSnapshot {
+    uint64_t connections_opened = 0;
+    uint64_t connections_closed = 0;
+    uint64_t bytes_received = 0;
+    uint64_t bytes_sent = 0;
+    std::array<uint64_t, 256> messages_received{};     // 按 MessageType 取值
+    uint64_t frames_sent = 0;
+    uint64_t http_requests = 0;
+    uint64_t parse_errors = 0;
+    uint64_t read_pauses = 0;
+    std::array<uint64_t, static_cast<std::size_t>(Rejection::COUNT)> connections_rejected{};
+    uint64_t requests_shed = 0;     // 过载时以 503 / ERROR 拒绝的请求
+    std::array<HistogramSnapshot, static_cast<std::size_t>(Histogram::COUNT)> histograms;
+};
+
+#if HWP_METRICS
+
+// 埋点只写本线程的计数器（relaxed 存储，不加锁、不竞争缓存行），抓取时汇总各线程
+void connection_opened();
+void connection_closed();
+void bytes_received(std::size_t bytes);
+void bytes_sent(std::size_t bytes);
+void message_received(MessageType type);
+void frames_sent(std::size_t frames);
+void http_request();
+void parse_error();
+void read_paused();     // 写队列积压，暂停读取一条连接
+void connection_rejected(Rejection reason);
+void request_shed();
+void observe(Histogram histogram, uint64_t nanoseconds);
+
+inline uint64_t now() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// 记录从 start（now() 的返回值）到现在的耗时
+inline void observe_since(Histogram histogram, uint64_t start) {
+    observe(histogram, now() - start);
+}
+
+#else
+
+inline void connection_opened() {}
+inline void connection_closed() {}
+inline void bytes_received(std::size_t) {}
+inline void bytes_sent(std::size_t) {}
+inline void message_received(MessageType) {}
+inline void frames_sent(std::size_t) {}
+inline void http_request() {}
+inline void parse_error() {}
+inline void read_paused() {}
+inline void connection_rejected(Rejection) {}
+inline void request_shed() {}
+inline void observe(Histogram, uint64_t) {}
+inline uint64_t now() { return 0; }
+inline void observe_since(Histogram, uint64_t) {}
+
+#endif // HWP_METRICS
+
+constexpr bool enabled() { return HWP_METRICS != 0; }
+
+MetricsSnapshot snapshot();
+
+// Prometheus 文本格式（0.0.4），追加到 out
+void render_prometheus(std::string& out);
+
+} // namespace metrics
+} // namespace hwp
+
+#endif // HWP_METRICS_HPP
@@ -0,0 +1,547 @@
+#ifndef HWP_MSGPACK_HPP
+#define HWP_MSGPACK_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <new>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "pool.hpp"
+#include "protocol.hpp"
+
+// 在结构体内声明参与编码的字段，按声明顺序编码为 msgpack 数组：
+//     struct Order {
+//         uint64_t id;
+//         std::string_view symbol;
+//         std::span<const int32_t> fills;
+//         HWP_MSGPACK(id, symbol, fills)
+//     };
+// 解码时多出的字段跳过、缺少的字段保持默认值，两端可以各自在末尾追加字段
+#define HWP_MSGPACK(...)                                                        \
+    template <typename Visitor>                                                 \
+    void msgpack_fields(Visitor&& visitor) { visitor(__VA_ARGS__); }            \
+    template <typename Visitor>                                                 \
+    void msgpack_fields(Visitor&& visitor) const { visitor(__VA_ARGS__); }
+
+namespace hwp {
+namespace msgpack {
+
+// 单条消息的解码内存：只分配不释放，reset() 或析构时整体归还。
+// 首块内联在对象中，小消息解码不分配堆内存；后续块取自线程内存池，按需翻倍。
+// 不调用析构函数，只用于可平凡析构的类型（视图、数值、由它们组成的结构体）
+class Arena {
+public:
+    Arena() = default;
+    ~Arena() { release(); }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(std::size_t size, std::size_t align) {
+        std::size_t offset = (align - reinterpret_cast<uintptr_t>(cursor_) % align) % align;
+        if (static_cast<std::size_t>(end_ - cursor_) < offset + size) {
+            return grow(size, align);
+        }
+        std::byte* p = cursor_ + offset;
+        cursor_ = p + size;
+        return p;
+    }
+
+    template <typename T>
+    T* allocate_array(std::size_t count) {
+        static_assert(std::is_trivially_destructible_v<T>, "arena memory is released without running destructors");
+        T* items = static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+        for (std::size_t i = 0; i < count; ++i) {
+            new (items + i) T();
+        }
+        return items;
+    }
+
+    // 归还全部外部块，回到内联块开头；之前解码出的结果随之失效
+    void reset() {
+        release();
+        cursor_ = inline_;
+        end_ = inline_ + sizeof(inline_);
+    }
+
+    // 已分配的外部块字节数（不含内联块）
+    std::size_t heap_bytes() const { return heap_bytes_; }
+
+private:
+    struct Block {
+        Block* next;
+        std::size_t size;
+    };
+
+    void* grow(std::size_t size, std::size_t align);
+    void release();
+
+    alignas(std::max_align_t) std::byte inline_[256];
+    std::byte* cursor_ = inline_;
+    std::byte* end_ = inline_ + sizeof(inline_);
+    Block* blocks_ = nullptr;
+    std::size_t heap_bytes_ = 0;
+};
+
+// 二进制数据的视图（msgpack bin），解码时指向接收缓冲区
+using Bytes = std::span<const uint8_t>;
+
+namespace detail {
+
+template <typename T> struct is_vector : std::false_type {};
+template <typename T, typename A> struct is_vector<std::vector<T, A>> : std::true_type {};
+template <typename T> struct is_span : std::false_type {};
+template <typename T, std::size_t N> struct is_span<std::span<T, N>> : std::bool_constant<N == std::dynamic_extent> {};
+template <typename T> struct is_optional : std::false_type {};
+template <typename T> struct is_optional<std::optional<T>> : std::true_type {};
+template <typename T> struct is_map : std::false_type {};
+template <typename K, typename V, typename C, typename A> struct is_map<std::map<K, V, C, A>> : std::true_type {};
+
+template <typename T>
+concept Fields = requires(T& value) { value.msgpack_fields([](auto&...) {}); };
+
+template <typename T>
+constexpr bool is_byte_view = std::is_same_v<T, Bytes> || std::is_same_v<T, std::span<uint8_t>>;
+
+template <typename>
+constexpr bool unsupported = false;
+
+// 数组解码时按声明的元素个数预留的上限：个数不可信，之后随实际解出的元素倍增，
+// 分配量因此不超过已解出元素的两倍，与声明的个数无关
+constexpr std::size_t ARRAY_RESERVE = 64;
+
+// 编码分两遍：Sizer 只计长度，Writer 写入已按长度分配好的缓冲区，不做边界检查
+class Sizer {
+public:
+    void put(uint8_t) { ++size_; }
+    void put(const void*, std::size_t length) { size_ += length; }
+    std::size_t size() const { return size_; }
+
+private:
+    std::size_t size_ = 0;
+};
+
+class Writer {
+public:
+    explicit Writer(uint8_t* out) : out_(out) {}
+    void put(uint8_t byte) { *out_++ = byte; }
+    void put(const void* data, std::size_t length) {
+        if (length > 0) {
+            std::memcpy(out_, data, length);
+            out_ += length;
+        }
+    }
+    uint8_t* position() const { return out_; }
+
+private:
+    uint8_t* out_;
+};
+
+// 大端写入 bytes 字节
+template <typename Sink>
+void put_be(Sink& sink, uint64_t value, int bytes) {
+    for (int shift = (bytes - 1) * 8; shift >= 0; shift -= 8) {
+        sink.put(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+template <typename Sink>
+void put_unsigned(Sink& sink, uint64_t value) {
+    if (value < 0x80) {
+        sink.put(static_cast<uint8_t>(value));
+    } else if (value <= 0xff) {
+        sink.put(0xcc);
+        put_be(sink, value, 1);
+    } else if (value <= 0xffff) {
+        sink.put(0xcd);
+        put_be(sink, value, 2);
+    } else if (value <= 0xffffffff) {
+        sink.put(0xce);
+        put_be(sink, value, 4);
+    } else {
+        sink.put(0xcf);
+        put_be(sink, value, 8);
+    }
+}
+
+template <typename Sink>
+void put_signed(Sink& sink, int64_t value) {
+    if (value >= 0) {
+        put_unsigned(sink, static_cast<uint64_t>(value));
+    } else if (value >= -32) {
+        sink.put(static_cast<uint8_t>(value));
+    } else if (value >= std::numeric_limits<int8_t>::min()) {
+        sink.put(0xd0);
+        put_be(sink, static_cast<uint64_t>(value), 1);
+    } else if (value >= std::numeric_limits<int16_t>::min()) {
+        sink.put(0xd1);
+        put_be(sink, static_cast<uint64_t>(value), 2);
+    } else if (value >= std::numeric_limits<int32_t>::min()) {
+        sink.put(0xd2);
+        put_be(sink, static_cast<uint64_t>(value), 4);
+    } else {
+        sink.put(0xd3);
+        put_be(sink, static_cast<uint64_t>(value), 8);
+    }
+}
+
+// 长度前缀：fix 形式（如有）、8、16、32 位
+template <typename Sink>
+void put_length(Sink& sink, std::size_t length, uint8_t fix, std::size_t fix_max, uint8_t code8, uint8_t code16,
+                uint8_t code32) {
+    if (fix != 0 && length <= fix_max) {
+        sink.put(static_cast<uint8_t>(fix | length));
+    } else if (code8 != 0 && length <= 0xff) {
+        sink.put(code8);
+        put_be(sink, length, 1);
+    } else if (length <= 0xffff) {
+        sink.put(code16);
+        put_be(sink, length, 2);
+    } else {
+        sink.put(code32);
+        put_be(sink, length, 4);
+    }
+}
+
+template <typename Sink>
+void put_str(Sink& sink, std::string_view text) {
+    put_length(sink, text.size(), 0xa0, 31, 0xd9, 0xda, 0xdb);
+    sink.put(text.data(), text.size());
+}
+
+template <typename Sink>
+void put_bin(Sink& sink, const uint8_t* data, std::size_t length) {
+    put_length(sink, length, 0, 0, 0xc4, 0xc5, 0xc6);
+    sink.put(data, length);
+}
+
+template <typename Sink>
+void put_array(Sink& sink, std::size_t count) {
+    put_length(sink, count, 0x90, 15, 0, 0xdc, 0xdd);
+}
+
+template <typename Sink>
+void put_map(Sink& sink, std::size_t count) {
+    put_length(sink, count, 0x80, 15, 0, 0xde, 0xdf);
+}
+
+template <typename Sink, typename T>
+void pack(Sink& sink, const T& value) {
+    if constexpr (std::is_same_v<T, bool>) {
+        sink.put(value ? 0xc3 : 0xc2);
+    } else if constexpr (std::is_enum_v<T>) {
+        pack(sink, static_cast<std::underlying_type_t<T>>(value));
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+        put_signed(sink, value);
+    } else if constexpr (std::is_integral_v<T>) {
+        put_unsigned(sink, value);
+    } else if constexpr (std::is_same_v<T, float>) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        sink.put(0xca);
+        put_be(sink, bits, 4);
+    } else if constexpr (std::is_same_v<T, double>) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        sink.put(0xcb);
+        put_be(sink, bits, 8);
+    } else if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>) {
+        put_str(sink, value);
+    } else if constexpr (is_byte_view<T> || std::is_same_v<T, std::vector<uint8_t>>) {
+        put_bin(sink, value.data(), value.size());
+    } else if constexpr (is_vector<T>::value || is_span<T>::value) {
+        put_array(sink, value.size());
+        for (const auto& item : value) {
+            pack(sink, item);
+        }
+    } else if constexpr (is_map<T>::value) {
+        put_map(sink, value.size());
+        for (const auto& [key, item] : value) {
+            pack(sink, key);
+            pack(sink, item);
+        }
+    } else if constexpr (is_optional<T>::value) {
+        if (value) {
+            pack(sink, *value);
+        } else {
+            sink.put(0xc0);
+        }
+    } else if constexpr (Fields<T>) {
+        value.msgpack_fields([&sink](const auto&... fields) {
+            put_array(sink, sizeof...(fields));
+            (pack(sink, fields), ...);
+        });
+    } else {
+        static_assert(unsupported<T>, "type has no msgpack encoding; add HWP_MSGPACK(...) to it");
+    }
+}
+
+// 解码游标：越界、类型不符时返回 false，不抛异常
+class Reader {
+public:
+    Reader(const uint8_t* data, std::size_t size, Arena& arena) : p_(data), end_(data + size), arena_(arena) {}
+
+    bool done() const { return p_ == end_; }
+    std::size_t remaining() const { return static_cast<std::size_t>(end_ - p_); }
+    Arena& arena() { return arena_; }
+
+    bool peek(uint8_t& code) const {
+        if (p_ == end_) {
+            return false;
+        }
+        code = *p_;
+        return true;
+    }
+
+    bool byte(uint8_t& out) {
+        if (p_ == end_) {
+            return false;
+        }
+        out = *p_++;
+        return true;
+    }
+
+    bool be(uint64_t& out, int bytes) {
+        if (remaining() < static_cast<std::size_t>(bytes)) {
+            return false;
+        }
+        out = 0;
+        for (int i = 0; i < bytes; ++i) {
+            out = (out << 8) | *p_++;
+        }
+        return true;
+    }
+
+    bool take(std::size_t length, const uint8_t*& out) {
+        if (remaining() < length) {
+            return false;
+        }
+        out = p_;
+        p_ += length;
+        return true;
+    }
+
+    // 整数：任意宽度的 msgpack 整数，negative 表示值为负（此时 value 为补码）
+    bool integer(uint64_t& value, bool& negative);
+    // str 或 bin 的内容（两者都接受）
+    bool raw(const uint8_t*& data, std::size_t& length);
+    bool array(std::size_t& count);
+    bool map(std::size_t& count);
+    bool real(double& value);
+    // 跳过一个任意类型的值（含扩展类型），嵌套过深时失败
+    bool skip(int depth = 0);
+
+private:
+    const uint8_t* p_;
+    const uint8_t* end_;
+    Arena& arena_;
+};
+
+template <typename T>
+bool unpack(Reader& reader, T& out) {
+    if constexpr (std::is_same_v<T, bool>) {
+        uint8_t code;
+        if (!reader.byte(code) || (code != 0xc2 && code != 0xc3)) {
+            return false;
+        }
+        out = code == 0xc3;
+        return true;
+    } else if constexpr (std::is_enum_v<T>) {
+        std::underlying_type_t<T> raw;
+        if (!unpack(reader, raw)) {
+            return false;
+        }
+        out = static_cast<T>(raw);
+        return true;
+    } else if constexpr (std::is_integral_v<T>) {
+        uint64_t value;
+        bool negative;
+        if (!reader.integer(value, negative)) {
+            return false;
+        }
+        if constexpr (std::is_signed_v<T>) {
+            auto signed_value = static_cast<int64_t>(value);
+            if (negative ? signed_value < std::numeric_limits<T>::min()
+                         : value > static_cast<uint64_t>(std::numeric_limits<T>::max())) {
+                return false;
+            }
+            out = static_cast<T>(signed_value);
+        } else {
+            if (negative || value > std::numeric_limits<T>::max()) {
+                return false;
+            }
+            out = static_cast<T>(value);
+        }
+        return true;
+    } else if constexpr (std::is_floating_point_v<T>) {
+        double value;
+        if (!reader.real(value)) {
+            return false;
+        }
+        out = static_cast<T>(value);
+        return true;
+    } else if constexpr (std::is_same_v<T, std::string_view> || is_byte_view<T>) {
+        // 视图：指向接收缓冲区，不拷贝
+        const uint8_t* data;
+        std::size_t length;
+        if (!reader.raw(data, length)) {
+            return false;
+        }
+        if constexpr (std::is_same_v<T, std::string_view>) {
+            out = std::string_view(reinterpret_cast<const char*>(data), length);
+        } else {
+            out = T(const_cast<uint8_t*>(data), length);
+        }
+        return true;
+    } else if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::vector<uint8_t>>) {
+        const uint8_t* data;
+        std::size_t length;
+        if (!reader.raw(data, length)) {
+            return false;
+        }
+        out.assign(data, data + length);
+        return true;
+    } else if constexpr (is_span<T>::value) {
+        // 数组：元素在 arena 中分配，空间不够时换一块翻倍的（旧块随 arena 一起归还）
+        using Item = std::remove_const_t<typename T::element_type>;
+        std::size_t count;
+        // 每个元素至少占 1 字节
+        if (!reader.array(count) || count > reader.remaining()) {
+            return false;
+        }
+        std::size_t capacity = std::min(count, ARRAY_RESERVE);
+        Item* items = reader.arena().template allocate_array<Item>(capacity);
+        for (std::size_t i = 0; i < count; ++i) {
+            if (i == capacity) {
+                capacity = std::min(count, capacity * 2);
+                Item* grown = reader.arena().template allocate_array<Item>(capacity);
+                std::copy(items, items + i, grown);
+                items = grown;
+            }
+            if (!unpack(reader, items[i])) {
+                return false;
+            }
+        }
+        out = T(items, count);
+        return true;
+    } else if constexpr (is_vector<T>::value) {
+        std::size_t count;
+        if (!reader.array(count) || count > reader.remaining()) {
+            return false;
+        }
+        out.clear();
+        out.reserve(std::min(count, ARRAY_RESERVE));
+        for (std::size_t i = 0; i < count; ++i) {
+            if (!unpack(reader, out.emplace_back())) {
+                return false;
+            }
+        }
+        return true;
+    } else if constexpr (is_map<T>::value) {
+        std::size_t count;
+        if (!reader.map(count) || count > reader.remaining()) {
+            return false;
+        }
+        out.clear();
+        for (std::size_t i = 0; i < count; ++i) {
+            typename T::key_type key;
+            typename T::mapped_type item;
+            if (!unpack(reader, key) || !unpack(reader, item)) {
+                return false;
+            }
+            out.insert_or_assign(std::move(key), std::move(item));
+        }
+        return true;
+    } else if constexpr (is_optional<T>::value) {
+        uint8_t code;
+        if (!reader.peek(code)) {
+            return false;
+        }
+        if (code == 0xc0) {
+            reader.byte(code);
+            out.reset();
+            return true;
+        }
+        return unpack(reader, out.emplace());
+    } else if constexpr (Fields<T>) {
+        std::size_t count;
+        if (!reader.array(count)) {
+            return false;
+        }
+        bool ok = true;
+        std::size_t index = 0;
+        out.msgpack_fields([&](auto&... fields) {
+            ((ok = ok && (index++ >= count || unpack(reader, fields))), ...);
+        });
+        for (; ok && index < count; ++index) {
+            ok = reader.skip();
+        }
+        return ok;
+    } else {
+        static_assert(unsupported<T>, "type has no msgpack decoding; add HWP_MSGPACK(...) to it");
+    }
+}
+
+} // namespace detail
+
+// 编码后的字节数
+template <typename T>
+std::size_t encoded_size(const T& value) {
+    detail::Sizer sizer;
+    detail::pack(sizer, value);
+    return sizer.size();
+}
+
+// 编码到 out（至少 encoded_size(value) 字节），返回写入的字节数
+template <typename T>
+std::size_t encode(const T& value, uint8_t* out) {
+    detail::Writer writer(out);
+    detail::pack(writer, value);
+    return static_cast<std::size_t>(writer.position() - out);
+}
+
+// 解码整个缓冲区。字符串（std::string_view）与二进制（Bytes）是 data 的视图，
+// std::span 数组在 arena 中分配：结果只在 data 与 arena 都有效时可用。
+// 格式错误、类型不符、数值越界或有多余字节时返回 false
+template <typename T>
+bool decode(const uint8_t* data, std::size_t size, T& out, Arena& arena) {
+    detail::Reader reader(data, size, arena);
+    return detail::unpack(reader, out) && reader.done();
+}
+
+template <typename T>
+bool decode(const Message& msg, T& out, Arena& arena) {
+    return decode(msg.payload.data(), msg.payload.size(), out, arena);
+}
+
+// 构造负载为 value 的消息：先算出长度，再直接编码进线程内存池的负载缓冲区，
+// 该缓冲区随消息移入 OutgoingFrame 写出，中间没有临时缓冲区和拷贝
+template <typename T>
+Message make_message(MessageType type, uint32_t session_id, const T& value,
+                     uint8_t flags = static_cast<uint8_t>(Flags::BINARY_MODE)) {
+    std::vector<uint8_t> payload = pool::acquire_buffer(encoded_size(value));
+    encode(value, payload.data());
+    return ProtocolHandler::create_message(type, session_id, std::move(payload), flags);
+}
+
+// 构造对 request 的回复（见 ProtocolHandler::create_reply）
+template <typename T>
+Message make_reply(const Message& request, MessageType type, const T& value) {
+    std::vector<uint8_t> payload = pool::acquire_buffer(encoded_size(value));
+    encode(value, payload.data());
+    return ProtocolHandler::create_reply(request, type, std::move(payload));
+}
+
+} // namespace msgpack
+} // namespace hwp
+
+#endif // HWP_MSGPACK_HPP
@@ -0,0 +1,145 @@
+#ifndef HWP_POOL_HPP
+#define HWP_POOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <type_traits>
+#include <vector>
+
+namespace hwp {
+
+// 内存池容量限制（所有线程共享同一配置）
+struct PoolLimits {
+    size_t max_cached_blocks = 4096;        // 每线程、每个尺寸级别缓存的空闲块上限
+    size_t max_cached_buffers = 1024;       // 每线程缓存的负载缓冲区上限
+    size_t max_buffer_capacity = 1 << 20;   // 容量超过此值的缓冲区直接释放，不回收
+};
+
+// 内存池统计（所有线程汇总）
+struct PoolStats {
+    uint64_t block_hits = 0;            // 从空闲链表取得的块
+    uint64_t block_misses = 0;          // 回落到全局堆的块
+    uint64_t blocks_cached = 0;         // 当前缓存的空闲块
+    uint64_t buffer_hits = 0;           // 复用的负载缓冲区
+    uint64_t buffer_misses = 0;         // 新分配或扩容的负载缓冲区
+    uint64_t buffers_cached = 0;        // 当前缓存的负载缓冲区
+    uint64_t buffer_bytes_cached = 0;   // 缓存缓冲区的总容量
+    uint64_t handler_inline = 0;        // 落在连接内置处理器内存中的分配
+    uint64_t handler_fallback = 0;      // 内置内存不足或被占用时回落到块池的分配
+};
+
+void configure_pools(const PoolLimits& limits);
+PoolStats pool_stats();
+
+namespace pool {
+
+// 定长块分配：按 2 的幂尺寸级别，使用当前线程的空闲链表，无锁
+// 每个块都是独立的堆分配，可在任意线程释放（释放后归入释放线程的链表）
+void* allocate(size_t size);
+void deallocate(void* p, size_t size) noexcept;
+
+// 负载缓冲区：复用已有容量，返回 size() == size 的缓冲区
+std::vector<uint8_t> acquire_buffer(size_t size);
+void release_buffer(std::vector<uint8_t>&& buffer) noexcept;
+
+} // namespace pool
+
+// 基于线程本地块池的标准分配器，用于 allocate_shared 和容器
+template <typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+
+    PoolAllocator() noexcept = default;
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(pool::allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        pool::deallocate(p, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const PoolAllocator<U>&) const noexcept { return false; }
+};
+
+// 异步操作完成处理器的内存：每个连接为读、写各保留一块
+// 同一时刻只有一个操作占用；尺寸不足或被占用时回落到块池
+class HandlerMemory {
+public:
+    HandlerMemory() = default;
+    HandlerMemory(const HandlerMemory&) = delete;
+    HandlerMemory& operator=(const HandlerMemory&) = delete;
+
+    void* allocate(size_t size);
+    void deallocate(void* p, size_t size) noexcept;
+
+private:
+    alignas(std::max_align_t) unsigned char storage_[512];
+    bool in_use_ = false;
+};
+
+template <typename T>
+class HandlerAllocator {
+public:
+    using value_type = T;
+
+    explicit HandlerAllocator(HandlerMemory& memory) noexcept : memory_(&memory) {}
+    template <typename U>
+    HandlerAllocator(const HandlerAllocator<U>& other) noexcept : memory_(other.memory_) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(memory_->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        memory_->deallocate(p, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const HandlerAllocator<U>& other) const noexcept { return memory_ == other.memory_; }
+    template <typename U>
+    bool operator!=(const HandlerAllocator<U>& other) const noexcept { return memory_ != other.memory_; }
+
+private:
+    template <typename> friend class HandlerAllocator;
+    HandlerMemory* memory_;
+};
+
+// 为完成处理器关联自定义分配器（Asio 通过 get_allocator() 发现）
+template <typename Handler>
+class CustomAllocHandler {
+public:
+    using allocator_type = HandlerAllocator<Handler>;
+
+    CustomAllocHandler(HandlerMemory& memory, Handler handler)
+        : memory_(memory), handler_(std::move(handler)) {}
+
+    allocator_type get_allocator() const noexcept {
+        return allocator_type(memory_);
+    }
+
+    template <typename... Args>
+    void operator()(Args&&... args) {
+        handler_(std::forward<Args>(args)...);
+    }
+
+private:
+    HandlerMemory& memory_;
+    Handler handler_;
+};
+
+template <typename Handler>
+CustomAllocHandler<std::decay_t<Handler>> make_custom_alloc_handler(HandlerMemory& memory, Handler&& handler) {
+    return CustomAllocHandler<std::decay_t<Handler>>(memory, std::forward<Handler>(handler));
+}
+
+} // namespace hwp
+
+#endif // HWP_POOL_HPP
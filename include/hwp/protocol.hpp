@@ -1,8 +1,13 @@
 #ifndef HWP_PROTOCOL_HPP
 #define HWP_PROTOCOL_HPP
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <string>
 #include <vector>
+#include <boost/asio/buffer.hpp>
 
 namespace hwp {
 
@@ -13,14 +18,38 @@ constexpr uint8_t PROTOCOL_VERSION = 1;
 enum class MessageType : uint8_t {
     HANDSHAKE = 0x01,
     DATA = 0x02,
-    CONTROL = 0x03
+    CONTROL = 0x03,
+    ERROR = 0x04,           // 请求未被处理：u8 错误码（ErrorCode），ack_num 为该请求的 seq_num
+    FILE_TRANSFER_START = 0x10,
+    FILE_TRANSFER_DATA = 0x11,
+    FILE_TRANSFER_END = 0x12
 };
 
 // 协议标志
 enum class Flags : uint8_t {
     NONE = 0x00,
     HTTP_MODE = 0x01,
-    BINARY_MODE = 0x02
+    BINARY_MODE = 0x02,
+    COMPRESSED = 0x04,      // 负载经过压缩，格式见 compression.hpp
+    NEW_SESSION = 0x08,     // HANDSHAKE 携带代理分配的新 session_id：该 id 已存在时回复 ERROR(SESSION_EXISTS)
+    REQUIRES_ACK = 0x10,    // 可靠消息：接收方需用 ACK 确认其 seq_num，发送方保留至确认
+    MORE = 0x20,            // 消息未结束，同一流的下一帧继续
+    ACK_NOW = 0x40          // 发送窗口已满，接收方应立即确认而不是延迟合并
+};
+
+// CONTROL 消息负载的首字节
+enum class ControlCode : uint8_t {
+    WINDOW_UPDATE = 0x01,   // u32 窗口增量（大端）；stream_id 为 0 时作用于整条连接
+    ACK = 0x02,             // u32 累计确认号 + u8 区间数 + 区间数 x (u32 起, u32 止) 选择确认
+    FORWARD = 0x03,         // u32 序列号：发送方不会再发送不大于它的消息，接收方可推进累计确认号
+    DICTIONARY = 0x04,      // u32 字典ID + 字典内容：之后的压缩消息可引用该字典
+    PAUSE = 0x05            // u8 1 暂停 / 0 恢复：接收方写队列积压，发送方应暂停发送新请求
+};
+
+// ERROR 消息负载的首字节
+enum class ErrorCode : uint8_t {
+    OVERLOADED = 0x01,      // 服务器过载，请求被丢弃，可稍后重试
+    SESSION_EXISTS = 0x02   // NEW_SESSION 握手的 id 已被其他会话占用，以 session_id 0 重新握手
 };
 
 // 基础头部结构
@@ -31,11 +60,47 @@ struct BaseHeader {
     uint16_t head_len;    // 头部长度
 };
 
-// 会话头部结构
+// 会话头部结构（线上为网络字节序，内存中为主机字节序）
 struct SessionHeader {
     uint32_t session_id;  // 会话ID
     uint32_t seq_num;     // 序列号
     uint32_t ack_num;     // 确认号
+    uint32_t payload_len; // 负载长度
+    MessageType msg_type; // 消息类型
+    uint8_t reserved;     // 保留
+    uint16_t stream_id;   // 逻辑流ID，0 为连接级默认流
+};
+
+static_assert(sizeof(BaseHeader) == 8, "BaseHeader must be 8 bytes on the wire");
+static_assert(sizeof(SessionHeader) == 20, "SessionHeader must be 20 bytes on the wire");
+
+// Wire 模式帧头长度（基础头 + 会话头）
+constexpr std::size_t FRAME_HEADER_SIZE = sizeof(BaseHeader) + sizeof(SessionHeader);
+
+// 单帧负载上限，防止恶意长度导致超大分配
+constexpr uint32_t MAX_PAYLOAD_LEN = 64 * 1024 * 1024;
+
+// 会话保存的客户端标识上限（与快照记录一致），握手负载超出部分截断
+constexpr std::size_t MAX_CLIENT_ID_LEN = 48;
+
+// session_id 空间按最高位划分：置位的 id 由代理分配，清零的由服务端分配，两者不会撞上同一会话
+constexpr uint32_t PROXY_SESSION_ID_BIT = 0x80000000u;
+
+// 会话状态
+struct SessionState {
+    uint32_t session_id = 0;
+    bool is_authenticated = false;
+    std::string client_id;
+    uint64_t last_activity = 0;     // 毫秒时间戳（steady clock）
+};
+
+// 文件传输状态：bytes_transferred 即续传偏移
+struct FileTransferState {
+    std::string filename;
+    uint64_t total_size = 0;
+    uint64_t bytes_transferred = 0;
+    uint32_t chunk_size = 0;
+    bool is_complete = false;
 };
 
 // 完整消息结构
@@ -45,10 +110,77 @@ struct Message {
     std::vector<uint8_t> payload;
 };
 
+// 待发送的帧：帧头单独编码，负载不拷贝
+// 负载可以移入（帧持有所有权）或借用（调用方保证写完成前数据有效），
+// buffers() 返回 {帧头, 负载} 两段，适合一次 async_write/writev 写出
+class OutgoingFrame {
+public:
+    using const_buffers_type = std::array<boost::asio::const_buffer, 2>;
+
+    OutgoingFrame() = default;
+    // 移入整条消息（负载所有权随之转移）
+    explicit OutgoingFrame(Message&& msg);
+    // 借用负载，不持有所有权
+    OutgoingFrame(const Message& header_source, const uint8_t* payload, size_t length);
+    // 持有 payload，只发送其中 [offset, offset + length) 一段（大消息切分的最后一帧）
+    OutgoingFrame(const Message& header_source, std::vector<uint8_t>&& payload, size_t offset, size_t length);
+    // 与他处共享负载（可靠消息的重传缓冲区），帧存活期间负载不会被释放
+    OutgoingFrame(const Message& header_source, std::shared_ptr<const std::vector<uint8_t>> payload);
+
+    const_buffers_type buffers() const {
+        return {boost::asio::buffer(header_), boost::asio::buffer(payload_data(), payload_len_)};
+    }
+    size_t size() const { return FRAME_HEADER_SIZE + payload_len_; }
+    size_t payload_size() const { return payload_len_; }
+    const uint8_t* header_data() const { return header_.data(); }
+    // 从已编码的帧头读出会话ID与消息类型（出口调度用）
+    uint32_t session_id() const {
+        const uint8_t* p = header_.data() + sizeof(BaseHeader);
+        return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+    }
+    MessageType msg_type() const { return static_cast<MessageType>(header_[sizeof(BaseHeader) + 16]); }
+    const uint8_t* payload_data() const { return borrowed_ ? borrowed_ : owned_.data() + owned_offset_; }
+    // 写完成后取回持有的负载缓冲区（借用负载时为空），以便复用
+    std::vector<uint8_t> release_payload() {
+        payload_len_ = 0;
+        owned_offset_ = 0;
+        borrowed_ = nullptr;
+        shared_.reset();
+        return std::move(owned_);
+    }
+
+private:
+    std::array<uint8_t, FRAME_HEADER_SIZE> header_{};
+    std::vector<uint8_t> owned_;
+    size_t owned_offset_ = 0;
+    const uint8_t* borrowed_ = nullptr;
+    std::shared_ptr<const std::vector<uint8_t>> shared_;
+    size_t payload_len_ = 0;
+};
+
+// 借用一组缓冲区的序列（不拷贝）：Asio 的 async_write 按值保存缓冲区序列，
+// 直接传 std::vector 时每次写都会复制一次数组；写完成前原数组必须保持不变
+class BufferRange {
+public:
+    using value_type = boost::asio::const_buffer;
+    using const_iterator = const boost::asio::const_buffer*;
+
+    explicit BufferRange(const std::vector<boost::asio::const_buffer>& buffers) noexcept
+        : begin_(buffers.data()), end_(buffers.data() + buffers.size()) {}
+
+    const_iterator begin() const noexcept { return begin_; }
+    const_iterator end() const noexcept { return end_; }
+
+private:
+    const_iterator begin_;
+    const_iterator end_;
+};
+
 // 协议处理器
 class ProtocolHandler {
 public:
     enum class ParseResult {
+        NEED_MORE,
         HTTP,
         BINARY,
         ERROR
@@ -57,16 +189,85 @@ public:
     static Message create_message(MessageType type, uint32_t session_id,
                                 const std::vector<uint8_t>& payload,
                                 uint8_t flags);
-    
+
+    // 移入负载，避免拷贝
+    static Message create_message(MessageType type, uint32_t session_id,
+                                std::vector<uint8_t>&& payload,
+                                uint8_t flags);
+
+    // 构造对 request 的回复：沿用会话ID与流ID，ack_num 携带请求的 seq_num 供对端匹配
+    static Message create_reply(const Message& request, MessageType type,
+                                std::vector<uint8_t>&& payload);
+
+    // 拒绝 request 的 ERROR 回复
+    static Message create_error(const Message& request, ErrorCode code);
+
     static std::vector<uint8_t> serialize_message(const Message& msg);
-    
+
+    // 将帧头编码为网络字节序写入 out（FRAME_HEADER_SIZE 字节）
+    static void encode_header(const BaseHeader& base, const SessionHeader& session,
+                              uint32_t payload_len, uint8_t* out);
+
+    // 识别不带 HWP 前缀的普通 HTTP 请求（按请求方法前缀判断，最多需要 8 字节）
+    static bool is_http_request(const uint8_t* data, size_t length);
+
+    // 分配新的会话ID并初始化会话状态
+    static SessionState create_session(const std::string& client_id);
+    static uint64_t get_current_timestamp();
+
+    // 增量解析：数据不足时返回 NEED_MORE，required_bytes() 给出当前帧需要的总字节数
     ParseResult parse(const uint8_t* data, size_t length);
+    const BaseHeader& get_base_header() const { return current_base_; }
     const SessionHeader& get_session_header() const { return current_session_; }
+    size_t required_bytes() const { return required_bytes_; }
+
+private:
+    static uint32_t generate_session_id();
+
+    BaseHeader current_base_{};
+    SessionHeader current_session_{};
+    size_t required_bytes_ = sizeof(BaseHeader);
+};
+
+// 接收缓冲区中的一帧：帧头已解码为主机字节序，负载直接指向缓冲区（不拷贝，缓冲区改动前有效）
+struct FrameView {
+    BaseHeader base;
+    SessionHeader session;
+    const uint8_t* payload;
+};
+
+// 批量帧解码：一次遍历连续的接收缓冲区，解出其中全部完整的 Wire 帧。
+// 帧头固定字段（魔数、版本、模式位、头长度）用一次 64 位掩码比较校验。
+// 末尾不完整的帧不计入 consumed()，调用方只需保留这一段字节等待下次读取
+class FrameDecoder {
+public:
+    enum class Status {
+        OK,
+        ERROR       // 格式错误；frames() 仍包含出错位置之前的完整帧
+    };
+
+    Status decode(const uint8_t* data, size_t length);
+
+    const std::vector<FrameView>& frames() const { return frames_; }
+    // 完整帧占用的字节数
+    size_t consumed() const { return consumed_; }
+    // 末尾不完整帧需要的总字节数（帧头未到齐时为 FRAME_HEADER_SIZE）；恰好解完时为 0
+    size_t required() const { return required_; }
+    // 末尾不完整帧的帧头已到齐时有效；其 payload 指向已到达的部分
+    bool has_pending() const { return has_pending_; }
+    const FrameView& pending() const { return pending_; }
+
+    // 校验并解码 data 处的帧头（至少 FRAME_HEADER_SIZE 字节），payload 指向帧头之后
+    static bool decode_header(const uint8_t* data, FrameView& frame);
 
 private:
-    SessionHeader current_session_;
+    std::vector<FrameView> frames_;     // 容量跨调用保留
+    size_t consumed_ = 0;
+    size_t required_ = 0;
+    bool has_pending_ = false;
+    FrameView pending_{};
 };
 
 } // namespace hwp
 
-#endif // HWP_PROTOCOL_HPP 
\ No newline at end of file
+#endif // HWP_PROTOCOL_HPP
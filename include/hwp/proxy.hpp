@@ -0,0 +1,92 @@
+#ifndef HWP_PROXY_HPP
+#define HWP_PROXY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace hwp {
+namespace proxy {
+
+// 一致性哈希环：每个后端放置 virtual_nodes 个虚拟节点，key 顺时针落到第一个节点。
+// 增删一个后端只改变落在其虚拟节点上的 key（约 1/N），其余 key 的归属不变
+class HashRing {
+public:
+    explicit HashRing(size_t virtual_nodes = 160) : virtual_nodes_(virtual_nodes == 0 ? 1 : virtual_nodes) {}
+
+    // 后端以名字（如 "127.0.0.1:9001"）标识，虚拟节点位置只取决于名字
+    void add(uint32_t backend, const std::string& name);
+    void remove(uint32_t backend);
+
+    bool empty() const { return points_.empty(); }
+
+    // 返回 key 所属的后端；skip 跳过顺时针方向上前 skip 个不同的后端（所属后端不可用时依次后备）。
+    // 环为空或 skip 不小于后端数时返回 false
+    bool pick(uint64_t key, size_t skip, uint32_t& backend) const;
+
+    static uint64_t hash(uint64_t key);
+
+private:
+    size_t virtual_nodes_;
+    std::vector<std::pair<uint64_t, uint32_t>> points_;    // (位置, 后端)，按位置排序
+    size_t backends_ = 0;
+};
+
+// 代理配置
+struct ProxyOptions {
+    unsigned short port = 8080;         // 监听端口，0 表示由系统分配
+    std::size_t threads = 1;            // 事件循环线程数，每个线程独立 SO_REUSEPORT 监听
+    std::vector<std::string> backends;  // 后端 "host:port"
+    size_t virtual_nodes = 160;         // 每个后端在哈希环上的虚拟节点数
+};
+
+// 代理统计
+struct ProxyStats {
+    uint64_t wire_connections = 0;
+    uint64_t http_connections = 0;
+    uint64_t connect_failures = 0;  // 后端连接失败（已改连后备后端或关闭客户端连接）
+    uint64_t spliced_bytes = 0;     // 经管道在内核中转发的负载字节
+};
+
+// 会话亲和的转发代理。
+// Wire 模式：只读取每帧的 BaseHeader/SessionHeader，连接按第一帧的 session_id 在哈希环上选择后端，
+// 负载经管道 splice 在内核中转发，不经过用户态；回程字节流整体 splice。
+// 新会话（session_id 为 0 的 HANDSHAKE）由代理分配 session_id（置 PROXY_SESSION_ID_BIT，
+// 与后端自行分配的 id 不重叠），后端沿用该 id 建立会话，
+// 之后同一会话的连接都落到同一后端，代理本身不保存会话状态。
+// HTTP 模式（带 HWP 前缀或普通 HTTP）：连接交给在途请求最少的后端，双向整体 splice。
+// 后端可在运行中增删；已建立的连接不受影响，之后的新连接按新的哈希环选择后端
+class Proxy {
+public:
+    explicit Proxy(const ProxyOptions& options);   // 进程忽略 SIGPIPE（splice 没有 MSG_NOSIGNAL）
+    ~Proxy();
+
+    Proxy(const Proxy&) = delete;
+    Proxy& operator=(const Proxy&) = delete;
+
+    // 启动事件循环线程（非阻塞）
+    void run();
+    // 停止所有事件循环并等待线程退出
+    void stop();
+
+    unsigned short port() const;
+
+    // 增删后端，可从任意线程调用；地址无法解析或后端已存在 / 不存在时返回 false
+    bool add_backend(const std::string& backend);
+    bool remove_backend(const std::string& backend);
+    std::vector<std::string> backends() const;
+
+    ProxyStats stats() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace proxy
+} // namespace hwp
+
+#endif // HWP_PROXY_HPP
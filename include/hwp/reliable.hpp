@@ -0,0 +1,143 @@
+#ifndef HWP_RELIABLE_HPP
+#define HWP_RELIABLE_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "protocol.hpp"
+
+namespace hwp {
+
+struct ReliableOptions {
+    uint32_t window = 1024;                         // 发送窗口：未确认的可靠消息上限，超出后排队
+    std::chrono::milliseconds ack_delay{5};         // 延迟确认的最长等待时间
+    uint32_t ack_every = 32;                        // 累计收到这么多条可靠消息后立即确认
+    std::size_t max_sack_ranges = 16;               // 单个 ACK 携带的选择确认区间数上限
+};
+
+// 序列号按 32 位回绕比较
+inline bool seq_after(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) > 0;
+}
+
+// ACK 内容：cumulative 及之前的消息全部收到，ranges 为其后已收到的闭区间（升序）
+struct AckInfo {
+    uint32_t session_id = 0;
+    uint32_t cumulative = 0;
+    std::vector<std::pair<uint32_t, uint32_t>> ranges;
+};
+
+struct ReliableStats {
+    uint64_t sent = 0;              // 首次发出的可靠消息
+    uint64_t retransmitted = 0;     // 重连后补发的消息
+    uint64_t acked = 0;             // 已被确认的消息
+    uint64_t received = 0;          // 收到的新可靠消息
+    uint64_t duplicates = 0;        // 收到并丢弃的重复消息
+    uint64_t acks_sent = 0;         // 发出的 ACK
+    uint64_t acks_received = 0;     // 收到的 ACK
+};
+
+// 会话级的可靠传输状态，独立于连接存在，连接断开重连后继续使用。
+// 发送方向：为会话内的消息分配连续序列号；带 REQUIRES_ACK 的消息保留负载直到对端确认，
+// 未确认数达到 window 时后续消息排队。消息不做超时重传（单条 TCP 连接本身可靠），
+// 只在发出它的连接断开后，收到对端 ACK 时补发其中仍未确认的部分。填满窗口的消息带 ACK_NOW。
+// 接收方向：记录收到的序列号，生成累计确认 + 选择确认，丢弃重复的可靠消息。
+// 可靠消息至多交付一次；重连后补发的消息可能晚于新消息到达。
+// 线程安全：服务器上同一会话的多条连接可能位于不同线程。
+class ReliableChannel {
+public:
+    // 消息被确认时以 true 调用，放弃时（abandon）以 false 调用；不在锁内调用
+    using AckCallback = std::function<void(bool acked)>;
+
+    enum class Receive {
+        IN_ORDER,       // 新消息，紧接累计确认号
+        OUT_OF_ORDER,   // 新消息，前面有空洞
+        DUPLICATE       // 已收到过的可靠消息，应丢弃
+    };
+
+    explicit ReliableChannel(const ReliableOptions& options = ReliableOptions());
+
+    ReliableChannel(const ReliableChannel&) = delete;
+    ReliableChannel& operator=(const ReliableChannel&) = delete;
+
+    const ReliableOptions& options() const { return options_; }
+
+    // ---- 发送方向 ----
+
+    // 为不需要确认的消息分配序列号（跳过 0）
+    uint32_t next_seq();
+    // 可靠发送：分配序列号、置 REQUIRES_ACK 并保留负载；窗口未满时帧追加到 out，由 connection 写出
+    void send(Message&& msg, uint64_t connection, AckCallback callback, std::vector<OutgoingFrame>& out);
+    // 处理对端 ACK（由 connection 收到）：释放已确认消息，补发断开连接上仍未确认的消息，
+    // 窗口腾出后发出排队消息；需要发送的帧（含 FORWARD）追加到 out
+    void on_ack(const AckInfo& ack, uint64_t connection, std::vector<OutgoingFrame>& out);
+    // 连接断开：经它发出的未确认消息在下次收到 ACK 时补发
+    void connection_lost(uint64_t connection);
+    // 是否有等待补发的消息
+    bool has_lost() const;
+    // 放弃所有未确认与排队的消息
+    void abandon();
+
+    // ---- 接收方向 ----
+
+    // 记录收到的序列号；只有 reliable 消息会判为重复
+    Receive on_receive(uint32_t seq, bool reliable);
+    // 对端声明不会再发送不大于 seq 的消息
+    void on_forward(uint32_t seq);
+    AckInfo ack_state() const;
+    // 构造携带当前接收状态的 ACK
+    Message make_ack(uint32_t session_id);
+
+    // ---- 编解码 ----
+
+    static Message ack_message(uint32_t session_id, const AckInfo& ack, std::size_t max_ranges);
+    static bool parse_ack(const Message& msg, AckInfo& ack);
+    static Message forward_message(uint32_t session_id, uint32_t seq);
+    static bool parse_forward(const Message& msg, uint32_t& seq);
+
+    size_t unacked() const;
+    ReliableStats stats() const;
+
+private:
+    struct Pending {
+        uint32_t seq = 0;
+        Message header;                                     // 只有头部，负载在 payload 中
+        std::shared_ptr<const std::vector<uint8_t>> payload;
+        uint64_t connection = 0;                            // 最近一次经哪条连接发出
+        bool lost = false;                                  // 该连接已断开，等待补发
+        bool sacked = false;                                // 已被选择确认
+        AckCallback callback;
+    };
+
+    struct Queued {
+        Message msg;
+        AckCallback callback;
+    };
+
+    uint32_t allocate_seq();
+    void transmit(Queued&& queued, uint64_t connection, std::vector<OutgoingFrame>& out);
+
+    ReliableOptions options_;
+    mutable std::mutex mutex_;
+
+    uint32_t next_seq_ = 1;
+    std::deque<Pending> unacked_;       // 按序列号升序
+    std::deque<Queued> backlog_;
+    size_t lost_ = 0;
+    uint32_t last_cumulative_ = 0;      // 上一个 ACK 的累计确认号，用于判断停滞
+
+    uint32_t cumulative_ = 0;
+    std::vector<std::pair<uint32_t, uint32_t>> received_;  // 累计确认号之后已收到的区间
+
+    ReliableStats stats_;
+};
+
+} // namespace hwp
+
+#endif // HWP_RELIABLE_HPP
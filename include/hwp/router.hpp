@@ -0,0 +1,97 @@
+#ifndef HWP_ROUTER_HPP
+#define HWP_ROUTER_HPP
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include "admission.hpp"
+#include "connection.hpp"
+#include "protocol.hpp"
+#include "work_pool.hpp"
+
+namespace hwp {
+namespace server {
+
+// 处理函数的执行位置
+enum class Dispatch : uint8_t {
+    INLINE,     // 在连接所属的 I/O 线程上同步调用，适合短小的处理
+    OFFLOAD     // 交给工作线程池执行，结果回到连接的执行器上发送；不阻塞同一线程上的其他连接
+};
+
+// 卸载到线程池的处理函数：在工作线程上调用，返回的回复（如有）在连接的执行器上发出。
+// 同一连接上卸载的消息可能并行处理，回复顺序不保证与请求一致
+using OffloadHandler = std::function<std::optional<Message>(Message&)>;
+
+// 路由配置
+struct RouterOptions {
+    WorkPoolOptions workers;    // 卸载处理函数的线程池（首次注册 OFFLOAD 路由时创建）
+    CoDelOptions queue_delay;   // 任务在线程池中的排队延迟：持续过载时丢弃排队过久的任务
+};
+
+// 路由统计
+struct RouterStats {
+    uint64_t offloaded = 0;     // 提交到线程池的消息
+    uint64_t unrouted = 0;      // 没有对应路由、由 fallback 处理或丢弃的消息
+    uint64_t shed = 0;          // 排队过久、未执行处理函数就按 overloaded 处理的消息
+    WorkPoolStats workers;      // rejected 为线程池队列已满的消息（可靠消息就地执行，其余按 overloaded 处理）
+};
+
+// 按 MessageType 分发 Wire 消息：256 项的表，O(1) 查找。
+// 路由在编译期按类型注册并检查处理函数的签名，需在服务器 run() 之前完成：
+//     router.on<MessageType::DATA>(echo);
+//     router.on<MessageType(0x20), Dispatch::OFFLOAD>(render);
+//     server.set_message_handler(router.handler());
+// Router 须在服务器 stop() 之后销毁；析构时等已排队的任务执行完，其回复投递到各连接的执行器，
+// 因此也须在服务器销毁之前销毁（先声明服务器，再声明 Router）
+class Router {
+public:
+    explicit Router(const RouterOptions& options = RouterOptions());
+    ~Router();
+
+    Router(const Router&) = delete;
+    Router& operator=(const Router&) = delete;
+
+    template <MessageType Type, Dispatch Mode = Dispatch::INLINE, typename Handler>
+    void on(Handler handler) {
+        // 握手与文件传输由连接自己处理，不会交给应用
+        static_assert(Type != MessageType::HANDSHAKE && Type != MessageType::FILE_TRANSFER_START &&
+                      Type != MessageType::FILE_TRANSFER_DATA && Type != MessageType::FILE_TRANSFER_END,
+                      "message type is handled by the connection and cannot be routed");
+        if constexpr (Mode == Dispatch::INLINE) {
+            static_assert(std::is_invocable_v<Handler&, const std::shared_ptr<Connection>&, Message&>,
+                          "inline handlers take (const std::shared_ptr<Connection>&, Message&)");
+            set_inline(Type, MessageHandler(std::move(handler)));
+        } else {
+            static_assert(std::is_invocable_r_v<std::optional<Message>, Handler&, Message&>,
+                          "offloaded handlers take (Message&) and return std::optional<Message>");
+            set_offload(Type, OffloadHandler(std::move(handler)));
+        }
+    }
+
+    // 没有对应路由的消息，在 I/O 线程上调用；未设置时丢弃
+    void fallback(MessageHandler handler);
+    // 线程池队列已满或任务排队过久时，在 I/O 线程上调用（例如关闭连接）；
+    // 未设置时回复 ERROR(OVERLOADED)。可靠消息（REQUIRES_ACK）交给应用前已被确认，不按过载处理：
+    // 排队过久时照常执行，队列已满时在 I/O 线程上就地执行
+    void overloaded(MessageHandler handler);
+
+    // 按路由表分发一条消息（在连接所属线程上调用）
+    void dispatch(const std::shared_ptr<Connection>& connection, Message& msg);
+    // 交给 Server::set_message_handler 的回调
+    MessageHandler handler();
+
+    RouterStats stats() const;
+
+private:
+    void set_inline(MessageType type, MessageHandler handler);
+    void set_offload(MessageType type, OffloadHandler handler);
+
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace server
+} // namespace hwp
+
+#endif // HWP_ROUTER_HPP
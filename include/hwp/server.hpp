@@ -1,23 +1,92 @@
 #ifndef HWP_SERVER_HPP
 #define HWP_SERVER_HPP
 
+#include <cstddef>
 #include <memory>
+#include <string>
+#include <utility>
 #include <boost/asio.hpp>
+#include "admission.hpp"
+#include "backpressure.hpp"
+#include "capture.hpp"
+#include "compression.hpp"
+#include "connection.hpp"
+#include "egress.hpp"
+#include "metrics.hpp"
+#include "pool.hpp"
+#include "reliable.hpp"
+#include "session.hpp"
+#include "session_table.hpp"
+#include "stream.hpp"
+#include "uring.hpp"
 
 namespace hwp {
 namespace server {
 
+// 服务器配置（多线程模式）
+struct ServerOptions {
+    unsigned short port = 8080;     // 监听端口，0 表示由系统分配
+    std::size_t threads = 1;        // 事件循环线程数，每个线程独占一个 io_context
+    bool reuse_port = true;         // true: 每个线程独立 SO_REUSEPORT 监听；false: 线程0接受后轮询分发
+    SessionTableOptions sessions;   // 会话表容量与 TTL
+    std::string transfer_dir;       // FILE_TRANSFER_* 接收目录，为空时拒绝文件传输
+    FlowControlOptions flow;        // 流复用的窗口与分帧参数（每条连接）
+    ReliableOptions reliable;       // 可靠消息的发送窗口与延迟确认参数（每个会话）
+    compress::CompressionOptions compression;   // 发往客户端的 DATA 消息是否压缩（每条连接）
+    IoBackend backend = IoBackend::EPOLL;       // Wire 模式读写与 accept 的 I/O 后端（每个线程一个 ring）
+    bool metrics_endpoint = true;   // HTTP 模式下由服务器应答 GET /metrics（Prometheus 文本格式）
+    BackpressureOptions backpressure;   // Wire 模式写队列的水位（每条连接）与缓冲预算（整个服务器）
+    AdmissionOptions admission;     // 连接数与接受速率上限；事件循环持续过载时以 503 / ERROR 拒绝新请求（可靠消息除外）
+    EgressOptions egress;           // 写出顺序：CONTROL / HANDSHAKE / ERROR 优先，同一优先级内各会话加权公平（每条连接）
+    capture::CaptureOptions capture;    // path 非空时把 Wire 模式收到的帧连同时间戳、连接ID写入抓包文件（见 capture.hpp）
+};
+
 // Server-side functionality will be implemented here
 class Server {
 public:
+    // 单线程模式：由调用方驱动 io_context
     Server(boost::asio::io_context& io, unsigned short port);
+    // 多线程模式：服务器自带 io_context 线程池，连接固定在接受它的线程上
+    explicit Server(const ServerOptions& options);
     ~Server();
-    
+
     // 禁用拷贝
     Server(const Server&) = delete;
     Server& operator=(const Server&) = delete;
-    
-    // Add server-specific methods here
+
+    // 设置 Wire 模式消息回调，需在 run() 之前调用
+    void set_message_handler(MessageHandler handler);
+    // 设置协程会话处理函数（见 session.hpp），设置后 Wire 模式消息不再交给 MessageHandler；
+    // 需在 run() 之前调用
+    void set_session_handler(SessionHandler handler);
+    // 设置流式消息回调：流上（stream_id 非 0）的 DATA 消息不再重组，逐帧交给该回调，
+    // 每条消息占用的内存以 flow.max_frame_payload 与流窗口为上限，总长不受 payload_len 限制。
+    // 压缩的消息仍重组后交给 MessageHandler / 会话；需在 run() 之前调用
+    void set_chunk_handler(ChunkHandler handler);
+    // 设置 HTTP 模式请求回调（带 HWP 前缀或普通 HTTP 均可），需在 run() 之前调用
+    void set_http_handler(HttpHandler handler);
+
+    // 启动事件循环线程（仅多线程模式，非阻塞）
+    void run();
+    // 停止所有事件循环并等待线程退出
+    void stop();
+
+    unsigned short port() const;
+    std::size_t thread_count() const;
+
+    // 会话表（HANDSHAKE 创建，之后每条消息刷新）
+    SessionTable& sessions();
+
+    // 抓包是否在进行（options.capture.path 为空或文件无法创建时为 false，stop() 后关闭）
+    bool capturing() const;
+    capture::CaptureStats capture_stats() const;
+
+    // 准入控制拒绝的连接与请求（不依赖 HWP_METRICS）
+    AdmissionStats admission_stats() const;
+
+    // 连接、缓冲区与完成处理器内存池的统计（进程内所有线程汇总）
+    static PoolStats pool_stats();
+
 private:
     class Impl;
     std::unique_ptr<Impl> impl_;
@@ -26,4 +95,4 @@ private:
 } // namespace server
 } // namespace hwp
 
-#endif // HWP_SERVER_HPP 
\ No newline at end of file
+#endif // HWP_SERVER_HPP
@@ -0,0 +1,76 @@
+#ifndef HWP_SESSION_HPP
+#define HWP_SESSION_HPP
+
+#include <coroutine>
+#include <functional>
+#include <optional>
+#include <utility>
+#include "connection.hpp"
+#include "protocol.hpp"
+#include "task.hpp"
+
+namespace hwp {
+namespace server {
+
+// Wire 连接上的协程会话：处理函数写成顺序循环
+//     while (auto msg = co_await session.read_message()) {
+//         co_await session.send(ProtocolHandler::create_reply(*msg, ...));
+//     }
+// 会话对象属于连接，处理函数的协程在连接所属线程上执行和恢复，不需要加锁；
+// 处理函数返回（或抛出异常）后连接关闭
+class Session {
+public:
+    class ReadAwaiter {
+    public:
+        explicit ReadAwaiter(Session& session) noexcept : session_(session) {}
+
+        bool await_ready() { return session_.message_ready(); }
+        void await_suspend(std::coroutine_handle<> handle) { session_.wait_message(handle); }
+        std::optional<Message> await_resume() { return session_.take_message(); }
+
+    private:
+        Session& session_;
+    };
+
+    class SendAwaiter {
+    public:
+        SendAwaiter(Session& session, Message msg) noexcept : session_(session), msg_(std::move(msg)) {}
+
+        // 排入写队列后队列未满则不挂起
+        bool await_ready() { return session_.enqueue(std::move(msg_)); }
+        void await_suspend(std::coroutine_handle<> handle) { session_.wait_send(handle); }
+        void await_resume() noexcept {}
+
+    private:
+        Session& session_;
+        Message msg_;
+    };
+
+    virtual ~Session() = default;
+
+    // 等待下一条应用消息（流控、确认等协议消息由连接处理，不会出现在这里）；连接关闭后返回空
+    ReadAwaiter read_message() noexcept { return ReadAwaiter(*this); }
+    // 发送一条消息；写队列已满时挂起，写出一批后恢复。连接关闭后消息被丢弃
+    SendAwaiter send(Message msg) noexcept { return SendAwaiter(*this, std::move(msg)); }
+
+    // 所属连接：可靠发送、关闭、执行器等
+    virtual Connection& connection() = 0;
+
+protected:
+    // 以下只在连接所属线程上调用
+    virtual bool message_ready() = 0;
+    virtual std::optional<Message> take_message() = 0;
+    // 返回 true 表示写队列未满，无需挂起
+    virtual bool enqueue(Message msg) = 0;
+    // 记录挂起的协程：消息到达（或读端关闭）、写队列腾出、连接关闭时恢复
+    virtual void wait_message(std::coroutine_handle<> handle) = 0;
+    virtual void wait_send(std::coroutine_handle<> handle) = 0;
+};
+
+// 会话处理函数：每条进入 Wire 模式的连接调用一次，设置后代替 MessageHandler
+using SessionHandler = std::function<Task<void>(Session&)>;
+
+} // namespace server
+} // namespace hwp
+
+#endif // HWP_SESSION_HPP
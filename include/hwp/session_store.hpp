@@ -0,0 +1,74 @@
+#ifndef HWP_SESSION_STORE_HPP
+#define HWP_SESSION_STORE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "protocol.hpp"
+
+namespace hwp {
+
+// 快照文件中的一条会话：固定 64 字节，内存中的布局就是文件布局，读写不做序列化
+struct SessionRecord {
+    uint32_t session_id;        // 0 表示空槽
+    uint8_t authenticated;
+    uint8_t client_id_len;
+    uint16_t reserved;
+    uint64_t expires_ms;        // 到期时刻（系统时钟的 Unix 毫秒），重启后仍然有效
+    char client_id[MAX_CLIENT_ID_LEN];  // 超出部分截断
+};
+static_assert(sizeof(SessionRecord) == 64, "session record layout is part of the file format");
+
+// 会话表的内存映射快照：文件头之后是按分片划分的定长槽位，
+// 每个分片独占一段连续槽位，由分片自己的锁保护，从前往后分配、删除后复用。
+// 会话的创建、刷新、删除直接写映射内存（刷新只改一个 8 字节字段），由内核回写；
+// 进程退出或崩溃后数据仍在页缓存中，sync() 只在需要抵御掉电时使用。
+// 文件按最大会话数预留长度，未使用的槽位不占磁盘空间（稀疏文件）。
+// 同一文件同时只能被一个进程打开（flock）
+class SessionStore {
+public:
+    enum class OpenResult {
+        FAILED,     // 无法创建、映射或文件被其他进程占用
+        CREATED,    // 新文件，或旧文件无法识别
+        MAPPED,     // 布局一致：直接沿用文件中的槽位
+        REBUILT     // 分片布局变化：旧记录已读出到 existing，文件按新布局重建
+    };
+
+    SessionStore() = default;
+    ~SessionStore();
+
+    SessionStore(const SessionStore&) = delete;
+    SessionStore& operator=(const SessionStore&) = delete;
+
+    OpenResult open(const std::string& path, size_t shards, size_t slots_per_shard,
+                    std::vector<SessionRecord>& existing);
+
+    bool is_open() const { return records_ != nullptr; }
+    size_t slots_per_shard() const { return slots_per_shard_; }
+
+    SessionRecord& record(size_t slot) { return records_[slot]; }
+
+    // 写入整条记录：session_id 最后写入，中途崩溃时该槽仍为空
+    void write(size_t slot, const SessionState& state, uint64_t expires_ms);
+    void set_expires(size_t slot, uint64_t expires_ms) { records_[slot].expires_ms = expires_ms; }
+    void clear(size_t slot) { records_[slot].session_id = 0; }
+
+    // 异步回写脏页（MS_ASYNC）
+    void sync();
+
+    static uint64_t wall_clock_ms();
+
+private:
+    void close();
+
+    int fd_ = -1;
+    void* map_ = nullptr;
+    size_t map_size_ = 0;
+    SessionRecord* records_ = nullptr;
+    size_t slots_per_shard_ = 0;
+};
+
+} // namespace hwp
+
+#endif // HWP_SESSION_STORE_HPP
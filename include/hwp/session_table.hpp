@@ -0,0 +1,91 @@
+#ifndef HWP_SESSION_TABLE_HPP
+#define HWP_SESSION_TABLE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "protocol.hpp"
+
+namespace hwp {
+
+class SessionStore;
+
+// 会话表配置
+struct SessionTableOptions {
+    size_t shards = 64;                                  // 分片数，向上取整为 2 的幂
+    size_t max_sessions = 1 << 20;                       // 会话总数上限，超出后按 LRU 淘汰
+    std::chrono::milliseconds ttl{std::chrono::minutes(5)};  // 空闲超时
+    std::chrono::milliseconds tick{100};                 // 时间轮精度
+    std::string snapshot_path;      // 非空时会话持续写入该内存映射文件，重启后从中恢复（见 session_store.hpp）
+};
+
+// 会话表统计
+struct SessionTableStats {
+    size_t sessions = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evicted = 0;   // 因容量上限被 LRU 淘汰
+    uint64_t expired = 0;   // 因 TTL 到期被时间轮回收
+    uint64_t restored = 0;  // 启动时从快照恢复
+};
+
+// 并发会话表：按 session_id 分片，每片独立加锁
+// 每次访问 O(1) 刷新 LRU 位置；TTL 由分层时间轮统一驱动，不为每个会话创建定时器
+class SessionTable {
+public:
+    explicit SessionTable(const SessionTableOptions& options = SessionTableOptions());
+    ~SessionTable();
+
+    SessionTable(const SessionTable&) = delete;
+    SessionTable& operator=(const SessionTable&) = delete;
+
+    // 创建新会话（分配一个表中尚不存在的 session_id）
+    SessionState create(const std::string& client_id);
+    // 插入会话，返回是否新建了条目；replace 为 false 时已存在的会话保持不变
+    bool insert(const SessionState& state, bool replace = true);
+    // 刷新会话活跃时间；会话不存在时返回 false
+    bool touch(uint32_t session_id);
+    // 查找并刷新会话
+    bool find(uint32_t session_id, SessionState& out);
+    bool erase(uint32_t session_id);
+
+    // 推进时间轮到当前时间并回收过期会话，返回回收数量
+    size_t expire();
+    size_t expire(uint64_t now_ms);
+
+    size_t size() const;
+    SessionTableStats stats() const;
+    const SessionTableOptions& options() const { return options_; }
+
+    // 快照文件已打开（未配置或打开失败时会话只在内存中）
+    bool persistent() const;
+    // 请求内核回写快照的脏页；进程崩溃不需要，只为抵御掉电
+    void checkpoint();
+
+private:
+    class Shard;
+
+    Shard& shard_for(uint32_t session_id);
+    uint64_t current_tick() const { return tick_.load(std::memory_order_relaxed); }
+    // 到期 tick 对应的系统时钟时刻，写入快照
+    uint64_t wall_expires(uint64_t expires_tick) const {
+        return origin_wall_ms_ + expires_tick * static_cast<uint64_t>(options_.tick.count());
+    }
+
+    SessionTableOptions options_;
+    uint64_t ttl_ticks_;
+    uint64_t origin_ms_;
+    uint64_t origin_wall_ms_;
+    std::atomic<uint64_t> tick_{0};
+    std::unique_ptr<SessionStore> store_;
+    uint64_t restored_ = 0;
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+} // namespace hwp
+
+#endif // HWP_SESSION_TABLE_HPP
@@ -0,0 +1,170 @@
+#ifndef HWP_STREAM_HPP
+#define HWP_STREAM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "backpressure.hpp"
+#include "protocol.hpp"
+
+namespace hwp {
+
+// 流控窗口的协议初始值：双方无需协商，接收方可用 WINDOW_UPDATE 扩大
+constexpr uint32_t INITIAL_STREAM_WINDOW = 256 * 1024;
+constexpr uint32_t INITIAL_CONNECTION_WINDOW = 1024 * 1024;
+constexpr int64_t MAX_FLOW_WINDOW = 0x7fffffff;
+
+struct FlowControlOptions {
+    uint32_t connection_window = 4 * 1024 * 1024;   // 本端接收窗口，首次收到流数据时通告
+    uint32_t max_frame_payload = 16 * 1024;         // 流上消息切分的最大帧负载
+    std::size_t max_streams = 256;                  // 接收端保留状态的流数，超过时归还全部窗口并清理；
+                                                    // 同时重组中的流不得超过该数
+    std::size_t max_reassembly = 32 * 1024 * 1024;  // 单连接所有流重组缓冲区的合计上限
+    bool stream_payloads = false;                   // 接收的流消息逐帧交付（Inbound::CHUNK），不在内存中重组
+};
+
+// 流式发送的数据源：向 data 写入至多 capacity 字节，返回写入的字节数，返回 0 表示数据结束。
+// 在连接所属线程上按流控窗口逐帧调用，capacity 不超过 max_frame_payload
+using ByteSource = std::function<std::size_t(uint8_t* data, std::size_t capacity)>;
+
+// 流式接收的一段负载：消息的各帧依次交付，每段不超过对端的 max_frame_payload
+struct PayloadChunk {
+    SessionHeader header;       // 本帧的会话头（session_id、stream_id、seq_num 等）
+    uint64_t offset = 0;        // 本段在整条消息中的偏移；流式消息的总长不受 32 位 payload_len 限制
+    bool last = false;          // 消息的最后一段（可能为空）
+    std::vector<uint8_t> data;
+};
+
+// 单条连接上的流复用与基于信用的流控。
+// 只有 stream_id 非 0 的 DATA 消息受流控：发送时切成不超过 max_frame_payload 的帧，
+// 各流轮转出帧，每帧同时消耗流窗口和连接窗口；大消息因此不会阻塞其他流上的小消息。
+// 其余消息（stream 0、CONTROL、HANDSHAKE 等）不受流控，由连接直接发送。
+// 流式消息：发送端从 ByteSource 按窗口逐帧读取，接收端开启 stream_payloads 时逐帧交付，
+// 两端为一条消息占用的内存都以帧大小与窗口为上限，与消息总长无关。
+// 重组中的分片已归还窗口，不受窗口约束：改由 max_streams 与 max_reassembly 限制，并计入 budget。
+// 非线程安全，由所属连接在其执行器上调用。
+class StreamMux {
+public:
+    enum class Inbound {
+        DELIVER,        // msg 为完整消息，交给应用
+        PARTIAL,        // 分片已缓存，等待后续帧
+        CHUNK,          // stream_payloads 时 msg 为消息的一段，交给应用后同样调用 consumed()
+        VIOLATION       // 对端超出窗口或消息过大，应关闭连接
+    };
+
+    // budget 非空时重组缓冲区的字节计入其中，与写队列共用服务器级预算
+    explicit StreamMux(const FlowControlOptions& options = FlowControlOptions(), BufferBudget* budget = nullptr);
+
+    static bool flow_controlled(const SessionHeader& header) {
+        return header.stream_id != 0 && header.msg_type == MessageType::DATA;
+    }
+
+    // 构造窗口更新消息
+    static Message window_update(uint32_t session_id, uint16_t stream_id, uint32_t increment);
+    // 识别 WINDOW_UPDATE，成功时写入增量
+    static bool parse_window_update(const Message& msg, uint32_t& increment);
+
+    // ---- 发送方向 ----
+
+    // 排队一条受流控的消息
+    void enqueue(Message&& msg);
+    // 排队一条流式消息：header 只提供帧头，负载在窗口允许时逐帧从 source 读取。
+    // 数据源结束后以一个空的末帧结束消息
+    void enqueue(Message&& header, ByteSource source);
+    // 按流轮转取出下一帧；窗口耗尽或无数据时返回 false。
+    // 非最后一帧借用队列中消息的负载，帧必须按取出顺序写出
+    bool next_frame(OutgoingFrame& frame);
+    // 处理对端的 WINDOW_UPDATE，窗口溢出时返回 false
+    bool on_window_update(uint16_t stream_id, uint32_t increment);
+
+    // ---- 接收方向 ----
+
+    // 流控检查与分片重组。已并入重组缓冲区的分片立即归还窗口（否则大于窗口的消息永远无法完成），
+    // 需要发送的 WINDOW_UPDATE 追加到 updates；返回 CHUNK 时 offset（如非空）为该段在消息中的偏移
+    Inbound on_frame(Message& msg, std::vector<Message>& updates, uint64_t* offset = nullptr);
+    // 应用处理完 on_frame 交付的消息后调用，归还其最后一帧占用的窗口
+    void consumed(const SessionHeader& header, std::vector<Message>& updates);
+
+private:
+    // 计入预算的重组字节，析构或整体替换时归还
+    class Charge {
+    public:
+        explicit Charge(BufferBudget* budget) : budget_(budget) {}
+        ~Charge() { release(bytes_); }
+        Charge(Charge&& other) noexcept : budget_(other.budget_), bytes_(std::exchange(other.bytes_, 0)) {}
+        Charge& operator=(Charge&& other) noexcept {
+            if (this != &other) {
+                release(bytes_);
+                budget_ = other.budget_;
+                bytes_ = std::exchange(other.bytes_, 0);
+            }
+            return *this;
+        }
+
+        void add(std::size_t bytes) {
+            bytes_ += bytes;
+            if (budget_) {
+                budget_->add(bytes);
+            }
+        }
+        void release(std::size_t bytes) {
+            bytes_ -= bytes;
+            if (budget_) {
+                budget_->release(bytes);
+            }
+        }
+        std::size_t bytes() const { return bytes_; }
+
+    private:
+        BufferBudget* budget_;
+        std::size_t bytes_ = 0;
+    };
+
+    struct Outbound {
+        Message msg;
+        ByteSource source;              // 流式消息的数据源，为空时负载在 msg 中
+    };
+
+    struct SendStream {
+        std::deque<Outbound> queue;
+        std::size_t offset = 0;         // 队首消息已切出的字节数
+        int64_t window = INITIAL_STREAM_WINDOW;
+        bool scheduled = false;         // 是否在 ready_ 中
+    };
+
+    struct RecvStream {
+        int64_t window = INITIAL_STREAM_WINDOW;
+        uint32_t unacked = 0;           // 已消费但尚未归还的字节数
+        uint32_t delivered = 0;         // 已交付、等待 consumed() 的帧字节数
+        bool assembling = false;
+        std::vector<uint8_t> partial;
+        uint64_t offset = 0;            // 逐帧交付时当前消息已交付的字节数
+    };
+
+    void push(uint16_t stream_id, Outbound&& outbound);
+    void schedule(uint16_t stream_id, SendStream& stream);
+    void credit(uint32_t session_id, uint16_t stream_id, RecvStream& stream, uint32_t bytes,
+                std::vector<Message>& updates);
+    void flush_streams(uint32_t session_id, std::vector<Message>& updates);
+
+    FlowControlOptions options_;
+
+    std::unordered_map<uint16_t, SendStream> send_;
+    std::deque<uint16_t> ready_;
+    int64_t send_connection_window_ = INITIAL_CONNECTION_WINDOW;
+
+    std::unordered_map<uint16_t, RecvStream> recv_;
+    std::size_t assembling_ = 0;        // 重组中的流数
+    Charge reassembly_;                 // 各流 partial 的字节合计
+    int64_t recv_connection_window_ = INITIAL_CONNECTION_WINDOW;
+    uint32_t connection_unacked_ = 0;
+    bool window_announced_ = false;
+};
+
+} // namespace hwp
+
+#endif // HWP_STREAM_HPP
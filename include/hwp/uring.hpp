@@ -0,0 +1,148 @@
+#ifndef HWP_URING_HPP
+#define HWP_URING_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+#include <boost/asio.hpp>
+
+namespace hwp {
+
+// 网络 I/O 后端
+enum class IoBackend {
+    EPOLL,      // Boost.Asio 反应器（Linux 上为 epoll）
+    IO_URING    // io_uring：批量提交、固定文件、注册缓冲区、多发 accept；内核不支持时回落到 EPOLL
+};
+
+namespace uring {
+
+// io_uring 统计（所有 ring 汇总）
+struct UringStats {
+    uint64_t enter_calls = 0;       // io_uring_enter 系统调用
+    uint64_t register_calls = 0;    // io_uring_register 系统调用（固定文件增删、同步取消）
+    uint64_t submitted = 0;         // 提交的 SQE
+    uint64_t completed = 0;         // 处理的 CQE
+    uint64_t fixed_reads = 0;       // 读入注册缓冲区的操作
+    uint64_t accepted = 0;          // 多发 accept 接受的连接
+};
+
+// 内核是否支持本后端用到的全部功能（首次调用时探测并缓存）
+bool supported();
+UringStats stats();
+
+class Ring;
+
+// io_context 上的 ring（作为 Asio 服务随 io_context 销毁）；后端不可用时返回 nullptr。
+// ring 的完成事件经 io_context 的反应器通知，完成回调在运行该 io_context 的线程上执行
+Ring* ring_for(boost::asio::io_context& io);
+
+// 完成回调的类型擦除：操作对象的内存取自回调关联的分配器，与 Asio 的约定相同，
+// 调用回调前先释放，回调中发起的下一个操作可复用同一块内存
+class Operation {
+public:
+    virtual void complete(const boost::system::error_code& ec, std::size_t bytes) = 0;
+    virtual void destroy() = 0;     // 不调用回调，只释放（ring 随 io_context 关闭时）
+
+protected:
+    ~Operation() = default;
+};
+
+template <typename Handler>
+class HandlerOperation final : public Operation {
+public:
+    using Allocator = typename std::allocator_traits<
+        boost::asio::associated_allocator_t<Handler>>::template rebind_alloc<HandlerOperation>;
+
+    static Operation* create(Handler&& handler) {
+        Allocator allocator(boost::asio::get_associated_allocator(handler));
+        HandlerOperation* op = std::allocator_traits<Allocator>::allocate(allocator, 1);
+        return new (op) HandlerOperation(std::move(handler));
+    }
+
+    void complete(const boost::system::error_code& ec, std::size_t bytes) override {
+        Handler handler(std::move(handler_));
+        release();
+        handler(ec, bytes);
+    }
+
+    void destroy() override {
+        // 回调可能持有释放目标内存的所有者，先移出再释放
+        Handler handler(std::move(handler_));
+        release();
+    }
+
+private:
+    explicit HandlerOperation(Handler&& handler) : handler_(std::move(handler)) {}
+
+    void release() {
+        Allocator allocator(boost::asio::get_associated_allocator(handler_));
+        this->~HandlerOperation();
+        std::allocator_traits<Allocator>::deallocate(allocator, this, 1);
+    }
+
+    Handler handler_;
+};
+
+template <typename Handler>
+Operation* make_operation(Handler&& handler) {
+    return HandlerOperation<std::decay_t<Handler>>::create(std::decay_t<Handler>(std::forward<Handler>(handler)));
+}
+
+struct SocketState;
+
+// 已连接 socket 在 io_uring 上的读写。fd 登记为 ring 的固定文件，小的定长读使用注册缓冲区；
+// fd 的所有权仍归调用方（通常是 asio socket），其余操作（HTTP、splice、选项）照常走 asio。
+// 回调签名与 Asio 相同：void(error_code, size_t)。关闭 fd 前必须先 shutdown()：
+// 它同步取消在途操作，返回后内核不再访问读写缓冲区，这些操作以 operation_aborted 完成。
+// 非线程安全；同一时刻最多一个读、一个写
+class Socket {
+public:
+    Socket(Ring& ring, int fd);
+    ~Socket();
+
+    Socket(const Socket&) = delete;
+    Socket& operator=(const Socket&) = delete;
+
+    // 读满 size 字节
+    template <typename Handler>
+    void async_read(void* data, std::size_t size, Handler&& handler) {
+        read(data, size, true, make_operation(std::forward<Handler>(handler)));
+    }
+
+    // 读到至少 1 字节
+    template <typename Handler>
+    void async_read_some(void* data, std::size_t size, Handler&& handler) {
+        read(data, size, false, make_operation(std::forward<Handler>(handler)));
+    }
+
+    // 聚合写出全部缓冲区；缓冲区内容须保持有效直到回调
+    template <typename Handler>
+    void async_write(const std::vector<boost::asio::const_buffer>& buffers, Handler&& handler) {
+        write(buffers, make_operation(std::forward<Handler>(handler)));
+    }
+
+    void shutdown();
+
+private:
+    void read(void* data, std::size_t size, bool exact, Operation* op);
+    void write(const std::vector<boost::asio::const_buffer>& buffers, Operation* op);
+
+    std::shared_ptr<SocketState> state_;
+};
+
+// 监听 socket 上的多发 accept：每个新连接以其 fd 调用一次 handler（close-on-exec），
+// 直到 ring 关闭或监听 socket 出错
+void async_accept(Ring& ring, int listen_fd, std::function<void(int fd)> handler);
+
+// 同步取消 fd 上的全部在途操作（如监听 socket 上的 accept）。
+// 关闭 fd 不会终止 io_uring 中引用它的操作，关闭前须先取消
+void cancel(Ring& ring, int fd);
+
+} // namespace uring
+} // namespace hwp
+
+#endif // HWP_URING_HPP
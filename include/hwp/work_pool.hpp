@@ -0,0 +1,195 @@
+#ifndef HWP_WORK_POOL_HPP
+#define HWP_WORK_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace hwp {
+
+// 工作线程池配置
+struct WorkPoolOptions {
+    size_t threads = 0;             // 工作线程数，0 表示 CPU 核数
+    size_t queue_capacity = 1024;   // 每个线程的任务队列容量，全部队列满时拒绝提交
+};
+
+// 工作线程池统计
+struct WorkPoolStats {
+    uint64_t submitted = 0;
+    uint64_t executed = 0;
+    uint64_t stolen = 0;    // 由其他线程从所属队列窃取执行的任务
+    uint64_t rejected = 0;  // 队列已满而被拒绝的提交
+};
+
+// 有界工作窃取线程池：每个线程一个定长环形队列，提交时轮询选择队列；
+// 线程按 FIFO 处理自己的队列，空闲时从其他队列尾部窃取。
+// Job 须可默认构造、可移动，调用 job() 执行；队列槽位预先分配，提交与执行不分配内存
+template <typename Job>
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(const WorkPoolOptions& options = WorkPoolOptions()) {
+        size_t threads = options.threads;
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        size_t capacity = std::max<size_t>(1, options.queue_capacity);
+        for (size_t i = 0; i < threads; ++i) {
+            queues_.push_back(std::make_unique<Queue>(capacity));
+        }
+        for (size_t i = 0; i < threads; ++i) {
+            threads_.emplace_back([this, i]() { run(i); });
+        }
+    }
+
+    // 执行完已排队的任务后退出
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // 可从任意线程调用；所有队列都满时返回 false，job 保持不变
+    bool submit(Job& job) {
+        // 先计数再入队，取出方不会看到负数
+        pending_.fetch_add(1, std::memory_order_seq_cst);
+        size_t start = next_.fetch_add(1, std::memory_order_relaxed);
+        for (size_t i = 0; i < queues_.size(); ++i) {
+            Queue& queue = *queues_[(start + i) % queues_.size()];
+            if (queue.push(job)) {
+                submitted_.fetch_add(1, std::memory_order_relaxed);
+                // 与 run() 中 idle_ 和 pending_ 的先后顺序配合，不会丢失唤醒
+                if (idle_.load(std::memory_order_seq_cst) > 0) {
+                    { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+                    wake_.notify_one();
+                }
+                return true;
+            }
+        }
+        pending_.fetch_sub(1, std::memory_order_relaxed);
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    size_t thread_count() const { return threads_.size(); }
+
+    WorkPoolStats stats() const {
+        WorkPoolStats s;
+        s.submitted = submitted_.load(std::memory_order_relaxed);
+        s.executed = executed_.load(std::memory_order_relaxed);
+        s.stolen = stolen_.load(std::memory_order_relaxed);
+        s.rejected = rejected_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    class Queue {
+    public:
+        explicit Queue(size_t capacity) : slots_(capacity) {}
+
+        bool push(Job& job) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (size_ == slots_.size()) {
+                return false;
+            }
+            slots_[(head_ + size_) % slots_.size()] = std::move(job);
+            ++size_;
+            return true;
+        }
+
+        // 所属线程从头部取（先提交先执行）
+        bool pop_front(Job& out) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (size_ == 0) {
+                return false;
+            }
+            out = std::move(slots_[head_]);
+            head_ = (head_ + 1) % slots_.size();
+            --size_;
+            return true;
+        }
+
+        // 窃取者从尾部取，与所属线程错开
+        bool pop_back(Job& out) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (size_ == 0) {
+                return false;
+            }
+            --size_;
+            out = std::move(slots_[(head_ + size_) % slots_.size()]);
+            return true;
+        }
+
+    private:
+        std::mutex mutex_;
+        std::vector<Job> slots_;
+        size_t head_ = 0;
+        size_t size_ = 0;
+    };
+
+    bool take(size_t self, Job& job) {
+        if (queues_[self]->pop_front(job)) {
+            return true;
+        }
+        for (size_t i = 1; i < queues_.size(); ++i) {
+            if (queues_[(self + i) % queues_.size()]->pop_back(job)) {
+                stolen_.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void run(size_t self) {
+        Job job;
+        for (;;) {
+            if (take(self, job)) {
+                pending_.fetch_sub(1, std::memory_order_relaxed);
+                job();
+                job = Job();    // 尽早释放任务持有的资源
+                executed_.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            idle_.fetch_add(1, std::memory_order_seq_cst);
+            wake_.wait(lock, [this]() {
+                return stopping_ || pending_.load(std::memory_order_seq_cst) > 0;
+            });
+            idle_.fetch_sub(1, std::memory_order_relaxed);
+            if (stopping_ && pending_.load(std::memory_order_relaxed) == 0) {
+                return;
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+    std::atomic<size_t> next_{0};
+    std::atomic<size_t> pending_{0};    // 已提交（或正在提交）未取出的任务数
+    std::atomic<size_t> idle_{0};       // 正在等待唤醒的线程数
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+    std::atomic<uint64_t> submitted_{0};
+    std::atomic<uint64_t> executed_{0};
+    std::atomic<uint64_t> stolen_{0};
+    std::atomic<uint64_t> rejected_{0};
+};
+
+} // namespace hwp
+
+#endif // HWP_WORK_POOL_HPP
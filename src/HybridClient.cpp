@@ -1,4 +1,7 @@
 #include <iostream>
+#include <algorithm>
+#include <array>
+#include <utility>
 #include <boost/asio.hpp>
 #include "../include/hwp.hpp"
 
@@ -7,6 +10,13 @@ using namespace boost::asio;
 namespace hwp {
 namespace client {
 
+namespace {
+
+// 代理分配的新会话 id 已被占用时重新握手的次数上限
+constexpr int HANDSHAKE_ATTEMPTS = 8;
+
+} // namespace
+
 class Client::Impl {
 public:
     Impl(const std::string& host, unsigned short port)
@@ -23,6 +33,45 @@ public:
         }
     }
 
+    // 握手：携带上次的会话ID以恢复会话，服务器回复最终的会话ID。
+    // 经代理新建会话时代理分配的 id 可能已被占用（ERROR(SESSION_EXISTS)），重新握手换一个
+    bool handshake(const std::string& client_id) {
+        try {
+            for (int attempt = 0; attempt < HANDSHAKE_ATTEMPTS; ++attempt) {
+                Message msg = ProtocolHandler::create_message(
+                    MessageType::HANDSHAKE,
+                    session_id_,
+                    std::vector<uint8_t>(client_id.begin(), client_id.end()),
+                    static_cast<uint8_t>(Flags::BINARY_MODE)
+                );
+                OutgoingFrame frame(std::move(msg));
+                write(socket_, frame.buffers());
+
+                Message reply;
+                if (!receiveBinaryMessage(reply)) {
+                    return false;
+                }
+                if (session_id_ == 0 && reply.session_header.msg_type == MessageType::ERROR &&
+                    reply.payload.size() == 1 && reply.payload[0] == static_cast<uint8_t>(ErrorCode::SESSION_EXISTS)) {
+                    continue;
+                }
+                if (reply.session_header.msg_type != MessageType::HANDSHAKE) {
+                    return false;
+                }
+                session_id_ = reply.session_header.session_id;
+                return true;
+            }
+            return false;
+        } catch (std::exception& e) {
+            std::cerr << "握手错误: " << e.what() << std::endl;
+            return false;
+        }
+    }
+
+    uint32_t sessionId() const {
+        return session_id_;
+    }
+
     // 发送HTTP模式的请求
     std::string sendHttpRequest(const std::string& http_request) {
         try {
@@ -36,16 +85,33 @@ public:
             msg.base_header.flags = static_cast<uint8_t>(Flags::HTTP_MODE);
             msg.base_header.head_len = htons(sizeof(BaseHeader));
             
-            // 发送头部
-            write(socket_, buffer(&msg.base_header, sizeof(BaseHeader)));
-            
+            // 发送头部（每个连接只在首个请求前发送一次）
+            if (!http_mode_) {
+                write(socket_, buffer(&msg.base_header, sizeof(BaseHeader)));
+                http_mode_ = true;
+            }
+
             // 发送HTTP请求
             write(socket_, buffer(http_request));
 
-            // 读取响应
-            std::vector<char> response(1024);
-            size_t len = socket_.read_some(buffer(response));
-            return std::string(response.begin(), response.begin() + len);
+            // 读取完整响应（按 Content-Length），多读到的数据留给下一个响应
+            size_t length = 0;
+            while ((length = http::message_length(rx_buffer_.data(), rx_buffer_.size())) == 0) {
+                boost::system::error_code ec;
+                size_t n = socket_.read_some(buffer(response_buffer_), ec);
+                rx_buffer_.append(response_buffer_.data(), n);
+                if (ec == error::eof) {
+                    // 连接关闭：剩余数据即为完整响应
+                    length = rx_buffer_.size();
+                    break;
+                }
+                if (ec) {
+                    throw boost::system::system_error(ec);
+                }
+            }
+            std::string response = rx_buffer_.substr(0, length);
+            rx_buffer_.erase(0, length);
+            return response;
         } catch (std::exception& e) {
             std::cerr << "请求错误: " << e.what() << std::endl;
             return "";
@@ -55,17 +121,17 @@ public:
     // 发送二进制模式的消息
     bool sendBinaryMessage(const std::vector<uint8_t>& payload, MessageType type) {
         try {
-            // 创建完整消息
+            // 创建消息头（负载借用调用方数据，不拷贝）
             Message msg = ProtocolHandler::create_message(
                 type,
-                0, // 新会话时session_id为0
-                payload,
+                session_id_, // 未握手时为0
+                std::vector<uint8_t>(),
                 static_cast<uint8_t>(Flags::BINARY_MODE)
             );
 
-            // 序列化并发送消息
-            std::vector<uint8_t> serialized = ProtocolHandler::serialize_message(msg);
-            write(socket_, buffer(serialized));
+            // 帧头与负载一次 writev 发出
+            OutgoingFrame frame(msg, payload.data(), payload.size());
+            write(socket_, frame.buffers());
             return true;
         } catch (std::exception& e) {
             std::cerr << "发送错误: " << e.what() << std::endl;
@@ -73,17 +139,147 @@ public:
         }
     }
 
+    // 接收一条二进制模式消息（阻塞直到完整帧到达）
+    bool receiveBinaryMessage(Message& msg) {
+        try {
+            for (;;) {
+                std::array<uint8_t, FRAME_HEADER_SIZE> header;
+                read(socket_, buffer(header));
+
+                ProtocolHandler parser;
+                auto result = parser.parse(header.data(), header.size());
+                if (result != ProtocolHandler::ParseResult::BINARY &&
+                    result != ProtocolHandler::ParseResult::NEED_MORE) {
+                    std::cerr << "接收错误: 无效的帧头" << std::endl;
+                    return false;
+                }
+
+                msg.base_header = parser.get_base_header();
+                msg.session_header = parser.get_session_header();
+                msg.payload.resize(msg.session_header.payload_len);
+                if (!msg.payload.empty()) {
+                    read(socket_, buffer(msg.payload));
+                }
+
+                // 同步客户端一问一答，服务器的暂停/恢复通知无需处理
+                bool pause = false;
+                if (backpressure::parse_signal(msg, pause)) {
+                    continue;
+                }
+                // 字典通告只更新解压状态，继续读取下一帧
+                bool dictionary_ok = true;
+                if (decompressor_.on_control(msg, dictionary_ok)) {
+                    if (!dictionary_ok) {
+                        std::cerr << "接收错误: 无效的压缩字典" << std::endl;
+                        return false;
+                    }
+                    continue;
+                }
+                if (!decompressor_.decompress(msg)) {
+                    std::cerr << "接收错误: 解压失败" << std::endl;
+                    return false;
+                }
+                return true;
+            }
+        } catch (std::exception& e) {
+            std::cerr << "接收错误: " << e.what() << std::endl;
+            return false;
+        }
+    }
+
+    bool sendFile(const std::string& path, const std::string& remote_name, FileTransferState* state) {
+        FileTransferState local;
+        FileTransferState& progress = state ? *state : local;
+        progress = FileTransferState();
+        progress.filename = remote_name;
+        progress.chunk_size = transfer::DEFAULT_CHUNK_SIZE;
+
+        transfer::FileSource source;
+        if (!source.open(path)) {
+            std::cerr << "文件传输错误: 无法打开 " << path << std::endl;
+            return false;
+        }
+        progress.total_size = source.size();
+
+        try {
+            // START：服务器回复续传偏移
+            std::vector<uint8_t> start(8 + remote_name.size());
+            transfer::put_u64(start.data(), progress.total_size);
+            std::copy(remote_name.begin(), remote_name.end(), start.begin() + 8);
+            uint64_t offset = 0;
+            if (!sendTransferControl(MessageType::FILE_TRANSFER_START, start, offset)) {
+                return false;
+            }
+            if (offset > progress.total_size) {
+                return false;
+            }
+            progress.bytes_transferred = offset;
+
+            // DATA：连续发送，不等待逐块确认
+            Message header = ProtocolHandler::create_message(
+                MessageType::FILE_TRANSFER_DATA, session_id_, std::vector<uint8_t>(),
+                static_cast<uint8_t>(Flags::BINARY_MODE));
+            while (progress.bytes_transferred < progress.total_size) {
+                uint32_t length = static_cast<uint32_t>(
+                    std::min<uint64_t>(progress.chunk_size, progress.total_size - progress.bytes_transferred));
+                if (!source.send_chunk(socket_.native_handle(), header, progress.bytes_transferred, length)) {
+                    std::cerr << "文件传输错误: 发送中断" << std::endl;
+                    return false;
+                }
+                progress.bytes_transferred += length;
+            }
+
+            // END：服务器核对长度后改名
+            std::vector<uint8_t> end(8);
+            transfer::put_u64(end.data(), progress.total_size);
+            uint64_t received = 0;
+            if (!sendTransferControl(MessageType::FILE_TRANSFER_END, end, received)) {
+                return false;
+            }
+            progress.is_complete = received == progress.total_size;
+            return progress.is_complete;
+        } catch (std::exception& e) {
+            std::cerr << "文件传输错误: " << e.what() << std::endl;
+            return false;
+        }
+    }
+
     // 关闭连接
     void close() {
         if (socket_.is_open()) {
             socket_.close();
         }
+        rx_buffer_.clear();
+        http_mode_ = false;
     }
 
 private:
+    // 发送 START/END 并等待对应回复（u8 status | u64 value）
+    bool sendTransferControl(MessageType type, const std::vector<uint8_t>& payload, uint64_t& value) {
+        if (!sendBinaryMessage(payload, type)) {
+            return false;
+        }
+        Message reply;
+        if (!receiveBinaryMessage(reply) || reply.session_header.msg_type != type || reply.payload.size() != 9) {
+            std::cerr << "文件传输错误: 无效的回复" << std::endl;
+            return false;
+        }
+        if (reply.payload[0] != static_cast<uint8_t>(transfer::TransferStatus::OK)) {
+            std::cerr << "文件传输错误: 服务器拒绝 (" << static_cast<int>(reply.payload[0]) << ")" << std::endl;
+            return false;
+        }
+        value = transfer::get_u64(reply.payload.data() + 1);
+        return true;
+    }
+
     io_context io_;
     ip::tcp::socket socket_;
     ip::tcp::endpoint endpoint_;
+    std::array<char, 4096> response_buffer_;
+    std::string rx_buffer_;
+    bool http_mode_ = false;
+    uint32_t session_id_ = 0;
+    compress::Decompressor decompressor_;
 };
 
 // Client class implementation
@@ -96,6 +292,14 @@ bool Client::connect() {
     return impl_->connect();
 }
 
+bool Client::handshake(const std::string& client_id) {
+    return impl_->handshake(client_id);
+}
+
+uint32_t Client::sessionId() const {
+    return impl_->sessionId();
+}
+
 std::string Client::sendHttpRequest(const std::string& http_request) {
     return impl_->sendHttpRequest(http_request);
 }
@@ -104,6 +308,14 @@ bool Client::sendBinaryMessage(const std::vector<uint8_t>& payload, MessageType
     return impl_->sendBinaryMessage(payload, type);
 }
 
+bool Client::receiveBinaryMessage(Message& msg) {
+    return impl_->receiveBinaryMessage(msg);
+}
+
+bool Client::sendFile(const std::string& path, const std::string& remote_name, FileTransferState* state) {
+    return impl_->sendFile(path, remote_name, state);
+}
+
 void Client::close() {
     impl_->close();
 }
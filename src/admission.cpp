@@ -0,0 +1,47 @@
+#include "../include/hwp/admission.hpp"
+#include <algorithm>
+
+namespace hwp {
+
+CoDel::CoDel(const CoDelOptions& options)
+    : target_(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(options.target).count())),
+      interval_(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(options.interval).count())) {}
+
+bool CoDel::shed(uint64_t delay_ns, uint64_t now_ns) {
+    if (target_ == 0) {
+        return false;
+    }
+    uint64_t end = interval_end_.load(std::memory_order_relaxed);
+    if (now_ns >= end && interval_end_.compare_exchange_strong(end, now_ns + interval_, std::memory_order_relaxed)) {
+        // 窗口结束：按窗口内的最小延迟判断是否过载，新窗口从本样本开始
+        uint64_t min_delay = min_delay_.exchange(delay_ns, std::memory_order_relaxed);
+        overloaded_.store(min_delay > target_, std::memory_order_relaxed);
+    } else {
+        uint64_t min_delay = min_delay_.load(std::memory_order_relaxed);
+        while (delay_ns < min_delay &&
+               !min_delay_.compare_exchange_weak(min_delay, delay_ns, std::memory_order_relaxed)) {
+        }
+    }
+    return overloaded_.load(std::memory_order_relaxed) && delay_ns > 2 * target_;
+}
+
+RateLimiter::RateLimiter(double rate, std::size_t burst)
+    : rate_(rate), burst_(static_cast<double>(std::max<std::size_t>(burst, 1))), tokens_(burst_) {}
+
+bool RateLimiter::acquire(uint64_t now_ns) {
+    if (rate_ <= 0) {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (last_ns_ != 0 && now_ns > last_ns_) {
+        tokens_ = std::min(burst_, tokens_ + static_cast<double>(now_ns - last_ns_) * rate_ / 1e9);
+    }
+    last_ns_ = now_ns;
+    if (tokens_ < 1) {
+        return false;
+    }
+    tokens_ -= 1;
+    return true;
+}
+
+} // namespace hwp
@@ -0,0 +1,944 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <atomic>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+#include <boost/asio.hpp>
+#include "../include/hwp/async_client.hpp"
+#include "../include/hwp/backpressure.hpp"
+#include "../include/hwp/http.hpp"
+#include "../include/hwp/pool.hpp"
+#include "../include/hwp/reliable.hpp"
+#include "../include/hwp/stream.hpp"
+#include "../include/hwp/uring.hpp"
+
+using namespace boost::asio;
+
+namespace hwp {
+namespace client {
+
+namespace {
+
+using Strand = strand<io_context::executor_type>;
+
+// 单次 writev 最多聚合的帧数
+constexpr size_t MAX_GATHER_FRAMES = 64;
+
+// Wire 模式每次读取的最小空闲空间
+constexpr size_t RX_CHUNK = 64 * 1024;
+
+// 有未确认的可靠消息时，断开的连接隔多久重连一次
+constexpr std::chrono::milliseconds RECONNECT_DELAY{200};
+
+// 代理分配的新会话 id 已被占用（ERROR(SESSION_EXISTS)）时重新握手的次数上限
+constexpr size_t HANDSHAKE_ATTEMPTS = 8;
+
+bool session_exists(const Message& reply) {
+    return reply.session_header.msg_type == MessageType::ERROR && reply.payload.size() == 1 &&
+           reply.payload[0] == static_cast<uint8_t>(ErrorCode::SESSION_EXISTS);
+}
+
+// 待写出的数据：Wire 帧或原始字节（HTTP）
+struct Outgoing {
+    OutgoingFrame frame;
+    std::string raw;
+};
+
+// 同一端点所有连接共享的会话状态，连接断开后保留
+struct SessionShared {
+    SessionShared(const ReliableOptions& options, const compress::CompressionOptions& compression)
+        : channel(options), compressor(compression) {}
+
+    std::atomic<uint32_t> session_id{0};
+    bool closed = false;                // 以下只在 strand 上访问
+    std::string client_id;
+    ReliableChannel channel;
+    compress::Compressor compressor;    // 各连接共用，字典在每条连接上首次使用前通告
+    AsyncClient::PushHandler push_handler;
+    AsyncClient::ChunkCallback chunk_handler;
+};
+
+// 连接池中的一条连接，所有成员只在 strand 上访问
+class PooledConnection : public std::enable_shared_from_this<PooledConnection> {
+public:
+    enum class Mode { WIRE, HTTP };
+
+    PooledConnection(Strand strand, const ip::tcp::endpoint& endpoint, Mode mode,
+                     const FlowControlOptions& flow_options, std::shared_ptr<SessionShared> session, uint64_t id,
+                     uring::Ring* ring = nullptr)
+        : strand_(strand), endpoint_(endpoint), mode_(mode), socket_(strand),
+          flow_options_(flow_options), mux_(flow_options), session_(std::move(session)), id_(id),
+          ack_timer_(strand), reconnect_timer_(strand), ring_(ring) {
+        write_buffers_.reserve(2 * MAX_GATHER_FRAMES);
+    }
+
+    size_t outstanding() const {
+        return pending_.size() + http_pending_.size();
+    }
+
+    void connect(AsyncClient::ConnectHandler handler) {
+        if (state_ == State::OPEN) {
+            handler(boost::system::error_code());
+            return;
+        }
+        connect_waiters_.push_back(std::move(handler));
+        ensure_connected();
+    }
+
+    void request(Message&& msg, AsyncClient::MessageCallback callback) {
+        uint32_t seq = session_->channel.next_seq();
+        msg.session_header.seq_num = seq;
+        if (callback) {
+            pending_.emplace(seq, std::move(callback));
+        }
+        compress_message(msg, false);
+        if (StreamMux::flow_controlled(msg.session_header)) {
+            mux_.enqueue(std::move(msg));
+            start_writing();
+        } else {
+            enqueue(Outgoing{OutgoingFrame(std::move(msg)), std::string()});
+        }
+    }
+
+    // 流式请求：不压缩，负载按窗口逐帧从 source 读取
+    void request_stream(Message&& header, ByteSource source, AsyncClient::MessageCallback callback) {
+        uint32_t seq = session_->channel.next_seq();
+        header.session_header.seq_num = seq;
+        if (callback) {
+            pending_.emplace(seq, std::move(callback));
+        }
+        mux_.enqueue(std::move(header), std::move(source));
+        start_writing();
+    }
+
+    void send_reliable(Message&& msg, ReliableChannel::AckCallback callback) {
+        compress_message(msg, true);
+        std::vector<OutgoingFrame> frames;
+        session_->channel.send(std::move(msg), id_, std::move(callback), frames);
+        write_frames(frames);
+    }
+
+    void http_request(std::string request, AsyncClient::HttpCallback callback) {
+        http_pending_.push_back(std::move(callback));
+        enqueue(Outgoing{OutgoingFrame(), std::move(request)});
+    }
+
+    void close(boost::system::error_code reason) {
+        // 作废旧连接上尚未完成的异步操作
+        ++generation_;
+        boost::system::error_code ignored;
+        // ring 中的读写先同步取消，之后才能关闭 fd、复用接收缓冲区
+        if (uring_) {
+            uring_->shutdown();
+            uring_.reset();
+        }
+        socket_.close(ignored);
+        state_ = State::IDLE;
+        write_queue_.clear();
+        writing_ = false;
+        peer_paused_ = false;
+        http_rx_.clear();
+        // 流状态与窗口属于连接，重连后从初始窗口开始
+        mux_ = StreamMux(flow_options_);
+        // 字典同样只在本连接上有效
+        announced_dictionary_ = 0;
+        decompressor_ = compress::Decompressor();
+        ack_timer_.cancel();
+        ack_pending_ = 0;
+        reconnect_timer_.cancel();
+        if (mode_ == Mode::WIRE) {
+            // 经本连接发出的可靠消息等待补发；主动关闭以外的断开稍后自动重连
+            session_->channel.connection_lost(id_);
+            if (reason != error::operation_aborted && session_->channel.has_lost()) {
+                schedule_reconnect();
+            }
+        }
+
+        auto pending = std::move(pending_);
+        pending_.clear();
+        auto http_pending = std::move(http_pending_);
+        http_pending_.clear();
+        auto waiters = std::move(connect_waiters_);
+        connect_waiters_.clear();
+        for (auto& entry : pending) {
+            entry.second(reason, Message());
+        }
+        for (auto& callback : http_pending) {
+            callback(reason, std::string());
+        }
+        for (auto& waiter : waiters) {
+            waiter(reason);
+        }
+    }
+
+private:
+    enum class State { IDLE, CONNECTING, OPEN };
+
+    void enqueue(Outgoing&& outgoing) {
+        write_queue_.push_back(std::move(outgoing));
+        start_writing();
+    }
+
+    void write_frames(std::vector<OutgoingFrame>& frames) {
+        for (auto& frame : frames) {
+            write_queue_.push_back(Outgoing{std::move(frame), std::string()});
+        }
+        if (!frames.empty()) {
+            start_writing();
+        }
+    }
+
+    void schedule_reconnect() {
+        auto self = shared_from_this();
+        reconnect_timer_.expires_after(RECONNECT_DELAY);
+        reconnect_timer_.async_wait([self, gen = generation_](boost::system::error_code ec) {
+            if (ec || gen != self->generation_) {
+                return;
+            }
+            if (self->session_->channel.has_lost()) {
+                self->ensure_connected();
+            }
+        });
+    }
+
+    // 已建立会话时，新连接先发送带 REQUIRES_ACK 的握手恢复会话：
+    // 服务器回复后紧接着发送其接收状态，本端据此补发；本端也回送自己的接收状态
+    void queue_resume() {
+        uint32_t session_id = session_->session_id.load();
+        const std::string& client_id = session_->client_id;
+        Message msg = ProtocolHandler::create_message(MessageType::HANDSHAKE, session_id,
+            std::vector<uint8_t>(client_id.begin(), client_id.end()),
+            static_cast<uint8_t>(Flags::BINARY_MODE) | static_cast<uint8_t>(Flags::REQUIRES_ACK));
+        uint32_t seq = session_->channel.next_seq();
+        msg.session_header.seq_num = seq;
+        auto self = shared_from_this();
+        pending_.emplace(seq, [self](boost::system::error_code ec, Message reply) {
+            if (ec) {
+                return;
+            }
+            // 会话已过期时服务器分配了新会话
+            uint32_t session_id = reply.session_header.session_id;
+            self->session_->session_id = session_id;
+            self->enqueue(Outgoing{OutgoingFrame(self->session_->channel.make_ack(session_id)), std::string()});
+        });
+        write_queue_.push_front(Outgoing{OutgoingFrame(std::move(msg)), std::string()});
+    }
+
+    void start_writing() {
+        if (state_ == State::OPEN) {
+            pump_writes();
+        } else {
+            ensure_connected();
+        }
+    }
+
+    // 写队列空时才从各流按窗口取帧，不受流控的消息不会排在大块流数据之后；
+    // 服务器发来 PAUSE 后请求留在本地队列，收到 RESUME 再写出
+    void pump_writes() {
+        if (writing_ || peer_paused_) {
+            return;
+        }
+        if (write_queue_.empty()) {
+            OutgoingFrame frame;
+            while (write_queue_.size() < MAX_GATHER_FRAMES && mux_.next_frame(frame)) {
+                write_queue_.push_back(Outgoing{std::move(frame), std::string()});
+            }
+        }
+        if (!write_queue_.empty()) {
+            do_write();
+        }
+    }
+
+    void ensure_connected() {
+        // 客户端关闭后，确认回调中触发的写入（如 ACK、FORWARD）不再重新建立连接
+        if (state_ != State::IDLE || session_->closed) {
+            return;
+        }
+        state_ = State::CONNECTING;
+        if (mode_ == Mode::HTTP) {
+            // HTTP 模式连接先发送一次基础头
+            BaseHeader header{};
+            header.magic[0] = 'H';
+            header.magic[1] = 'W';
+            header.magic[2] = 'P';
+            header.magic[3] = '\0';
+            header.version = PROTOCOL_VERSION;
+            header.flags = static_cast<uint8_t>(Flags::HTTP_MODE);
+            header.head_len = htons(sizeof(BaseHeader));
+            write_queue_.push_front(Outgoing{OutgoingFrame(),
+                std::string(reinterpret_cast<const char*>(&header), sizeof(header))});
+        } else if (session_->session_id.load() != 0) {
+            queue_resume();
+        }
+
+        auto self = shared_from_this();
+        socket_.async_connect(endpoint_, [self, gen = generation_](boost::system::error_code ec) {
+            if (gen != self->generation_) {
+                return;
+            }
+            if (ec) {
+                self->close(ec);
+                return;
+            }
+            boost::system::error_code ignored;
+            self->socket_.set_option(ip::tcp::no_delay(true), ignored);
+            self->state_ = State::OPEN;
+
+            auto waiters = std::move(self->connect_waiters_);
+            self->connect_waiters_.clear();
+            for (auto& waiter : waiters) {
+                waiter(boost::system::error_code());
+            }
+
+            if (self->mode_ == Mode::WIRE) {
+                if (self->ring_) {
+                    self->uring_ = std::make_unique<uring::Socket>(*self->ring_, self->socket_.native_handle());
+                }
+                self->rx_begin_ = 0;
+                self->rx_end_ = 0;
+                self->read_wire();
+            } else {
+                self->read_http();
+            }
+            self->pump_writes();
+        });
+    }
+
+    // 将队列中的多帧聚合为一次 writev
+    void do_write() {
+        write_buffers_.clear();
+        write_batch_ = 0;
+        for (const auto& outgoing : write_queue_) {
+            if (write_batch_ == MAX_GATHER_FRAMES) {
+                break;
+            }
+            if (!outgoing.raw.empty()) {
+                write_buffers_.push_back(buffer(outgoing.raw));
+            } else {
+                auto buffers = outgoing.frame.buffers();
+                write_buffers_.push_back(buffers[0]);
+                if (buffers[1].size() > 0) {
+                    write_buffers_.push_back(buffers[1]);
+                }
+            }
+            ++write_batch_;
+        }
+
+        writing_ = true;
+        auto self = shared_from_this();
+        if (uring_) {
+            // ring 的完成回调不在 strand 上执行，转回 strand 处理
+            uring_->async_write(write_buffers_, make_custom_alloc_handler(write_memory_,
+                [self, gen = generation_](boost::system::error_code ec, size_t /*bytes*/) {
+                    dispatch(self->strand_, [self, gen, ec]() { self->on_write(gen, ec); });
+                }));
+            return;
+        }
+        async_write(socket_, BufferRange(write_buffers_), make_custom_alloc_handler(write_memory_,
+            [self, gen = generation_](boost::system::error_code ec, size_t /*bytes*/) {
+                self->on_write(gen, ec);
+            }));
+    }
+
+    void on_write(uint64_t gen, boost::system::error_code ec) {
+        if (gen != generation_) {
+            return;
+        }
+        writing_ = false;
+        if (ec) {
+            close(ec);
+            return;
+        }
+        for (size_t i = 0; i < write_batch_; ++i) {
+            pool::release_buffer(write_queue_.front().frame.release_payload());
+            write_queue_.pop_front();
+        }
+        pump_writes();
+    }
+
+    // Wire 模式：一次 read_some 尽量多读，缓冲区内所有完整回复逐个交付
+    void read_wire() {
+        if (rx_buffer_.size() - rx_end_ < RX_CHUNK) {
+            compact_rx(RX_CHUNK);
+        }
+        auto self = shared_from_this();
+        if (uring_) {
+            uring_->async_read_some(rx_buffer_.data() + rx_end_, rx_buffer_.size() - rx_end_,
+                make_custom_alloc_handler(read_memory_,
+                [self, gen = generation_](boost::system::error_code ec, size_t bytes) {
+                    dispatch(self->strand_, [self, gen, ec, bytes]() { self->on_wire_read(gen, ec, bytes); });
+                }));
+            return;
+        }
+        socket_.async_read_some(buffer(rx_buffer_.data() + rx_end_, rx_buffer_.size() - rx_end_),
+            make_custom_alloc_handler(read_memory_,
+            [self, gen = generation_](boost::system::error_code ec, size_t bytes) {
+                self->on_wire_read(gen, ec, bytes);
+            }));
+    }
+
+    void on_wire_read(uint64_t gen, boost::system::error_code ec, size_t bytes) {
+        if (gen != generation_) {
+            return;
+        }
+        if (ec) {
+            close(ec);
+            return;
+        }
+        rx_end_ += bytes;
+        if (!deliver_frames()) {
+            close(error::make_error_code(error::invalid_argument));
+            return;
+        }
+        if (state_ == State::OPEN) {
+            read_wire();
+        }
+    }
+
+    // 批量解码已缓冲数据；剩余不完整帧留待下次读取，返回 false 表示协议错误
+    bool deliver_frames() {
+        auto status = decoder_.decode(rx_buffer_.data() + rx_begin_, rx_end_ - rx_begin_);
+        for (const FrameView& frame : decoder_.frames()) {
+            if (state_ != State::OPEN) {
+                return true;
+            }
+            Message msg;
+            msg.base_header = frame.base;
+            msg.session_header = frame.session;
+            msg.payload = pool::acquire_buffer(frame.session.payload_len);
+            std::copy(frame.payload, frame.payload + frame.session.payload_len, msg.payload.begin());
+            rx_begin_ += FRAME_HEADER_SIZE + frame.session.payload_len;
+            deliver(std::move(msg));
+        }
+        if (status == FrameDecoder::Status::ERROR) {
+            return false;
+        }
+        size_t available = rx_end_ - rx_begin_;
+        if (decoder_.required() > rx_buffer_.size() - rx_begin_) {
+            compact_rx(decoder_.required() - available);
+        }
+        return true;
+    }
+
+    // 将未消费数据移到缓冲区开头，并保证至少还有 free_space 字节空闲
+    void compact_rx(size_t free_space) {
+        size_t pending = rx_end_ - rx_begin_;
+        if (rx_begin_ > 0) {
+            std::memmove(rx_buffer_.data(), rx_buffer_.data() + rx_begin_, pending);
+            rx_begin_ = 0;
+            rx_end_ = pending;
+        }
+        if (rx_buffer_.size() - rx_end_ < free_space) {
+            rx_buffer_.resize(rx_end_ + free_space);
+        }
+    }
+
+    // 回复的 ack_num 即请求的 seq_num
+    void deliver(Message&& msg) {
+        uint32_t increment = 0;
+        if (StreamMux::parse_window_update(msg, increment)) {
+            if (!mux_.on_window_update(msg.session_header.stream_id, increment)) {
+                close(error::make_error_code(error::invalid_argument));
+                return;
+            }
+            pump_writes();
+            return;
+        }
+        bool pause = false;
+        if (backpressure::parse_signal(msg, pause)) {
+            peer_paused_ = pause;
+            if (!pause) {
+                pump_writes();
+            }
+            return;
+        }
+        AckInfo ack;
+        if (ReliableChannel::parse_ack(msg, ack)) {
+            std::vector<OutgoingFrame> frames;
+            session_->channel.on_ack(ack, id_, frames);
+            write_frames(frames);
+            return;
+        }
+        uint32_t forward = 0;
+        if (ReliableChannel::parse_forward(msg, forward)) {
+            session_->channel.on_forward(forward);
+            return;
+        }
+        bool dictionary_ok = true;
+        if (decompressor_.on_control(msg, dictionary_ok)) {
+            if (!dictionary_ok) {
+                close(error::make_error_code(error::invalid_argument));
+            }
+            return;
+        }
+        std::vector<Message> updates;
+        uint64_t offset = 0;
+        auto inbound = mux_.on_frame(msg, updates, &offset);
+        if (inbound == StreamMux::Inbound::VIOLATION) {
+            close(error::make_error_code(error::invalid_argument));
+            return;
+        }
+        if (inbound == StreamMux::Inbound::CHUNK) {
+            PayloadChunk chunk;
+            chunk.header = msg.session_header;
+            chunk.offset = offset;
+            chunk.last = !(msg.base_header.flags & static_cast<uint8_t>(Flags::MORE));
+            chunk.data = std::move(msg.payload);
+            if (session_->chunk_handler) {
+                session_->chunk_handler(chunk);
+            }
+            if (state_ == State::OPEN) {
+                mux_.consumed(chunk.header, updates);
+                send_updates(updates);
+            }
+            return;
+        }
+        if (inbound == StreamMux::Inbound::PARTIAL) {
+            send_updates(updates);
+            return;
+        }
+
+        if (!decompressor_.decompress(msg)) {
+            close(error::make_error_code(error::invalid_argument));
+            return;
+        }
+        SessionHeader header = msg.session_header;
+        if (!track_sequence(msg)) {
+            // 重复的可靠消息不再交付
+        } else if (auto it = pending_.find(msg.session_header.ack_num); it != pending_.end()) {
+            auto callback = std::move(it->second);
+            pending_.erase(it);
+            boost::system::error_code ec;
+            if (msg.session_header.msg_type == MessageType::ERROR) {
+                ec = error::make_error_code(error::try_again);
+            }
+            callback(ec, std::move(msg));
+        } else if (session_->push_handler) {
+            session_->push_handler(std::move(msg));
+        }
+
+        // 回调返回即视为已消费，归还窗口
+        if (state_ == State::OPEN) {
+            mux_.consumed(header, updates);
+            send_updates(updates);
+        }
+    }
+
+    // 服务器的可靠消息：去重并安排确认；返回 false 表示重复
+    bool track_sequence(const Message& msg) {
+        if (msg.session_header.seq_num == 0 ||
+            !(msg.base_header.flags & static_cast<uint8_t>(Flags::REQUIRES_ACK))) {
+            return true;
+        }
+        auto received = session_->channel.on_receive(msg.session_header.seq_num, true);
+        schedule_ack((msg.base_header.flags & static_cast<uint8_t>(Flags::ACK_NOW)) ||
+                     received == ReliableChannel::Receive::DUPLICATE);
+        return received != ReliableChannel::Receive::DUPLICATE;
+    }
+
+    // 延迟确认：累计 ack_every 条或等待 ack_delay 后合并为一个 ACK
+    void schedule_ack(bool immediate) {
+        const ReliableOptions& options = session_->channel.options();
+        ++ack_pending_;
+        if (immediate || ack_pending_ >= options.ack_every) {
+            send_ack();
+            return;
+        }
+        if (ack_pending_ > 1) {
+            return;
+        }
+        auto self = shared_from_this();
+        ack_timer_.expires_after(options.ack_delay);
+        ack_timer_.async_wait([self, gen = generation_](boost::system::error_code ec) {
+            if (!ec && gen == self->generation_) {
+                self->send_ack();
+            }
+        });
+    }
+
+    // 需要先行通告的字典直接排入写队列，保证先于该消息写出
+    void compress_message(Message& msg, bool self_contained) {
+        dictionary_frames_.clear();
+        session_->compressor.compress(msg, announced_dictionary_, dictionary_frames_, self_contained);
+        for (auto& dictionary : dictionary_frames_) {
+            enqueue(Outgoing{OutgoingFrame(std::move(dictionary)), std::string()});
+        }
+    }
+
+    void send_ack() {
+        if (ack_pending_ == 0) {
+            return;
+        }
+        ack_pending_ = 0;
+        ack_timer_.cancel();
+        enqueue(Outgoing{OutgoingFrame(session_->channel.make_ack(session_->session_id.load())), std::string()});
+    }
+
+    void send_updates(std::vector<Message>& updates) {
+        for (auto& update : updates) {
+            write_queue_.push_back(Outgoing{OutgoingFrame(std::move(update)), std::string()});
+        }
+        if (!updates.empty()) {
+            pump_writes();
+        }
+    }
+
+    void read_http() {
+        auto self = shared_from_this();
+        socket_.async_read_some(buffer(http_chunk_), make_custom_alloc_handler(read_memory_,
+            [self, gen = generation_](boost::system::error_code ec, size_t bytes) {
+                if (gen != self->generation_) {
+                    return;
+                }
+                self->http_rx_.append(self->http_chunk_.data(), bytes);
+
+                // 按顺序交付所有已完整的响应
+                size_t length;
+                while (!self->http_pending_.empty() &&
+                       (length = http::message_length(self->http_rx_.data(), self->http_rx_.size())) != 0) {
+                    auto callback = std::move(self->http_pending_.front());
+                    self->http_pending_.pop_front();
+                    callback(boost::system::error_code(), self->http_rx_.substr(0, length));
+                    self->http_rx_.erase(0, length);
+                }
+
+                if (ec) {
+                    // 服务器关闭连接：剩余数据作为最后一个响应
+                    if (ec == error::eof && !self->http_pending_.empty() && !self->http_rx_.empty()) {
+                        auto callback = std::move(self->http_pending_.front());
+                        self->http_pending_.pop_front();
+                        callback(boost::system::error_code(), std::move(self->http_rx_));
+                    }
+                    self->close(ec);
+                    return;
+                }
+                self->read_http();
+            }));
+    }
+
+    Strand strand_;
+    ip::tcp::endpoint endpoint_;
+    Mode mode_;
+    ip::tcp::socket socket_;
+    State state_ = State::IDLE;
+    uint64_t generation_ = 0;
+
+    std::unordered_map<uint32_t, AsyncClient::MessageCallback> pending_;
+    std::deque<AsyncClient::HttpCallback> http_pending_;
+    std::vector<AsyncClient::ConnectHandler> connect_waiters_;
+
+    std::deque<Outgoing> write_queue_;
+    std::vector<const_buffer> write_buffers_;
+    size_t write_batch_ = 0;
+    bool writing_ = false;
+    bool peer_paused_ = false;      // 服务器写队列积压，暂停发送
+    FlowControlOptions flow_options_;
+    StreamMux mux_;
+    std::shared_ptr<SessionShared> session_;
+    uint64_t id_;
+    uint32_t ack_pending_ = 0;
+    steady_timer ack_timer_;
+    steady_timer reconnect_timer_;
+    compress::Decompressor decompressor_;
+    uint32_t announced_dictionary_ = 0;
+    std::vector<Message> dictionary_frames_;
+
+    FrameDecoder decoder_;
+    std::vector<uint8_t> rx_buffer_;
+    size_t rx_begin_ = 0;
+    size_t rx_end_ = 0;
+    std::array<char, 8192> http_chunk_{};
+    std::string http_rx_;
+
+    HandlerMemory read_memory_;
+    HandlerMemory write_memory_;
+    uring::Ring* ring_;                     // io_uring 后端，为空时使用反应器
+    std::unique_ptr<uring::Socket> uring_;  // 仅 Wire 连接打开期间存在
+};
+
+} // namespace
+
+class AsyncClient::Impl : public std::enable_shared_from_this<Impl> {
+public:
+    Impl(io_context& io, const std::string& host, unsigned short port, const AsyncClientOptions& options)
+        : strand_(make_strand(io)),
+          endpoint_(ip::address::from_string(host), port),
+          options_(options),
+          session_(std::make_shared<SessionShared>(options.reliable, options.compression)) {
+        if (options_.connections == 0) {
+            options_.connections = 1;
+        }
+        // 内核不支持时 ring 为空，回落到反应器
+        if (options_.backend == IoBackend::IO_URING) {
+            ring_ = uring::ring_for(io);
+        }
+    }
+
+    void async_connect(ConnectHandler handler) {
+        auto self = shared_from_this();
+        dispatch(strand_, [self, handler = std::move(handler)]() mutable {
+            while (self->wire_.size() < self->options_.connections) {
+                self->wire_.push_back(self->make_connection(PooledConnection::Mode::WIRE));
+            }
+            auto remaining = std::make_shared<size_t>(self->wire_.size());
+            auto done = std::make_shared<bool>(false);
+            for (auto& connection : self->wire_) {
+                connection->connect([remaining, done, handler](boost::system::error_code ec) {
+                    if (*done) {
+                        return;
+                    }
+                    if (ec || --*remaining == 0) {
+                        *done = true;
+                        handler(ec);
+                    }
+                });
+            }
+        });
+    }
+
+    void async_handshake(const std::string& client_id, ConnectHandler handler,
+                         size_t attempts = HANDSHAKE_ATTEMPTS) {
+        auto self = shared_from_this();
+        async_request(0, MessageType::HANDSHAKE, std::vector<uint8_t>(client_id.begin(), client_id.end()),
+            [self, client_id, attempts, handler = std::move(handler)](boost::system::error_code ec, Message reply) {
+                // 代理分配的 id 撞上了已有会话：再次握手，代理分配下一个 id
+                if (ec && session_exists(reply) && attempts > 1) {
+                    self->async_handshake(client_id, std::move(handler), attempts - 1);
+                    return;
+                }
+                if (!ec) {
+                    self->session_->session_id = reply.session_header.session_id;
+                    self->session_->client_id = client_id;
+                }
+                handler(ec);
+            });
+    }
+
+    uint16_t open_stream() {
+        // 1..65535 循环分配，0 保留给默认流
+        return static_cast<uint16_t>(next_stream_.fetch_add(1, std::memory_order_relaxed) % 65535 + 1);
+    }
+
+    void async_request(uint16_t stream_id, MessageType type, std::vector<uint8_t> payload, MessageCallback callback) {
+        auto self = shared_from_this();
+        dispatch(strand_, [self, stream_id, type, payload = std::move(payload), callback = std::move(callback)]() mutable {
+            if (self->session_->closed) {
+                if (callback) {
+                    callback(error::operation_aborted, Message());
+                }
+                return;
+            }
+            Message msg = ProtocolHandler::create_message(type, self->session_->session_id.load(), std::move(payload),
+                                                          static_cast<uint8_t>(Flags::BINARY_MODE));
+            msg.session_header.stream_id = stream_id;
+            PooledConnection& connection = stream_id == 0 ? self->pick(self->wire_, PooledConnection::Mode::WIRE)
+                                                          : self->stream_connection(stream_id);
+            connection.request(std::move(msg), std::move(callback));
+        });
+    }
+
+    void async_request_stream(uint16_t stream_id, ByteSource source, MessageCallback callback) {
+        auto self = shared_from_this();
+        dispatch(strand_, [self, stream_id, source = std::move(source), callback = std::move(callback)]() mutable {
+            if (self->session_->closed || stream_id == 0) {
+                if (callback) {
+                    callback(self->session_->closed ? error::operation_aborted : error::invalid_argument, Message());
+                }
+                return;
+            }
+            Message header = ProtocolHandler::create_message(MessageType::DATA, self->session_->session_id.load(),
+                                                             std::vector<uint8_t>(),
+                                                             static_cast<uint8_t>(Flags::BINARY_MODE));
+            header.session_header.stream_id = stream_id;
+            self->stream_connection(stream_id).request_stream(std::move(header), std::move(source), std::move(callback));
+        });
+    }
+
+    void async_send_reliable(MessageType type, std::vector<uint8_t> payload, AckHandler handler) {
+        auto self = shared_from_this();
+        dispatch(strand_, [self, type, payload = std::move(payload), handler = std::move(handler)]() mutable {
+            if (self->session_->closed || self->session_->session_id.load() == 0) {
+                // 可靠消息以会话为单位确认，未握手时无法发送
+                if (handler) {
+                    handler(self->session_->closed ? error::operation_aborted : error::not_connected);
+                }
+                return;
+            }
+            Message msg = ProtocolHandler::create_message(type, self->session_->session_id.load(), std::move(payload),
+                                                          static_cast<uint8_t>(Flags::BINARY_MODE));
+            ReliableChannel::AckCallback callback;
+            if (handler) {
+                callback = [handler = std::move(handler)](bool acked) {
+                    handler(acked ? boost::system::error_code() : error::operation_aborted);
+                };
+            }
+            self->pick(self->wire_, PooledConnection::Mode::WIRE).send_reliable(std::move(msg), std::move(callback));
+        });
+    }
+
+    void async_http_request(std::string request, HttpCallback callback) {
+        auto self = shared_from_this();
+        dispatch(strand_, [self, request = std::move(request), callback = std::move(callback)]() mutable {
+            if (self->session_->closed) {
+                callback(error::operation_aborted, std::string());
+                return;
+            }
+            self->pick(self->http_, PooledConnection::Mode::HTTP).http_request(std::move(request), std::move(callback));
+        });
+    }
+
+    void set_push_handler(PushHandler handler) {
+        auto self = shared_from_this();
+        dispatch(strand_, [self, handler = std::move(handler)]() mutable {
+            self->session_->push_handler = std::move(handler);
+        });
+    }
+
+    void set_chunk_handler(ChunkCallback handler) {
+        options_.flow.stream_payloads = static_cast<bool>(handler);
+        auto self = shared_from_this();
+        dispatch(strand_, [self, handler = std::move(handler)]() mutable {
+            self->session_->chunk_handler = std::move(handler);
+        });
+    }
+
+    uint32_t session_id() const {
+        return session_->session_id;
+    }
+
+    ReliableStats reliable_stats() const {
+        return session_->channel.stats();
+    }
+
+    void close() {
+        auto self = shared_from_this();
+        dispatch(strand_, [self]() {
+            self->session_->closed = true;
+            for (auto& connection : self->wire_) {
+                connection->close(error::operation_aborted);
+            }
+            for (auto& connection : self->http_) {
+                connection->close(error::operation_aborted);
+            }
+            self->session_->channel.abandon();
+        });
+    }
+
+private:
+    std::shared_ptr<PooledConnection> make_connection(PooledConnection::Mode mode) {
+        return std::make_shared<PooledConnection>(strand_, endpoint_, mode, options_.flow, session_,
+                                                  next_connection_id_++, ring_);
+    }
+
+    // 选择在途请求最少的连接；池未满且所有连接都忙时新建连接
+    PooledConnection& pick(std::vector<std::shared_ptr<PooledConnection>>& pool, PooledConnection::Mode mode) {
+        PooledConnection* best = nullptr;
+        for (auto& connection : pool) {
+            if (!best || connection->outstanding() < best->outstanding()) {
+                best = connection.get();
+            }
+        }
+        if ((!best || best->outstanding() > 0) && pool.size() < options_.connections) {
+            pool.push_back(make_connection(mode));
+            best = pool.back().get();
+        }
+        return *best;
+    }
+
+    // 流固定在一条 Wire 连接上，流的帧与窗口都属于该连接
+    PooledConnection& stream_connection(uint16_t stream_id) {
+        size_t index = (stream_id - 1u) % options_.connections;
+        while (wire_.size() <= index) {
+            wire_.push_back(make_connection(PooledConnection::Mode::WIRE));
+        }
+        return *wire_[index];
+    }
+
+    Strand strand_;
+    ip::tcp::endpoint endpoint_;
+    AsyncClientOptions options_;
+    std::vector<std::shared_ptr<PooledConnection>> wire_;
+    std::vector<std::shared_ptr<PooledConnection>> http_;
+    std::shared_ptr<SessionShared> session_;
+    uring::Ring* ring_ = nullptr;
+    uint64_t next_connection_id_ = 1;
+    std::atomic<uint32_t> next_stream_{0};
+};
+
+AsyncClient::AsyncClient(io_context& io, const std::string& host, unsigned short port,
+                         const AsyncClientOptions& options)
+    : impl_(std::make_shared<Impl>(io, host, port, options)) {}
+
+AsyncClient::~AsyncClient() {
+    impl_->close();
+}
+
+void AsyncClient::async_connect(ConnectHandler handler) {
+    impl_->async_connect(std::move(handler));
+}
+
+void AsyncClient::async_handshake(const std::string& client_id, ConnectHandler handler) {
+    impl_->async_handshake(client_id, std::move(handler));
+}
+
+void AsyncClient::async_request(MessageType type, std::vector<uint8_t> payload, MessageCallback callback) {
+    impl_->async_request(0, type, std::move(payload), std::move(callback));
+}
+
+void AsyncClient::async_send(MessageType type, std::vector<uint8_t> payload) {
+    impl_->async_request(0, type, std::move(payload), MessageCallback());
+}
+
+uint16_t AsyncClient::open_stream() {
+    return impl_->open_stream();
+}
+
+void AsyncClient::async_request(uint16_t stream_id, MessageType type, std::vector<uint8_t> payload,
+                                MessageCallback callback) {
+    impl_->async_request(stream_id, type, std::move(payload), std::move(callback));
+}
+
+void AsyncClient::async_send(uint16_t stream_id, MessageType type, std::vector<uint8_t> payload) {
+    impl_->async_request(stream_id, type, std::move(payload), MessageCallback());
+}
+
+void AsyncClient::async_request_stream(uint16_t stream_id, ByteSource source, MessageCallback callback) {
+    impl_->async_request_stream(stream_id, std::move(source), std::move(callback));
+}
+
+void AsyncClient::async_send_stream(uint16_t stream_id, ByteSource source) {
+    impl_->async_request_stream(stream_id, std::move(source), MessageCallback());
+}
+
+void AsyncClient::async_send_reliable(MessageType type, std::vector<uint8_t> payload, AckHandler handler) {
+    impl_->async_send_reliable(type, std::move(payload), std::move(handler));
+}
+
+void AsyncClient::async_http_request(std::string request, HttpCallback callback) {
+    impl_->async_http_request(std::move(request), std::move(callback));
+}
+
+void AsyncClient::set_push_handler(PushHandler handler) {
+    impl_->set_push_handler(std::move(handler));
+}
+
+void AsyncClient::set_chunk_handler(ChunkCallback handler) {
+    impl_->set_chunk_handler(std::move(handler));
+}
+
+uint32_t AsyncClient::session_id() const {
+    return impl_->session_id();
+}
+
+ReliableStats AsyncClient::reliable_stats() const {
+    return impl_->reliable_stats();
+}
+
+void AsyncClient::close() {
+    impl_->close();
+}
+
+} // namespace client
+} // namespace hwp
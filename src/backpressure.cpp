@@ -0,0 +1,24 @@
+#include "../include/hwp/backpressure.hpp"
+
+namespace hwp {
+namespace backpressure {
+
+Message make_signal(uint32_t session_id, bool pause) {
+    std::vector<uint8_t> payload(2);
+    payload[0] = static_cast<uint8_t>(ControlCode::PAUSE);
+    payload[1] = pause ? 1 : 0;
+    return ProtocolHandler::create_message(MessageType::CONTROL, session_id, std::move(payload),
+                                           static_cast<uint8_t>(Flags::BINARY_MODE));
+}
+
+bool parse_signal(const Message& msg, bool& pause) {
+    if (msg.session_header.msg_type != MessageType::CONTROL || msg.payload.size() != 2 ||
+        msg.payload[0] != static_cast<uint8_t>(ControlCode::PAUSE)) {
+        return false;
+    }
+    pause = msg.payload[1] != 0;
+    return true;
+}
+
+} // namespace backpressure
+} // namespace hwp
@@ -0,0 +1,379 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include "../include/hwp/capture.hpp"
+
+namespace hwp {
+namespace capture {
+
+namespace {
+
+void put_u16(uint8_t* out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value >> 8);
+    out[1] = static_cast<uint8_t>(value);
+}
+
+void put_u32(uint8_t* out, uint32_t value) {
+    for (int i = 3; i >= 0; --i, value >>= 8) {
+        out[i] = static_cast<uint8_t>(value);
+    }
+}
+
+void put_u64(uint8_t* out, uint64_t value) {
+    for (int i = 7; i >= 0; --i, value >>= 8) {
+        out[i] = static_cast<uint8_t>(value);
+    }
+}
+
+uint16_t get_u16(const uint8_t* in) {
+    return static_cast<uint16_t>((in[0] << 8) | in[1]);
+}
+
+uint32_t get_u32(const uint8_t* in) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+uint64_t get_u64(const uint8_t* in) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+} // namespace
+
+// 每个写入线程一块前台缓冲区，记录（含负载拷贝）只在本线程的缓冲区里进行；
+// 写满后在 mutex_ 下移入 pending_，由后台线程写文件，写完的缓冲区放回 spare_ 复用。
+// Local::mutex 只在所属线程与 close() 之间竞争；两把锁的顺序总是先 Local::mutex 后 mutex_
+class CaptureWriter::Impl {
+public:
+    ~Impl() {
+        close();
+    }
+
+    bool open(const CaptureOptions& options) {
+        close();
+        std::lock_guard<std::mutex> lock(mutex_);
+        file_ = std::fopen(options.path.c_str(), "wb");
+        if (!file_) {
+            return false;
+        }
+        std::setvbuf(file_, nullptr, _IONBF, 0);
+        options_ = options;
+        if (options_.buffer_size < RECORD_HEADER_SIZE + FRAME_HEADER_SIZE) {
+            options_.buffer_size = RECORD_HEADER_SIZE + FRAME_HEADER_SIZE;
+        }
+        bytes_ = 0;
+        records_ = 0;
+        dropped_ = 0;
+        stopping_ = false;
+        generation_ = next_generation().fetch_add(1, std::memory_order_relaxed);
+
+        uint8_t header[FILE_HEADER_SIZE];
+        std::memcpy(header, FILE_MAGIC, sizeof(FILE_MAGIC));
+        put_u16(header + 6, FILE_VERSION);
+        auto wall = std::chrono::system_clock::now().time_since_epoch();
+        put_u64(header + 8, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(wall).count()));
+        start_ = std::chrono::steady_clock::now();
+        pending_.emplace_back(header, header + sizeof(header));
+        reserved_ = sizeof(header);
+
+        flusher_ = std::thread([this]() { flush_loop(); });
+        return true;
+    }
+
+    bool is_open() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return file_ != nullptr;
+    }
+
+    void record(uint64_t connection_id, const BaseHeader& base, const SessionHeader& session,
+                const uint8_t* payload, size_t length) {
+        uint64_t time_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_).count());
+        size_t frame_size = FRAME_HEADER_SIZE + length;
+        size_t size = RECORD_HEADER_SIZE + frame_size;
+
+        std::shared_ptr<Local> local = local_buffer();
+        if (!local) {
+            return;
+        }
+        std::lock_guard<std::mutex> guard(local->mutex);
+        if (local->closed) {
+            return;
+        }
+        if (options_.max_bytes != 0 &&
+            reserved_.fetch_add(size, std::memory_order_relaxed) + size > options_.max_bytes) {
+            reserved_.fetch_sub(size, std::memory_order_relaxed);
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        std::vector<uint8_t>& buffer = local->buffer;
+        if (!buffer.empty() && buffer.size() + size > options_.buffer_size && !hand_off(buffer)) {
+            if (options_.max_bytes != 0) {
+                reserved_.fetch_sub(size, std::memory_order_relaxed);
+            }
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        size_t offset = buffer.size();
+        buffer.resize(offset + size);
+        uint8_t* out = buffer.data() + offset;
+        put_u64(out, time_ns);
+        put_u64(out + 8, connection_id);
+        put_u32(out + 16, static_cast<uint32_t>(frame_size));
+        put_u32(out + 20, 0);
+        ProtocolHandler::encode_header(base, session, session.payload_len, out + RECORD_HEADER_SIZE);
+        if (length > 0) {
+            std::memcpy(out + RECORD_HEADER_SIZE + FRAME_HEADER_SIZE, payload, length);
+        }
+        records_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void close() {
+        std::vector<std::shared_ptr<Local>> locals;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!file_ || stopping_) {
+                return;
+            }
+            // 之后不再登记新的线程缓冲区
+            stopping_ = true;
+            locals.swap(locals_);
+        }
+        // 收走各线程缓冲区中剩余的记录，进行中的 record 先完成
+        std::vector<std::vector<uint8_t>> rest;
+        for (auto& local : locals) {
+            std::lock_guard<std::mutex> guard(local->mutex);
+            local->closed = true;
+            if (!local->buffer.empty()) {
+                rest.push_back(std::move(local->buffer));
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto& buffer : rest) {
+                pending_.push_back(std::move(buffer));
+            }
+        }
+        ready_.notify_one();
+        flusher_.join();
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::fclose(file_);
+        file_ = nullptr;
+        pending_.clear();
+        spare_.clear();
+    }
+
+    CaptureStats stats() const {
+        CaptureStats s;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            s.bytes = bytes_;
+        }
+        s.records = records_.load(std::memory_order_relaxed);
+        s.dropped = dropped_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    struct Local {
+        std::mutex mutex;
+        std::vector<uint8_t> buffer;
+        bool closed = false;    // close() 已收走缓冲区，之后的记录忽略
+    };
+
+    // 每次 open 一个新编号，线程缓存据此区分不同的写入器与同一写入器的不同文件
+    static std::atomic<uint64_t>& next_generation() {
+        static std::atomic<uint64_t> generation{1};
+        return generation;
+    }
+
+    // 本线程的前台缓冲区，首次记录时登记；未打开或正在关闭时返回空
+    std::shared_ptr<Local> local_buffer() {
+        thread_local std::vector<std::pair<uint64_t, std::weak_ptr<Local>>> cache;
+        uint64_t generation = generation_;
+        for (auto& [owner, weak] : cache) {
+            if (owner == generation) {
+                return weak.lock();
+            }
+        }
+        // 丢弃已关闭的写入器留下的表项
+        cache.erase(std::remove_if(cache.begin(), cache.end(), [](const auto& entry) { return entry.second.expired(); }),
+                    cache.end());
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!file_ || stopping_) {
+            return nullptr;
+        }
+        auto local = std::make_shared<Local>();
+        local->buffer.reserve(options_.buffer_size);
+        locals_.push_back(local);
+        cache.emplace_back(generation, local);
+        return local;
+    }
+
+    // 调用方持有本线程的 Local::mutex：写满的缓冲区交给后台线程，换入一块空缓冲区；
+    // 积压过多时返回 false（本条记录丢弃）
+    bool hand_off(std::vector<uint8_t>& buffer) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (pending_.size() >= options_.max_pending) {
+                return false;
+            }
+            pending_.push_back(std::move(buffer));
+            if (spare_.empty()) {
+                buffer = std::vector<uint8_t>();
+            } else {
+                buffer = std::move(spare_.back());
+                spare_.pop_back();
+            }
+        }
+        ready_.notify_one();
+        if (buffer.capacity() < options_.buffer_size) {
+            buffer.reserve(options_.buffer_size);
+        }
+        return true;
+    }
+
+    void flush_loop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            ready_.wait(lock, [this]() { return !pending_.empty() || stopping_; });
+            if (pending_.empty()) {
+                return;
+            }
+            std::vector<uint8_t> buffer = std::move(pending_.front());
+            pending_.pop_front();
+            lock.unlock();
+            size_t written = std::fwrite(buffer.data(), 1, buffer.size(), file_);
+            lock.lock();
+            bytes_ += written;
+            buffer.clear();
+            if (spare_.size() < 2) {
+                spare_.push_back(std::move(buffer));
+            }
+        }
+    }
+
+    CaptureOptions options_;
+    std::FILE* file_ = nullptr;
+    std::chrono::steady_clock::time_point start_;
+    std::atomic<uint64_t> generation_{0};
+    mutable std::mutex mutex_;
+    std::condition_variable ready_;
+    std::vector<std::shared_ptr<Local>> locals_;
+    std::deque<std::vector<uint8_t>> pending_;
+    std::vector<std::vector<uint8_t>> spare_;
+    std::atomic<uint64_t> reserved_{0};     // 已接受的字节（含尚未写入文件的部分），用于 max_bytes
+    bool stopping_ = false;
+    uint64_t bytes_ = 0;
+    std::atomic<uint64_t> records_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::thread flusher_;
+};
+
+CaptureWriter::CaptureWriter() : impl_(std::make_unique<Impl>()) {}
+
+CaptureWriter::~CaptureWriter() = default;
+
+bool CaptureWriter::open(const CaptureOptions& options) {
+    return impl_->open(options);
+}
+
+bool CaptureWriter::is_open() const {
+    return impl_->is_open();
+}
+
+void CaptureWriter::record(uint64_t connection_id, const BaseHeader& base, const SessionHeader& session,
+                           const uint8_t* payload, size_t length) {
+    impl_->record(connection_id, base, session, payload, length);
+}
+
+void CaptureWriter::close() {
+    impl_->close();
+}
+
+CaptureStats CaptureWriter::stats() const {
+    return impl_->stats();
+}
+
+CaptureReader::~CaptureReader() {
+    if (file_) {
+        std::fclose(file_);
+    }
+}
+
+bool CaptureReader::open(const std::string& path) {
+    if (file_) {
+        std::fclose(file_);
+    }
+    file_ = std::fopen(path.c_str(), "rb");
+    if (!file_) {
+        return false;
+    }
+    uint8_t header[FILE_HEADER_SIZE];
+    if (std::fread(header, 1, sizeof(header), file_) != sizeof(header) ||
+        std::memcmp(header, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 || get_u16(header + 6) != FILE_VERSION) {
+        std::fclose(file_);
+        file_ = nullptr;
+        return false;
+    }
+    start_unix_ns_ = get_u64(header + 8);
+    return true;
+}
+
+CaptureReader::Status CaptureReader::next(CaptureRecord& record) {
+    if (!file_) {
+        return Status::ERROR;
+    }
+    uint8_t header[RECORD_HEADER_SIZE];
+    size_t got = std::fread(header, 1, sizeof(header), file_);
+    if (got == 0) {
+        return std::feof(file_) ? Status::END : Status::ERROR;
+    }
+    if (got != sizeof(header)) {
+        return Status::ERROR;
+    }
+    record.time_ns = get_u64(header);
+    record.connection_id = get_u64(header + 8);
+    size_t stored = get_u32(header + 16);
+    if (stored < FRAME_HEADER_SIZE) {
+        return Status::ERROR;
+    }
+
+    uint8_t frame_header[FRAME_HEADER_SIZE];
+    FrameView view;
+    if (std::fread(frame_header, 1, sizeof(frame_header), file_) != sizeof(frame_header) ||
+        !FrameDecoder::decode_header(frame_header, view)) {
+        return Status::ERROR;
+    }
+    size_t frame_size = FRAME_HEADER_SIZE + view.session.payload_len;
+    if (stored > frame_size) {
+        return Status::ERROR;
+    }
+    record.base = view.base;
+    record.session = view.session;
+    record.truncated = stored < frame_size;
+    record.frame.assign(frame_size, 0);
+    std::memcpy(record.frame.data(), frame_header, sizeof(frame_header));
+    size_t rest = stored - FRAME_HEADER_SIZE;
+    if (rest > 0 && std::fread(record.frame.data() + FRAME_HEADER_SIZE, 1, rest, file_) != rest) {
+        return Status::ERROR;
+    }
+    return Status::OK;
+}
+
+} // namespace capture
+} // namespace hwp
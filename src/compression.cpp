@@ -0,0 +1,378 @@
+#include "../include/hwp/compression.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstring>
+#include <unordered_set>
+#include <string>
+#include <zlib.h>
+#include "thread_stats.hpp"
+
+namespace hwp {
+namespace compress {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int FAST_LEVEL = 1;
+constexpr int BULK_LEVEL = 6;
+constexpr int RAW_WINDOW_BITS = -15;        // raw deflate：前缀已携带长度，不需要 zlib 头和校验
+constexpr std::size_t MAX_DICTIONARY_SIZE = 32 * 1024;     // deflate 窗口大小
+constexpr std::size_t MAX_SAMPLE_SIZE = 1024;
+constexpr uint32_t SAMPLE_EVERY = 4;        // 每隔几条小消息取一个样本
+constexpr std::size_t EVALUATION_SAMPLES = 32;
+constexpr double RATIO_WEIGHT = 0.125;      // 压缩率滑动平均中新样本的权重
+constexpr double RETRAIN_GAIN = 0.9;        // 新字典须让近期样本至少再缩小 10% 才替换旧字典
+// deflate 的最大膨胀倍数：每个 258 字节的匹配至少占 2 位；另加少量余量覆盖块头
+constexpr uint64_t MAX_INFLATE_RATIO = 1032;
+constexpr uint64_t INFLATE_SLACK = 64;
+
+void put_u32(uint8_t* out, uint32_t value) {
+    value = htonl(value);
+    std::memcpy(out, &value, sizeof(value));
+}
+
+uint32_t get_u32(const uint8_t* in) {
+    uint32_t value;
+    std::memcpy(&value, in, sizeof(value));
+    return ntohl(value);
+}
+
+uint64_t elapsed_ns(Clock::time_point start) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+}
+
+using Counter = detail::StatCounter;
+
+void accumulate(CompressionStats& total, const CompressionStats& part) {
+    total.messages += part.messages;
+    total.compressed += part.compressed;
+    total.bytes_in += part.bytes_in;
+    total.bytes_out += part.bytes_out;
+    total.compress_ns += part.compress_ns;
+    total.decompressed += part.decompressed;
+    total.decompress_ns += part.decompress_ns;
+    total.dictionaries += part.dictionaries;
+    total.errors += part.errors;
+}
+
+class ThreadContext;
+
+using Registry = detail::StatsRegistry<ThreadContext, CompressionStats, accumulate>;
+
+// 每线程一套 zlib 上下文，每条消息只做 reset，不重新分配约 256 KiB 的内部状态。
+// 两个压缩级别各用一个流：deflateParams 在已用过的流上会先输出一个块，不能用于切换级别
+class ThreadContext {
+public:
+    ThreadContext() {
+        ok_ = deflateInit2(&fast_, FAST_LEVEL, Z_DEFLATED, RAW_WINDOW_BITS, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+        ok_ = deflateInit2(&bulk_, BULK_LEVEL, Z_DEFLATED, RAW_WINDOW_BITS, 8, Z_DEFAULT_STRATEGY) == Z_OK && ok_;
+        ok_ = inflateInit2(&inflater_, RAW_WINDOW_BITS) == Z_OK && ok_;
+
+        Registry::instance().add(this);
+    }
+
+    ~ThreadContext() {
+        deflateEnd(&fast_);
+        deflateEnd(&bulk_);
+        inflateEnd(&inflater_);
+
+        Registry::instance().remove(this, stats());
+    }
+
+    ThreadContext(const ThreadContext&) = delete;
+    ThreadContext& operator=(const ThreadContext&) = delete;
+
+    // 压缩到 out[HEADER_SIZE..]；结果不短于 limit 时放弃并返回 false
+    bool deflate(Codec codec, const uint8_t* data, std::size_t size, const Dictionary* dictionary,
+                 std::size_t limit, std::vector<uint8_t>& out) {
+        if (!ok_) {
+            return false;
+        }
+        z_stream& stream = codec == Codec::DEFLATE ? bulk_ : fast_;
+        deflateReset(&stream);
+        if (dictionary && deflateSetDictionary(&stream, dictionary->bytes.data(),
+                                               static_cast<uInt>(dictionary->bytes.size())) != Z_OK) {
+            return false;
+        }
+        // 输出区只开到 limit：不值得压缩的数据写满后即停止，不必压完整条消息
+        out.resize(HEADER_SIZE + limit);
+        stream.next_in = const_cast<Bytef*>(data);
+        stream.avail_in = static_cast<uInt>(size);
+        stream.next_out = out.data() + HEADER_SIZE;
+        stream.avail_out = static_cast<uInt>(limit);
+        int rc = ::deflate(&stream, Z_FINISH);
+        if (rc != Z_STREAM_END) {
+            return false;
+        }
+        out.resize(HEADER_SIZE + (limit - stream.avail_out));
+        return true;
+    }
+
+    bool inflate(const uint8_t* data, std::size_t size, const Dictionary* dictionary,
+                 uint8_t* out, std::size_t out_size) {
+        if (!ok_) {
+            return false;
+        }
+        inflateReset(&inflater_);
+        if (dictionary && inflateSetDictionary(&inflater_, dictionary->bytes.data(),
+                                               static_cast<uInt>(dictionary->bytes.size())) != Z_OK) {
+            return false;
+        }
+        inflater_.next_in = const_cast<Bytef*>(data);
+        inflater_.avail_in = static_cast<uInt>(size);
+        inflater_.next_out = out;
+        inflater_.avail_out = static_cast<uInt>(out_size);
+        int rc = ::inflate(&inflater_, Z_FINISH);
+        return rc == Z_STREAM_END && inflater_.avail_out == 0 && inflater_.avail_in == 0;
+    }
+
+    CompressionStats stats() const {
+        CompressionStats s;
+        s.messages = messages.get();
+        s.compressed = compressed.get();
+        s.bytes_in = bytes_in.get();
+        s.bytes_out = bytes_out.get();
+        s.compress_ns = compress_ns.get();
+        s.decompressed = decompressed.get();
+        s.decompress_ns = decompress_ns.get();
+        s.dictionaries = dictionaries.get();
+        s.errors = errors.get();
+        return s;
+    }
+
+    Counter messages;
+    Counter compressed;
+    Counter bytes_in;
+    Counter bytes_out;
+    Counter compress_ns;
+    Counter decompressed;
+    Counter decompress_ns;
+    Counter dictionaries;
+    Counter errors;
+
+private:
+    z_stream fast_{};
+    z_stream bulk_{};
+    z_stream inflater_{};
+    bool ok_ = false;
+};
+
+ThreadContext& context() {
+    thread_local ThreadContext instance;
+    return instance;
+}
+
+void write_header(std::vector<uint8_t>& out, Codec codec, uint32_t dictionary_id, std::size_t original) {
+    out[0] = static_cast<uint8_t>(codec);
+    put_u32(out.data() + 1, dictionary_id);
+    put_u32(out.data() + 5, static_cast<uint32_t>(original));
+}
+
+} // namespace
+
+CompressionStats compression_stats() {
+    return Registry::instance().total();
+}
+
+Compressor::Compressor(const CompressionOptions& options) : options_(options) {
+    options_.min_size = std::max<std::size_t>(options_.min_size, HEADER_SIZE + 1);
+    options_.dictionary_size = std::min(options_.dictionary_size, MAX_DICTIONARY_SIZE);
+    options_.dictionary_samples = std::max<uint32_t>(options_.dictionary_samples, 1);
+}
+
+void Compressor::compress(Message& msg, uint32_t& announced, std::vector<Message>& control, bool self_contained) {
+    if (!options_.enabled || msg.session_header.msg_type != MessageType::DATA ||
+        (msg.base_header.flags & static_cast<uint8_t>(Flags::COMPRESSED)) ||
+        msg.payload.size() < options_.min_size || msg.payload.size() > MAX_PAYLOAD_LEN) {
+        return;
+    }
+    ThreadContext& ctx = context();
+    ctx.messages.add(1);
+
+    SizeClass size_class = msg.payload.size() >= options_.bulk_size ? BULK : SMALL;
+    if (size_class == SMALL && options_.dictionary_size > 0) {
+        sample(msg.payload);
+    }
+    // 近期不可压缩：跳过若干条后再试探一次，数据特征变化时能恢复压缩
+    if (skip_[size_class] > 0) {
+        --skip_[size_class];
+        return;
+    }
+
+    auto start = Clock::now();
+    Codec codec = size_class == BULK ? Codec::DEFLATE : Codec::DEFLATE_FAST;
+    const Dictionary* dictionary = size_class == SMALL && !self_contained ? dictionary_.get() : nullptr;
+    std::size_t original = msg.payload.size();
+    std::vector<uint8_t> out;
+    bool ok = ctx.deflate(codec, msg.payload.data(), original, dictionary, original - HEADER_SIZE, out);
+    ctx.compress_ns.add(elapsed_ns(start));
+
+    double ratio = ok ? static_cast<double>(out.size()) / original : 1.0;
+    ratio_[size_class] = ratio_[size_class] == 0 ? ratio
+                                                 : ratio_[size_class] + (ratio - ratio_[size_class]) * RATIO_WEIGHT;
+    if (ratio_[size_class] > options_.max_ratio) {
+        skip_[size_class] = options_.probe_interval;
+        // 下次试探时从中间值起步，一次好结果就能恢复
+        ratio_[size_class] = options_.max_ratio;
+    }
+    if (!ok) {
+        return;
+    }
+
+    uint32_t dictionary_id = dictionary ? dictionary->id : 0;
+    if (dictionary_id != 0 && dictionary_id != announced) {
+        control.push_back(dictionary_message(msg.session_header.session_id, *dictionary));
+        announced = dictionary_id;
+    }
+    write_header(out, codec, dictionary_id, original);
+    ctx.compressed.add(1);
+    ctx.bytes_in.add(original);
+    ctx.bytes_out.add(out.size());
+    msg.payload = std::move(out);
+    msg.base_header.flags |= static_cast<uint8_t>(Flags::COMPRESSED);
+    msg.session_header.payload_len = static_cast<uint32_t>(msg.payload.size());
+}
+
+void Compressor::sample(const std::vector<uint8_t>& payload) {
+    if (++sample_tick_ % SAMPLE_EVERY != 0) {
+        return;
+    }
+    std::size_t size = std::min(payload.size(), MAX_SAMPLE_SIZE);
+    samples_.emplace_back(payload.begin(), payload.begin() + static_cast<std::ptrdiff_t>(size));
+    if (samples_.size() > options_.dictionary_samples) {
+        samples_.pop_front();
+    }
+    if (++since_training_ >= options_.dictionary_samples) {
+        since_training_ = 0;
+        train();
+    }
+}
+
+// 用近期的不同样本拼出字典：deflate 对离窗口末尾越近的内容匹配越便宜，最新的样本放在最后。
+// 新字典在最近的样本上实测压缩结果，明显优于现有字典时才替换（替换需要向每条连接重新通告）
+void Compressor::train() {
+    auto start = Clock::now();
+    std::unordered_set<std::string> seen;
+    std::vector<const std::vector<uint8_t>*> picked;
+    std::size_t total = 0;
+    for (auto it = samples_.rbegin(); it != samples_.rend() && total < options_.dictionary_size; ++it) {
+        if (seen.emplace(it->begin(), it->end()).second) {
+            picked.push_back(&*it);
+            total += it->size();
+        }
+    }
+    auto candidate = std::make_shared<Dictionary>();
+    candidate->id = next_dictionary_id_;
+    for (auto it = picked.rbegin(); it != picked.rend(); ++it) {
+        candidate->bytes.insert(candidate->bytes.end(), (*it)->begin(), (*it)->end());
+    }
+    if (candidate->bytes.size() > options_.dictionary_size) {
+        candidate->bytes.erase(candidate->bytes.begin(),
+            candidate->bytes.end() - static_cast<std::ptrdiff_t>(options_.dictionary_size));
+    }
+
+    ThreadContext& ctx = context();
+    auto measure = [&](const Dictionary* dictionary) {
+        std::size_t bytes = 0;
+        std::vector<uint8_t> out;
+        std::size_t count = std::min(samples_.size(), EVALUATION_SAMPLES);
+        for (auto it = samples_.end() - static_cast<std::ptrdiff_t>(count); it != samples_.end(); ++it) {
+            bytes += ctx.deflate(Codec::DEFLATE_FAST, it->data(), it->size(), dictionary, it->size() + 64, out)
+                ? out.size() : it->size() + HEADER_SIZE;
+        }
+        return bytes;
+    };
+    if (!dictionary_ || measure(candidate.get()) < measure(dictionary_.get()) * RETRAIN_GAIN) {
+        dictionary_ = std::move(candidate);
+        if (++next_dictionary_id_ == 0) {
+            next_dictionary_id_ = 1;
+        }
+        ctx.dictionaries.add(1);
+    }
+    ctx.compress_ns.add(elapsed_ns(start));
+}
+
+bool Decompressor::on_control(const Message& msg, bool& ok) {
+    const auto& payload = msg.payload;
+    if (msg.session_header.msg_type != MessageType::CONTROL || payload.empty() ||
+        payload[0] != static_cast<uint8_t>(ControlCode::DICTIONARY)) {
+        return false;
+    }
+    ok = payload.size() > 5 && payload.size() - 5 <= MAX_DICTIONARY_SIZE;
+    if (!ok) {
+        return true;
+    }
+    auto dictionary = std::make_shared<Dictionary>();
+    dictionary->id = get_u32(payload.data() + 1);
+    dictionary->bytes.assign(payload.begin() + 5, payload.end());
+    dictionaries_.erase(std::remove_if(dictionaries_.begin(), dictionaries_.end(),
+        [&](const std::shared_ptr<const Dictionary>& d) { return d->id == dictionary->id; }), dictionaries_.end());
+    dictionaries_.push_back(std::move(dictionary));
+    if (dictionaries_.size() > MAX_DICTIONARIES) {
+        dictionaries_.pop_front();
+    }
+    return true;
+}
+
+bool Decompressor::decompress(Message& msg) {
+    uint8_t compressed_flag = static_cast<uint8_t>(Flags::COMPRESSED);
+    if (!(msg.base_header.flags & compressed_flag)) {
+        return true;
+    }
+    ThreadContext& ctx = context();
+    const auto& payload = msg.payload;
+    auto fail = [&]() {
+        ctx.errors.add(1);
+        return false;
+    };
+    if (payload.size() < HEADER_SIZE) {
+        return fail();
+    }
+    Codec codec = static_cast<Codec>(payload[0]);
+    uint32_t dictionary_id = get_u32(payload.data() + 1);
+    uint32_t original = get_u32(payload.data() + 5);
+    // 原始长度来自对端：超过压缩数据可能解出的上限时直接拒绝，不按它分配
+    uint64_t inflate_limit = (payload.size() - HEADER_SIZE) * MAX_INFLATE_RATIO + INFLATE_SLACK;
+    if ((codec != Codec::DEFLATE_FAST && codec != Codec::DEFLATE) || original > MAX_PAYLOAD_LEN ||
+        original > inflate_limit) {
+        return fail();
+    }
+    const Dictionary* dictionary = nullptr;
+    if (dictionary_id != 0) {
+        for (const auto& d : dictionaries_) {
+            if (d->id == dictionary_id) {
+                dictionary = d.get();
+            }
+        }
+        if (!dictionary) {
+            return fail();
+        }
+    }
+
+    auto start = Clock::now();
+    std::vector<uint8_t> out(original);
+    if (!ctx.inflate(payload.data() + HEADER_SIZE, payload.size() - HEADER_SIZE, dictionary, out.data(), original)) {
+        return fail();
+    }
+    ctx.decompress_ns.add(elapsed_ns(start));
+    ctx.decompressed.add(1);
+    msg.payload = std::move(out);
+    msg.base_header.flags &= static_cast<uint8_t>(~compressed_flag);
+    msg.session_header.payload_len = original;
+    return true;
+}
+
+Message dictionary_message(uint32_t session_id, const Dictionary& dictionary) {
+    std::vector<uint8_t> payload(5 + dictionary.bytes.size());
+    payload[0] = static_cast<uint8_t>(ControlCode::DICTIONARY);
+    put_u32(payload.data() + 1, dictionary.id);
+    std::copy(dictionary.bytes.begin(), dictionary.bytes.end(), payload.begin() + 5);
+    return ProtocolHandler::create_message(MessageType::CONTROL, session_id, std::move(payload),
+                                           static_cast<uint8_t>(Flags::BINARY_MODE));
+}
+
+} // namespace compress
+} // namespace hwp
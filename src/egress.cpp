@@ -0,0 +1,104 @@
+#include <algorithm>
+#include "../include/hwp/egress.hpp"
+
+namespace hwp {
+
+namespace {
+
+// 结束标签的定点放大倍数：权重大于帧长时标签仍能递增
+constexpr uint64_t TAG_SCALE = 256;
+
+// 优先级空闲时保留的会话表项上限
+constexpr size_t MAX_IDLE_FLOWS = 64;
+
+// std::push_heap 默认是最大堆，用 greater 得到最小堆
+constexpr auto later = std::greater<std::pair<uint64_t, uint32_t>>();
+
+} // namespace
+
+EgressScheduler::EgressScheduler(const EgressOptions& options) : options_(options) {
+    if (options_.batch_bytes == 0) {
+        options_.batch_bytes = 1;
+    }
+}
+
+EgressClass EgressScheduler::classify(MessageType type) {
+    switch (type) {
+    case MessageType::CONTROL:
+    case MessageType::HANDSHAKE:
+    case MessageType::ERROR:
+        return EgressClass::CONTROL;
+    // 文件传输的三类帧同属一类：END 不会越过同一会话中排在它之前的 DATA
+    case MessageType::FILE_TRANSFER_START:
+    case MessageType::FILE_TRANSFER_DATA:
+    case MessageType::FILE_TRANSFER_END:
+        return EgressClass::BULK;
+    default:
+        return EgressClass::DATA;
+    }
+}
+
+void EgressScheduler::push(OutgoingFrame&& frame) {
+    // 关闭优先级时所有帧进入同一类的同一队列，即提交顺序
+    uint32_t session_id = 0;
+    EgressClass priority = EgressClass::DATA;
+    if (options_.priority) {
+        session_id = frame.session_id();
+        priority = classify(frame.msg_type());
+    }
+    Class& cls = classes_[static_cast<size_t>(priority)];
+    auto [it, inserted] = cls.flows.try_emplace(session_id);
+    Flow& flow = it->second;
+    if (inserted && options_.session_weight) {
+        flow.weight = std::max<uint32_t>(1, options_.session_weight(session_id));
+    }
+
+    uint64_t finish = std::max(cls.virtual_time, flow.last_finish) + frame.size() * TAG_SCALE / flow.weight;
+    flow.last_finish = finish;
+    if (flow.queue.empty()) {
+        cls.heads.emplace_back(finish, session_id);
+        std::push_heap(cls.heads.begin(), cls.heads.end(), later);
+    }
+    flow.queue.push_back(Entry{std::move(frame), finish});
+    ++size_;
+}
+
+bool EgressScheduler::pop(OutgoingFrame& frame) {
+    for (Class& cls : classes_) {
+        if (cls.heads.empty()) {
+            continue;
+        }
+        std::pop_heap(cls.heads.begin(), cls.heads.end(), later);
+        uint32_t session_id = cls.heads.back().second;
+        cls.heads.pop_back();
+
+        auto it = cls.flows.find(session_id);
+        Flow& flow = it->second;
+        frame = std::move(flow.queue.front().frame);
+        cls.virtual_time = flow.queue.front().finish;
+        flow.queue.pop_front();
+        --size_;
+
+        // 取空的会话保留在表中：其最后一帧的标签即当前虚拟时间，重新活跃时从虚拟时间起算，
+        // 不因空闲而积攒份额。整个优先级空闲时才清理，避免每帧创建、删除表项
+        if (!flow.queue.empty()) {
+            cls.heads.emplace_back(flow.queue.front().finish, session_id);
+            std::push_heap(cls.heads.begin(), cls.heads.end(), later);
+        } else if (cls.heads.empty() && cls.flows.size() > MAX_IDLE_FLOWS) {
+            cls.flows.clear();
+        }
+        return true;
+    }
+    return false;
+}
+
+void EgressScheduler::clear() {
+    for (Class& cls : classes_) {
+        cls.flows.clear();
+        cls.heads.clear();
+        cls.virtual_time = 0;
+    }
+    size_ = 0;
+}
+
+} // namespace hwp
@@ -0,0 +1,270 @@
+#include "../include/hwp/file_transfer.hpp"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace hwp {
+namespace transfer {
+
+namespace {
+
+// 单次 splice 搬运量，同时作为管道容量
+constexpr std::size_t PIPE_SIZE = 1024 * 1024;
+
+std::string part_path(const std::string& dir, const std::string& name) {
+    return dir + "/" + name + ".part";
+}
+
+// 在阻塞 fd 上写完全部 iovec
+bool writev_all(int fd, struct iovec* iov, int count) {
+    while (count > 0) {
+        ssize_t n = ::writev(fd, iov, count);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        while (count > 0 && static_cast<size_t>(n) >= iov->iov_len) {
+            n -= static_cast<ssize_t>(iov->iov_len);
+            ++iov;
+            --count;
+        }
+        if (count > 0) {
+            iov->iov_base = static_cast<uint8_t*>(iov->iov_base) + n;
+            iov->iov_len -= static_cast<size_t>(n);
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+void put_u64(uint8_t* out, uint64_t value) {
+    for (int i = 7; i >= 0; --i) {
+        out[i] = static_cast<uint8_t>(value);
+        value >>= 8;
+    }
+}
+
+uint64_t get_u64(const uint8_t* in) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+bool valid_name(const std::string& name) {
+    return !name.empty() && name.size() <= 255 && name != "." && name != ".." &&
+           name.find('/') == std::string::npos && name.find('\0') == std::string::npos;
+}
+
+FileSource::~FileSource() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+bool FileSource::open(const std::string& path) {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0) {
+        return false;
+    }
+    struct stat st;
+    if (::fstat(fd_, &st) != 0 || !S_ISREG(st.st_mode)) {
+        return false;
+    }
+    size_ = static_cast<uint64_t>(st.st_size);
+    // 顺序读取，提示内核加大预读
+    ::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+    return true;
+}
+
+bool FileSource::send_chunk(int socket_fd, const Message& header_source, uint64_t offset, uint32_t length) {
+    std::array<uint8_t, FRAME_HEADER_SIZE + DATA_PREFIX_SIZE> head;
+    ProtocolHandler::encode_header(header_source.base_header, header_source.session_header,
+                                   static_cast<uint32_t>(DATA_PREFIX_SIZE + length), head.data());
+    put_u64(head.data() + FRAME_HEADER_SIZE, offset);
+    struct iovec iov = {head.data(), head.size()};
+    if (!writev_all(socket_fd, &iov, 1)) {
+        return false;
+    }
+
+    off_t position = static_cast<off_t>(offset);
+    size_t remaining = length;
+    while (remaining > 0) {
+        ssize_t n = ::sendfile(socket_fd, fd_, &position, remaining);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            // n == 0: 文件在传输过程中被截断
+            return false;
+        }
+        remaining -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+FileSink::~FileSink() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    if (pipe_[0] >= 0) {
+        ::close(pipe_[0]);
+        ::close(pipe_[1]);
+    }
+}
+
+TransferStatus FileSink::open(const std::string& dir, const std::string& name, uint64_t total_size) {
+    if (dir.empty() || !valid_name(name) || fd_ >= 0) {
+        return TransferStatus::REJECTED;
+    }
+    std::string path = part_path(dir, name);
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        return TransferStatus::IO_ERROR;
+    }
+    // 同名文件同一时间只允许一个接收者
+    if (::flock(fd_, LOCK_EX | LOCK_NB) != 0) {
+        ::close(fd_);
+        fd_ = -1;
+        return TransferStatus::REJECTED;
+    }
+
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) {
+        return TransferStatus::IO_ERROR;
+    }
+    uint64_t existing = static_cast<uint64_t>(st.st_size);
+    if (existing > total_size) {
+        // 与之前的传输不是同一个文件，从头开始
+        if (::ftruncate(fd_, 0) != 0) {
+            return TransferStatus::IO_ERROR;
+        }
+        existing = 0;
+    }
+    // 预分配剩余空间（不改变文件长度），不支持的文件系统上忽略
+    if (total_size > existing) {
+        ::fallocate(fd_, FALLOC_FL_KEEP_SIZE, static_cast<off_t>(existing),
+                    static_cast<off_t>(total_size - existing));
+    }
+    if (::lseek(fd_, static_cast<off_t>(existing), SEEK_SET) < 0) {
+        return TransferStatus::IO_ERROR;
+    }
+
+    if (::pipe2(pipe_, O_CLOEXEC) == 0) {
+        ::fcntl(pipe_[1], F_SETPIPE_SZ, static_cast<int>(PIPE_SIZE));
+    } else {
+        use_splice_ = false;
+    }
+
+    dir_ = dir;
+    state_.filename = name;
+    state_.total_size = total_size;
+    state_.bytes_transferred = existing;
+    state_.chunk_size = 0;
+    state_.is_complete = false;
+    return TransferStatus::OK;
+}
+
+ssize_t FileSink::splice_from(int socket_fd, std::size_t max) {
+    if (max > state_.total_size - state_.bytes_transferred) {
+        errno = EFBIG;
+        return -1;
+    }
+    if (!use_splice_) {
+        return read_into_file(socket_fd, max);
+    }
+    ssize_t n = ::splice(socket_fd, nullptr, pipe_[1], nullptr, std::min(max, PIPE_SIZE),
+                         SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (n < 0 && errno == EINVAL) {
+        // 内核或 socket 类型不支持 splice，退回 read + write
+        use_splice_ = false;
+        return read_into_file(socket_fd, max);
+    }
+    if (n <= 0) {
+        return n;
+    }
+
+    // 管道中的数据全部写入文件后才返回，保证文件长度与已确认字节数一致
+    size_t pending = static_cast<size_t>(n);
+    while (pending > 0) {
+        ssize_t written = ::splice(pipe_[0], nullptr, fd_, nullptr, pending, SPLICE_F_MOVE);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            errno = written == 0 ? EIO : errno;
+            return -1;
+        }
+        pending -= static_cast<size_t>(written);
+    }
+    state_.bytes_transferred += static_cast<uint64_t>(n);
+    return n;
+}
+
+ssize_t FileSink::read_into_file(int socket_fd, std::size_t max) {
+    std::array<uint8_t, 64 * 1024> buffer;
+    ssize_t n = ::read(socket_fd, buffer.data(), std::min(max, buffer.size()));
+    if (n <= 0) {
+        return n;
+    }
+    if (!write(buffer.data(), static_cast<size_t>(n))) {
+        return -1;
+    }
+    return n;
+}
+
+bool FileSink::write(const uint8_t* data, std::size_t length) {
+    if (length > state_.total_size - state_.bytes_transferred) {
+        errno = EFBIG;
+        return false;
+    }
+    while (length > 0) {
+        ssize_t n = ::write(fd_, data, length);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            errno = n == 0 ? EIO : errno;
+            return false;
+        }
+        data += n;
+        length -= static_cast<size_t>(n);
+        state_.bytes_transferred += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+TransferStatus FileSink::finish(uint64_t total_size) {
+    if (fd_ < 0) {
+        return TransferStatus::REJECTED;
+    }
+    if (total_size != state_.total_size || state_.bytes_transferred != total_size) {
+        return TransferStatus::SIZE_MISMATCH;
+    }
+    std::string part = part_path(dir_, state_.filename);
+    std::string target = dir_ + "/" + state_.filename;
+    if (::rename(part.c_str(), target.c_str()) != 0) {
+        return TransferStatus::IO_ERROR;
+    }
+    ::close(fd_);
+    fd_ = -1;
+    state_.is_complete = true;
+    return TransferStatus::OK;
+}
+
+} // namespace transfer
+} // namespace hwp
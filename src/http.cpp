@@ -0,0 +1,401 @@
+#include "../include/hwp/http.hpp"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace hwp {
+namespace http {
+
+namespace {
+
+// chunk 大小行（含扩展）的长度上限
+constexpr size_t MAX_CHUNK_LINE = 1024;
+
+bool iequals(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string_view trim(std::string_view value) {
+    while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+        value.remove_prefix(1);
+    }
+    while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+        value.remove_suffix(1);
+    }
+    return value;
+}
+
+// 逗号分隔的列表中是否包含 token（如 Connection: keep-alive, Upgrade）
+bool has_token(std::string_view list, std::string_view token) {
+    while (!list.empty()) {
+        size_t comma = list.find(',');
+        if (iequals(trim(list.substr(0, comma)), token)) {
+            return true;
+        }
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        list.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+bool parse_decimal(std::string_view text, size_t& value) {
+    if (text.empty()) {
+        return false;
+    }
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+bool parse_hex(std::string_view text, size_t& value) {
+    if (text.empty()) {
+        return false;
+    }
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value, 16);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+} // namespace
+
+const char* find_crlf(const char* begin, const char* end) {
+    const char* p = begin;
+#ifdef __SSE2__
+    // 同时比较 p[i] == '\r' 与 p[i+1] == '\n'，两次非对齐加载覆盖 17 字节
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lf = _mm_set1_epi8('\n');
+    while (end - p >= 17) {
+        __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i next = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 1));
+        int mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(current, cr), _mm_cmpeq_epi8(next, lf)));
+        if (mask != 0) {
+            return p + __builtin_ctz(static_cast<unsigned>(mask));
+        }
+        p += 16;
+    }
+#endif
+    for (; end - p >= 2; ++p) {
+        if (p[0] == '\r' && p[1] == '\n') {
+            return p;
+        }
+    }
+    return end;
+}
+
+std::string_view Request::header(std::string_view name) const {
+    for (size_t i = 0; i < header_count; ++i) {
+        if (iequals(headers[i].name, name)) {
+            return headers[i].value;
+        }
+    }
+    return std::string_view();
+}
+
+void Response::set_header(std::string_view name, std::string_view value) {
+    headers.append(name.data(), name.size());
+    headers.append(": ");
+    headers.append(value.data(), value.size());
+    headers.append("\r\n");
+}
+
+void Response::reset() {
+    status = 200;
+    content_type.assign("text/plain");
+    headers.clear();
+    body.clear();
+    close = false;
+}
+
+void RequestParser::reset() {
+    stage_ = Stage::HEAD;
+    scanned_ = 0;
+    head_length_ = 0;
+    content_length_ = 0;
+    chunked_ = false;
+    chunk_in_ = 0;
+    chunk_out_ = 0;
+    chunk_left_ = 0;
+    consumed_ = 0;
+    head_data_ = nullptr;
+}
+
+ParseStatus RequestParser::parse(char* data, size_t length, Request& request) {
+    if (stage_ == Stage::HEAD) {
+        // 从上次停下的位置继续寻找空行
+        const char* end = data + length;
+        const char* p = data + scanned_;
+        for (;;) {
+            const char* crlf = find_crlf(p, end);
+            if (crlf == end) {
+                scanned_ = length > 0 ? length - 1 : 0;
+                return length > MAX_HEADER_BYTES ? ParseStatus::ERROR : ParseStatus::NEED_MORE;
+            }
+            if (end - crlf < 4) {
+                scanned_ = static_cast<size_t>(crlf - data);
+                return ParseStatus::NEED_MORE;
+            }
+            if (crlf[2] == '\r' && crlf[3] == '\n') {
+                head_length_ = static_cast<size_t>(crlf - data) + 4;
+                break;
+            }
+            p = crlf + 2;
+        }
+        if (head_length_ > MAX_HEADER_BYTES || !parse_head(data, request)) {
+            return ParseStatus::ERROR;
+        }
+        head_data_ = data;
+        if (chunked_) {
+            chunk_in_ = head_length_;
+            chunk_out_ = head_length_;
+            stage_ = Stage::CHUNK_SIZE;
+        } else {
+            stage_ = Stage::BODY;
+        }
+    } else if (data != head_data_) {
+        // 缓冲区被搬移过，头部字段需要重新指向新位置
+        if (!parse_head(data, request)) {
+            return ParseStatus::ERROR;
+        }
+        head_data_ = data;
+    }
+
+    if (stage_ == Stage::BODY) {
+        if (length < head_length_ + content_length_) {
+            return ParseStatus::NEED_MORE;
+        }
+        request.body = std::string_view(data + head_length_, content_length_);
+        consumed_ = head_length_ + content_length_;
+        return ParseStatus::COMPLETE;
+    }
+
+    ParseStatus status = parse_chunks(data, length);
+    if (status == ParseStatus::COMPLETE) {
+        request.body = std::string_view(data + head_length_, chunk_out_ - head_length_);
+    }
+    return status;
+}
+
+// 请求行与头部；同时确定请求体的分帧方式和连接是否保持
+bool RequestParser::parse_head(const char* data, Request& request) {
+    const char* end = data + head_length_ - 2;
+    const char* line_end = find_crlf(data, end);
+    std::string_view line(data, static_cast<size_t>(line_end - data));
+
+    size_t first_space = line.find(' ');
+    size_t second_space = line.find(' ', first_space + 1);
+    if (first_space == 0 || first_space == std::string_view::npos || second_space == std::string_view::npos) {
+        return false;
+    }
+    request.method = line.substr(0, first_space);
+    request.target = line.substr(first_space + 1, second_space - first_space - 1);
+    std::string_view version = line.substr(second_space + 1);
+    if (request.target.empty() || version.size() != 8 || version.substr(0, 7) != "HTTP/1." ||
+        !std::isdigit(static_cast<unsigned char>(version[7]))) {
+        return false;
+    }
+    request.version_minor = version[7] - '0';
+    request.keep_alive = request.version_minor >= 1;
+    request.header_count = 0;
+    request.body = std::string_view();
+
+    bool has_content_length = false;
+    content_length_ = 0;
+    chunked_ = false;
+    const char* p = line_end + 2;
+    while (p < end) {
+        line_end = find_crlf(p, end);
+        std::string_view field(p, static_cast<size_t>(line_end - p));
+        p = line_end + 2;
+
+        size_t colon = field.find(':');
+        if (colon == 0 || colon == std::string_view::npos || request.header_count == MAX_HEADERS) {
+            return false;
+        }
+        std::string_view name = field.substr(0, colon);
+        if (name.find_first_of(" \t") != std::string_view::npos) {
+            return false;
+        }
+        std::string_view value = trim(field.substr(colon + 1));
+        request.headers[request.header_count++] = Header{name, value};
+
+        if (iequals(name, "Content-Length")) {
+            size_t length = 0;
+            if (!parse_decimal(value, length) || (has_content_length && length != content_length_)) {
+                return false;
+            }
+            content_length_ = length;
+            has_content_length = true;
+        } else if (iequals(name, "Transfer-Encoding")) {
+            // 只支持恰好一个编码 chunked：其他编码不解码，叠加的编码（含重复的头部）视为请求走私，一律拒绝
+            if (chunked_ || !iequals(value, "chunked")) {
+                return false;
+            }
+            chunked_ = true;
+        } else if (iequals(name, "Connection")) {
+            if (has_token(value, "close")) {
+                request.keep_alive = false;
+            } else if (has_token(value, "keep-alive")) {
+                request.keep_alive = true;
+            }
+        }
+    }
+
+    // 同时出现两种分帧方式时拒绝，避免请求走私
+    if (chunked_ && has_content_length) {
+        return false;
+    }
+    return content_length_ <= MAX_BODY_BYTES;
+}
+
+// chunked 请求体：每段数据前移到已解码区域末尾，解码结果在头部之后连续存放
+ParseStatus RequestParser::parse_chunks(char* data, size_t length) {
+    const char* end = data + length;
+    for (;;) {
+        switch (stage_) {
+        case Stage::CHUNK_SIZE: {
+            const char* line = data + chunk_in_;
+            const char* crlf = find_crlf(line, end);
+            if (crlf == end) {
+                return length - chunk_in_ > MAX_CHUNK_LINE ? ParseStatus::ERROR : ParseStatus::NEED_MORE;
+            }
+            std::string_view size_text(line, static_cast<size_t>(crlf - line));
+            size_text = trim(size_text.substr(0, size_text.find(';')));
+            size_t size = 0;
+            if (!parse_hex(size_text, size) || size > MAX_BODY_BYTES - (chunk_out_ - head_length_)) {
+                return ParseStatus::ERROR;
+            }
+            chunk_in_ = static_cast<size_t>(crlf - data) + 2;
+            chunk_left_ = size;
+            stage_ = size == 0 ? Stage::TRAILER : Stage::CHUNK_DATA;
+            break;
+        }
+        case Stage::CHUNK_DATA: {
+            size_t n = std::min(chunk_left_, length - chunk_in_);
+            if (n > 0 && chunk_out_ != chunk_in_) {
+                std::memmove(data + chunk_out_, data + chunk_in_, n);
+            }
+            chunk_out_ += n;
+            chunk_in_ += n;
+            chunk_left_ -= n;
+            if (chunk_left_ > 0 || length - chunk_in_ < 2) {
+                return ParseStatus::NEED_MORE;
+            }
+            if (data[chunk_in_] != '\r' || data[chunk_in_ + 1] != '\n') {
+                return ParseStatus::ERROR;
+            }
+            chunk_in_ += 2;
+            stage_ = Stage::CHUNK_SIZE;
+            break;
+        }
+        case Stage::TRAILER: {
+            // 忽略 trailer 字段，遇到空行结束
+            const char* line = data + chunk_in_;
+            const char* crlf = find_crlf(line, end);
+            if (crlf == end) {
+                return length - chunk_in_ > MAX_HEADER_BYTES ? ParseStatus::ERROR : ParseStatus::NEED_MORE;
+            }
+            chunk_in_ = static_cast<size_t>(crlf - data) + 2;
+            if (crlf == line) {
+                consumed_ = chunk_in_;
+                return ParseStatus::COMPLETE;
+            }
+            break;
+        }
+        default:
+            return ParseStatus::ERROR;
+        }
+    }
+}
+
+std::string_view reason_phrase(int status) {
+    switch (status) {
+    case 200: return "OK";
+    case 201: return "Created";
+    case 204: return "No Content";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 413: return "Payload Too Large";
+    case 431: return "Request Header Fields Too Large";
+    case 500: return "Internal Server Error";
+    case 503: return "Service Unavailable";
+    default: return "Unknown";
+    }
+}
+
+void serialize_response(const Response& response, bool head_only, std::string& out) {
+    char number[24];
+    out.append("HTTP/1.1 ");
+    auto result = std::to_chars(number, number + sizeof(number), response.status);
+    out.append(number, result.ptr);
+    out.push_back(' ');
+    std::string_view reason = reason_phrase(response.status);
+    out.append(reason.data(), reason.size());
+    out.append("\r\nContent-Length: ");
+    result = std::to_chars(number, number + sizeof(number), response.body.size());
+    out.append(number, result.ptr);
+    out.append("\r\n");
+    if (!response.content_type.empty()) {
+        out.append("Content-Type: ");
+        out.append(response.content_type);
+        out.append("\r\n");
+    }
+    if (response.close) {
+        out.append("Connection: close\r\n");
+    }
+    out.append(response.headers);
+    out.append("\r\n");
+    if (!head_only) {
+        out.append(response.body);
+    }
+}
+
+size_t message_length(const char* data, size_t length) {
+    std::string_view view(data, length);
+    size_t header_end = view.find("\r\n\r\n");
+    if (header_end == std::string_view::npos) {
+        return 0;
+    }
+    size_t head_length = header_end + 4;
+
+    // 逐行查找 Content-Length
+    size_t body_length = 0;
+    size_t line_start = view.find("\r\n") + 2;
+    while (line_start < header_end) {
+        size_t line_end = view.find("\r\n", line_start);
+        std::string_view line = view.substr(line_start, line_end - line_start);
+        size_t colon = line.find(':');
+        if (colon != std::string_view::npos && iequals(line.substr(0, colon), "Content-Length")) {
+            std::string_view value = line.substr(colon + 1);
+            while (!value.empty() && value.front() == ' ') {
+                value.remove_prefix(1);
+            }
+            body_length = std::strtoul(std::string(value).c_str(), nullptr, 10);
+            break;
+        }
+        line_start = line_end + 2;
+    }
+
+    if (length < head_length + body_length) {
+        return 0;
+    }
+    return head_length + body_length;
+}
+
+} // namespace http
+} // namespace hwp
@@ -0,0 +1,74 @@
+#ifndef HWP_IO_WORKER_HPP
+#define HWP_IO_WORKER_HPP
+
+// 库内部使用：服务器与代理共用的每线程事件循环脚手架，不属于公开接口
+
+#include <memory>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <sys/socket.h>
+#include <boost/asio.hpp>
+
+namespace hwp {
+namespace detail {
+
+#ifdef SO_REUSEPORT
+using reuse_port_option = boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+#endif
+
+// 一个事件循环线程：io_context（自有或外部传入）、保持其运行的 work guard、本线程的监听器
+struct IoWorker {
+    IoWorker()
+        : owned_io(std::make_unique<boost::asio::io_context>(1)),
+          io(owned_io.get()),
+          work(boost::asio::make_work_guard(*io)) {}
+
+    // 外部事件循环：由调用方驱动，不持有 work guard，也不启动线程
+    explicit IoWorker(boost::asio::io_context& external) : io(&external) {}
+
+    // 监听端口（0 表示由内核选择）；reuse_port 时多个线程各自监听同一端口，由内核分发连接
+    void open_acceptor(unsigned short port, bool reuse_port) {
+        boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::tcp::v4(), port);
+        auto listener = std::make_unique<boost::asio::ip::tcp::acceptor>(*io);
+        listener->open(endpoint.protocol());
+        listener->set_option(boost::asio::ip::tcp::acceptor::reuse_address(true));
+#ifdef SO_REUSEPORT
+        if (reuse_port) {
+            listener->set_option(reuse_port_option(true));
+        }
+#else
+        (void)reuse_port;
+#endif
+        listener->bind(endpoint);
+        listener->listen(boost::asio::socket_base::max_listen_connections);
+        acceptor = std::move(listener);
+    }
+
+    void start() {
+        thread = std::thread([this]() { io->run(); });
+    }
+
+    // 只让事件循环退出，不等待线程：多个线程先各自 stop 再逐个 join
+    void stop() {
+        work.reset();
+        io->stop();
+    }
+
+    void join() {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    std::unique_ptr<boost::asio::io_context> owned_io;
+    boost::asio::io_context* io;
+    std::optional<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> work;
+    std::unique_ptr<boost::asio::ip::tcp::acceptor> acceptor;
+    std::thread thread;
+};
+
+} // namespace detail
+} // namespace hwp
+
+#endif // HWP_IO_WORKER_HPP
@@ -0,0 +1,296 @@
+#include "../include/hwp/metrics.hpp"
+#include <algorithm>
+#include <cstdio>
+#include "thread_stats.hpp"
+
+namespace hwp {
+namespace metrics {
+
+namespace {
+
+constexpr std::size_t HISTOGRAMS = static_cast<std::size_t>(Histogram::COUNT);
+
+using Counter = detail::StatCounter;
+
+struct HistogramCounters {
+    std::array<Counter, HISTOGRAM_BUCKETS + 1> buckets;
+    Counter count;
+    Counter sum_ns;
+};
+
+#if HWP_METRICS
+// 桶下标：向上取整到微秒后取 log2 的上整，超过最大桶归入 +Inf
+std::size_t bucket_index(uint64_t nanoseconds) {
+    uint64_t micros = (nanoseconds + 999) / 1000;
+    if (micros <= 1) {
+        return 0;
+    }
+    std::size_t index = 64 - static_cast<std::size_t>(__builtin_clzll(micros - 1));
+    return std::min(index, HISTOGRAM_BUCKETS);
+}
+#endif
+
+void accumulate(MetricsSnapshot& total, const MetricsSnapshot& part) {
+    total.connections_opened += part.connections_opened;
+    total.connections_closed += part.connections_closed;
+    total.bytes_received += part.bytes_received;
+    total.bytes_sent += part.bytes_sent;
+    for (std::size_t i = 0; i < total.messages_received.size(); ++i) {
+        total.messages_received[i] += part.messages_received[i];
+    }
+    total.frames_sent += part.frames_sent;
+    total.http_requests += part.http_requests;
+    total.parse_errors += part.parse_errors;
+    total.read_pauses += part.read_pauses;
+    for (std::size_t i = 0; i < total.connections_rejected.size(); ++i) {
+        total.connections_rejected[i] += part.connections_rejected[i];
+    }
+    total.requests_shed += part.requests_shed;
+    for (std::size_t h = 0; h < HISTOGRAMS; ++h) {
+        for (std::size_t b = 0; b <= HISTOGRAM_BUCKETS; ++b) {
+            total.histograms[h].buckets[b] += part.histograms[h].buckets[b];
+        }
+        total.histograms[h].count += part.histograms[h].count;
+        total.histograms[h].sum_ns += part.histograms[h].sum_ns;
+    }
+}
+
+class ThreadMetrics;
+
+using Registry = detail::StatsRegistry<ThreadMetrics, MetricsSnapshot, accumulate>;
+
+class ThreadMetrics {
+public:
+    ThreadMetrics() {
+        Registry::instance().add(this);
+    }
+
+    ~ThreadMetrics() {
+        Registry::instance().remove(this, stats());
+    }
+
+    MetricsSnapshot stats() const {
+        MetricsSnapshot s;
+        s.connections_opened = connections_opened.get();
+        s.connections_closed = connections_closed.get();
+        s.bytes_received = bytes_received.get();
+        s.bytes_sent = bytes_sent.get();
+        for (std::size_t i = 0; i < messages_received.size(); ++i) {
+            s.messages_received[i] = messages_received[i].get();
+        }
+        s.frames_sent = frames_sent.get();
+        s.http_requests = http_requests.get();
+        s.parse_errors = parse_errors.get();
+        s.read_pauses = read_pauses.get();
+        for (std::size_t i = 0; i < connections_rejected.size(); ++i) {
+            s.connections_rejected[i] = connections_rejected[i].get();
+        }
+        s.requests_shed = requests_shed.get();
+        for (std::size_t h = 0; h < HISTOGRAMS; ++h) {
+            for (std::size_t b = 0; b <= HISTOGRAM_BUCKETS; ++b) {
+                s.histograms[h].buckets[b] = histograms[h].buckets[b].get();
+            }
+            s.histograms[h].count = histograms[h].count.get();
+            s.histograms[h].sum_ns = histograms[h].sum_ns.get();
+        }
+        return s;
+    }
+
+    Counter connections_opened;
+    Counter connections_closed;
+    Counter bytes_received;
+    Counter bytes_sent;
+    std::array<Counter, 256> messages_received;
+    Counter frames_sent;
+    Counter http_requests;
+    Counter parse_errors;
+    Counter read_pauses;
+    std::array<Counter, static_cast<std::size_t>(Rejection::COUNT)> connections_rejected;
+    Counter requests_shed;
+    std::array<HistogramCounters, HISTOGRAMS> histograms;
+};
+
+#if HWP_METRICS
+ThreadMetrics& local() {
+    thread_local ThreadMetrics instance;
+    return instance;
+}
+#endif
+
+const char* type_name(std::size_t type) {
+    switch (static_cast<MessageType>(type)) {
+    case MessageType::HANDSHAKE: return "HANDSHAKE";
+    case MessageType::DATA: return "DATA";
+    case MessageType::CONTROL: return "CONTROL";
+    case MessageType::ERROR: return "ERROR";
+    case MessageType::FILE_TRANSFER_START: return "FILE_TRANSFER_START";
+    case MessageType::FILE_TRANSFER_DATA: return "FILE_TRANSFER_DATA";
+    case MessageType::FILE_TRANSFER_END: return "FILE_TRANSFER_END";
+    }
+    return nullptr;
+}
+
+void family(std::string& out, const char* name, const char* type, const char* help) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+void sample(std::string& out, const char* name, uint64_t value) {
+    out += name;
+    out += ' ';
+    out += std::to_string(value);
+    out += '\n';
+}
+
+void histogram(std::string& out, const char* name, const char* help, const HistogramSnapshot& h) {
+    family(out, name, "histogram", help);
+    uint64_t cumulative = 0;
+    for (std::size_t b = 0; b <= HISTOGRAM_BUCKETS; ++b) {
+        cumulative += h.buckets[b];
+        out += name;
+        out += "_bucket{le=\"";
+        if (b == HISTOGRAM_BUCKETS) {
+            out += "+Inf";
+        } else {
+            char bound[32];
+            std::snprintf(bound, sizeof(bound), "%g", 1e-6 * static_cast<double>(uint64_t(1) << b));
+            out += bound;
+        }
+        out += "\"} ";
+        out += std::to_string(cumulative);
+        out += '\n';
+    }
+    char sum[32];
+    std::snprintf(sum, sizeof(sum), "%.9f", static_cast<double>(h.sum_ns) / 1e9);
+    out += name;
+    out += "_sum ";
+    out += sum;
+    out += '\n';
+    out += name;
+    out += "_count ";
+    out += std::to_string(h.count);
+    out += '\n';
+}
+
+} // namespace
+
+#if HWP_METRICS
+
+void connection_opened() {
+    local().connections_opened.add(1);
+}
+
+void connection_closed() {
+    local().connections_closed.add(1);
+}
+
+void bytes_received(std::size_t bytes) {
+    local().bytes_received.add(bytes);
+}
+
+void bytes_sent(std::size_t bytes) {
+    local().bytes_sent.add(bytes);
+}
+
+void message_received(MessageType type) {
+    local().messages_received[static_cast<uint8_t>(type)].add(1);
+}
+
+void frames_sent(std::size_t frames) {
+    local().frames_sent.add(frames);
+}
+
+void http_request() {
+    local().http_requests.add(1);
+}
+
+void parse_error() {
+    local().parse_errors.add(1);
+}
+
+void read_paused() {
+    local().read_pauses.add(1);
+}
+
+void connection_rejected(Rejection reason) {
+    local().connections_rejected[static_cast<std::size_t>(reason)].add(1);
+}
+
+void request_shed() {
+    local().requests_shed.add(1);
+}
+
+void observe(Histogram histogram, uint64_t nanoseconds) {
+    HistogramCounters& h = local().histograms[static_cast<std::size_t>(histogram)];
+    h.buckets[bucket_index(nanoseconds)].add(1);
+    h.count.add(1);
+    h.sum_ns.add(nanoseconds);
+}
+
+#endif // HWP_METRICS
+
+MetricsSnapshot snapshot() {
+    return Registry::instance().total();
+}
+
+void render_prometheus(std::string& out) {
+    MetricsSnapshot s = snapshot();
+
+    family(out, "hwp_connections_opened_total", "counter", "Accepted connections.");
+    sample(out, "hwp_connections_opened_total", s.connections_opened);
+    family(out, "hwp_connections_active", "gauge", "Currently open connections.");
+    sample(out, "hwp_connections_active", s.connections_opened - s.connections_closed);
+    family(out, "hwp_received_bytes_total", "counter", "Bytes read from clients.");
+    sample(out, "hwp_received_bytes_total", s.bytes_received);
+    family(out, "hwp_sent_bytes_total", "counter", "Bytes written to clients.");
+    sample(out, "hwp_sent_bytes_total", s.bytes_sent);
+
+    family(out, "hwp_messages_received_total", "counter", "Wire-mode frames received, by message type.");
+    for (std::size_t type = 0; type < s.messages_received.size(); ++type) {
+        const char* name = type_name(type);
+        if (!name && s.messages_received[type] == 0) {
+            continue;
+        }
+        out += "hwp_messages_received_total{type=\"";
+        out += name ? name : std::to_string(type);
+        out += "\"} ";
+        out += std::to_string(s.messages_received[type]);
+        out += '\n';
+    }
+    family(out, "hwp_frames_sent_total", "counter", "Wire-mode frames written.");
+    sample(out, "hwp_frames_sent_total", s.frames_sent);
+    family(out, "hwp_http_requests_total", "counter", "HTTP-mode requests handled.");
+    sample(out, "hwp_http_requests_total", s.http_requests);
+    family(out, "hwp_parse_errors_total", "counter", "Malformed frames or HTTP requests.");
+    sample(out, "hwp_parse_errors_total", s.parse_errors);
+    family(out, "hwp_read_pauses_total", "counter", "Times reading from a connection was paused for a write backlog.");
+    sample(out, "hwp_read_pauses_total", s.read_pauses);
+    family(out, "hwp_connections_rejected_total", "counter", "Connections closed at accept by admission control, by reason.");
+    static const char* const reasons[] = {"limit", "rate", "overload"};
+    for (std::size_t i = 0; i < s.connections_rejected.size(); ++i) {
+        out += "hwp_connections_rejected_total{reason=\"";
+        out += reasons[i];
+        out += "\"} ";
+        out += std::to_string(s.connections_rejected[i]);
+        out += '\n';
+    }
+    family(out, "hwp_requests_shed_total", "counter", "Requests answered with 503 or ERROR because the server was overloaded.");
+    sample(out, "hwp_requests_shed_total", s.requests_shed);
+
+    histogram(out, "hwp_parse_duration_seconds", "Time spent decoding the frames of one read.",
+              s.histograms[static_cast<std::size_t>(Histogram::PARSE)]);
+    histogram(out, "hwp_dispatch_duration_seconds", "Time spent handling one frame.",
+              s.histograms[static_cast<std::size_t>(Histogram::DISPATCH)]);
+    histogram(out, "hwp_write_duration_seconds", "Time from starting a gathered write to its completion.",
+              s.histograms[static_cast<std::size_t>(Histogram::WRITE)]);
+}
+
+} // namespace metrics
+} // namespace hwp
@@ -0,0 +1,239 @@
+#include "../include/hwp/msgpack.hpp"
+#include <algorithm>
+
+namespace hwp {
+namespace msgpack {
+
+namespace {
+
+// 外部块的最小容量；之后每块是前一块的两倍，直到单块 64 KiB
+constexpr std::size_t MIN_BLOCK = 1024;
+constexpr std::size_t MAX_BLOCK = 64 * 1024;
+
+// skip() 的最大嵌套深度，防止恶意负载耗尽栈
+constexpr int MAX_DEPTH = 64;
+
+} // namespace
+
+void* Arena::grow(std::size_t size, std::size_t align) {
+    std::size_t capacity = blocks_ ? std::min(blocks_->size * 2, MAX_BLOCK) : MIN_BLOCK;
+    std::size_t needed = sizeof(Block) + size + align;
+    if (capacity < needed) {
+        capacity = needed;
+    }
+    auto* block = static_cast<Block*>(pool::allocate(capacity));
+    block->next = blocks_;
+    block->size = capacity;
+    blocks_ = block;
+    heap_bytes_ += capacity;
+
+    cursor_ = reinterpret_cast<std::byte*>(block + 1);
+    end_ = reinterpret_cast<std::byte*>(block) + capacity;
+    return allocate(size, align);
+}
+
+void Arena::release() {
+    while (blocks_) {
+        Block* next = blocks_->next;
+        pool::deallocate(blocks_, blocks_->size);
+        blocks_ = next;
+    }
+    heap_bytes_ = 0;
+}
+
+namespace detail {
+
+bool Reader::integer(uint64_t& value, bool& negative) {
+    uint8_t code;
+    if (!byte(code)) {
+        return false;
+    }
+    negative = false;
+    if (code < 0x80) {
+        value = code;
+        return true;
+    }
+    if (code >= 0xe0) {
+        value = static_cast<uint64_t>(static_cast<int64_t>(static_cast<int8_t>(code)));
+        negative = true;
+        return true;
+    }
+    switch (code) {
+    case 0xcc: return be(value, 1);
+    case 0xcd: return be(value, 2);
+    case 0xce: return be(value, 4);
+    case 0xcf: return be(value, 8);
+    default: break;
+    }
+    int bytes;
+    switch (code) {
+    case 0xd0: bytes = 1; break;
+    case 0xd1: bytes = 2; break;
+    case 0xd2: bytes = 4; break;
+    case 0xd3: bytes = 8; break;
+    default: return false;
+    }
+    if (!be(value, bytes)) {
+        return false;
+    }
+    // 符号扩展到 64 位
+    if (bytes < 8 && (value >> (bytes * 8 - 1)) != 0) {
+        value |= ~uint64_t{0} << (bytes * 8);
+    }
+    negative = static_cast<int64_t>(value) < 0;
+    return true;
+}
+
+bool Reader::raw(const uint8_t*& data, std::size_t& length) {
+    uint8_t code;
+    if (!byte(code)) {
+        return false;
+    }
+    uint64_t n;
+    if (code >= 0xa0 && code <= 0xbf) {
+        n = code & 0x1f;
+    } else if (code == 0xd9 || code == 0xc4) {
+        if (!be(n, 1)) return false;
+    } else if (code == 0xda || code == 0xc5) {
+        if (!be(n, 2)) return false;
+    } else if (code == 0xdb || code == 0xc6) {
+        if (!be(n, 4)) return false;
+    } else {
+        return false;
+    }
+    length = static_cast<std::size_t>(n);
+    return take(length, data);
+}
+
+bool Reader::array(std::size_t& count) {
+    uint8_t code;
+    if (!byte(code)) {
+        return false;
+    }
+    uint64_t n;
+    if (code >= 0x90 && code <= 0x9f) {
+        n = code & 0x0f;
+    } else if (code == 0xdc) {
+        if (!be(n, 2)) return false;
+    } else if (code == 0xdd) {
+        if (!be(n, 4)) return false;
+    } else {
+        return false;
+    }
+    count = static_cast<std::size_t>(n);
+    return true;
+}
+
+bool Reader::map(std::size_t& count) {
+    uint8_t code;
+    if (!byte(code)) {
+        return false;
+    }
+    uint64_t n;
+    if (code >= 0x80 && code <= 0x8f) {
+        n = code & 0x0f;
+    } else if (code == 0xde) {
+        if (!be(n, 2)) return false;
+    } else if (code == 0xdf) {
+        if (!be(n, 4)) return false;
+    } else {
+        return false;
+    }
+    count = static_cast<std::size_t>(n);
+    return true;
+}
+
+bool Reader::real(double& value) {
+    uint8_t code;
+    if (!peek(code)) {
+        return false;
+    }
+    if (code == 0xca || code == 0xcb) {
+        byte(code);
+        uint64_t bits;
+        if (code == 0xca) {
+            if (!be(bits, 4)) return false;
+            uint32_t narrow = static_cast<uint32_t>(bits);
+            float f;
+            std::memcpy(&f, &narrow, sizeof(f));
+            value = f;
+        } else {
+            if (!be(bits, 8)) return false;
+            std::memcpy(&value, &bits, sizeof(value));
+        }
+        return true;
+    }
+    // 整数也可解码为浮点数
+    bool negative;
+    uint64_t bits;
+    if (!integer(bits, negative)) {
+        return false;
+    }
+    value = negative ? static_cast<double>(static_cast<int64_t>(bits)) : static_cast<double>(bits);
+    return true;
+}
+
+bool Reader::skip(int depth) {
+    if (depth > MAX_DEPTH) {
+        return false;
+    }
+    uint8_t code;
+    if (!peek(code)) {
+        return false;
+    }
+    const uint8_t* data;
+    std::size_t length;
+    uint64_t n;
+    if (code < 0x80 || code >= 0xe0 || (code >= 0xcc && code <= 0xd3)) {
+        bool negative;
+        return integer(n, negative);
+    }
+    if ((code >= 0xa0 && code <= 0xbf) || (code >= 0xc4 && code <= 0xc6) || (code >= 0xd9 && code <= 0xdb)) {
+        return raw(data, length);
+    }
+    if ((code >= 0x90 && code <= 0x9f) || code == 0xdc || code == 0xdd) {
+        if (!array(length)) {
+            return false;
+        }
+        for (std::size_t i = 0; i < length; ++i) {
+            if (!skip(depth + 1)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    if ((code >= 0x80 && code <= 0x8f) || code == 0xde || code == 0xdf) {
+        if (!map(length)) {
+            return false;
+        }
+        for (std::size_t i = 0; i < length * 2; ++i) {
+            if (!skip(depth + 1)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    byte(code);
+    switch (code) {
+    case 0xc0:      // nil
+    case 0xc2:      // false
+    case 0xc3:      // true
+        return true;
+    case 0xca: return take(4, data);
+    case 0xcb: return take(8, data);
+    case 0xd4: return take(2, data);    // fixext 1..16：类型字节 + 数据
+    case 0xd5: return take(3, data);
+    case 0xd6: return take(5, data);
+    case 0xd7: return take(9, data);
+    case 0xd8: return take(17, data);
+    case 0xc7: return be(n, 1) && take(static_cast<std::size_t>(n) + 1, data);
+    case 0xc8: return be(n, 2) && take(static_cast<std::size_t>(n) + 1, data);
+    case 0xc9: return be(n, 4) && take(static_cast<std::size_t>(n) + 1, data);
+    default: return false;  // 0xc1 保留
+    }
+}
+
+} // namespace detail
+
+} // namespace msgpack
+} // namespace hwp
@@ -0,0 +1,265 @@
+#include "../include/hwp/pool.hpp"
+#include <atomic>
+#include <new>
+#include "thread_stats.hpp"
+
+namespace hwp {
+
+namespace {
+
+// 尺寸级别：32 字节 .. 64 KiB，超出范围直接走全局堆
+constexpr size_t MIN_CLASS_SHIFT = 5;
+constexpr size_t MAX_CLASS_SHIFT = 16;
+constexpr size_t CLASS_COUNT = MAX_CLASS_SHIFT - MIN_CLASS_SHIFT + 1;
+
+struct Limits {
+    std::atomic<size_t> max_cached_blocks{PoolLimits().max_cached_blocks};
+    std::atomic<size_t> max_cached_buffers{PoolLimits().max_cached_buffers};
+    std::atomic<size_t> max_buffer_capacity{PoolLimits().max_buffer_capacity};
+};
+
+Limits& limits() {
+    static Limits instance;
+    return instance;
+}
+
+using Counter = detail::StatCounter;
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+size_t class_index(size_t size) {
+    size_t shift = MIN_CLASS_SHIFT;
+    while ((size_t(1) << shift) < size) {
+        ++shift;
+    }
+    return shift - MIN_CLASS_SHIFT;
+}
+
+// 实际分配的块大小：池内块一律按尺寸级别分配，以便在任意线程归还
+size_t block_size(size_t size) {
+    if (size > (size_t(1) << MAX_CLASS_SHIFT)) {
+        return size;
+    }
+    return size_t(1) << (class_index(size) + MIN_CLASS_SHIFT);
+}
+
+void accumulate(PoolStats& total, const PoolStats& part) {
+    total.block_hits += part.block_hits;
+    total.block_misses += part.block_misses;
+    total.blocks_cached += part.blocks_cached;
+    total.buffer_hits += part.buffer_hits;
+    total.buffer_misses += part.buffer_misses;
+    total.buffers_cached += part.buffers_cached;
+    total.buffer_bytes_cached += part.buffer_bytes_cached;
+    total.handler_inline += part.handler_inline;
+    total.handler_fallback += part.handler_fallback;
+}
+
+class ThreadPools;
+
+using Registry = detail::StatsRegistry<ThreadPools, PoolStats, accumulate>;
+
+class ThreadPools {
+public:
+    ThreadPools() {
+        Registry::instance().add(this);
+    }
+
+    ~ThreadPools() {
+        for (auto& head : free_lists_) {
+            while (head) {
+                FreeBlock* next = head->next;
+                ::operator delete(head);
+                head = next;
+            }
+        }
+        buffers_.clear();
+
+        // 缓存已释放，只计入累计的命中与未命中次数
+        PoolStats last = stats();
+        last.blocks_cached = 0;
+        last.buffers_cached = 0;
+        last.buffer_bytes_cached = 0;
+        Registry::instance().remove(this, last);
+    }
+
+    void* allocate(size_t size) {
+        if (size > (size_t(1) << MAX_CLASS_SHIFT)) {
+            block_misses_.add(1);
+            return ::operator new(size);
+        }
+        size_t index = class_index(size);
+        if (FreeBlock* block = free_lists_[index]) {
+            free_lists_[index] = block->next;
+            free_counts_[index].sub(1);
+            block_hits_.add(1);
+            return block;
+        }
+        block_misses_.add(1);
+        return ::operator new(block_size(size));
+    }
+
+    void deallocate(void* p, size_t size) noexcept {
+        if (size > (size_t(1) << MAX_CLASS_SHIFT)) {
+            ::operator delete(p);
+            return;
+        }
+        size_t index = class_index(size);
+        if (free_counts_[index].get() >= limits().max_cached_blocks.load(std::memory_order_relaxed)) {
+            ::operator delete(p);
+            return;
+        }
+        auto* block = static_cast<FreeBlock*>(p);
+        block->next = free_lists_[index];
+        free_lists_[index] = block;
+        free_counts_[index].add(1);
+    }
+
+    std::vector<uint8_t> acquire_buffer(size_t size) {
+        std::vector<uint8_t> buffer;
+        if (!buffers_.empty()) {
+            buffer = std::move(buffers_.back());
+            buffers_.pop_back();
+            buffer_count_.sub(1);
+            buffer_bytes_.sub(buffer.capacity());
+        }
+        if (buffer.capacity() >= size) {
+            buffer_hits_.add(1);
+        } else {
+            buffer_misses_.add(1);
+        }
+        buffer.resize(size);
+        return buffer;
+    }
+
+    void release_buffer(std::vector<uint8_t>&& buffer) noexcept {
+        size_t capacity = buffer.capacity();
+        if (capacity == 0 ||
+            capacity > limits().max_buffer_capacity.load(std::memory_order_relaxed) ||
+            buffers_.size() >= limits().max_cached_buffers.load(std::memory_order_relaxed)) {
+            return;
+        }
+        buffer.clear();
+        buffers_.push_back(std::move(buffer));
+        buffer_count_.add(1);
+        buffer_bytes_.add(capacity);
+    }
+
+    void note_handler(bool inline_storage) noexcept {
+        (inline_storage ? handler_inline_ : handler_fallback_).add(1);
+    }
+
+    PoolStats stats() const {
+        PoolStats s;
+        s.block_hits = block_hits_.get();
+        s.block_misses = block_misses_.get();
+        for (const auto& count : free_counts_) {
+            s.blocks_cached += count.get();
+        }
+        s.buffer_hits = buffer_hits_.get();
+        s.buffer_misses = buffer_misses_.get();
+        s.buffers_cached = buffer_count_.get();
+        s.buffer_bytes_cached = buffer_bytes_.get();
+        s.handler_inline = handler_inline_.get();
+        s.handler_fallback = handler_fallback_.get();
+        return s;
+    }
+
+private:
+    FreeBlock* free_lists_[CLASS_COUNT] = {};
+    Counter free_counts_[CLASS_COUNT];
+    std::vector<std::vector<uint8_t>> buffers_;
+
+    Counter block_hits_;
+    Counter block_misses_;
+    Counter buffer_hits_;
+    Counter buffer_misses_;
+    Counter buffer_count_;
+    Counter buffer_bytes_;
+    Counter handler_inline_;
+    Counter handler_fallback_;
+};
+
+// 线程退出时 thread_local 析构后，后续分配直接走全局堆
+thread_local bool pools_destroyed = false;
+
+struct ThreadPoolsHolder {
+    ThreadPools pools;
+    ~ThreadPoolsHolder() { pools_destroyed = true; }
+};
+
+ThreadPools* local_pools() {
+    if (pools_destroyed) {
+        return nullptr;
+    }
+    thread_local ThreadPoolsHolder holder;
+    return &holder.pools;
+}
+
+} // namespace
+
+void configure_pools(const PoolLimits& config) {
+    limits().max_cached_blocks = config.max_cached_blocks;
+    limits().max_cached_buffers = config.max_cached_buffers;
+    limits().max_buffer_capacity = config.max_buffer_capacity;
+}
+
+PoolStats pool_stats() {
+    return Registry::instance().total();
+}
+
+namespace pool {
+
+void* allocate(size_t size) {
+    if (ThreadPools* pools = local_pools()) {
+        return pools->allocate(size);
+    }
+    return ::operator new(block_size(size));
+}
+
+void deallocate(void* p, size_t size) noexcept {
+    if (ThreadPools* pools = local_pools()) {
+        pools->deallocate(p, size);
+    } else {
+        ::operator delete(p);
+    }
+}
+
+std::vector<uint8_t> acquire_buffer(size_t size) {
+    if (ThreadPools* pools = local_pools()) {
+        return pools->acquire_buffer(size);
+    }
+    return std::vector<uint8_t>(size);
+}
+
+void release_buffer(std::vector<uint8_t>&& buffer) noexcept {
+    if (ThreadPools* pools = local_pools()) {
+        pools->release_buffer(std::move(buffer));
+    }
+}
+
+} // namespace pool
+
+void* HandlerMemory::allocate(size_t size) {
+    bool fits = !in_use_ && size <= sizeof(storage_);
+    if (ThreadPools* pools = local_pools()) {
+        pools->note_handler(fits);
+    }
+    if (fits) {
+        in_use_ = true;
+        return storage_;
+    }
+    return pool::allocate(size);
+}
+
+void HandlerMemory::deallocate(void* p, size_t size) noexcept {
+    if (p == storage_) {
+        in_use_ = false;
+        return;
+    }
+    pool::deallocate(p, size);
+}
+
+} // namespace hwp
@@ -1,14 +1,17 @@
 #include "../include/hwp/protocol.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
 #include <cstring>
 #include <arpa/inet.h>
 
 namespace hwp {
 
-Message ProtocolHandler::create_message(MessageType type, uint32_t session_id,
-                                     const std::vector<uint8_t>& payload,
-                                     uint8_t flags) {
-    Message msg;
-    
+namespace {
+
+// 填写除负载外的消息字段
+void init_message(Message& msg, MessageType type, uint32_t session_id, size_t payload_len, uint8_t flags) {
     // 设置基础头部
     msg.base_header.magic[0] = 'H';
     msg.base_header.magic[1] = 'W';
@@ -16,67 +19,279 @@ Message ProtocolHandler::create_message(MessageType type, uint32_t session_id,
     msg.base_header.magic[3] = '\0';
     msg.base_header.version = PROTOCOL_VERSION;
     msg.base_header.flags = flags;
-    msg.base_header.head_len = sizeof(BaseHeader) + sizeof(SessionHeader);
-    
+    msg.base_header.head_len = FRAME_HEADER_SIZE;
+
     // 设置会话头部
     msg.session_header.session_id = session_id;
-    msg.session_header.seq_num = 0;  // TODO: 实现序列号管理
-    msg.session_header.ack_num = 0;  // TODO: 实现确认号管理
-    
+    msg.session_header.seq_num = 0;  // 0 表示未编号；会话内序列号由 ReliableChannel 分配
+    msg.session_header.ack_num = 0;  // 回复由 create_reply 填写
+    msg.session_header.payload_len = static_cast<uint32_t>(payload_len);
+    msg.session_header.msg_type = type;
+    msg.session_header.reserved = 0;
+    msg.session_header.stream_id = 0;
+}
+
+} // namespace
+
+OutgoingFrame::OutgoingFrame(Message&& msg)
+    : owned_(std::move(msg.payload)), payload_len_(owned_.size()) {
+    ProtocolHandler::encode_header(msg.base_header, msg.session_header,
+                                   static_cast<uint32_t>(payload_len_), header_.data());
+}
+
+OutgoingFrame::OutgoingFrame(const Message& header_source, std::vector<uint8_t>&& payload,
+                             size_t offset, size_t length)
+    : owned_(std::move(payload)), owned_offset_(offset), payload_len_(length) {
+    ProtocolHandler::encode_header(header_source.base_header, header_source.session_header,
+                                   static_cast<uint32_t>(payload_len_), header_.data());
+}
+
+OutgoingFrame::OutgoingFrame(const Message& header_source, const uint8_t* payload, size_t length)
+    : borrowed_(payload), payload_len_(length) {
+    ProtocolHandler::encode_header(header_source.base_header, header_source.session_header,
+                                   static_cast<uint32_t>(payload_len_), header_.data());
+}
+
+OutgoingFrame::OutgoingFrame(const Message& header_source, std::shared_ptr<const std::vector<uint8_t>> payload)
+    : borrowed_(payload->data()), shared_(std::move(payload)), payload_len_(shared_->size()) {
+    ProtocolHandler::encode_header(header_source.base_header, header_source.session_header,
+                                   static_cast<uint32_t>(payload_len_), header_.data());
+}
+
+Message ProtocolHandler::create_message(MessageType type, uint32_t session_id,
+                                     const std::vector<uint8_t>& payload,
+                                     uint8_t flags) {
+    Message msg;
+    init_message(msg, type, session_id, payload.size(), flags);
+
     // 设置负载
     msg.payload = payload;
-    
+
+    return msg;
+}
+
+Message ProtocolHandler::create_message(MessageType type, uint32_t session_id,
+                                     std::vector<uint8_t>&& payload,
+                                     uint8_t flags) {
+    Message msg;
+    init_message(msg, type, session_id, payload.size(), flags);
+    msg.payload = std::move(payload);
     return msg;
 }
 
+Message ProtocolHandler::create_reply(const Message& request, MessageType type,
+                                     std::vector<uint8_t>&& payload) {
+    Message msg = create_message(type, request.session_header.session_id, std::move(payload),
+                                 static_cast<uint8_t>(Flags::BINARY_MODE));
+    msg.session_header.ack_num = request.session_header.seq_num;
+    msg.session_header.stream_id = request.session_header.stream_id;
+    return msg;
+}
+
+Message ProtocolHandler::create_error(const Message& request, ErrorCode code) {
+    return create_reply(request, MessageType::ERROR, std::vector<uint8_t>(1, static_cast<uint8_t>(code)));
+}
+
+void ProtocolHandler::encode_header(const BaseHeader& base_header, const SessionHeader& session_header,
+                                    uint32_t payload_len, uint8_t* out) {
+    // 基础头部（多字节字段转为网络字节序）
+    BaseHeader base = base_header;
+    base.head_len = htons(static_cast<uint16_t>(FRAME_HEADER_SIZE));
+    std::memcpy(out, &base, sizeof(BaseHeader));
+
+    // 会话头部
+    SessionHeader session = session_header;
+    session.session_id = htonl(session.session_id);
+    session.seq_num = htonl(session.seq_num);
+    session.ack_num = htonl(session.ack_num);
+    session.payload_len = htonl(payload_len);
+    session.stream_id = htons(session.stream_id);
+    std::memcpy(out + sizeof(BaseHeader), &session, sizeof(SessionHeader));
+}
+
 std::vector<uint8_t> ProtocolHandler::serialize_message(const Message& msg) {
-    std::vector<uint8_t> buffer;
-    size_t total_size = sizeof(BaseHeader) + sizeof(SessionHeader) + msg.payload.size();
-    buffer.reserve(total_size);
-    
-    // 序列化基础头部
-    const uint8_t* base_header_ptr = reinterpret_cast<const uint8_t*>(&msg.base_header);
-    buffer.insert(buffer.end(), base_header_ptr, base_header_ptr + sizeof(BaseHeader));
-    
-    // 序列化会话头部
-    const uint8_t* session_header_ptr = reinterpret_cast<const uint8_t*>(&msg.session_header);
-    buffer.insert(buffer.end(), session_header_ptr, session_header_ptr + sizeof(SessionHeader));
-    
-    // 添加负载
-    buffer.insert(buffer.end(), msg.payload.begin(), msg.payload.end());
-    
+    std::vector<uint8_t> buffer(FRAME_HEADER_SIZE + msg.payload.size());
+    encode_header(msg.base_header, msg.session_header,
+                  static_cast<uint32_t>(msg.payload.size()), buffer.data());
+    std::copy(msg.payload.begin(), msg.payload.end(), buffer.begin() + FRAME_HEADER_SIZE);
     return buffer;
 }
 
+bool ProtocolHandler::is_http_request(const uint8_t* data, size_t length) {
+    static const char* const methods[] = {
+        "GET ", "POST ", "PUT ", "HEAD ", "DELETE ", "OPTIONS ", "PATCH ", "CONNECT ", "TRACE "
+    };
+    for (const char* method : methods) {
+        size_t method_length = std::strlen(method);
+        if (length >= method_length && std::memcmp(data, method, method_length) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+SessionState ProtocolHandler::create_session(const std::string& client_id) {
+    SessionState session;
+    session.session_id = generate_session_id();
+    session.client_id = client_id;
+    session.last_activity = get_current_timestamp();
+    return session;
+}
+
+uint64_t ProtocolHandler::get_current_timestamp() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t ProtocolHandler::generate_session_id() {
+    // 随机起点 + 奇数步长遍历低 31 位空间，0 保留给“新会话”，最高位留给代理分配的 id
+    static const uint32_t seed = std::random_device{}();
+    static std::atomic<uint32_t> counter{0};
+    uint32_t id;
+    do {
+        id = (seed + counter.fetch_add(1, std::memory_order_relaxed) * 2654435761u) & ~PROXY_SESSION_ID_BIT;
+    } while (id == 0);
+    return id;
+}
+
 ProtocolHandler::ParseResult ProtocolHandler::parse(const uint8_t* data, size_t length) {
+    required_bytes_ = sizeof(BaseHeader);
     if (length < sizeof(BaseHeader)) {
-        return ParseResult::ERROR;
+        return ParseResult::NEED_MORE;
     }
-    
-    const BaseHeader* base_header = reinterpret_cast<const BaseHeader*>(data);
-    
+
+    std::memcpy(&current_base_, data, sizeof(BaseHeader));
+    current_base_.head_len = ntohs(current_base_.head_len);
+
     // 验证魔数
-    if (strncmp(base_header->magic, "HWP", 3) != 0) {
+    if (std::memcmp(current_base_.magic, "HWP", 4) != 0) {
         return ParseResult::ERROR;
     }
-    
+
     // 检查协议版本
-    if (base_header->version != PROTOCOL_VERSION) {
+    if (current_base_.version != PROTOCOL_VERSION) {
         return ParseResult::ERROR;
     }
-    
+
     // 根据标志判断协议类型
-    if (base_header->flags & static_cast<uint8_t>(Flags::HTTP_MODE)) {
+    if (current_base_.flags & static_cast<uint8_t>(Flags::HTTP_MODE)) {
         return ParseResult::HTTP;
-    } else if (base_header->flags & static_cast<uint8_t>(Flags::BINARY_MODE)) {
-        if (length >= sizeof(BaseHeader) + sizeof(SessionHeader)) {
-            // 保存会话信息
-            current_session_ = *reinterpret_cast<const SessionHeader*>(data + sizeof(BaseHeader));
-            return ParseResult::BINARY;
+    } else if (current_base_.flags & static_cast<uint8_t>(Flags::BINARY_MODE)) {
+        required_bytes_ = FRAME_HEADER_SIZE;
+        if (length < FRAME_HEADER_SIZE) {
+            return ParseResult::NEED_MORE;
         }
+        if (current_base_.head_len != FRAME_HEADER_SIZE) {
+            return ParseResult::ERROR;
+        }
+
+        // 保存会话信息
+        std::memcpy(&current_session_, data + sizeof(BaseHeader), sizeof(SessionHeader));
+        current_session_.session_id = ntohl(current_session_.session_id);
+        current_session_.seq_num = ntohl(current_session_.seq_num);
+        current_session_.ack_num = ntohl(current_session_.ack_num);
+        current_session_.payload_len = ntohl(current_session_.payload_len);
+        current_session_.stream_id = ntohs(current_session_.stream_id);
+        if (current_session_.payload_len > MAX_PAYLOAD_LEN) {
+            return ParseResult::ERROR;
+        }
+
+        // 负载按长度前缀读取，不扫描分隔符
+        required_bytes_ = FRAME_HEADER_SIZE + current_session_.payload_len;
+        if (length < required_bytes_) {
+            return ParseResult::NEED_MORE;
+        }
+        return ParseResult::BINARY;
     }
-    
+
     return ParseResult::ERROR;
 }
 
-} // namespace hwp
\ No newline at end of file
+namespace {
+
+// 基础头的固定字段：魔数、版本、头长度必须完全一致，标志位只看 HTTP/BINARY 两位
+struct HeaderPattern {
+    uint64_t expected;
+    uint64_t mask;
+};
+
+HeaderPattern make_pattern() {
+    const uint16_t head_len = htons(FRAME_HEADER_SIZE);
+    uint8_t expected[8] = {'H', 'W', 'P', '\0', PROTOCOL_VERSION,
+                           static_cast<uint8_t>(Flags::BINARY_MODE), 0, 0};
+    uint8_t mask[8] = {0xff, 0xff, 0xff, 0xff, 0xff,
+                       static_cast<uint8_t>(Flags::HTTP_MODE) | static_cast<uint8_t>(Flags::BINARY_MODE), 0xff, 0xff};
+    std::memcpy(expected + 6, &head_len, sizeof(head_len));
+    HeaderPattern pattern;
+    std::memcpy(&pattern.expected, expected, sizeof(expected));
+    std::memcpy(&pattern.mask, mask, sizeof(mask));
+    return pattern;
+}
+
+const HeaderPattern HEADER_PATTERN = make_pattern();
+
+uint32_t load_u32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return ntohl(value);
+}
+
+uint16_t load_u16(const uint8_t* p) {
+    uint16_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return ntohs(value);
+}
+
+} // namespace
+
+bool FrameDecoder::decode_header(const uint8_t* data, FrameView& frame) {
+    uint64_t fixed;
+    std::memcpy(&fixed, data, sizeof(fixed));
+    if ((fixed & HEADER_PATTERN.mask) != HEADER_PATTERN.expected) {
+        return false;
+    }
+    std::memcpy(&frame.base, data, sizeof(BaseHeader));
+    frame.base.head_len = FRAME_HEADER_SIZE;
+    const uint8_t* session = data + sizeof(BaseHeader);
+    frame.session.session_id = load_u32(session);
+    frame.session.seq_num = load_u32(session + 4);
+    frame.session.ack_num = load_u32(session + 8);
+    frame.session.payload_len = load_u32(session + 12);
+    frame.session.msg_type = static_cast<MessageType>(session[16]);
+    frame.session.reserved = session[17];
+    frame.session.stream_id = load_u16(session + 18);
+    frame.payload = data + FRAME_HEADER_SIZE;
+    return frame.session.payload_len <= MAX_PAYLOAD_LEN;
+}
+
+FrameDecoder::Status FrameDecoder::decode(const uint8_t* data, size_t length) {
+    frames_.clear();
+    consumed_ = 0;
+    required_ = 0;
+    has_pending_ = false;
+    size_t offset = 0;
+    while (offset < length) {
+        size_t available = length - offset;
+        if (available < FRAME_HEADER_SIZE) {
+            required_ = FRAME_HEADER_SIZE;
+            break;
+        }
+        FrameView frame;
+        if (!decode_header(data + offset, frame)) {
+            return Status::ERROR;
+        }
+        size_t size = FRAME_HEADER_SIZE + frame.session.payload_len;
+        if (available < size) {
+            required_ = size;
+            pending_ = frame;
+            has_pending_ = true;
+            break;
+        }
+        frames_.push_back(frame);
+        offset += size;
+        consumed_ = offset;
+    }
+    return Status::OK;
+}
+
+} // namespace hwp
@@ -0,0 +1,776 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <boost/asio.hpp>
+#include "../include/hwp/proxy.hpp"
+#include "../include/hwp/protocol.hpp"
+#include "io_worker.hpp"
+
+using namespace boost::asio;
+
+namespace hwp {
+namespace proxy {
+
+namespace {
+
+// 每次经管道搬运的上限（Linux 管道默认容量）
+constexpr size_t PIPE_CHUNK = 64 * 1024;
+
+// 为连接中途的新会话挑选落在当前后端上的 session_id 时最多尝试的次数
+constexpr size_t SESSION_ID_ATTEMPTS = 64;
+
+// 帧头中 session_id 与 flags 的位置
+constexpr size_t SESSION_ID_OFFSET = sizeof(BaseHeader) + offsetof(SessionHeader, session_id);
+constexpr size_t FLAGS_OFFSET = offsetof(BaseHeader, flags);
+
+uint64_t hash_name(const std::string& name, size_t replica) {
+    // FNV-1a，再经 HashRing::hash 打散
+    uint64_t h = 1469598103934665603ULL;
+    for (char c : name) {
+        h = (h ^ static_cast<uint8_t>(c)) * 1099511628211ULL;
+    }
+    return HashRing::hash(h ^ (replica * 0x9e3779b97f4a7c15ULL));
+}
+
+struct Backend {
+    std::string name;
+    ip::tcp::endpoint endpoint;
+    std::atomic<size_t> outstanding{0};     // 已收到请求、尚未开始回复的 HTTP 请求
+    std::atomic<size_t> connections{0};     // 转发中的 HTTP 连接
+};
+
+// 某一时刻的后端集合：建立后不再修改，增删后端时复制出新的集合整体替换。
+// 下标即哈希环中的后端编号；删除的后端留下空位，之后加入的后端复用。转发中的连接各自持有后端的引用
+struct Membership {
+    explicit Membership(size_t virtual_nodes) : ring(virtual_nodes) {}
+
+    HashRing ring;
+    std::vector<std::shared_ptr<Backend>> backends;
+};
+
+// 各线程共享的状态
+struct ProxyContext {
+    explicit ProxyContext(size_t virtual_nodes) : membership(std::make_shared<Membership>(virtual_nodes)) {}
+
+    std::shared_ptr<const Membership> snapshot() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return membership;
+    }
+
+    mutable std::mutex mutex;   // 保护 membership 指针本身
+    std::shared_ptr<const Membership> membership;
+    std::atomic<uint64_t> wire_connections{0};
+    std::atomic<uint64_t> http_connections{0};
+    std::atomic<uint64_t> connect_failures{0};
+    std::atomic<uint64_t> spliced_bytes{0};
+    std::atomic<size_t> rotation{0};    // HTTP 选择后端时的起始位置，负载相同的后端轮流选中
+
+    // 代理分配的 session_id：置最高位，与后端自行分配的 id 互不重叠；
+    // 随机起点 + 奇数步长遍历低 31 位，同一代理在 2^31 次分配内不会重复。
+    // 其他代理（或重启前的本代理）分配的同一 id 由后端按 NEW_SESSION 拒绝，客户端重新握手
+    uint32_t next_session_id() {
+        uint32_t n = session_counter.fetch_add(1, std::memory_order_relaxed);
+        return ((session_seed + n * 2654435761u) & ~PROXY_SESSION_ID_BIT) | PROXY_SESSION_ID_BIT;
+    }
+
+    const uint32_t session_seed = std::random_device{}();
+    std::atomic<uint32_t> session_counter{0};
+};
+
+class Tunnel;
+
+// 单向转发：frames 模式下帧头读入用户态交给 Tunnel 检查，负载按 payload_len 经管道 splice；
+// 字节流模式下整个流经管道 splice。两端套接字均为非阻塞，不可读写时等待就绪后继续
+class Relay {
+public:
+    Relay(Tunnel& tunnel, ip::tcp::socket& from, ip::tcp::socket& to, bool upstream)
+        : tunnel_(tunnel), from_(from), to_(to), upstream_(upstream) {}
+
+    ~Relay() {
+        for (int fd : pipe_) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+    }
+
+    Relay(const Relay&) = delete;
+    Relay& operator=(const Relay&) = delete;
+
+    bool open() {
+        return ::pipe2(pipe_, O_NONBLOCK | O_CLOEXEC) == 0;
+    }
+
+    // 按帧转发；header 为已读出并检查过的第一帧帧头
+    void start_frames(const uint8_t* header, uint32_t payload_len) {
+        frames_ = true;
+        std::memcpy(header_.data(), header, FRAME_HEADER_SIZE);
+        header_len_ = FRAME_HEADER_SIZE;
+        payload_left_ = payload_len;
+        state_ = State::SEND_HEADER;
+    }
+
+    // 按字节流转发；prefix 为已从 from 读出、需先写出的字节
+    void start_stream(const uint8_t* prefix, size_t length) {
+        frames_ = false;
+        std::memcpy(header_.data(), prefix, length);
+        header_len_ = length;
+        payload_left_ = SIZE_MAX;
+        state_ = length > 0 ? State::SEND_HEADER : State::PAYLOAD;
+    }
+
+    bool done() const { return state_ == State::DONE; }
+
+    void pump();
+
+private:
+    enum class State { HEADER, SEND_HEADER, PAYLOAD, DONE };
+
+    void wait(socket_base::wait_type type);
+    void finish();
+
+    Tunnel& tunnel_;
+    ip::tcp::socket& from_;
+    ip::tcp::socket& to_;
+    bool upstream_;     // 客户端到后端方向
+    bool frames_ = false;
+    State state_ = State::HEADER;
+    std::array<uint8_t, FRAME_HEADER_SIZE> header_{};
+    size_t header_len_ = 0;     // 本帧帧头（或前缀）的长度
+    size_t header_done_ = 0;    // HEADER 状态下已读入、SEND_HEADER 状态下已写出的字节
+    uint64_t payload_left_ = 0; // 尚未读入管道的负载字节
+    size_t piped_ = 0;          // 管道中尚未写出的字节
+    int pipe_[2] = {-1, -1};
+};
+
+// 一条客户端连接及其后端连接
+class Tunnel : public std::enable_shared_from_this<Tunnel> {
+public:
+    Tunnel(ip::tcp::socket client, ProxyContext& context)
+        : client_(std::move(client)),
+          backend_socket_(client_.get_executor()),
+          context_(context),
+          upstream_(*this, client_, backend_socket_, true),
+          downstream_(*this, backend_socket_, client_, false) {}
+
+    ~Tunnel() {
+        release();
+    }
+
+    void start() {
+        // 先读基础头区分 Wire 与 HTTP
+        auto self = shared_from_this();
+        async_read(client_, buffer(header_.data(), sizeof(BaseHeader)),
+            [self](boost::system::error_code ec, size_t) {
+                if (ec) {
+                    return;
+                }
+                self->on_base_header();
+            });
+    }
+
+    ProxyContext& context() { return context_; }
+
+    // 客户端方向的每个后续帧头：检查并在需要时改写，返回 false 时关闭连接
+    bool on_frame(uint8_t* header, uint32_t& payload_len) {
+        if (!parse_frame_header(header)) {
+            return false;
+        }
+        const SessionHeader& session = parser_.get_session_header();
+        payload_len = session.payload_len;
+        if (session.msg_type == MessageType::HANDSHAKE && session.session_id == 0) {
+            // 连接中途的新会话：挑选落在当前后端上的 id，挑不到时交给后端分配
+            for (size_t i = 0; i < SESSION_ID_ATTEMPTS; ++i) {
+                uint32_t id = context_.next_session_id();
+                uint32_t owner;
+                if (membership_->ring.pick(id, 0, owner) && owner == backend_index_) {
+                    assign_session_id(header, id);
+                    break;
+                }
+            }
+        }
+        return true;
+    }
+
+    // HTTP 在途请求计数：客户端发来数据时请求开始，后端开始回复时结束
+    void on_input(bool upstream) {
+        if (!http_ || upstream == awaiting_reply_) {
+            return;
+        }
+        awaiting_reply_ = upstream;
+        if (upstream) {
+            backend_->outstanding.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            backend_->outstanding.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    // 一个方向读到 EOF 并写完后半关闭对端；两个方向都结束时关闭连接
+    void on_relay_done() {
+        if (upstream_.done() && downstream_.done()) {
+            close();
+        }
+    }
+
+    void close() {
+        boost::system::error_code ignored;
+        client_.close(ignored);
+        backend_socket_.close(ignored);
+        release();
+    }
+
+private:
+    void on_base_header() {
+        auto result = parser_.parse(header_.data(), sizeof(BaseHeader));
+        if (result == ProtocolHandler::ParseResult::HTTP ||
+            (result == ProtocolHandler::ParseResult::ERROR &&
+             ProtocolHandler::is_http_request(header_.data(), sizeof(BaseHeader)))) {
+            http_ = true;
+            context_.http_connections.fetch_add(1, std::memory_order_relaxed);
+            connect();
+            return;
+        }
+        if (result != ProtocolHandler::ParseResult::NEED_MORE) {
+            close();
+            return;
+        }
+        auto self = shared_from_this();
+        async_read(client_, buffer(header_.data() + sizeof(BaseHeader), FRAME_HEADER_SIZE - sizeof(BaseHeader)),
+            [self](boost::system::error_code ec, size_t) {
+                if (ec) {
+                    return;
+                }
+                self->on_first_frame();
+            });
+    }
+
+    // 第一帧决定连接的后端：按 session_id 哈希；新会话先由代理分配 id
+    void on_first_frame() {
+        if (!parse_frame_header(header_.data())) {
+            close();
+            return;
+        }
+        const SessionHeader& session = parser_.get_session_header();
+        payload_len_ = session.payload_len;
+        key_ = session.session_id;
+        if (key_ == 0) {
+            key_ = context_.next_session_id();
+            if (session.msg_type == MessageType::HANDSHAKE) {
+                assign_session_id(header_.data(), key_);
+            }
+        }
+        context_.wire_connections.fetch_add(1, std::memory_order_relaxed);
+        connect();
+    }
+
+    // 只有帧头时解析器对带负载的帧返回 NEED_MORE，帧头本身已完整检查
+    bool parse_frame_header(const uint8_t* header) {
+        auto result = parser_.parse(header, FRAME_HEADER_SIZE);
+        return result == ProtocolHandler::ParseResult::BINARY ||
+               (result == ProtocolHandler::ParseResult::NEED_MORE && parser_.required_bytes() > FRAME_HEADER_SIZE);
+    }
+
+    // 新会话握手填入代理分配的 id，并置 NEW_SESSION：该 id 已存在时后端拒绝而不是当作恢复
+    static void assign_session_id(uint8_t* header, uint32_t id) {
+        uint32_t net = htonl(id);
+        std::memcpy(header + SESSION_ID_OFFSET, &net, sizeof(net));
+        header[FLAGS_OFFSET] |= static_cast<uint8_t>(Flags::NEW_SESSION);
+    }
+
+    // 选择后端：Wire 依次取哈希环上的所属后端与后备后端；HTTP 取在途请求最少的后端
+    bool choose() {
+        membership_ = context_.snapshot();
+        const auto& backends = membership_->backends;
+        if (!http_) {
+            uint32_t index;
+            if (!membership_->ring.pick(key_, attempts_, index)) {
+                return false;
+            }
+            backend_index_ = index;
+            backend_ = backends[index];
+            return true;
+        }
+        std::shared_ptr<Backend> best;
+        for (size_t i = 0; i < backends.size(); ++i) {
+            const auto& candidate = backends[(rotation_ + i) % backends.size()];
+            if (!candidate || std::find(tried_.begin(), tried_.end(), candidate.get()) != tried_.end()) {
+                continue;
+            }
+            if (!best || candidate->outstanding.load(std::memory_order_relaxed) <
+                             best->outstanding.load(std::memory_order_relaxed) ||
+                (candidate->outstanding.load(std::memory_order_relaxed) ==
+                     best->outstanding.load(std::memory_order_relaxed) &&
+                 candidate->connections.load(std::memory_order_relaxed) <
+                     best->connections.load(std::memory_order_relaxed))) {
+                best = candidate;
+            }
+        }
+        if (!best) {
+            return false;
+        }
+        backend_ = std::move(best);
+        tried_.push_back(backend_.get());
+        return true;
+    }
+
+    void connect() {
+        if (attempts_ == 0) {
+            rotation_ = context_.rotation.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (!choose()) {
+            close();
+            return;
+        }
+        auto self = shared_from_this();
+        backend_socket_.async_connect(backend_->endpoint, [self](boost::system::error_code ec) {
+            if (ec == error::operation_aborted) {
+                return;
+            }
+            if (ec) {
+                self->context_.connect_failures.fetch_add(1, std::memory_order_relaxed);
+                boost::system::error_code ignored;
+                self->backend_socket_.close(ignored);
+                ++self->attempts_;
+                self->connect();
+                return;
+            }
+            self->on_connected();
+        });
+    }
+
+    void on_connected() {
+        boost::system::error_code ec;
+        client_.set_option(ip::tcp::no_delay(true), ec);
+        backend_socket_.set_option(ip::tcp::no_delay(true), ec);
+        client_.native_non_blocking(true, ec);
+        if (!ec) {
+            backend_socket_.native_non_blocking(true, ec);
+        }
+        if (ec || !upstream_.open() || !downstream_.open()) {
+            close();
+            return;
+        }
+        if (http_) {
+            backend_->connections.fetch_add(1, std::memory_order_relaxed);
+            counted_ = true;
+            upstream_.start_stream(header_.data(), sizeof(BaseHeader));
+            on_input(true);
+        } else {
+            upstream_.start_frames(header_.data(), payload_len_);
+        }
+        downstream_.start_stream(nullptr, 0);
+        upstream_.pump();
+        downstream_.pump();
+    }
+
+    // 归还 HTTP 计数（只做一次）
+    void release() {
+        if (!counted_) {
+            return;
+        }
+        counted_ = false;
+        backend_->connections.fetch_sub(1, std::memory_order_relaxed);
+        if (awaiting_reply_) {
+            awaiting_reply_ = false;
+            backend_->outstanding.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    ip::tcp::socket client_;
+    ip::tcp::socket backend_socket_;
+    ProxyContext& context_;
+    Relay upstream_;
+    Relay downstream_;
+    ProtocolHandler parser_;
+    std::array<uint8_t, FRAME_HEADER_SIZE> header_{};
+    uint32_t payload_len_ = 0;
+    bool http_ = false;
+    bool counted_ = false;
+    bool awaiting_reply_ = false;
+    uint64_t key_ = 0;
+    size_t attempts_ = 0;
+    size_t rotation_ = 0;
+    std::vector<const Backend*> tried_;
+    std::shared_ptr<const Membership> membership_;
+    std::shared_ptr<Backend> backend_;
+    uint32_t backend_index_ = 0;
+};
+
+void Relay::wait(socket_base::wait_type type) {
+    auto self = tunnel_.shared_from_this();
+    ip::tcp::socket& socket = type == socket_base::wait_read ? from_ : to_;
+    socket.async_wait(type, [self, this](boost::system::error_code ec) {
+        if (!ec) {
+            pump();
+        }
+    });
+}
+
+void Relay::finish() {
+    // 读端 EOF：把半关闭传给对端，对端仍可继续回写
+    ::shutdown(to_.native_handle(), SHUT_WR);
+    state_ = State::DONE;
+    tunnel_.on_relay_done();
+}
+
+void Relay::pump() {
+    int in = from_.native_handle();
+    int out = to_.native_handle();
+    for (;;) {
+        if (state_ == State::DONE) {
+            return;
+        }
+        if (state_ == State::HEADER) {
+            ssize_t n = ::recv(in, header_.data() + header_done_, FRAME_HEADER_SIZE - header_done_, 0);
+            if (n > 0) {
+                header_done_ += static_cast<size_t>(n);
+                if (header_done_ < FRAME_HEADER_SIZE) {
+                    continue;
+                }
+                uint32_t payload_len = 0;
+                if (!tunnel_.on_frame(header_.data(), payload_len)) {
+                    tunnel_.close();
+                    return;
+                }
+                payload_left_ = payload_len;
+                header_len_ = FRAME_HEADER_SIZE;
+                header_done_ = 0;
+                state_ = State::SEND_HEADER;
+                continue;
+            }
+            if (n == 0 && header_done_ == 0) {
+                finish();
+                return;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                wait(socket_base::wait_read);
+                return;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            tunnel_.close();    // 帧头中途断开或出错
+            return;
+        }
+        if (state_ == State::SEND_HEADER) {
+            // 负载紧随其后时 MSG_MORE，帧头与负载尽量合并为同一个分段
+            int flags = MSG_NOSIGNAL | (frames_ && payload_left_ > 0 ? MSG_MORE : 0);
+            ssize_t n = ::send(out, header_.data() + header_done_, header_len_ - header_done_, flags);
+            if (n > 0) {
+                header_done_ += static_cast<size_t>(n);
+                if (header_done_ == header_len_) {
+                    header_done_ = 0;
+                    state_ = State::PAYLOAD;
+                }
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                wait(socket_base::wait_write);
+                return;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            tunnel_.close();
+            return;
+        }
+
+        // PAYLOAD：管道中有数据先写出，写空后再从源端读入
+        if (piped_ > 0) {
+            unsigned int flags = SPLICE_F_MOVE | SPLICE_F_NONBLOCK | (frames_ && payload_left_ > 0 ? SPLICE_F_MORE : 0);
+            ssize_t n = ::splice(pipe_[0], nullptr, out, nullptr, piped_, flags);
+            if (n > 0) {
+                piped_ -= static_cast<size_t>(n);
+                tunnel_.context().spliced_bytes.fetch_add(static_cast<uint64_t>(n), std::memory_order_relaxed);
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                wait(socket_base::wait_write);
+                return;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            tunnel_.close();
+            return;
+        }
+        if (frames_ && payload_left_ == 0) {
+            state_ = State::HEADER;
+            continue;
+        }
+        size_t chunk = static_cast<size_t>(std::min<uint64_t>(payload_left_, PIPE_CHUNK));
+        ssize_t n = ::splice(in, nullptr, pipe_[1], nullptr, chunk, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (n > 0) {
+            piped_ += static_cast<size_t>(n);
+            if (frames_) {
+                payload_left_ -= static_cast<uint64_t>(n);
+            } else {
+                tunnel_.on_input(upstream_);
+            }
+            continue;
+        }
+        if (n == 0 && !frames_) {
+            finish();
+            return;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            wait(socket_base::wait_read);
+            return;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        tunnel_.close();    // 负载中途断开或出错
+        return;
+    }
+}
+
+} // namespace
+
+uint64_t HashRing::hash(uint64_t key) {
+    // splitmix64 的最终混合
+    key += 0x9e3779b97f4a7c15ULL;
+    key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+    return key ^ (key >> 31);
+}
+
+void HashRing::add(uint32_t backend, const std::string& name) {
+    for (size_t i = 0; i < virtual_nodes_; ++i) {
+        points_.emplace_back(hash_name(name, i), backend);
+    }
+    std::sort(points_.begin(), points_.end());
+    ++backends_;
+}
+
+void HashRing::remove(uint32_t backend) {
+    size_t before = points_.size();
+    points_.erase(std::remove_if(points_.begin(), points_.end(),
+                                 [backend](const std::pair<uint64_t, uint32_t>& point) { return point.second == backend; }),
+                  points_.end());
+    if (points_.size() != before) {
+        --backends_;
+    }
+}
+
+bool HashRing::pick(uint64_t key, size_t skip, uint32_t& backend) const {
+    if (points_.empty() || skip >= backends_) {
+        return false;
+    }
+    uint64_t position = hash(key);
+    auto it = std::lower_bound(points_.begin(), points_.end(), std::make_pair(position, uint32_t(0)));
+    size_t start = static_cast<size_t>(it - points_.begin());
+    // 顺时针遇到的不同后端依次作为所属后端与后备后端
+    std::vector<uint32_t> seen;
+    for (size_t i = 0; i < points_.size(); ++i) {
+        uint32_t candidate = points_[(start + i) % points_.size()].second;
+        if (std::find(seen.begin(), seen.end(), candidate) != seen.end()) {
+            continue;
+        }
+        if (seen.size() == skip) {
+            backend = candidate;
+            return true;
+        }
+        seen.push_back(candidate);
+    }
+    return false;
+}
+
+class Proxy::Impl {
+public:
+    explicit Impl(const ProxyOptions& options) : context_(options.virtual_nodes) {
+        // splice 写入已断开的套接字没有 MSG_NOSIGNAL 可用，忽略 SIGPIPE，以 EPIPE 返回
+        ::signal(SIGPIPE, SIG_IGN);
+        for (const auto& backend : options.backends) {
+            add_backend(backend);
+        }
+        std::size_t threads = options.threads == 0 ? 1 : options.threads;
+        for (std::size_t i = 0; i < threads; ++i) {
+            workers_.emplace_back(std::make_unique<Worker>());
+        }
+        // 第一个监听器决定实际端口（支持端口0），其余线程复用该端口
+        workers_.front()->open_acceptor(options.port, threads > 1);
+        unsigned short bound = workers_.front()->acceptor->local_endpoint().port();
+        for (std::size_t i = 1; i < workers_.size(); ++i) {
+            workers_[i]->open_acceptor(bound, true);
+        }
+        for (auto& worker : workers_) {
+            start_accept(*worker);
+        }
+    }
+
+    ~Impl() {
+        stop();
+    }
+
+    void run() {
+        if (running_.exchange(true)) {
+            return;
+        }
+        for (auto& worker : workers_) {
+            worker->start();
+        }
+    }
+
+    void stop() {
+        for (auto& worker : workers_) {
+            worker->stop();
+        }
+        for (auto& worker : workers_) {
+            worker->join();
+        }
+        running_ = false;
+    }
+
+    unsigned short port() const {
+        return workers_.front()->acceptor->local_endpoint().port();
+    }
+
+    bool add_backend(const std::string& name) {
+        auto backend = std::make_shared<Backend>();
+        backend->name = name;
+        if (!resolve(name, backend->endpoint)) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(context_.mutex);
+        const Membership& current = *context_.membership;
+        for (const auto& existing : current.backends) {
+            if (existing && existing->name == name) {
+                return false;
+            }
+        }
+        auto next = std::make_shared<Membership>(current);
+        auto hole = std::find(next->backends.begin(), next->backends.end(), nullptr);
+        uint32_t index = static_cast<uint32_t>(hole - next->backends.begin());
+        if (hole == next->backends.end()) {
+            next->backends.push_back(std::move(backend));
+        } else {
+            *hole = std::move(backend);
+        }
+        next->ring.add(index, name);
+        context_.membership = std::move(next);
+        return true;
+    }
+
+    bool remove_backend(const std::string& name) {
+        std::lock_guard<std::mutex> lock(context_.mutex);
+        const Membership& current = *context_.membership;
+        for (size_t i = 0; i < current.backends.size(); ++i) {
+            if (current.backends[i] && current.backends[i]->name == name) {
+                auto next = std::make_shared<Membership>(current);
+                next->backends[i].reset();
+                next->ring.remove(static_cast<uint32_t>(i));
+                context_.membership = std::move(next);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::vector<std::string> backends() const {
+        std::vector<std::string> names;
+        for (const auto& backend : context_.snapshot()->backends) {
+            if (backend) {
+                names.push_back(backend->name);
+            }
+        }
+        return names;
+    }
+
+    ProxyStats stats() const {
+        ProxyStats s;
+        s.wire_connections = context_.wire_connections.load(std::memory_order_relaxed);
+        s.http_connections = context_.http_connections.load(std::memory_order_relaxed);
+        s.connect_failures = context_.connect_failures.load(std::memory_order_relaxed);
+        s.spliced_bytes = context_.spliced_bytes.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    using Worker = detail::IoWorker;
+
+    // "host:port"，host 可以是地址或主机名（取第一个解析结果）
+    static bool resolve(const std::string& name, ip::tcp::endpoint& out) {
+        size_t colon = name.rfind(':');
+        if (colon == std::string::npos || colon == 0) {
+            return false;
+        }
+        io_context io;
+        ip::tcp::resolver resolver(io);
+        boost::system::error_code ec;
+        auto results = resolver.resolve(name.substr(0, colon), name.substr(colon + 1), ec);
+        if (ec || results.empty()) {
+            return false;
+        }
+        out = results.begin()->endpoint();
+        return true;
+    }
+
+    void start_accept(Worker& worker) {
+        worker.acceptor->async_accept([this, &worker](boost::system::error_code ec, ip::tcp::socket peer) {
+            if (ec == error::operation_aborted) {
+                return;
+            }
+            if (!ec) {
+                std::make_shared<Tunnel>(std::move(peer), context_)->start();
+            }
+            start_accept(worker);
+        });
+    }
+
+    ProxyContext context_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<bool> running_{false};
+};
+
+Proxy::Proxy(const ProxyOptions& options)
+    : impl_(std::make_unique<Impl>(options)) {}
+
+Proxy::~Proxy() = default;
+
+void Proxy::run() {
+    impl_->run();
+}
+
+void Proxy::stop() {
+    impl_->stop();
+}
+
+unsigned short Proxy::port() const {
+    return impl_->port();
+}
+
+bool Proxy::add_backend(const std::string& backend) {
+    return impl_->add_backend(backend);
+}
+
+bool Proxy::remove_backend(const std::string& backend) {
+    return impl_->remove_backend(backend);
+}
+
+std::vector<std::string> Proxy::backends() const {
+    return impl_->backends();
+}
+
+ProxyStats Proxy::stats() const {
+    return impl_->stats();
+}
+
+} // namespace proxy
+} // namespace hwp
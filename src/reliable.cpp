@@ -0,0 +1,334 @@
+#include "../include/hwp/reliable.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstring>
+
+namespace hwp {
+
+namespace {
+
+// 接收端最多记录的乱序区间数，超过时放弃最早的空洞（等同收到对端的 FORWARD）
+constexpr std::size_t MAX_RECEIVE_RANGES = 1024;
+
+void put_u32(uint8_t* out, uint32_t value) {
+    value = htonl(value);
+    std::memcpy(out, &value, sizeof(value));
+}
+
+uint32_t get_u32(const uint8_t* in) {
+    uint32_t value;
+    std::memcpy(&value, in, sizeof(value));
+    return ntohl(value);
+}
+
+// 下一个序列号：0 表示未编号，发送方回绕时跳过
+uint32_t successor(uint32_t seq) {
+    return seq == UINT32_MAX ? 1 : seq + 1;
+}
+
+} // namespace
+
+ReliableChannel::ReliableChannel(const ReliableOptions& options) : options_(options) {
+    options_.window = std::max<uint32_t>(options_.window, 1);
+    options_.ack_every = std::max<uint32_t>(options_.ack_every, 1);
+}
+
+uint32_t ReliableChannel::allocate_seq() {
+    uint32_t seq = next_seq_++;
+    if (next_seq_ == 0) {
+        next_seq_ = 1;
+    }
+    return seq;
+}
+
+uint32_t ReliableChannel::next_seq() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return allocate_seq();
+}
+
+void ReliableChannel::send(Message&& msg, uint64_t connection, AckCallback callback,
+                           std::vector<OutgoingFrame>& out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Queued queued{std::move(msg), std::move(callback)};
+    if (backlog_.empty() && unacked_.size() < options_.window) {
+        transmit(std::move(queued), connection, out);
+    } else {
+        backlog_.push_back(std::move(queued));
+    }
+}
+
+// 负载转为共享所有权：写队列中的帧与重传缓冲区各持一份引用，确认与写完成的先后无关
+void ReliableChannel::transmit(Queued&& queued, uint64_t connection, std::vector<OutgoingFrame>& out) {
+    Pending pending;
+    pending.seq = allocate_seq();
+    pending.header.base_header = queued.msg.base_header;
+    pending.header.session_header = queued.msg.session_header;
+    pending.header.base_header.flags |= static_cast<uint8_t>(Flags::REQUIRES_ACK);
+    pending.header.session_header.seq_num = pending.seq;
+    // 可靠消息整帧发送，不参与流复用
+    pending.header.session_header.stream_id = 0;
+    // 窗口在此填满：请对端跳过延迟确认，否则小窗口每轮都要多等 ack_delay
+    if (unacked_.size() + 1 >= options_.window) {
+        pending.header.base_header.flags |= static_cast<uint8_t>(Flags::ACK_NOW);
+    }
+    pending.payload = std::make_shared<const std::vector<uint8_t>>(std::move(queued.msg.payload));
+    pending.connection = connection;
+    pending.callback = std::move(queued.callback);
+    out.emplace_back(pending.header, pending.payload);
+    unacked_.push_back(std::move(pending));
+    ++stats_.sent;
+}
+
+void ReliableChannel::on_ack(const AckInfo& ack, uint64_t connection, std::vector<OutgoingFrame>& out) {
+    std::vector<AckCallback> acked;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.acks_received;
+        auto release = [&](Pending& pending) {
+            if (pending.sacked) {
+                return;
+            }
+            pending.sacked = true;
+            pending.payload.reset();
+            if (pending.lost) {
+                pending.lost = false;
+                --lost_;
+            }
+            ++stats_.acked;
+            if (pending.callback) {
+                acked.push_back(std::move(pending.callback));
+            }
+        };
+
+        while (!unacked_.empty() && !seq_after(unacked_.front().seq, ack.cumulative)) {
+            release(unacked_.front());
+            unacked_.pop_front();
+        }
+        for (const auto& range : ack.ranges) {
+            auto it = std::lower_bound(unacked_.begin(), unacked_.end(), range.first,
+                [](const Pending& pending, uint32_t seq) { return seq_after(seq, pending.seq); });
+            for (; it != unacked_.end() && !seq_after(it->seq, range.second); ++it) {
+                release(*it);
+            }
+        }
+        while (!unacked_.empty() && unacked_.front().sacked) {
+            unacked_.pop_front();
+        }
+
+        // 补发断开连接上发出、对端仍未确认的消息
+        if (lost_ > 0) {
+            for (auto& pending : unacked_) {
+                if (pending.lost) {
+                    pending.lost = false;
+                    pending.connection = connection;
+                    out.emplace_back(pending.header, pending.payload);
+                    ++stats_.retransmitted;
+                }
+            }
+            lost_ = 0;
+        }
+
+        // 累计确认号停滞在最早的未确认消息之前：中间的空洞是不需要确认、断开时丢失的消息，
+        // 告知对端跳过，避免其选择确认区间无限增长
+        if (!unacked_.empty() || !backlog_.empty() || next_seq_ != 1) {
+            uint32_t floor = unacked_.empty() ? next_seq_ - 1 : unacked_.front().seq - 1;
+            if (ack.cumulative == last_cumulative_ && seq_after(floor, ack.cumulative)) {
+                out.emplace_back(forward_message(ack.session_id, floor));
+            }
+        }
+        last_cumulative_ = ack.cumulative;
+
+        while (!backlog_.empty() && unacked_.size() < options_.window) {
+            transmit(std::move(backlog_.front()), connection, out);
+            backlog_.pop_front();
+        }
+    }
+    for (auto& callback : acked) {
+        callback(true);
+    }
+}
+
+void ReliableChannel::connection_lost(uint64_t connection) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& pending : unacked_) {
+        if (pending.connection == connection && !pending.lost && !pending.sacked) {
+            pending.lost = true;
+            ++lost_;
+        }
+    }
+}
+
+bool ReliableChannel::has_lost() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lost_ > 0;
+}
+
+void ReliableChannel::abandon() {
+    std::vector<AckCallback> dropped;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& pending : unacked_) {
+            if (!pending.sacked && pending.callback) {
+                dropped.push_back(std::move(pending.callback));
+            }
+        }
+        for (auto& queued : backlog_) {
+            if (queued.callback) {
+                dropped.push_back(std::move(queued.callback));
+            }
+        }
+        unacked_.clear();
+        backlog_.clear();
+        lost_ = 0;
+    }
+    for (auto& callback : dropped) {
+        callback(false);
+    }
+}
+
+ReliableChannel::Receive ReliableChannel::on_receive(uint32_t seq, bool reliable) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto absorb = [this]() {
+        while (!received_.empty() && !seq_after(received_.front().first, successor(cumulative_))) {
+            if (seq_after(received_.front().second, cumulative_)) {
+                cumulative_ = received_.front().second;
+            }
+            received_.erase(received_.begin());
+        }
+    };
+    auto duplicate = [&]() {
+        if (!reliable) {
+            return Receive::OUT_OF_ORDER;
+        }
+        ++stats_.duplicates;
+        return Receive::DUPLICATE;
+    };
+
+    if (!seq_after(seq, cumulative_)) {
+        return duplicate();
+    }
+    if (seq == successor(cumulative_)) {
+        cumulative_ = seq;
+        absorb();
+        stats_.received += reliable;
+        return Receive::IN_ORDER;
+    }
+
+    // 第一个末端不小于 seq 的区间
+    auto it = std::lower_bound(received_.begin(), received_.end(), seq,
+        [](const std::pair<uint32_t, uint32_t>& range, uint32_t value) { return seq_after(value, range.second); });
+    if (it != received_.end() && !seq_after(it->first, seq)) {
+        return duplicate();
+    }
+    stats_.received += reliable;
+    bool join_prev = it != received_.begin() && successor(std::prev(it)->second) == seq;
+    bool join_next = it != received_.end() && it->first == successor(seq);
+    if (join_prev && join_next) {
+        std::prev(it)->second = it->second;
+        received_.erase(it);
+    } else if (join_prev) {
+        std::prev(it)->second = seq;
+    } else if (join_next) {
+        it->first = seq;
+    } else {
+        received_.insert(it, std::make_pair(seq, seq));
+    }
+    if (received_.size() > MAX_RECEIVE_RANGES) {
+        cumulative_ = received_.front().second;
+        received_.erase(received_.begin());
+        absorb();
+    }
+    return Receive::OUT_OF_ORDER;
+}
+
+void ReliableChannel::on_forward(uint32_t seq) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!seq_after(seq, cumulative_)) {
+        return;
+    }
+    cumulative_ = seq;
+    while (!received_.empty() && !seq_after(received_.front().second, cumulative_)) {
+        received_.erase(received_.begin());
+    }
+    while (!received_.empty() && !seq_after(received_.front().first, successor(cumulative_))) {
+        cumulative_ = received_.front().second;
+        received_.erase(received_.begin());
+    }
+}
+
+AckInfo ReliableChannel::ack_state() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    AckInfo ack;
+    ack.cumulative = cumulative_;
+    std::size_t count = std::min(received_.size(), options_.max_sack_ranges);
+    ack.ranges.assign(received_.begin(), received_.begin() + static_cast<std::ptrdiff_t>(count));
+    return ack;
+}
+
+Message ReliableChannel::make_ack(uint32_t session_id) {
+    AckInfo ack = ack_state();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.acks_sent;
+    }
+    return ack_message(session_id, ack, options_.max_sack_ranges);
+}
+
+Message ReliableChannel::ack_message(uint32_t session_id, const AckInfo& ack, std::size_t max_ranges) {
+    std::size_t count = std::min<std::size_t>({ack.ranges.size(), max_ranges, 255});
+    std::vector<uint8_t> payload(6 + count * 8);
+    payload[0] = static_cast<uint8_t>(ControlCode::ACK);
+    put_u32(payload.data() + 1, ack.cumulative);
+    payload[5] = static_cast<uint8_t>(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        put_u32(payload.data() + 6 + i * 8, ack.ranges[i].first);
+        put_u32(payload.data() + 10 + i * 8, ack.ranges[i].second);
+    }
+    return ProtocolHandler::create_message(MessageType::CONTROL, session_id, std::move(payload),
+                                           static_cast<uint8_t>(Flags::BINARY_MODE));
+}
+
+bool ReliableChannel::parse_ack(const Message& msg, AckInfo& ack) {
+    const auto& payload = msg.payload;
+    if (msg.session_header.msg_type != MessageType::CONTROL || payload.size() < 6 ||
+        payload[0] != static_cast<uint8_t>(ControlCode::ACK) || payload.size() != 6 + payload[5] * 8u) {
+        return false;
+    }
+    ack.session_id = msg.session_header.session_id;
+    ack.cumulative = get_u32(payload.data() + 1);
+    ack.ranges.resize(payload[5]);
+    for (std::size_t i = 0; i < ack.ranges.size(); ++i) {
+        ack.ranges[i].first = get_u32(payload.data() + 6 + i * 8);
+        ack.ranges[i].second = get_u32(payload.data() + 10 + i * 8);
+    }
+    return true;
+}
+
+Message ReliableChannel::forward_message(uint32_t session_id, uint32_t seq) {
+    std::vector<uint8_t> payload(5);
+    payload[0] = static_cast<uint8_t>(ControlCode::FORWARD);
+    put_u32(payload.data() + 1, seq);
+    return ProtocolHandler::create_message(MessageType::CONTROL, session_id, std::move(payload),
+                                           static_cast<uint8_t>(Flags::BINARY_MODE));
+}
+
+bool ReliableChannel::parse_forward(const Message& msg, uint32_t& seq) {
+    if (msg.session_header.msg_type != MessageType::CONTROL || msg.payload.size() != 5 ||
+        msg.payload[0] != static_cast<uint8_t>(ControlCode::FORWARD)) {
+        return false;
+    }
+    seq = get_u32(msg.payload.data() + 1);
+    return true;
+}
+
+size_t ReliableChannel::unacked() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return unacked_.size() + backlog_.size();
+}
+
+ReliableStats ReliableChannel::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+} // namespace hwp
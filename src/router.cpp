@@ -0,0 +1,195 @@
+#include "../include/hwp/router.hpp"
+#include <array>
+#include <atomic>
+#include <boost/asio/post.hpp>
+#include "../include/hwp/metrics.hpp"
+
+namespace hwp {
+namespace server {
+
+namespace {
+
+struct Route {
+    Dispatch mode = Dispatch::INLINE;
+    MessageHandler inline_handler;
+    OffloadHandler offload_handler;
+};
+
+// 过载时拒绝消息：交给 overloaded 回调，未设置时直接回复 ERROR
+struct Shedding {
+    explicit Shedding(const CoDelOptions& options) : codel(options) {}
+
+    // 可在任意线程调用；回调总是在连接的执行器上执行
+    void reject(const std::shared_ptr<Connection>& connection, Message msg) const {
+        metrics::request_shed();
+        if (!handler) {
+            connection->send(ProtocolHandler::create_error(msg, ErrorCode::OVERLOADED));
+            return;
+        }
+        boost::asio::post(connection->get_executor(), [this, connection, msg = std::move(msg)]() mutable {
+            handler(connection, msg);
+        });
+    }
+
+    CoDel codel;
+    MessageHandler handler;
+    std::atomic<uint64_t> shed{0};
+};
+
+// 可靠消息在交给应用之前已被确认，对端不会再发：过载时也不能丢弃
+bool sheddable(const Message& msg) {
+    return !(msg.base_header.flags & static_cast<uint8_t>(Flags::REQUIRES_ACK));
+}
+
+// 执行卸载的处理函数，回复经 Connection::send 投递回连接的执行器
+void run_offload(const OffloadHandler& handler, const std::shared_ptr<Connection>& connection, Message& msg) {
+    try {
+        std::optional<Message> reply = handler(msg);
+        if (reply) {
+            connection->send(std::move(*reply));
+        }
+    } catch (...) {
+        // 处理函数的异常只影响这条连接
+        connection->close();
+    }
+}
+
+// 线程池中的一项任务
+struct OffloadJob {
+    const OffloadHandler* handler = nullptr;
+    Shedding* shedding = nullptr;
+    std::shared_ptr<Connection> connection;
+    Message msg;
+    uint64_t queued_at = 0;
+
+    void operator()() {
+        // 排队过久的任务不再执行：回复已经来不及，腾出线程处理较新的任务
+        uint64_t now = steady_now_ns();
+        if (shedding->codel.shed(now - queued_at, now) && sheddable(msg)) {
+            shedding->shed.fetch_add(1, std::memory_order_relaxed);
+            shedding->reject(connection, std::move(msg));
+            return;
+        }
+        run_offload(*handler, connection, msg);
+    }
+};
+
+} // namespace
+
+class Router::Impl {
+public:
+    explicit Impl(const RouterOptions& options) : shedding_(options.queue_delay), options_(options) {}
+
+    void set_inline(MessageType type, MessageHandler handler) {
+        Route& route = routes_[static_cast<uint8_t>(type)];
+        route.mode = Dispatch::INLINE;
+        route.inline_handler = std::move(handler);
+        route.offload_handler = nullptr;
+    }
+
+    void set_offload(MessageType type, OffloadHandler handler) {
+        Route& route = routes_[static_cast<uint8_t>(type)];
+        route.mode = Dispatch::OFFLOAD;
+        route.offload_handler = std::move(handler);
+        route.inline_handler = nullptr;
+        if (!pool_) {
+            pool_ = std::make_unique<WorkStealingPool<OffloadJob>>(options_.workers);
+        }
+    }
+
+    void dispatch(const std::shared_ptr<Connection>& connection, Message& msg) {
+        const Route& route = routes_[static_cast<uint8_t>(msg.session_header.msg_type)];
+        if (route.mode == Dispatch::INLINE) {
+            if (route.inline_handler) {
+                route.inline_handler(connection, msg);
+                return;
+            }
+            unrouted_.fetch_add(1, std::memory_order_relaxed);
+            if (fallback_) {
+                fallback_(connection, msg);
+            }
+            return;
+        }
+
+        OffloadJob job;
+        job.handler = &route.offload_handler;
+        job.shedding = &shedding_;
+        job.connection = connection;
+        job.msg = std::move(msg);
+        job.queued_at = steady_now_ns();
+        if (pool_->submit(job)) {
+            offloaded_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        // 队列已满：消息仍在 job 中，交还给调用方；可靠消息就地处理
+        msg = std::move(job.msg);
+        if (!sheddable(msg)) {
+            run_offload(route.offload_handler, connection, msg);
+        } else if (shedding_.handler) {
+            metrics::request_shed();
+            shedding_.handler(connection, msg);
+        } else {
+            shedding_.reject(connection, std::move(msg));
+        }
+    }
+
+    RouterStats stats() const {
+        RouterStats s;
+        s.offloaded = offloaded_.load(std::memory_order_relaxed);
+        s.unrouted = unrouted_.load(std::memory_order_relaxed);
+        s.shed = shedding_.shed.load(std::memory_order_relaxed);
+        if (pool_) {
+            s.workers = pool_->stats();
+        }
+        return s;
+    }
+
+    MessageHandler fallback_;
+    Shedding shedding_;
+
+private:
+    RouterOptions options_;
+    std::array<Route, 256> routes_;
+    std::atomic<uint64_t> offloaded_{0};
+    std::atomic<uint64_t> unrouted_{0};
+    // 最后销毁：析构时先执行完已排队的任务，任务引用 routes_ 中的处理函数
+    std::unique_ptr<WorkStealingPool<OffloadJob>> pool_;
+};
+
+Router::Router(const RouterOptions& options)
+    : impl_(std::make_unique<Impl>(options)) {}
+
+Router::~Router() = default;
+
+void Router::set_inline(MessageType type, MessageHandler handler) {
+    impl_->set_inline(type, std::move(handler));
+}
+
+void Router::set_offload(MessageType type, OffloadHandler handler) {
+    impl_->set_offload(type, std::move(handler));
+}
+
+void Router::fallback(MessageHandler handler) {
+    impl_->fallback_ = std::move(handler);
+}
+
+void Router::overloaded(MessageHandler handler) {
+    impl_->shedding_.handler = std::move(handler);
+}
+
+void Router::dispatch(const std::shared_ptr<Connection>& connection, Message& msg) {
+    impl_->dispatch(connection, msg);
+}
+
+MessageHandler Router::handler() {
+    return [impl = impl_.get()](const std::shared_ptr<Connection>& connection, Message& msg) {
+        impl->dispatch(connection, msg);
+    };
+}
+
+RouterStats Router::stats() const {
+    return impl_->stats();
+}
+
+} // namespace server
+} // namespace hwp
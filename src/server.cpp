@@ -1,72 +1,1587 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <memory>
 #include <vector>
 #include <string>
+#include <thread>
+#include <optional>
+#include <atomic>
+#include <array>
+#include <coroutine>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <unistd.h>
 #include <boost/asio.hpp>
 #include "../include/hwp.hpp"
+#include "io_worker.hpp"
 
 using namespace boost::asio;
 
 namespace hwp {
 namespace server {
 
-class Server::Impl {
+namespace {
+
+// 单次 writev 最多聚合的帧数
+constexpr size_t MAX_GATHER_FRAMES = 64;
+
+// 协程会话：收件队列达到上限时暂停读取，降到一半时恢复；写队列达到上限时 send 挂起
+constexpr size_t SESSION_INBOX_LIMIT = 256;
+constexpr size_t SESSION_SEND_LIMIT = MAX_GATHER_FRAMES;
+
+// 每隔多少个会话时间轮 tick 清理一次已过期会话的可靠传输状态，并回写会话快照
+constexpr size_t CHANNEL_SWEEP_TICKS = 100;
+
+// 服务器内所有连接共享的状态
+struct ServerContext {
+    explicit ServerContext(const SessionTableOptions& session_options, std::string dir = std::string(),
+                           const FlowControlOptions& flow_options = FlowControlOptions(),
+                           const ReliableOptions& reliable_options = ReliableOptions(),
+                           const compress::CompressionOptions& compression_options = compress::CompressionOptions(),
+                           bool metrics = true,
+                           const BackpressureOptions& backpressure_options = BackpressureOptions(),
+                           const AdmissionOptions& admission_options = AdmissionOptions(),
+                           const EgressOptions& egress_options = EgressOptions())
+        : sessions(session_options), transfer_dir(std::move(dir)), flow(flow_options),
+          reliable(reliable_options), compression(compression_options), metrics_endpoint(metrics),
+          backpressure(backpressure_options), budget(backpressure_options.memory_budget),
+          admission(admission_options), accept_limiter(admission_options.accept_rate, admission_options.accept_burst),
+          egress(egress_options) {}
+
+    // 会话的可靠传输状态，同一会话的所有连接共享；create 为 false 时不存在则返回空
+    std::shared_ptr<ReliableChannel> channel(uint32_t session_id, bool create) {
+        std::lock_guard<std::mutex> lock(channels_mutex);
+        auto it = channels.find(session_id);
+        if (it != channels.end()) {
+            return it->second;
+        }
+        if (!create) {
+            return nullptr;
+        }
+        auto channel = std::make_shared<ReliableChannel>(reliable);
+        channels.emplace(session_id, channel);
+        return channel;
+    }
+
+    // 新分配的 session_id 不继承同一 id 上尚未清扫的旧可靠传输状态
+    void drop_channel(uint32_t session_id) {
+        std::lock_guard<std::mutex> lock(channels_mutex);
+        channels.erase(session_id);
+    }
+
+    // 会话已从会话表中淘汰或过期时，丢弃其可靠传输状态
+    void sweep_channels() {
+        std::lock_guard<std::mutex> lock(channels_mutex);
+        SessionState state;
+        for (auto it = channels.begin(); it != channels.end();) {
+            if (sessions.find(it->first, state)) {
+                ++it;
+            } else {
+                it = channels.erase(it);
+            }
+        }
+    }
+
+    MessageHandler handler;
+    ChunkHandler chunk_handler;     // 设置时 flow.stream_payloads 为 true
+    SessionHandler session_handler;
+    HttpHandler http_handler;
+    SessionTable sessions;
+    std::string transfer_dir;
+    FlowControlOptions flow;
+    ReliableOptions reliable;
+    compress::CompressionOptions compression;
+    bool metrics_endpoint;
+    BackpressureOptions backpressure;
+    BufferBudget budget;
+    AdmissionOptions admission;
+    RateLimiter accept_limiter;
+    EgressOptions egress;
+    std::unique_ptr<capture::CaptureWriter> capture;    // 未抓包时为空
+    std::atomic<std::size_t> connections{0};    // 当前打开的连接数
+    // 准入控制的计数：按 metrics::Rejection 下标的拒绝连接数与拒绝的请求数，关闭指标时同样统计
+    std::array<std::atomic<uint64_t>, static_cast<std::size_t>(metrics::Rejection::COUNT)> rejected{};
+    std::atomic<uint64_t> shed{0};
+    std::mutex channels_mutex;
+    std::unordered_map<uint32_t, std::shared_ptr<ReliableChannel>> channels;
+};
+
+// 每个观测窗口内探测事件循环排队延迟的次数
+constexpr int LOAD_PROBES_PER_INTERVAL = 8;
+
+// 事件循环的排队延迟探针：定时器按周期到期，处理器实际执行比到期时刻晚出的时间，
+// 就是就绪的处理器在该线程上排队的时间。样本交给 CoDel：整个窗口内每次探测都晚于 target
+// 说明线程持续饱和（而非短暂突发），此时拒绝新连接与新请求，直到某个窗口恢复
+class LoadMonitor {
 public:
-    Impl(io_context& io, unsigned short port)
-            : acceptor_(io, ip::tcp::endpoint(ip::tcp::v4(), port)) {
-        start_accept();
+    LoadMonitor(io_context& io, const CoDelOptions& options)
+        : timer_(io), codel_(options),
+          period_(std::max<steady_timer::duration>(options.interval / LOAD_PROBES_PER_INTERVAL,
+                                                   std::chrono::milliseconds(1))) {}
+
+    void start() {
+        deadline_ = steady_now_ns() + static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(period_).count());
+        timer_.expires_after(period_);
+        timer_.async_wait([this](boost::system::error_code ec) {
+            if (ec) {
+                return;
+            }
+            uint64_t now = steady_now_ns();
+            codel_.shed(now > deadline_ ? now - deadline_ : 0, now);
+            start();
+        });
+    }
+
+    void stop() {
+        timer_.cancel();
+    }
+
+    // 可从其他线程读取（转交连接时由接受线程判断）
+    bool overloaded() const {
+        return codel_.overloaded();
     }
 
 private:
-    void start_accept() {
-        auto socket = std::make_shared<ip::tcp::socket>(acceptor_.get_executor());
-        acceptor_.async_accept(*socket, [this, socket](boost::system::error_code ec) {
-            if (!ec) {
-                handle_connection(socket);
+    steady_timer timer_;
+    CoDel codel_;
+    steady_timer::duration period_;
+    uint64_t deadline_ = 0;
+};
+
+// HTTP 模式每次读取的最小空闲空间
+constexpr size_t HTTP_READ_CHUNK = 16 * 1024;
+
+// Wire 模式读缓冲区的空闲空间；超过它的帧不经过读缓冲区，负载直接读入
+constexpr size_t WIRE_READ_CHUNK = 16 * 1024;
+
+// 未设置 HTTP 回调时的默认响应
+void default_http_handler(const http::Request& /*request*/, http::Response& response) {
+    response.body.assign("Hello, Hybrid!");
+}
+
+// 单条 TCP 连接：首帧决定 HTTP 或 Wire 模式，Wire 模式下持续按长度前缀读帧；
+// HTTP 模式支持 keep-alive 与流水线，一次读取中的所有完整请求合并为一次写出
+class ServerConnection final : public Connection {
+public:
+    ServerConnection(ip::tcp::socket socket, ServerContext& context, uint64_t id, uring::Ring* ring = nullptr,
+                     const LoadMonitor* monitor = nullptr)
+        : socket_(std::move(socket)), context_(context), id_(id), monitor_(monitor), egress_(context.egress),
+          mux_(context.flow, &context.budget), compressor_(context.compression) {
+        write_buffers_.reserve(2 * MAX_GATHER_FRAMES);
+        // 写出中的帧头被 write_buffers_ 引用，容量预留后填充不会搬移元素
+        in_flight_.reserve(MAX_GATHER_FRAMES);
+        if (ring) {
+            uring_ = std::make_unique<uring::Socket>(*ring, socket_.native_handle());
+        }
+        context_.connections.fetch_add(1, std::memory_order_relaxed);
+        metrics::connection_opened();
+    }
+
+    ~ServerConnection() override {
+        context_.connections.fetch_sub(1, std::memory_order_relaxed);
+        metrics::connection_closed();
+    }
+
+    void start() {
+        boost::system::error_code ignored;
+        socket_.set_option(ip::tcp::no_delay(true), ignored);
+        // 文件数据直接对 fd 做 splice，需要非阻塞 socket
+        socket_.native_non_blocking(true, ignored);
+        read_base_header();
+    }
+
+    void send(Message msg) override {
+        bool compress = compressor_.options().enabled && msg.session_header.msg_type == MessageType::DATA;
+        if (!compress && !StreamMux::flow_controlled(msg.session_header)) {
+            send(OutgoingFrame(std::move(msg)));
+            return;
+        }
+        auto self = shared_self();
+        dispatch(socket_.get_executor(), [self, msg = std::move(msg)]() mutable {
+            if (!self->socket_.is_open()) {
+                return;
             }
-            start_accept();
+            self->queue_message(std::move(msg));
         });
     }
 
-    void handle_connection(std::shared_ptr<ip::tcp::socket> socket) {
-        auto buffer = std::make_shared<std::string>();
+    void send(OutgoingFrame frame) override {
+        auto self = shared_self();
+        dispatch(socket_.get_executor(), [self, frame = std::move(frame)]() mutable {
+            if (!self->socket_.is_open()) {
+                return;
+            }
+            self->queue_frame(std::move(frame));
+            self->pump_writes();
+        });
+    }
+
+    void send_reliable(Message msg) override {
+        uint32_t session_id = msg.session_header.session_id;
+        if (session_id == 0) {
+            send(std::move(msg));
+            return;
+        }
+        auto self = shared_self();
+        dispatch(socket_.get_executor(), [self, session_id, msg = std::move(msg)]() mutable {
+            ReliableChannel* channel = self->reliable_channel(session_id, true);
+            if (self->socket_.is_open()) {
+                self->compress_message(msg, true);
+            }
+            self->reliable_frames_.clear();
+            channel->send(std::move(msg), self->id_, nullptr, self->reliable_frames_);
+            if (!self->socket_.is_open()) {
+                // 连接已断开：消息保留在会话中，等待客户端恢复会话后补发
+                channel->connection_lost(self->id_);
+                return;
+            }
+            self->write_reliable_frames();
+        });
+    }
+
+    bool send_stream(Message header, ByteSource source) override {
+        if (!StreamMux::flow_controlled(header.session_header)) {
+            return false;
+        }
+        auto self = shared_self();
+        dispatch(socket_.get_executor(), [self, header = std::move(header), source = std::move(source)]() mutable {
+            if (!self->socket_.is_open()) {
+                return;
+            }
+            self->mux_.enqueue(std::move(header), std::move(source));
+            self->pump_writes();
+        });
+        return true;
+    }
+
+    void close() override {
+        auto self = shared_self();
+        dispatch(socket_.get_executor(), [self]() { self->close_socket(); });
+    }
+
+    any_io_executor get_executor() override {
+        return socket_.get_executor();
+    }
+
+    uint64_t id() const override {
+        return id_;
+    }
 
-        async_read_until(*socket, dynamic_buffer(*buffer), "\r\n\r\n",
-            [this, socket, buffer](boost::system::error_code ec, size_t /*bytes*/) {
-                if (!ec) {
-                    ProtocolHandler handler;
-                    auto result = handler.parse(reinterpret_cast<const uint8_t*>(buffer->data()), buffer->size());
+private:
+    std::shared_ptr<ServerConnection> shared_self() {
+        return std::static_pointer_cast<ServerConnection>(shared_from_this());
+    }
+
+    // 所属线程持续过载：新请求直接拒绝，不交给应用
+    bool overloaded() const {
+        return monitor_ && monitor_->overloaded();
+    }
+
+    // 连接的协程会话：状态都在连接上，这里只转发
+    class WireSession final : public Session {
+    public:
+        explicit WireSession(ServerConnection& owner) : owner_(owner) {}
+
+        Connection& connection() override { return owner_; }
+
+    protected:
+        bool message_ready() override {
+            return !owner_.inbox_.empty() || owner_.rx_closed_ || !owner_.socket_.is_open();
+        }
+        std::optional<Message> take_message() override { return owner_.take_session_message(); }
+        bool enqueue(Message msg) override {
+            if (owner_.socket_.is_open()) {
+                owner_.queue_message(std::move(msg));
+            }
+            return !owner_.send_blocked();
+        }
+        void wait_message(std::coroutine_handle<> handle) override {
+            owner_.session_waiter_ = handle;
+            owner_.waiting_send_ = false;
+        }
+        void wait_send(std::coroutine_handle<> handle) override {
+            owner_.session_waiter_ = handle;
+            owner_.waiting_send_ = true;
+        }
+
+    private:
+        ServerConnection& owner_;
+    };
+
+    // 会话协程持有连接：处理函数返回后写完已排队的消息再关闭
+    static Task<void> run_session(std::shared_ptr<ServerConnection> self) {
+        try {
+            co_await self->context_.session_handler(*self->session_);
+        } catch (...) {
+            // 处理函数的异常只结束本连接
+        }
+        self->session_done_ = true;
+        if (self->socket_.is_open() && !self->writing_ && self->egress_.empty()) {
+            self->close_socket();
+        }
+    }
+
+    void start_session() {
+        session_ = std::make_unique<WireSession>(*this);
+        run_session(shared_self()).detach();
+    }
+
+    void resume_session() {
+        auto handle = std::exchange(session_waiter_, nullptr);
+        handle.resume();
+    }
+
+    std::optional<Message> take_session_message() {
+        if (inbox_.empty() || !socket_.is_open()) {
+            return std::nullopt;
+        }
+        Message msg = std::move(inbox_.front());
+        inbox_.pop_front();
+        resume_reading();
+        return msg;
+    }
 
-                    if (result == ProtocolHandler::ParseResult::HTTP) {
-                        send_http_response(socket);
-                    } else if (result == ProtocolHandler::ParseResult::BINARY) {
-                        handle_binary_protocol(socket, handler);
+    // 读端出错或对端关闭：会话取完已收到的消息后得到空
+    void read_failed() {
+        rx_closed_ = true;
+        if (session_waiter_ && !waiting_send_) {
+            resume_session();
+        }
+    }
+
+    // 会话收件队列已满或写队列积压时暂停读取，由会话取走消息或写出后恢复
+    void continue_reading() {
+        if (session_ && inbox_.size() >= SESSION_INBOX_LIMIT) {
+            read_paused_ = true;
+            return;
+        }
+        if (write_backlogged()) {
+            read_paused_ = true;
+            pause_peer();
+            return;
+        }
+        read_wire();
+    }
+
+    // 收件队列降到一半、写队列降到低水位后恢复读取
+    void resume_reading() {
+        if (!read_paused_ || !socket_.is_open()) {
+            return;
+        }
+        if ((session_ && inbox_.size() > SESSION_INBOX_LIMIT / 2) ||
+            queued_bytes_ > context_.backpressure.low_watermark) {
+            return;
+        }
+        read_paused_ = false;
+        if (peer_paused_) {
+            peer_paused_ = false;
+            queue_frame(OutgoingFrame(backpressure::make_signal(frame_session_.session_id, false)));
+            pump_writes();
+        }
+        read_wire();
+    }
+
+    // 写队列达到高水位，或服务器超出缓冲预算且本连接积压高于低水位
+    bool write_backlogged() const {
+        const BackpressureOptions& options = context_.backpressure;
+        if (options.high_watermark != 0 && queued_bytes_ >= options.high_watermark) {
+            return true;
+        }
+        return queued_bytes_ > options.low_watermark && context_.budget.exceeded();
+    }
+
+    // 会话的 send 在写队列帧数或字节数达到上限时挂起
+    bool send_blocked() const {
+        return egress_.size() + in_flight_.size() >= SESSION_SEND_LIMIT ||
+               (context_.backpressure.high_watermark != 0 && queued_bytes_ >= context_.backpressure.high_watermark);
+    }
+
+    // 通知对端暂停发送：PAUSE 是 CONTROL 帧，下一批写出时排在积压的数据前面
+    void pause_peer() {
+        if (peer_paused_) {
+            return;
+        }
+        peer_paused_ = true;
+        metrics::read_paused();
+        queue_frame(OutgoingFrame(backpressure::make_signal(frame_session_.session_id, true)));
+        pump_writes();
+    }
+
+    // 写队列的入口：按字节计入本连接与服务器的积压，由出口调度器决定写出顺序
+    void queue_frame(OutgoingFrame frame) {
+        queued_bytes_ += frame.size();
+        context_.budget.add(frame.size());
+        egress_.push(std::move(frame));
+    }
+
+    // 在连接线程上排队一条消息：压缩器属于连接，只在执行器上使用
+    void queue_message(Message msg) {
+        compress_message(msg, false);
+        if (StreamMux::flow_controlled(msg.session_header)) {
+            mux_.enqueue(std::move(msg));
+        } else {
+            queue_frame(OutgoingFrame(std::move(msg)));
+        }
+        pump_writes();
+    }
+
+    // 读满 size 字节：io_uring 后端经 ring 读取，否则走 Asio 反应器
+    template <typename Handler>
+    void read_exact(void* data, size_t size, Handler&& handler) {
+        if (uring_) {
+            uring_->async_read(data, size, make_custom_alloc_handler(read_memory_, std::forward<Handler>(handler)));
+        } else {
+            async_read(socket_, buffer(data, size),
+                       make_custom_alloc_handler(read_memory_, std::forward<Handler>(handler)));
+        }
+    }
+
+    // 读到至少 1 字节
+    template <typename Handler>
+    void read_some(void* data, size_t size, Handler&& handler) {
+        if (uring_) {
+            uring_->async_read_some(data, size,
+                                    make_custom_alloc_handler(read_memory_, std::forward<Handler>(handler)));
+        } else {
+            socket_.async_read_some(buffer(data, size),
+                                    make_custom_alloc_handler(read_memory_, std::forward<Handler>(handler)));
+        }
+    }
+
+    // 首帧：先读基础头以识别模式
+    void read_base_header() {
+        auto self = shared_self();
+        read_exact(header_.data(), sizeof(BaseHeader),
+            [self](boost::system::error_code ec, size_t bytes) {
+                metrics::bytes_received(bytes);
+                if (ec) {
+                    return;
+                }
+                auto result = self->parser_.parse(self->header_.data(), sizeof(BaseHeader));
+                if (result == ProtocolHandler::ParseResult::HTTP) {
+                    self->start_http(false);
+                } else if (result == ProtocolHandler::ParseResult::NEED_MORE) {
+                    // 已读的基础头属于第一帧，放入读缓冲区开头
+                    self->compact_rx();
+                    std::memcpy(self->rx_buffer_.data(), self->header_.data(), sizeof(BaseHeader));
+                    self->rx_end_ = sizeof(BaseHeader);
+                    if (self->context_.session_handler) {
+                        self->start_session();
                     }
+                    self->read_wire();
+                } else if (ProtocolHandler::is_http_request(self->header_.data(), sizeof(BaseHeader))) {
+                    // 不带 HWP 前缀的普通 HTTP：已读的 8 字节属于请求行
+                    self->start_http(true);
+                } else {
+                    metrics::parse_error();
+                    self->close_socket();
                 }
             });
     }
 
-    void send_http_response(std::shared_ptr<ip::tcp::socket> socket) {
-        std::string response =
-                "HTTP/1.1 200 OK\r\n"
-                "Content-Length: 13\r\n"
-                "\r\n"
-                "Hello, Hybrid!";
-        async_write(*socket, buffer(response), [socket](boost::system::error_code /*ec*/, size_t /*bytes*/) {});
+    // Wire 模式：一次读取尽量多的数据，缓冲区内的完整帧批量解码后逐个处理
+    void read_wire() {
+        if (rx_begin_ == rx_end_) {
+            rx_begin_ = 0;
+            rx_end_ = 0;
+        }
+        if (rx_buffer_.size() - rx_end_ < WIRE_READ_CHUNK / 2) {
+            compact_rx();
+        }
+        auto self = shared_self();
+        read_some(rx_buffer_.data() + rx_end_, rx_buffer_.size() - rx_end_,
+            [self](boost::system::error_code ec, size_t bytes) {
+                metrics::bytes_received(bytes);
+                if (ec) {
+                    self->read_failed();
+                    return;
+                }
+                self->rx_end_ += bytes;
+                self->process_frames();
+            });
+    }
+
+    // 末尾不完整的帧移到缓冲区开头（只搬移这一段），并保证至少 WIRE_READ_CHUNK 的空闲空间
+    void compact_rx() {
+        size_t pending = rx_end_ - rx_begin_;
+        if (rx_begin_ > 0) {
+            std::memmove(rx_buffer_.data(), rx_buffer_.data() + rx_begin_, pending);
+            rx_begin_ = 0;
+            rx_end_ = pending;
+        }
+        if (rx_buffer_.size() < pending + WIRE_READ_CHUNK) {
+            rx_buffer_.resize(pending + WIRE_READ_CHUNK);
+        }
+    }
+
+    void process_frames() {
+        uint64_t decode_start = metrics::now();
+        auto status = decoder_.decode(rx_buffer_.data() + rx_begin_, rx_end_ - rx_begin_);
+        metrics::observe_since(metrics::Histogram::PARSE, decode_start);
+        for (const FrameView& frame : decoder_.frames()) {
+            if (!socket_.is_open()) {
+                return;
+            }
+            handle_frame(frame);
+        }
+        if (!socket_.is_open()) {
+            return;
+        }
+        rx_begin_ += decoder_.consumed();
+        if (status == FrameDecoder::Status::ERROR) {
+            metrics::parse_error();
+            close_socket();
+            return;
+        }
+        if (decoder_.has_pending()) {
+            const FrameView& frame = decoder_.pending();
+            size_t have = rx_end_ - rx_begin_ - FRAME_HEADER_SIZE;
+            if (frame.session.msg_type == MessageType::FILE_TRANSFER_DATA) {
+                if (have >= transfer::DATA_PREFIX_SIZE) {
+                    start_file_data(frame, have);
+                    return;
+                }
+            } else if (decoder_.required() > WIRE_READ_CHUNK) {
+                read_large_payload(frame, have);
+                return;
+            }
+        }
+        continue_reading();
+    }
+
+    // 缓冲区内的一帧完整消息：负载拷入独立缓冲区交给处理流程（文件数据直接写入文件）
+    void handle_frame(const FrameView& frame) {
+        capture_frame(frame, frame.payload, frame.session.payload_len);
+        frame_base_ = frame.base;
+        frame_session_ = frame.session;
+        size_t length = frame.session.payload_len;
+        if (frame.session.msg_type == MessageType::FILE_TRANSFER_DATA) {
+            metrics::message_received(frame.session.msg_type);
+            if (!accept_file_offset(frame.payload, length) ||
+                !sink_->write(frame.payload + transfer::DATA_PREFIX_SIZE, length - transfer::DATA_PREFIX_SIZE)) {
+                close_socket();
+            }
+            return;
+        }
+        if (payload_.capacity() == 0) {
+            payload_ = pool::acquire_buffer(length);
+        } else {
+            payload_.resize(length);
+        }
+        std::memcpy(payload_.data(), frame.payload, length);
+        handle_binary_protocol();
+    }
+
+    // 抓包：记录收到的一帧，未开启时只有一次判空
+    void capture_frame(const FrameView& frame, const uint8_t* payload, size_t length) {
+        if (context_.capture) {
+            context_.capture->record(id_, frame.base, frame.session, payload, length);
+        }
+    }
+
+    // 超过读缓冲区的大帧：已到达的部分拷入负载缓冲区，其余直接读入，不经过读缓冲区
+    void read_large_payload(const FrameView& frame, size_t have) {
+        frame_base_ = frame.base;
+        frame_session_ = frame.session;
+        size_t length = frame.session.payload_len;
+        if (payload_.capacity() == 0) {
+            payload_ = pool::acquire_buffer(length);
+        } else {
+            payload_.resize(length);
+        }
+        std::memcpy(payload_.data(), frame.payload, have);
+        rx_begin_ = 0;
+        rx_end_ = 0;
+        auto self = shared_self();
+        read_exact(payload_.data() + have, length - have,
+            [self](boost::system::error_code ec, size_t bytes) {
+                metrics::bytes_received(bytes);
+                if (ec) {
+                    self->read_failed();
+                    return;
+                }
+                if (self->context_.capture) {
+                    self->context_.capture->record(self->id_, self->frame_base_, self->frame_session_,
+                                                   self->payload_.data(), self->payload_.size());
+                }
+                self->handle_binary_protocol();
+                if (self->socket_.is_open()) {
+                    self->continue_reading();
+                }
+            });
+    }
+
+    void handle_binary_protocol() {
+        const SessionHeader& header = frame_session_;
+        metrics::message_received(header.msg_type);
+        uint64_t dispatch_start = metrics::now();
+        if (header.msg_type == MessageType::HANDSHAKE) {
+            handle_handshake();
+        } else if (header.msg_type == MessageType::FILE_TRANSFER_START) {
+            handle_transfer_start();
+        } else if (header.msg_type == MessageType::FILE_TRANSFER_END) {
+            handle_transfer_end();
+        } else {
+            // 每条消息刷新会话的 LRU 位置与 TTL
+            bool fresh = true;
+            if (header.session_id != 0) {
+                context_.sessions.touch(header.session_id);
+                fresh = track_sequence();
+            }
+            if (fresh) {
+                dispatch_message();
+            }
+        }
+        payload_.clear();
+        metrics::observe_since(metrics::Histogram::DISPATCH, dispatch_start);
+    }
+
+    // 握手：session_id 为 0 时分配新会话，否则恢复原会话；回复携带最终的 session_id。
+    // 请求的会话不存在（已过期、本端重启或由代理分配）时沿用该 id 新建，
+    // 按 session_id 选择后端的代理因此总能把同一会话送到同一后端。
+    // 代理分配的 id 置 PROXY_SESSION_ID_BIT，本端分配的不置，沿用时不会并入本端的其他会话；
+    // 代理为新会话分配的 id 带 NEW_SESSION，只新建不恢复，已被占用时回复 ERROR(SESSION_EXISTS)
+    void handle_handshake() {
+        SessionState state;
+        uint32_t requested = frame_session_.session_id;
+        bool create_only = (frame_base_.flags & static_cast<uint8_t>(Flags::NEW_SESSION)) != 0;
+        // 负载即客户端标识，只保留前 MAX_CLIENT_ID_LEN 字节，空闲会话的内存占用不随负载增长
+        std::string client_id(payload_.begin(),
+                              payload_.begin() + static_cast<std::ptrdiff_t>(std::min(payload_.size(), MAX_CLIENT_ID_LEN)));
+        Message request;
+        request.session_header = frame_session_;
+        if (requested == 0) {
+            state = context_.sessions.create(client_id);
+            context_.drop_channel(state.session_id);
+        } else if (create_only) {
+            state = ProtocolHandler::create_session(client_id);
+            state.session_id = requested;
+            if (!context_.sessions.insert(state, false)) {
+                send(ProtocolHandler::create_error(request, ErrorCode::SESSION_EXISTS));
+                return;
+            }
+            context_.drop_channel(state.session_id);
+        } else if (!context_.sessions.find(requested, state)) {
+            state = ProtocolHandler::create_session(client_id);
+            state.session_id = requested;
+            context_.sessions.insert(state);
+        }
+        request.session_header.session_id = state.session_id;
+        send(ProtocolHandler::create_reply(request, MessageType::HANDSHAKE, std::vector<uint8_t>()));
+
+        // 恢复会话且对端请求时紧接着发送本端的接收状态，对端据此只补发未确认的部分
+        bool resumed = requested != 0 && requested == state.session_id && !create_only;
+        if (resumed && (frame_base_.flags & static_cast<uint8_t>(Flags::REQUIRES_ACK))) {
+            ReliableChannel* channel = reliable_channel(state.session_id, true);
+            if (request.session_header.seq_num != 0) {
+                channel->on_receive(request.session_header.seq_num, false);
+            }
+            send(OutgoingFrame(channel->make_ack(state.session_id)));
+        }
+    }
+
+    // 连接通常只服务一个会话，缓存其可靠传输状态
+    ReliableChannel* reliable_channel(uint32_t session_id, bool create) {
+        if (reliable_ && reliable_session_ == session_id) {
+            return reliable_.get();
+        }
+        auto channel = context_.channel(session_id, create);
+        if (!channel) {
+            return nullptr;
+        }
+        send_ack();
+        reliable_ = std::move(channel);
+        reliable_session_ = session_id;
+        return reliable_.get();
+    }
+
+    // 会话内序列号：可靠消息去重并安排确认，普通消息只记录以推进累计确认号。
+    // 返回 false 表示重复的可靠消息，不再交给应用
+    bool track_sequence() {
+        const BaseHeader& base = frame_base_;
+        const SessionHeader& header = frame_session_;
+        // 分片消息只在最后一帧记录
+        if (header.seq_num == 0 || header.msg_type == MessageType::CONTROL ||
+            (base.flags & static_cast<uint8_t>(Flags::MORE))) {
+            return true;
+        }
+        bool reliable = (base.flags & static_cast<uint8_t>(Flags::REQUIRES_ACK)) != 0;
+        ReliableChannel* channel = reliable_channel(header.session_id, reliable);
+        if (!channel) {
+            return true;
+        }
+        auto received = channel->on_receive(header.seq_num, reliable);
+        if (reliable) {
+            // 对端窗口已满或正在补发时立即确认，否则延迟合并
+            schedule_ack((base.flags & static_cast<uint8_t>(Flags::ACK_NOW)) ||
+                         received == ReliableChannel::Receive::DUPLICATE);
+        }
+        return received != ReliableChannel::Receive::DUPLICATE;
+    }
+
+    void schedule_ack(bool immediate) {
+        ++ack_pending_;
+        if (immediate || ack_pending_ >= context_.reliable.ack_every) {
+            send_ack();
+            return;
+        }
+        if (ack_timer_armed_) {
+            return;
+        }
+        if (!ack_timer_) {
+            ack_timer_ = std::make_unique<steady_timer>(socket_.get_executor());
+        }
+        ack_timer_armed_ = true;
+        ack_timer_->expires_after(context_.reliable.ack_delay);
+        auto self = shared_self();
+        ack_timer_->async_wait([self](boost::system::error_code ec) {
+            self->ack_timer_armed_ = false;
+            if (!ec && self->socket_.is_open()) {
+                self->send_ack();
+            }
+        });
+    }
+
+    void send_ack() {
+        if (ack_pending_ == 0 || !reliable_) {
+            return;
+        }
+        ack_pending_ = 0;
+        queue_frame(OutgoingFrame(reliable_->make_ack(reliable_session_)));
+        pump_writes();
+    }
+
+    void write_reliable_frames() {
+        for (auto& frame : reliable_frames_) {
+            queue_frame(std::move(frame));
+        }
+        reliable_frames_.clear();
+        pump_writes();
+    }
+
+    // 文件传输开始：打开（或续传）接收文件，回复续传偏移
+    void handle_transfer_start() {
+        transfer::TransferStatus status = transfer::TransferStatus::REJECTED;
+        uint64_t offset = 0;
+        if (!sink_ && payload_.size() > 8) {
+            uint64_t total_size = transfer::get_u64(payload_.data());
+            std::string name(payload_.begin() + 8, payload_.end());
+            auto sink = std::make_unique<transfer::FileSink>();
+            status = sink->open(context_.transfer_dir, name, total_size);
+            if (status == transfer::TransferStatus::OK) {
+                offset = sink->state().bytes_transferred;
+                sink_ = std::move(sink);
+            }
+        }
+        send_transfer_reply(MessageType::FILE_TRANSFER_START, status, offset);
+    }
+
+    void handle_transfer_end() {
+        transfer::TransferStatus status = transfer::TransferStatus::REJECTED;
+        uint64_t received = 0;
+        if (sink_ && payload_.size() == 8) {
+            status = sink_->finish(transfer::get_u64(payload_.data()));
+            received = sink_->state().bytes_transferred;
+        }
+        sink_.reset();
+        send_transfer_reply(MessageType::FILE_TRANSFER_END, status, received);
+    }
+
+    void send_transfer_reply(MessageType type, transfer::TransferStatus status, uint64_t value) {
+        std::vector<uint8_t> payload(9);
+        payload[0] = static_cast<uint8_t>(status);
+        transfer::put_u64(payload.data() + 1, value);
+        Message request;
+        request.session_header = frame_session_;
+        send(ProtocolHandler::create_reply(request, type, std::move(payload)));
     }
 
-    void handle_binary_protocol(std::shared_ptr<ip::tcp::socket> /*socket*/,
-                              const ProtocolHandler& /*handler*/) {
-        // TODO: 实现具体的二进制协议处理逻辑
+    // 文件数据帧只接受顺序数据；偏移不符说明双方续传位置不一致，超出 START 声明的大小也不接受
+    bool accept_file_offset(const uint8_t* payload, size_t length) const {
+        if (!sink_ || length < transfer::DATA_PREFIX_SIZE) {
+            return false;
+        }
+        const FileTransferState& state = sink_->state();
+        return transfer::get_u64(payload) == state.bytes_transferred &&
+               length - transfer::DATA_PREFIX_SIZE <= state.total_size - state.bytes_transferred;
     }
 
-    ip::tcp::acceptor acceptor_;
+    // 跨读取的文件数据帧：缓冲区中已到达的部分直接写入文件，
+    // 其余不经过用户态缓冲区，从 socket splice 进文件
+    void start_file_data(const FrameView& frame, size_t have) {
+        // 其余负载 splice 直接落盘，不经过用户态：只记录已在读缓冲区中的一段
+        capture_frame(frame, frame.payload, have);
+        metrics::message_received(frame.session.msg_type);
+        frame_base_ = frame.base;
+        frame_session_ = frame.session;
+        size_t length = frame.session.payload_len;
+        size_t buffered = have - transfer::DATA_PREFIX_SIZE;
+        if (!accept_file_offset(frame.payload, length) ||
+            !sink_->write(frame.payload + transfer::DATA_PREFIX_SIZE, buffered)) {
+            close_socket();
+            return;
+        }
+        rx_begin_ = 0;
+        rx_end_ = 0;
+        file_remaining_ = length - transfer::DATA_PREFIX_SIZE - buffered;
+        splice_file_data();
+    }
+
+    void splice_file_data() {
+        while (file_remaining_ > 0) {
+            ssize_t n = sink_->splice_from(socket_.native_handle(), file_remaining_);
+            if (n > 0) {
+                metrics::bytes_received(static_cast<size_t>(n));
+                file_remaining_ -= static_cast<size_t>(n);
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                auto self = shared_self();
+                socket_.async_wait(ip::tcp::socket::wait_read, make_custom_alloc_handler(read_memory_,
+                    [self](boost::system::error_code ec) {
+                        if (ec) {
+                            self->read_failed();
+                            return;
+                        }
+                        self->splice_file_data();
+                    }));
+                return;
+            }
+            // 对端关闭或写文件失败：已落盘部分保留，下次 START 时续传
+            close_socket();
+            return;
+        }
+        continue_reading();
+    }
+
+    // 压缩一条待发消息；需要先行通告的字典直接排入写队列，保证先于该消息写出
+    void compress_message(Message& msg, bool self_contained) {
+        dictionary_frames_.clear();
+        compressor_.compress(msg, announced_dictionary_, dictionary_frames_, self_contained);
+        for (auto& dictionary : dictionary_frames_) {
+            queue_frame(OutgoingFrame(std::move(dictionary)));
+        }
+    }
+
+    void dispatch_message() {
+        Message msg;
+        msg.base_header = frame_base_;
+        msg.session_header = frame_session_;
+        msg.payload = std::move(payload_);
+
+        // 流控窗口更新由连接自己处理，不交给应用
+        uint32_t increment = 0;
+        if (StreamMux::parse_window_update(msg, increment)) {
+            payload_ = std::move(msg.payload);
+            if (!mux_.on_window_update(msg.session_header.stream_id, increment)) {
+                close_socket();
+                return;
+            }
+            pump_writes();
+            return;
+        }
+
+        // 可靠消息的确认：释放已确认消息，补发与窗口腾出后的排队消息从本连接写出
+        AckInfo ack;
+        uint32_t forward = 0;
+        if (ReliableChannel::parse_ack(msg, ack)) {
+            payload_ = std::move(msg.payload);
+            if (ReliableChannel* channel = reliable_channel(ack.session_id, false)) {
+                reliable_frames_.clear();
+                channel->on_ack(ack, id_, reliable_frames_);
+                write_reliable_frames();
+            }
+            return;
+        }
+        if (ReliableChannel::parse_forward(msg, forward)) {
+            payload_ = std::move(msg.payload);
+            if (ReliableChannel* channel = reliable_channel(msg.session_header.session_id, false)) {
+                channel->on_forward(forward);
+            }
+            return;
+        }
+
+        // 压缩字典通告
+        bool dictionary_ok = true;
+        if (decompressor_.on_control(msg, dictionary_ok)) {
+            payload_ = std::move(msg.payload);
+            if (!dictionary_ok) {
+                close_socket();
+            }
+            return;
+        }
+
+        flow_updates_.clear();
+        uint64_t offset = 0;
+        auto inbound = mux_.on_frame(msg, flow_updates_, &offset);
+        if (inbound == StreamMux::Inbound::VIOLATION) {
+            close_socket();
+            return;
+        }
+        if (inbound == StreamMux::Inbound::CHUNK) {
+            // 流式消息：每段交给应用后即归还窗口，应用未取走的缓冲区留给下一帧
+            PayloadChunk chunk;
+            chunk.header = msg.session_header;
+            chunk.offset = offset;
+            chunk.last = !(msg.base_header.flags & static_cast<uint8_t>(Flags::MORE));
+            chunk.data = std::move(msg.payload);
+            context_.chunk_handler(shared_from_this(), chunk);
+            mux_.consumed(chunk.header, flow_updates_);
+            msg.payload = std::move(chunk.data);
+        }
+        if (inbound == StreamMux::Inbound::DELIVER) {
+            SessionHeader header = msg.session_header;
+            // 可靠消息此时已记录并安排了确认，对端不会重发：过载时也照常交付
+            bool reliable = (msg.base_header.flags & static_cast<uint8_t>(Flags::REQUIRES_ACK)) != 0;
+            if (overloaded() && !reliable) {
+                context_.shed.fetch_add(1, std::memory_order_relaxed);
+                metrics::request_shed();
+                queue_frame(OutgoingFrame(ProtocolHandler::create_error(msg, ErrorCode::OVERLOADED)));
+                pump_writes();
+            } else if (!decompressor_.decompress(msg)) {
+                close_socket();
+                return;
+            } else if (session_) {
+                // 交给会话协程：等待中的协程在这里恢复，处理完后回到帧循环
+                inbox_.push_back(std::move(msg));
+                if (session_waiter_ && !waiting_send_) {
+                    resume_session();
+                }
+            } else if (const MessageHandler& handler = context_.handler) {
+                handler(shared_from_this(), msg);
+            }
+            // 应用处理完（或排入会话收件队列）后归还窗口
+            mux_.consumed(header, flow_updates_);
+        }
+        // 回调未取走负载时保留缓冲区供下一帧复用
+        payload_ = std::move(msg.payload);
+        for (auto& update : flow_updates_) {
+            send(OutgoingFrame(std::move(update)));
+        }
+    }
+
+    void start_http(bool keep_sniffed) {
+        http_buffer_.resize(HTTP_READ_CHUNK);
+        http_begin_ = 0;
+        http_end_ = 0;
+        if (keep_sniffed) {
+            std::memcpy(http_buffer_.data(), header_.data(), sizeof(BaseHeader));
+            http_end_ = sizeof(BaseHeader);
+            handle_http();
+        } else {
+            read_http();
+        }
+    }
+
+    void read_http() {
+        // 未完成的请求移到缓冲区开头（解析器偏移量相对请求开头，不受影响），空间不足时扩容
+        if (http_begin_ > 0) {
+            std::memmove(http_buffer_.data(), http_buffer_.data() + http_begin_, http_end_ - http_begin_);
+            http_end_ -= http_begin_;
+            http_begin_ = 0;
+        }
+        if (http_buffer_.size() - http_end_ < HTTP_READ_CHUNK) {
+            http_buffer_.resize(std::max(http_buffer_.size() * 2, http_end_ + HTTP_READ_CHUNK));
+        }
+        auto self = shared_self();
+        socket_.async_read_some(buffer(http_buffer_.data() + http_end_, http_buffer_.size() - http_end_),
+            make_custom_alloc_handler(read_memory_, [self](boost::system::error_code ec, size_t bytes) {
+                metrics::bytes_received(bytes);
+                if (ec) {
+                    self->close_socket();
+                    return;
+                }
+                self->http_end_ += bytes;
+                self->handle_http();
+            }));
+    }
+
+    // 处理缓冲区内所有完整请求，响应按顺序追加到同一输出缓冲区
+    void handle_http() {
+        bool close_after = false;
+        for (;;) {
+            auto status = http_parser_.parse(http_buffer_.data() + http_begin_, http_end_ - http_begin_, http_request_);
+            if (status == http::ParseStatus::NEED_MORE) {
+                break;
+            }
+            http_response_.reset();
+            if (status == http::ParseStatus::ERROR) {
+                metrics::parse_error();
+                http_response_.status = 400;
+                http_response_.close = true;
+                http::serialize_response(http_response_, false, http_out_);
+                close_after = true;
+                break;
+            }
+
+            metrics::http_request();
+            if (metrics::enabled() && context_.metrics_endpoint && http_request_.target == "/metrics" &&
+                (http_request_.method == "GET" || http_request_.method == "HEAD")) {
+                // 同端口提供 Prometheus 抓取，不经过应用回调
+                http_response_.content_type = "text/plain; version=0.0.4";
+                metrics::render_prometheus(http_response_.body);
+            } else if (overloaded()) {
+                context_.shed.fetch_add(1, std::memory_order_relaxed);
+                metrics::request_shed();
+                http_response_.status = 503;
+                http_response_.set_header("Retry-After", "1");
+            } else {
+                const HttpHandler& handler = context_.http_handler ? context_.http_handler : default_http_handler;
+                handler(http_request_, http_response_);
+            }
+            http_response_.close = http_response_.close || !http_request_.keep_alive;
+            http::serialize_response(http_response_, http_request_.method == "HEAD", http_out_);
+            http_begin_ += http_parser_.consumed();
+            http_parser_.reset();
+            if (http_response_.close) {
+                close_after = true;
+                break;
+            }
+        }
+
+        if (!http_out_.empty()) {
+            write_http(close_after);
+        } else if (close_after) {
+            close_socket();
+        } else {
+            read_http();
+        }
+    }
+
+    void write_http(bool close_after) {
+        auto self = shared_self();
+        write_start_ = metrics::now();
+        async_write(socket_, buffer(http_out_), make_custom_alloc_handler(write_memory_,
+            [self, close_after](boost::system::error_code ec, size_t bytes) {
+                metrics::bytes_sent(bytes);
+                metrics::observe_since(metrics::Histogram::WRITE, self->write_start_);
+                self->http_out_.clear();
+                if (ec || close_after) {
+                    boost::system::error_code ignored;
+                    self->socket_.shutdown(ip::tcp::socket::shutdown_send, ignored);
+                    self->close_socket();
+                    return;
+                }
+                self->read_http();
+            }));
+    }
+
+    // 不受流控的帧直接排队；写队列空时才从各流按窗口取帧，
+    // 因此控制消息最多只需等待一批正在写出的数据
+    void pump_writes() {
+        if (writing_) {
+            return;
+        }
+        if (egress_.empty()) {
+            OutgoingFrame frame;
+            while (egress_.size() < MAX_GATHER_FRAMES && mux_.next_frame(frame)) {
+                queue_frame(std::move(frame));
+            }
+        }
+        if (!egress_.empty()) {
+            do_write();
+        }
+    }
+
+    // 按调度顺序取出一批帧（至多 MAX_GATHER_FRAMES 帧，超过 batch_bytes 后停止），
+    // 聚合为一次 writev：每帧贡献 {帧头, 负载} 两段
+    void do_write() {
+        size_t batch_bytes = 0;
+        OutgoingFrame frame;
+        while (in_flight_.size() < MAX_GATHER_FRAMES && batch_bytes < egress_.batch_bytes() && egress_.pop(frame)) {
+            batch_bytes += frame.size();
+            in_flight_.push_back(std::move(frame));
+        }
+        write_buffers_.clear();
+        for (const auto& outgoing : in_flight_) {
+            auto buffers = outgoing.buffers();
+            write_buffers_.push_back(buffers[0]);
+            if (buffers[1].size() > 0) {
+                write_buffers_.push_back(buffers[1]);
+            }
+        }
+
+        writing_ = true;
+        write_start_ = metrics::now();
+        auto self = shared_self();
+        auto on_write = make_custom_alloc_handler(write_memory_,
+            [self](boost::system::error_code ec, size_t bytes) {
+                metrics::bytes_sent(bytes);
+                metrics::observe_since(metrics::Histogram::WRITE, self->write_start_);
+                if (ec) {
+                    self->close_socket();
+                    return;
+                }
+                // 已写出帧的负载缓冲区归还线程池
+                metrics::frames_sent(self->in_flight_.size());
+                size_t written = 0;
+                for (auto& outgoing : self->in_flight_) {
+                    written += outgoing.size();
+                    pool::release_buffer(outgoing.release_payload());
+                }
+                self->in_flight_.clear();
+                self->queued_bytes_ -= written;
+                self->context_.budget.release(written);
+                self->writing_ = false;
+                self->pump_writes();
+                self->resume_reading();
+                if (self->session_waiter_ && self->waiting_send_ && !self->send_blocked()) {
+                    self->resume_session();
+                }
+                if (self->session_done_ && !self->writing_ && self->egress_.empty()) {
+                    self->close_socket();
+                }
+            });
+        if (uring_) {
+            uring_->async_write(write_buffers_, std::move(on_write));
+        } else {
+            async_write(socket_, BufferRange(write_buffers_), std::move(on_write));
+        }
+    }
+
+    void close_socket() {
+        boost::system::error_code ignored;
+        // 先同步取消 ring 中的读写，内核不再引用 fd 与缓冲区后再关闭
+        if (uring_) {
+            uring_->shutdown();
+        }
+        socket_.close(ignored);
+        egress_.clear();
+        in_flight_.clear();
+        context_.budget.release(queued_bytes_);
+        queued_bytes_ = 0;
+        if (ack_timer_) {
+            ack_timer_->cancel();
+        }
+        if (reliable_) {
+            reliable_->connection_lost(id_);
+        }
+        inbox_.clear();
+        if (session_waiter_) {
+            // 会话协程可能在恢复后结束并释放对连接的引用
+            auto self = shared_self();
+            resume_session();
+        }
+    }
+
+    ip::tcp::socket socket_;
+    ServerContext& context_;
+    uint64_t id_;
+    const LoadMonitor* monitor_;        // 所属线程的负载探针，未启用时为空
+    ProtocolHandler parser_;
+    std::array<uint8_t, sizeof(BaseHeader)> header_{};
+    FrameDecoder decoder_;
+    std::vector<uint8_t> rx_buffer_;
+    size_t rx_begin_ = 0;
+    size_t rx_end_ = 0;
+    BaseHeader frame_base_{};           // 当前处理的帧
+    SessionHeader frame_session_{};
+    std::vector<uint8_t> payload_;
+    std::unique_ptr<transfer::FileSink> sink_;
+    size_t file_remaining_ = 0;
+    std::vector<char> http_buffer_;
+    size_t http_begin_ = 0;
+    size_t http_end_ = 0;
+    http::RequestParser http_parser_;
+    http::Request http_request_;
+    http::Response http_response_;
+    std::string http_out_;
+    EgressScheduler egress_;            // 待写出的帧
+    std::vector<OutgoingFrame> in_flight_;  // 正在写出的一批帧
+    std::vector<const_buffer> write_buffers_;
+    bool writing_ = false;
+    size_t queued_bytes_ = 0;       // 写队列中帧的总字节数（含正在写出的一批，背压）
+    bool peer_paused_ = false;      // 已向对端发送 PAUSE，尚未 RESUME
+    StreamMux mux_;
+    std::vector<Message> flow_updates_;
+    std::shared_ptr<ReliableChannel> reliable_;
+    uint32_t reliable_session_ = 0;
+    std::vector<OutgoingFrame> reliable_frames_;
+    uint32_t ack_pending_ = 0;
+    std::unique_ptr<steady_timer> ack_timer_;
+    bool ack_timer_armed_ = false;
+    compress::Compressor compressor_;
+    compress::Decompressor decompressor_;
+    uint32_t announced_dictionary_ = 0;
+    std::vector<Message> dictionary_frames_;
+    HandlerMemory read_memory_;
+    HandlerMemory write_memory_;
+    std::unique_ptr<uring::Socket> uring_;
+    uint64_t write_start_ = 0;      // 当前写开始的时刻（指标）
+    std::unique_ptr<WireSession> session_;
+    std::deque<Message, PoolAllocator<Message>> inbox_;     // 会话尚未取走的消息
+    std::coroutine_handle<> session_waiter_;                // 挂起在 read_message / send 上的会话协程
+    bool waiting_send_ = false;
+    bool read_paused_ = false;
+    bool rx_closed_ = false;
+    bool session_done_ = false;
+};
+
+} // namespace
+
+class Server::Impl {
+public:
+    // 单线程模式：使用调用方的 io_context
+    Impl(io_context& io, unsigned short port) : context_(SessionTableOptions()) {
+        workers_.emplace_back(std::make_unique<Worker>(io));
+        workers_.front()->open_acceptor(port, false);
+        start_accept(*workers_.front());
+        start_session_timer();
+    }
+
+    // 多线程模式：每个线程一个 io_context
+    explicit Impl(const ServerOptions& options)
+        : context_(options.sessions, options.transfer_dir, options.flow, options.reliable,
+                   options.compression, options.metrics_endpoint, options.backpressure, options.admission,
+                   options.egress),
+          owns_threads_(true) {
+        std::size_t threads = options.threads == 0 ? 1 : options.threads;
+        bool reuse_port = options.reuse_port;
+        if (!options.capture.path.empty()) {
+            context_.capture = std::make_unique<capture::CaptureWriter>();
+            if (!context_.capture->open(options.capture)) {
+                context_.capture.reset();
+            }
+        }
+#ifndef SO_REUSEPORT
+        reuse_port = false;
+#endif
+        for (std::size_t i = 0; i < threads; ++i) {
+            workers_.emplace_back(std::make_unique<Worker>());
+            // 内核不支持 io_uring 时 ring 为空，该线程回落到反应器
+            if (options.backend == IoBackend::IO_URING) {
+                workers_.back()->ring = uring::ring_for(*workers_.back()->io);
+            }
+            if (options.admission.queue_delay.target.count() > 0) {
+                workers_.back()->monitor = std::make_unique<LoadMonitor>(*workers_.back()->io,
+                                                                         options.admission.queue_delay);
+                workers_.back()->monitor->start();
+            }
+        }
+
+        // 第一个监听器决定实际端口（支持端口0），其余线程复用该端口
+        workers_.front()->open_acceptor(options.port, reuse_port && threads > 1);
+        unsigned short bound = workers_.front()->acceptor->local_endpoint().port();
+        handoff_ = !reuse_port && threads > 1;
+        if (reuse_port) {
+            for (std::size_t i = 1; i < workers_.size(); ++i) {
+                workers_[i]->open_acceptor(bound, true);
+            }
+        }
+
+        for (auto& worker : workers_) {
+            if (worker->acceptor) {
+                start_accept(*worker);
+            }
+        }
+        start_session_timer();
+    }
+
+    ~Impl() {
+        // 单线程模式下调用方的 io_context 比服务器活得久，不能再投递引用本对象的回调：就地关闭
+        if (!owns_threads_) {
+            alive_.reset();
+            close_local();
+            return;
+        }
+        stop();
+    }
+
+    void run() {
+        if (!owns_threads_ || running_.exchange(true)) {
+            return;
+        }
+        for (auto& worker : workers_) {
+            worker->start();
+        }
+    }
+
+    void stop() {
+        if (!owns_threads_) {
+            // 在事件循环线程上直接关闭；从其他线程调用时投递过去，服务器先被销毁则回调不再执行
+            if (workers_.front()->io->get_executor().running_in_this_thread()) {
+                close_local();
+            } else {
+                post(*workers_.front()->io, [this, alive = std::weak_ptr<void>(alive_)]() {
+                    if (alive.lock()) {
+                        close_local();
+                    }
+                });
+            }
+            return;
+        }
+        if (session_timer_) {
+            post(session_timer_->get_executor(), [this]() { session_timer_->cancel(); });
+        }
+        for (auto& worker : workers_) {
+            worker->stop();
+        }
+        for (auto& worker : workers_) {
+            worker->join();
+        }
+        running_ = false;
+        // 事件循环都已退出，不会再有记录：写出抓包文件的剩余部分
+        if (context_.capture) {
+            context_.capture->close();
+        }
+    }
+
+    void set_message_handler(MessageHandler handler) {
+        context_.handler = std::move(handler);
+    }
+
+    void set_session_handler(SessionHandler handler) {
+        context_.session_handler = std::move(handler);
+    }
+
+    void set_chunk_handler(ChunkHandler handler) {
+        context_.flow.stream_payloads = static_cast<bool>(handler);
+        context_.chunk_handler = std::move(handler);
+    }
+
+    void set_http_handler(HttpHandler handler) {
+        context_.http_handler = std::move(handler);
+    }
+
+    SessionTable& sessions() {
+        return context_.sessions;
+    }
+
+    unsigned short port() const {
+        return workers_.front()->acceptor->local_endpoint().port();
+    }
+
+    std::size_t thread_count() const {
+        return workers_.size();
+    }
+
+    bool capturing() const {
+        return context_.capture && context_.capture->is_open();
+    }
+
+    capture::CaptureStats capture_stats() const {
+        return context_.capture ? context_.capture->stats() : capture::CaptureStats();
+    }
+
+    AdmissionStats admission_stats() const {
+        AdmissionStats s;
+        auto rejected = [this](metrics::Rejection reason) {
+            return context_.rejected[static_cast<std::size_t>(reason)].load(std::memory_order_relaxed);
+        };
+        s.rejected_limit = rejected(metrics::Rejection::LIMIT);
+        s.rejected_rate = rejected(metrics::Rejection::RATE);
+        s.rejected_overload = rejected(metrics::Rejection::OVERLOAD);
+        s.shed = context_.shed.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    // 事件循环线程：连接在哪个线程被接受就固定在哪个线程处理
+    struct Worker : detail::IoWorker {
+        using IoWorker::IoWorker;
+
+        uring::Ring* ring = nullptr;    // io_uring 后端，随 io 销毁
+        std::unique_ptr<LoadMonitor> monitor;   // 排队延迟探针，未启用过载保护时为空
+    };
+
+    // 单线程模式：停止接受新连接与会话定时器，须在事件循环线程上或事件循环未运行时调用
+    void close_local() {
+        if (session_timer_) {
+            session_timer_->cancel();
+        }
+        if (auto& acceptor = workers_.front()->acceptor) {
+            boost::system::error_code ignored;
+            acceptor->close(ignored);
+        }
+    }
+
+    // 下一个接收分发连接的线程（仅 reuse_port 关闭时使用）
+    Worker& next_worker() {
+        std::size_t index = next_worker_++ % workers_.size();
+        return *workers_[index];
+    }
+
+    // 准入控制：达到连接数上限、超过接受速率或目标线程过载时不建立连接
+    bool admit(const Worker& target) {
+        const AdmissionOptions& options = context_.admission;
+        metrics::Rejection reason;
+        if (options.max_connections != 0 &&
+            context_.connections.load(std::memory_order_relaxed) >= options.max_connections) {
+            reason = metrics::Rejection::LIMIT;
+        } else if (target.monitor && target.monitor->overloaded()) {
+            reason = metrics::Rejection::OVERLOAD;
+        } else if (!context_.accept_limiter.acquire(steady_now_ns())) {
+            reason = metrics::Rejection::RATE;
+        } else {
+            return true;
+        }
+        context_.rejected[static_cast<std::size_t>(reason)].fetch_add(1, std::memory_order_relaxed);
+        metrics::connection_rejected(reason);
+        return false;
+    }
+
+    // 被拒绝的连接立即复位：对端马上得到错误，本端不留 TIME_WAIT
+    static void reject(ip::tcp::socket& peer) {
+        boost::system::error_code ignored;
+        peer.set_option(socket_base::linger(true, 0), ignored);
+        peer.close(ignored);
+    }
+
+    void start_accept(Worker& worker) {
+        if (worker.ring) {
+            start_uring_accept(worker);
+            return;
+        }
+        Worker& target = handoff_ ? next_worker() : worker;
+        worker.acceptor->async_accept(*target.io,
+            [this, &worker, &target, alive = std::weak_ptr<void>(alive_)](boost::system::error_code ec,
+                                                                           ip::tcp::socket peer) {
+                // 完成已排队时服务器可能已被销毁（单线程模式）
+                if (ec == error::operation_aborted || alive.expired()) {
+                    return;
+                }
+                if (!ec && !admit(target)) {
+                    reject(peer);
+                } else if (!ec) {
+                    if (&target == &worker) {
+                        handle_connection(std::move(peer), nullptr, target.monitor.get());
+                    } else {
+                        post(*target.io, [this, &target, peer = std::move(peer)]() mutable {
+                            handle_connection(std::move(peer), nullptr, target.monitor.get());
+                        });
+                    }
+                }
+                start_accept(worker);
+            });
+    }
+
+    // 多发 accept：一次提交持续接受连接，不必每个连接重新发起
+    void start_uring_accept(Worker& worker) {
+        uring::async_accept(*worker.ring, worker.acceptor->native_handle(), [this, &worker](int fd) {
+            Worker& target = handoff_ ? next_worker() : worker;
+            boost::system::error_code ec;
+            ip::tcp::socket peer(*target.io);
+            peer.assign(ip::tcp::v4(), fd, ec);
+            if (ec) {
+                ::close(fd);
+                return;
+            }
+            if (!admit(target)) {
+                reject(peer);
+                return;
+            }
+            if (&target == &worker) {
+                handle_connection(std::move(peer), target.ring, target.monitor.get());
+            } else {
+                post(*target.io, [this, &target, peer = std::move(peer)]() mutable {
+                    handle_connection(std::move(peer), target.ring, target.monitor.get());
+                });
+            }
+        });
+    }
+
+    void handle_connection(ip::tcp::socket socket, uring::Ring* ring, const LoadMonitor* monitor) {
+        auto connection = std::allocate_shared<ServerConnection>(
+            PoolAllocator<ServerConnection>(), std::move(socket), context_, next_connection_id_.fetch_add(1, std::memory_order_relaxed),
+            ring, monitor);
+        connection->start();
+    }
+
+    // 时间轮按 tick 推进，统一回收过期会话
+    void start_session_timer() {
+        if (!session_timer_) {
+            session_timer_ = std::make_unique<steady_timer>(*workers_.front()->io);
+        }
+        session_timer_->expires_after(context_.sessions.options().tick);
+        session_timer_->async_wait([this, alive = std::weak_ptr<void>(alive_)](boost::system::error_code ec) {
+            if (ec || alive.expired()) {
+                return;
+            }
+            context_.sessions.expire();
+            if (++session_ticks_ % CHANNEL_SWEEP_TICKS == 0) {
+                context_.sweep_channels();
+                context_.sessions.checkpoint();
+            }
+            start_session_timer();
+        });
+    }
+
+    ServerContext context_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::unique_ptr<steady_timer> session_timer_;
+    size_t session_ticks_ = 0;
+    std::atomic<std::size_t> next_worker_{0};
+    std::atomic<bool> running_{false};
+    bool owns_threads_ = false;
+    bool handoff_ = false;
+    std::atomic<uint64_t> next_connection_id_{1};
+    std::shared_ptr<void> alive_ = std::make_shared<int>(0);    // 单线程模式下已排队的回调据此判断服务器是否仍存活
 };
 
 // Server class implementation
 Server::Server(io_context& io, unsigned short port)
     : impl_(std::make_unique<Impl>(io, port)) {}
 
+Server::Server(const ServerOptions& options)
+    : impl_(std::make_unique<Impl>(options)) {}
+
 Server::~Server() = default;
 
+void Server::run() {
+    impl_->run();
+}
+
+void Server::stop() {
+    impl_->stop();
+}
+
+unsigned short Server::port() const {
+    return impl_->port();
+}
+
+void Server::set_message_handler(MessageHandler handler) {
+    impl_->set_message_handler(std::move(handler));
+}
+
+void Server::set_session_handler(SessionHandler handler) {
+    impl_->set_session_handler(std::move(handler));
+}
+
+void Server::set_chunk_handler(ChunkHandler handler) {
+    impl_->set_chunk_handler(std::move(handler));
+}
+
+void Server::set_http_handler(HttpHandler handler) {
+    impl_->set_http_handler(std::move(handler));
+}
+
+std::size_t Server::thread_count() const {
+    return impl_->thread_count();
+}
+
+bool Server::capturing() const {
+    return impl_->capturing();
+}
+
+capture::CaptureStats Server::capture_stats() const {
+    return impl_->capture_stats();
+}
+
+AdmissionStats Server::admission_stats() const {
+    return impl_->admission_stats();
+}
+
+SessionTable& Server::sessions() {
+    return impl_->sessions();
+}
+
+PoolStats Server::pool_stats() {
+    return hwp::pool_stats();
+}
+
 } // namespace server
 } // namespace hwp
@@ -0,0 +1,144 @@
+#include "../include/hwp/session_store.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace hwp {
+
+namespace {
+
+constexpr char STORE_MAGIC[4] = {'H', 'W', 'P', 'S'};
+constexpr uint32_t STORE_VERSION = 1;
+
+// 文件头与记录同为 64 字节，记录区按记录大小对齐
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t shards;
+    uint64_t slots_per_shard;
+    uint8_t reserved[40];
+};
+static_assert(sizeof(FileHeader) == sizeof(SessionRecord), "header occupies exactly one record");
+
+} // namespace
+
+SessionStore::~SessionStore() {
+    close();
+}
+
+void SessionStore::close() {
+    if (map_) {
+        ::munmap(map_, map_size_);
+        map_ = nullptr;
+        records_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);   // 同时释放 flock
+        fd_ = -1;
+    }
+}
+
+SessionStore::OpenResult SessionStore::open(const std::string& path, size_t shards, size_t slots_per_shard,
+                                            std::vector<SessionRecord>& existing) {
+    close();
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        return OpenResult::FAILED;
+    }
+    // 旧进程仍持有文件时不共用：两边各自分配槽位会互相覆盖
+    if (::flock(fd_, LOCK_EX | LOCK_NB) != 0) {
+        close();
+        return OpenResult::FAILED;
+    }
+
+    size_t size = sizeof(FileHeader) + shards * slots_per_shard * sizeof(SessionRecord);
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) {
+        close();
+        return OpenResult::FAILED;
+    }
+    size_t old_size = static_cast<size_t>(st.st_size);
+
+    OpenResult result = OpenResult::CREATED;
+    FileHeader header{};
+    if (old_size >= sizeof(header) && ::pread(fd_, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+        std::memcmp(header.magic, STORE_MAGIC, sizeof(STORE_MAGIC)) == 0 && header.version == STORE_VERSION &&
+        header.record_size == sizeof(SessionRecord)) {
+        if (header.shards == shards && header.slots_per_shard == slots_per_shard && old_size == size) {
+            result = OpenResult::MAPPED;
+        } else {
+            // 布局变化：读出旧文件中的会话，按新布局重建
+            void* old = ::mmap(nullptr, old_size, PROT_READ, MAP_SHARED, fd_, 0);
+            if (old != MAP_FAILED) {
+                const auto* records = static_cast<const SessionRecord*>(old) + 1;
+                size_t count = old_size / sizeof(SessionRecord) - 1;
+                for (size_t i = 0; i < count; ++i) {
+                    if (records[i].session_id != 0) {
+                        existing.push_back(records[i]);
+                    }
+                }
+                ::munmap(old, old_size);
+            }
+            result = OpenResult::REBUILT;
+        }
+    }
+
+    if (result != OpenResult::MAPPED) {
+        // 先截断为 0 清掉旧内容，再扩展为稀疏文件
+        if (::ftruncate(fd_, 0) != 0 || ::ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+            close();
+            return OpenResult::FAILED;
+        }
+    }
+    map_ = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (map_ == MAP_FAILED) {
+        map_ = nullptr;
+        close();
+        return OpenResult::FAILED;
+    }
+    map_size_ = size;
+    records_ = static_cast<SessionRecord*>(map_) + 1;
+    slots_per_shard_ = slots_per_shard;
+
+    if (result != OpenResult::MAPPED) {
+        // 魔数最后写入：中途崩溃的文件下次按无法识别处理
+        auto* out = static_cast<FileHeader*>(map_);
+        out->version = STORE_VERSION;
+        out->record_size = sizeof(SessionRecord);
+        out->shards = static_cast<uint32_t>(shards);
+        out->slots_per_shard = slots_per_shard;
+        std::memcpy(out->magic, STORE_MAGIC, sizeof(STORE_MAGIC));
+    }
+    return result;
+}
+
+void SessionStore::write(size_t slot, const SessionState& state, uint64_t expires_ms) {
+    SessionRecord& record = records_[slot];
+    record.session_id = 0;
+    record.authenticated = state.is_authenticated ? 1 : 0;
+    size_t length = std::min(state.client_id.size(), sizeof(record.client_id));
+    record.client_id_len = static_cast<uint8_t>(length);
+    record.reserved = 0;
+    record.expires_ms = expires_ms;
+    std::memcpy(record.client_id, state.client_id.data(), length);
+    record.session_id = state.session_id;
+}
+
+void SessionStore::sync() {
+    if (map_) {
+        ::msync(map_, map_size_, MS_ASYNC);
+    }
+}
+
+uint64_t SessionStore::wall_clock_ms() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+} // namespace hwp
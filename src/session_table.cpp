@@ -0,0 +1,448 @@
+#include "../include/hwp/session_table.hpp"
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include "../include/hwp/session_store.hpp"
+
+namespace hwp {
+
+namespace {
+
+// 分层时间轮：4 层 x 64 槽，覆盖 64^4 个 tick
+constexpr unsigned WHEEL_BITS = 6;
+constexpr uint64_t WHEEL_SIZE = uint64_t(1) << WHEEL_BITS;
+constexpr uint64_t WHEEL_MASK = WHEEL_SIZE - 1;
+constexpr unsigned WHEEL_LEVELS = 4;
+constexpr uint64_t WHEEL_RANGE = uint64_t(1) << (WHEEL_BITS * WHEEL_LEVELS);
+
+struct Entry {
+    SessionState state;
+    uint64_t expires = 0;           // 到期 tick，访问时只更新此值
+    Entry* lru_prev = nullptr;      // LRU 双向链表（表头为最近使用）
+    Entry* lru_next = nullptr;
+    Entry* wheel_next = nullptr;    // 时间轮槽位单链表
+    Entry** wheel_pprev = nullptr;
+    uint32_t slot = 0;              // 在分片快照槽位段中的序号
+};
+
+class TimingWheel {
+public:
+    explicit TimingWheel(uint64_t now) : current_(now) {}
+
+    void schedule(Entry* entry) {
+        uint64_t when = std::max(entry->expires, current_);
+        uint64_t delta = when - current_;
+        if (delta >= WHEEL_RANGE) {
+            // 超出时间轮范围：先放在最远处，到时再重新排期
+            when = current_ + WHEEL_RANGE - 1;
+            delta = WHEEL_RANGE - 1;
+        }
+        unsigned level = 0;
+        while (delta >= (uint64_t(1) << (WHEEL_BITS * (level + 1)))) {
+            ++level;
+        }
+        link(slots_[level][(when >> (WHEEL_BITS * level)) & WHEEL_MASK], entry);
+    }
+
+    static void unlink(Entry* entry) {
+        if (entry->wheel_pprev) {
+            *entry->wheel_pprev = entry->wheel_next;
+            if (entry->wheel_next) {
+                entry->wheel_next->wheel_pprev = entry->wheel_pprev;
+            }
+            entry->wheel_next = nullptr;
+            entry->wheel_pprev = nullptr;
+        }
+    }
+
+    // 逐 tick 推进；到期条目交给 on_expire，访问过的条目按新的到期时间重新排期
+    template <typename OnExpire>
+    void advance(uint64_t target, OnExpire&& on_expire) {
+        while (current_ < target) {
+            ++current_;
+            for (unsigned level = WHEEL_LEVELS - 1; level > 0; --level) {
+                if ((current_ & ((uint64_t(1) << (WHEEL_BITS * level)) - 1)) == 0) {
+                    reschedule_all(slots_[level][(current_ >> (WHEEL_BITS * level)) & WHEEL_MASK]);
+                }
+            }
+
+            Entry* list = take(slots_[0][current_ & WHEEL_MASK]);
+            while (list) {
+                Entry* next = list->wheel_next;
+                list->wheel_next = nullptr;
+                list->wheel_pprev = nullptr;
+                if (list->expires <= current_) {
+                    on_expire(list);
+                } else {
+                    schedule(list);
+                }
+                list = next;
+            }
+        }
+    }
+
+    uint64_t current() const { return current_; }
+
+private:
+    static void link(Entry*& head, Entry* entry) {
+        entry->wheel_next = head;
+        entry->wheel_pprev = &head;
+        if (head) {
+            head->wheel_pprev = &entry->wheel_next;
+        }
+        head = entry;
+    }
+
+    static Entry* take(Entry*& head) {
+        Entry* list = head;
+        head = nullptr;
+        if (list) {
+            list->wheel_pprev = nullptr;
+        }
+        return list;
+    }
+
+    void reschedule_all(Entry*& head) {
+        Entry* list = take(head);
+        while (list) {
+            Entry* next = list->wheel_next;
+            list->wheel_next = nullptr;
+            list->wheel_pprev = nullptr;
+            schedule(list);
+            list = next;
+        }
+    }
+
+    uint64_t current_;
+    Entry* slots_[WHEEL_LEVELS][WHEEL_SIZE] = {};
+};
+
+size_t round_up_pow2(size_t n) {
+    size_t result = 1;
+    while (result < n) {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // namespace
+
+// 单个分片：哈希索引 + 侵入式 LRU 链表 + 时间轮，由一把锁保护；
+// 启用快照时另有一段专属槽位，与条目同在这把锁下更新
+class alignas(64) SessionTable::Shard {
+public:
+    Shard(size_t capacity, uint64_t now, SessionStore* store = nullptr, size_t slot_base = 0)
+        : capacity_(std::max<size_t>(capacity, 1)), wheel_(now), store_(store), slot_base_(slot_base) {
+        lru_.lru_prev = &lru_;
+        lru_.lru_next = &lru_;
+    }
+
+    // 返回是否新建了条目；replace 为 false 时已存在的条目保持不变
+    bool insert(const SessionState& state, uint64_t expires, uint64_t expires_ms, bool replace = true) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto result = entries_.try_emplace(state.session_id);
+        if (!result.second && !replace) {
+            return false;
+        }
+        Entry& entry = result.first->second;
+        entry.state = state;
+        entry.expires = expires;
+        if (result.second) {
+            if (store_) {
+                entry.slot = allocate_slot();
+            }
+            lru_push_front(&entry);
+            wheel_.schedule(&entry);
+        } else {
+            lru_move_front(&entry);
+        }
+        if (store_) {
+            store_->write(slot_base_ + entry.slot, state, expires_ms);
+        }
+        if (result.second && entries_.size() > capacity_) {
+            Entry* victim = lru_.lru_prev;
+            remove(victim);
+            ++evicted_;
+        }
+        return result.second;
+    }
+
+    // 沿用快照中本分片槽位段里未过期的会话（布局未变时），返回恢复的数量
+    size_t adopt(uint64_t now_wall_ms, uint64_t now_ms, uint64_t tick_ms) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t slots = store_->slots_per_shard();
+        for (size_t slot = 0; slot < slots; ++slot) {
+            SessionRecord& record = store_->record(slot_base_ + slot);
+            if (record.session_id == 0) {
+                continue;
+            }
+            if (record.expires_ms <= now_wall_ms || entries_.size() >= capacity_ ||
+                record.client_id_len > sizeof(record.client_id) || entries_.count(record.session_id) != 0) {
+                store_->clear(slot_base_ + slot);
+                continue;
+            }
+            auto result = entries_.try_emplace(record.session_id);
+            Entry& entry = result.first->second;
+            entry.state.session_id = record.session_id;
+            entry.state.is_authenticated = record.authenticated != 0;
+            entry.state.client_id.assign(record.client_id, record.client_id_len);
+            entry.state.last_activity = now_ms;
+            entry.expires = (record.expires_ms - now_wall_ms + tick_ms - 1) / tick_ms;
+            entry.slot = static_cast<uint32_t>(slot);
+            lru_push_front(&entry);
+            wheel_.schedule(&entry);
+            next_slot_ = static_cast<uint32_t>(slot + 1);
+        }
+        // 已用范围内的空槽留作复用
+        for (uint32_t slot = 0; slot < next_slot_; ++slot) {
+            if (store_->record(slot_base_ + slot).session_id == 0) {
+                free_slots_.push_back(slot);
+            }
+        }
+        return entries_.size();
+    }
+
+    bool touch(uint32_t session_id, uint64_t expires, uint64_t expires_ms, uint64_t now_ms, SessionState* out) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(session_id);
+        if (it == entries_.end()) {
+            ++misses_;
+            return false;
+        }
+        ++hits_;
+        Entry& entry = it->second;
+        entry.expires = expires;
+        entry.state.last_activity = now_ms;
+        if (store_) {
+            store_->set_expires(slot_base_ + entry.slot, expires_ms);
+        }
+        lru_move_front(&entry);
+        if (out) {
+            *out = entry.state;
+        }
+        return true;
+    }
+
+    bool erase(uint32_t session_id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(session_id);
+        if (it == entries_.end()) {
+            return false;
+        }
+        remove(&it->second);
+        return true;
+    }
+
+    size_t advance(uint64_t target) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t count = 0;
+        wheel_.advance(target, [this, &count](Entry* entry) {
+            remove(entry);
+            ++count;
+        });
+        expired_ += count;
+        return count;
+    }
+
+    void collect(SessionTableStats& stats) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats.sessions += entries_.size();
+        stats.hits += hits_;
+        stats.misses += misses_;
+        stats.evicted += evicted_;
+        stats.expired += expired_;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return entries_.size();
+    }
+
+private:
+    void lru_push_front(Entry* entry) {
+        entry->lru_prev = &lru_;
+        entry->lru_next = lru_.lru_next;
+        lru_.lru_next->lru_prev = entry;
+        lru_.lru_next = entry;
+    }
+
+    void lru_unlink(Entry* entry) {
+        entry->lru_prev->lru_next = entry->lru_next;
+        entry->lru_next->lru_prev = entry->lru_prev;
+    }
+
+    void lru_move_front(Entry* entry) {
+        if (lru_.lru_next != entry) {
+            lru_unlink(entry);
+            lru_push_front(entry);
+        }
+    }
+
+    void remove(Entry* entry) {
+        lru_unlink(entry);
+        TimingWheel::unlink(entry);
+        if (store_) {
+            store_->clear(slot_base_ + entry->slot);
+            free_slots_.push_back(entry->slot);
+        }
+        entries_.erase(entry->state.session_id);
+    }
+
+    // 槽位段按容量 + 1 预留（插入后才淘汰），不会用尽
+    uint32_t allocate_slot() {
+        if (!free_slots_.empty()) {
+            uint32_t slot = free_slots_.back();
+            free_slots_.pop_back();
+            return slot;
+        }
+        return next_slot_++;
+    }
+
+    mutable std::mutex mutex_;
+    size_t capacity_;
+    std::unordered_map<uint32_t, Entry> entries_;
+    Entry lru_;
+    TimingWheel wheel_;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    uint64_t evicted_ = 0;
+    uint64_t expired_ = 0;
+    SessionStore* store_;
+    size_t slot_base_;
+    uint32_t next_slot_ = 0;
+    std::vector<uint32_t> free_slots_;
+};
+
+SessionTable::SessionTable(const SessionTableOptions& options)
+    : options_(options),
+      origin_ms_(ProtocolHandler::get_current_timestamp()),
+      origin_wall_ms_(SessionStore::wall_clock_ms()) {
+    if (options_.tick.count() <= 0) {
+        options_.tick = std::chrono::milliseconds(1);
+    }
+    ttl_ticks_ = std::max<uint64_t>(1, (options_.ttl.count() + options_.tick.count() - 1) / options_.tick.count());
+
+    size_t shard_count = round_up_pow2(std::max<size_t>(options_.shards, 1));
+    options_.shards = shard_count;
+    size_t per_shard = (options_.max_sessions + shard_count - 1) / shard_count;
+    std::vector<SessionRecord> existing;
+    auto opened = SessionStore::OpenResult::FAILED;
+    if (!options_.snapshot_path.empty()) {
+        store_ = std::make_unique<SessionStore>();
+        opened = store_->open(options_.snapshot_path, shard_count, per_shard + 1, existing);
+        if (opened == SessionStore::OpenResult::FAILED) {
+            store_.reset();
+        }
+    }
+    for (size_t i = 0; i < shard_count; ++i) {
+        shards_.push_back(std::make_unique<Shard>(per_shard, 0, store_.get(), i * (per_shard + 1)));
+    }
+
+    // 恢复：布局未变时各分片直接沿用自己的槽位；否则把读出的旧记录重新插入
+    uint64_t now_wall = SessionStore::wall_clock_ms();
+    uint64_t tick_ms = static_cast<uint64_t>(options_.tick.count());
+    if (opened == SessionStore::OpenResult::MAPPED) {
+        for (auto& shard : shards_) {
+            restored_ += shard->adopt(now_wall, origin_ms_, tick_ms);
+        }
+    }
+    for (const SessionRecord& record : existing) {
+        if (record.expires_ms <= now_wall || record.client_id_len > sizeof(record.client_id)) {
+            continue;
+        }
+        SessionState state;
+        state.session_id = record.session_id;
+        state.is_authenticated = record.authenticated != 0;
+        state.client_id.assign(record.client_id, record.client_id_len);
+        state.last_activity = origin_ms_;
+        uint64_t expires = (record.expires_ms - now_wall + tick_ms - 1) / tick_ms;
+        shard_for(state.session_id).insert(state, expires, wall_expires(expires));
+        ++restored_;
+    }
+}
+
+SessionTable::~SessionTable() = default;
+
+SessionTable::Shard& SessionTable::shard_for(uint32_t session_id) {
+    // 乘法散列打散连续分配的 session_id
+    uint32_t hash = session_id * 2654435761u;
+    return *shards_[hash >> 16 & (shards_.size() - 1)];
+}
+
+SessionState SessionTable::create(const std::string& client_id) {
+    // 分配的 id 可能与快照恢复或外部指定的会话相同，撞上时换一个，不覆盖已有会话
+    SessionState state = ProtocolHandler::create_session(client_id);
+    uint64_t expires = current_tick() + ttl_ticks_;
+    while (!shard_for(state.session_id).insert(state, expires, wall_expires(expires), false)) {
+        state.session_id = ProtocolHandler::create_session(client_id).session_id;
+    }
+    return state;
+}
+
+bool SessionTable::insert(const SessionState& state, bool replace) {
+    uint64_t expires = current_tick() + ttl_ticks_;
+    return shard_for(state.session_id).insert(state, expires, wall_expires(expires), replace);
+}
+
+bool SessionTable::touch(uint32_t session_id) {
+    uint64_t expires = current_tick() + ttl_ticks_;
+    return shard_for(session_id).touch(session_id, expires, wall_expires(expires),
+                                       origin_ms_ + current_tick() * options_.tick.count(), nullptr);
+}
+
+bool SessionTable::find(uint32_t session_id, SessionState& out) {
+    uint64_t expires = current_tick() + ttl_ticks_;
+    return shard_for(session_id).touch(session_id, expires, wall_expires(expires),
+                                       origin_ms_ + current_tick() * options_.tick.count(), &out);
+}
+
+bool SessionTable::erase(uint32_t session_id) {
+    return shard_for(session_id).erase(session_id);
+}
+
+size_t SessionTable::expire() {
+    return expire(ProtocolHandler::get_current_timestamp());
+}
+
+size_t SessionTable::expire(uint64_t now_ms) {
+    uint64_t target = now_ms > origin_ms_ ? (now_ms - origin_ms_) / options_.tick.count() : 0;
+    if (target <= current_tick()) {
+        return 0;
+    }
+    tick_.store(target, std::memory_order_relaxed);
+
+    size_t count = 0;
+    for (auto& shard : shards_) {
+        count += shard->advance(target);
+    }
+    return count;
+}
+
+size_t SessionTable::size() const {
+    size_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard->size();
+    }
+    return total;
+}
+
+SessionTableStats SessionTable::stats() const {
+    SessionTableStats stats;
+    for (const auto& shard : shards_) {
+        shard->collect(stats);
+    }
+    stats.restored = restored_;
+    return stats;
+}
+
+bool SessionTable::persistent() const {
+    return store_ != nullptr;
+}
+
+void SessionTable::checkpoint() {
+    if (store_) {
+        store_->sync();
+    }
+}
+
+} // namespace hwp
@@ -0,0 +1,301 @@
+#include "../include/hwp/stream.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstring>
+#include "../include/hwp/pool.hpp"
+
+namespace hwp {
+
+namespace {
+
+void set_more(Message& header, bool more) {
+    if (more) {
+        header.base_header.flags |= static_cast<uint8_t>(Flags::MORE);
+    } else {
+        header.base_header.flags &= static_cast<uint8_t>(~static_cast<uint8_t>(Flags::MORE));
+    }
+}
+
+} // namespace
+
+StreamMux::StreamMux(const FlowControlOptions& options, BufferBudget* budget)
+    : options_(options), reassembly_(budget) {
+    options_.connection_window = std::max(options_.connection_window, INITIAL_CONNECTION_WINDOW);
+    options_.max_frame_payload = std::max<uint32_t>(options_.max_frame_payload, 1);
+}
+
+Message StreamMux::window_update(uint32_t session_id, uint16_t stream_id, uint32_t increment) {
+    std::vector<uint8_t> payload(5);
+    payload[0] = static_cast<uint8_t>(ControlCode::WINDOW_UPDATE);
+    uint32_t value = htonl(increment);
+    std::memcpy(payload.data() + 1, &value, sizeof(value));
+    Message msg = ProtocolHandler::create_message(MessageType::CONTROL, session_id, std::move(payload),
+                                                  static_cast<uint8_t>(Flags::BINARY_MODE));
+    msg.session_header.stream_id = stream_id;
+    return msg;
+}
+
+bool StreamMux::parse_window_update(const Message& msg, uint32_t& increment) {
+    if (msg.session_header.msg_type != MessageType::CONTROL || msg.payload.size() != 5 ||
+        msg.payload[0] != static_cast<uint8_t>(ControlCode::WINDOW_UPDATE)) {
+        return false;
+    }
+    uint32_t value;
+    std::memcpy(&value, msg.payload.data() + 1, sizeof(value));
+    increment = ntohl(value);
+    return true;
+}
+
+void StreamMux::enqueue(Message&& msg) {
+    uint16_t stream_id = msg.session_header.stream_id;
+    push(stream_id, Outbound{std::move(msg), ByteSource()});
+}
+
+void StreamMux::enqueue(Message&& header, ByteSource source) {
+    uint16_t stream_id = header.session_header.stream_id;
+    header.payload.clear();
+    push(stream_id, Outbound{std::move(header), std::move(source)});
+}
+
+void StreamMux::push(uint16_t stream_id, Outbound&& outbound) {
+    SendStream& stream = send_[stream_id];
+    stream.queue.push_back(std::move(outbound));
+    const Outbound& front = stream.queue.front();
+    if (stream.window > 0 || (!front.source && front.msg.payload.empty())) {
+        schedule(stream_id, stream);
+    }
+}
+
+void StreamMux::schedule(uint16_t stream_id, SendStream& stream) {
+    if (!stream.scheduled) {
+        stream.scheduled = true;
+        ready_.push_back(stream_id);
+    }
+}
+
+bool StreamMux::next_frame(OutgoingFrame& frame) {
+    if (send_connection_window_ <= 0) {
+        return false;
+    }
+    for (std::size_t attempts = ready_.size(); attempts > 0; --attempts) {
+        uint16_t stream_id = ready_.front();
+        ready_.pop_front();
+        auto it = send_.find(stream_id);
+        SendStream& stream = it->second;
+        Outbound& front = stream.queue.front();
+        Message& msg = front.msg;
+        int64_t credit = std::min(stream.window, send_connection_window_);
+
+        Message header;
+        header.base_header = msg.base_header;
+        header.session_header = msg.session_header;
+        std::size_t chunk;
+        bool last;
+        if (front.source) {
+            if (credit <= 0) {
+                stream.scheduled = false;
+                continue;
+            }
+            // 流式消息：每帧现读，读到 0 字节时以空帧结束
+            std::size_t capacity = std::min<std::size_t>(options_.max_frame_payload, static_cast<std::size_t>(credit));
+            std::vector<uint8_t> payload = pool::acquire_buffer(capacity);
+            chunk = std::min(front.source(payload.data(), capacity), capacity);
+            payload.resize(chunk);
+            last = chunk == 0;
+            set_more(header, !last);
+            frame = OutgoingFrame(header, std::move(payload), 0, chunk);
+            if (last) {
+                stream.queue.pop_front();
+            }
+        } else {
+            std::size_t remaining = msg.payload.size() - stream.offset;
+            chunk = std::min<std::size_t>(remaining, options_.max_frame_payload);
+            if (chunk > 0) {
+                if (credit <= 0) {
+                    // 流窗口耗尽：移出轮转，收到该流的 WINDOW_UPDATE 后重新加入
+                    stream.scheduled = false;
+                    continue;
+                }
+                chunk = std::min<std::size_t>(chunk, static_cast<std::size_t>(credit));
+            }
+            last = stream.offset + chunk == msg.payload.size();
+            set_more(header, !last);
+            if (last) {
+                frame = OutgoingFrame(header, std::move(msg.payload), stream.offset, chunk);
+                stream.queue.pop_front();
+                stream.offset = 0;
+            } else {
+                frame = OutgoingFrame(header, msg.payload.data() + stream.offset, chunk);
+                stream.offset += chunk;
+            }
+        }
+        stream.window -= static_cast<int64_t>(chunk);
+        send_connection_window_ -= static_cast<int64_t>(chunk);
+
+        if (!stream.queue.empty()) {
+            ready_.push_back(stream_id);
+        } else {
+            stream.scheduled = false;
+            if (stream.window == INITIAL_STREAM_WINDOW) {
+                send_.erase(it);
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+bool StreamMux::on_window_update(uint16_t stream_id, uint32_t increment) {
+    if (stream_id == 0) {
+        send_connection_window_ += increment;
+        return send_connection_window_ <= MAX_FLOW_WINDOW;
+    }
+    auto it = send_.find(stream_id);
+    if (it == send_.end()) {
+        // 流状态已回收（窗口已满），忽略
+        return true;
+    }
+    SendStream& stream = it->second;
+    stream.window += increment;
+    if (stream.window > MAX_FLOW_WINDOW) {
+        return false;
+    }
+    if (!stream.queue.empty()) {
+        if (stream.window > 0) {
+            schedule(stream_id, stream);
+        }
+    } else if (stream.window == INITIAL_STREAM_WINDOW) {
+        send_.erase(it);
+    }
+    return true;
+}
+
+StreamMux::Inbound StreamMux::on_frame(Message& msg, std::vector<Message>& updates, uint64_t* offset) {
+    if (!flow_controlled(msg.session_header)) {
+        return Inbound::DELIVER;
+    }
+    uint32_t session_id = msg.session_header.session_id;
+    uint16_t stream_id = msg.session_header.stream_id;
+    RecvStream& stream = recv_[stream_id];
+    uint32_t length = static_cast<uint32_t>(msg.payload.size());
+    if (length > stream.window || length > recv_connection_window_ || stream.delivered != 0) {
+        return Inbound::VIOLATION;
+    }
+    stream.window -= length;
+    recv_connection_window_ -= length;
+
+    bool more = (msg.base_header.flags & static_cast<uint8_t>(Flags::MORE)) != 0;
+    // 压缩以整条消息为单位，只能重组后解压
+    bool compressed = (msg.base_header.flags & static_cast<uint8_t>(Flags::COMPRESSED)) != 0;
+    if (options_.stream_payloads && !stream.assembling && !compressed) {
+        // 逐帧交付：窗口在 consumed() 时归还，应用处理前对端最多再发一个窗口
+        if (offset) {
+            *offset = stream.offset;
+        }
+        stream.offset = more ? stream.offset + length : 0;
+        stream.delivered = length;
+        return Inbound::CHUNK;
+    }
+    if (!stream.assembling && !more) {
+        stream.delivered = length;
+        return Inbound::DELIVER;
+    }
+
+    // 分片一经缓存即归还窗口，重组占用的内存只由流数与合计字节约束
+    if (reassembly_.bytes() + length > options_.max_reassembly) {
+        return Inbound::VIOLATION;
+    }
+    if (!stream.assembling) {
+        if (assembling_ >= options_.max_streams) {
+            return Inbound::VIOLATION;
+        }
+        // 首个分片直接接管负载缓冲区
+        stream.partial = std::move(msg.payload);
+        stream.assembling = true;
+        ++assembling_;
+    } else {
+        if (stream.partial.size() + msg.payload.size() > MAX_PAYLOAD_LEN) {
+            return Inbound::VIOLATION;
+        }
+        stream.partial.insert(stream.partial.end(), msg.payload.begin(), msg.payload.end());
+        pool::release_buffer(std::move(msg.payload));
+    }
+    reassembly_.add(length);
+    if (more) {
+        credit(session_id, stream_id, stream, length, updates);
+        return Inbound::PARTIAL;
+    }
+    reassembly_.release(stream.partial.size());
+    msg.payload = std::move(stream.partial);
+    msg.base_header.flags &= static_cast<uint8_t>(~static_cast<uint8_t>(Flags::MORE));
+    stream.partial = std::vector<uint8_t>();
+    stream.assembling = false;
+    --assembling_;
+    stream.delivered = length;
+    return Inbound::DELIVER;
+}
+
+void StreamMux::consumed(const SessionHeader& header, std::vector<Message>& updates) {
+    if (!flow_controlled(header)) {
+        return;
+    }
+    auto it = recv_.find(header.stream_id);
+    if (it == recv_.end()) {
+        return;
+    }
+    RecvStream& stream = it->second;
+    uint32_t bytes = stream.delivered;
+    stream.delivered = 0;
+    credit(header.session_id, header.stream_id, stream, bytes, updates);
+    if (stream.unacked == 0 && !stream.assembling && stream.offset == 0) {
+        recv_.erase(it);
+    }
+    if (recv_.size() > options_.max_streams) {
+        flush_streams(header.session_id, updates);
+    }
+}
+
+// 累计已消费字节，达到半个窗口时归还；连接窗口同理
+void StreamMux::credit(uint32_t session_id, uint16_t stream_id, RecvStream& stream, uint32_t bytes,
+                       std::vector<Message>& updates) {
+    // 首次收到流数据时通告本端更大的连接窗口
+    if (!window_announced_) {
+        window_announced_ = true;
+        uint32_t bonus = options_.connection_window - INITIAL_CONNECTION_WINDOW;
+        if (bonus > 0) {
+            recv_connection_window_ += bonus;
+            updates.push_back(window_update(session_id, 0, bonus));
+        }
+    }
+
+    stream.unacked += bytes;
+    if (stream.unacked >= INITIAL_STREAM_WINDOW / 2) {
+        updates.push_back(window_update(session_id, stream_id, stream.unacked));
+        stream.window += stream.unacked;
+        stream.unacked = 0;
+    }
+
+    connection_unacked_ += bytes;
+    if (connection_unacked_ >= options_.connection_window / 2) {
+        updates.push_back(window_update(session_id, 0, connection_unacked_));
+        recv_connection_window_ += connection_unacked_;
+        connection_unacked_ = 0;
+    }
+}
+
+// 归还所有空闲流的未确认窗口并回收其状态，限制接收端的流状态数量
+void StreamMux::flush_streams(uint32_t session_id, std::vector<Message>& updates) {
+    for (auto it = recv_.begin(); it != recv_.end();) {
+        RecvStream& stream = it->second;
+        if (stream.assembling || stream.offset != 0 || stream.delivered != 0) {
+            ++it;
+            continue;
+        }
+        if (stream.unacked > 0) {
+            updates.push_back(window_update(session_id, it->first, stream.unacked));
+        }
+        it = recv_.erase(it);
+    }
+}
+
+} // namespace hwp
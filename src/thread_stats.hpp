@@ -0,0 +1,72 @@
+#ifndef HWP_THREAD_STATS_HPP
+#define HWP_THREAD_STATS_HPP
+
+// 库内部使用：连接池、压缩、io_uring 与指标共用的统计计数脚手架，不属于公开接口
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace hwp {
+namespace detail {
+
+// 只有一个写入方（所属线程，或持有所属对象锁的线程），统计时由其他线程读取：
+// 写入不需要原子读改写，读取也不会看到撕裂的值
+struct StatCounter {
+    std::atomic<uint64_t> value{0};
+
+    void add(uint64_t delta) noexcept {
+        value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+    // 仅用于可增可减的计量值（如缓存中的块数）
+    void sub(uint64_t delta) noexcept {
+        value.store(value.load(std::memory_order_relaxed) - delta, std::memory_order_relaxed);
+    }
+    uint64_t get() const noexcept {
+        return value.load(std::memory_order_relaxed);
+    }
+};
+
+// 统计来源（每线程对象或每个 ring）的登记表：汇总值为在册来源的当前值加上已注销来源的累计值。
+// Source 须提供 Stats stats() const，Accumulate 把一份统计累加到另一份上
+template <typename Source, typename Stats, void (*Accumulate)(Stats&, const Stats&)>
+class StatsRegistry {
+public:
+    static StatsRegistry& instance() {
+        static StatsRegistry registry;
+        return registry;
+    }
+
+    void add(const Source* source) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sources_.push_back(source);
+    }
+
+    // 注销来源并把它的最终统计计入累计值
+    void remove(const Source* source, const Stats& last) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sources_.erase(std::remove(sources_.begin(), sources_.end(), source), sources_.end());
+        Accumulate(retired_, last);
+    }
+
+    Stats total() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Stats sum = retired_;
+        for (const Source* source : sources_) {
+            Accumulate(sum, source->stats());
+        }
+        return sum;
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<const Source*> sources_;
+    Stats retired_{};
+};
+
+} // namespace detail
+} // namespace hwp
+
+#endif // HWP_THREAD_STATS_HPP
@@ -0,0 +1,1001 @@
+#include "../include/hwp/uring.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include "../include/hwp/pool.hpp"
+#include "thread_stats.hpp"
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define HWP_HAS_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace hwp {
+namespace uring {
+
+#ifdef HWP_HAS_IO_URING
+
+namespace {
+
+constexpr unsigned RING_ENTRIES = 1024;
+constexpr unsigned FIXED_FILES = 4096;          // 固定文件表大小，用满后新连接直接使用 fd
+constexpr std::size_t SLOT_SIZE = 64;           // 注册缓冲区的槽位：容纳一个帧头
+constexpr std::size_t SLOT_COUNT = 4096;
+
+int sys_setup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int sys_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int sys_register(int fd, unsigned opcode, const void* arg, unsigned count) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+boost::system::error_code errno_code(int error) {
+    return boost::system::error_code(error, boost::system::system_category());
+}
+
+// 探测所需功能：单次 mmap、完成不丢弃、各操作码、同步取消（Linux 6.0）
+bool probe() {
+    io_uring_params params{};
+    int fd = sys_setup(8, &params);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = (params.features & IORING_FEAT_SINGLE_MMAP) && (params.features & IORING_FEAT_NODROP);
+
+    std::vector<uint8_t> buffer(sizeof(io_uring_probe) + IORING_OP_LAST * sizeof(io_uring_probe_op));
+    auto* ops = reinterpret_cast<io_uring_probe*>(buffer.data());
+    if (sys_register(fd, IORING_REGISTER_PROBE, ops, IORING_OP_LAST) < 0) {
+        ok = false;
+    } else {
+        for (unsigned op : {IORING_OP_ACCEPT, IORING_OP_RECV, IORING_OP_SENDMSG, IORING_OP_READ_FIXED}) {
+            if (op > ops->last_op || !(ops->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+                ok = false;
+            }
+        }
+    }
+
+    io_uring_sync_cancel_reg cancel{};
+    cancel.fd = -1;
+    cancel.flags = IORING_ASYNC_CANCEL_ANY;
+    cancel.timeout.tv_sec = -1;
+    cancel.timeout.tv_nsec = -1;
+    if (sys_register(fd, IORING_REGISTER_SYNC_CANCEL, &cancel, 1) < 0 && errno != ENOENT) {
+        ok = false;
+    }
+    ::close(fd);
+    return ok;
+}
+
+} // namespace
+
+using Counter = detail::StatCounter;
+
+// 仅在持有 ring 锁时写入
+struct RingCounters {
+    Counter enter_calls;
+    Counter register_calls;
+    Counter submitted;
+    Counter completed;
+    Counter fixed_reads;
+    Counter accepted;
+
+    UringStats stats() const {
+        UringStats s;
+        s.enter_calls = enter_calls.get();
+        s.register_calls = register_calls.get();
+        s.submitted = submitted.get();
+        s.completed = completed.get();
+        s.fixed_reads = fixed_reads.get();
+        s.accepted = accepted.get();
+        return s;
+    }
+};
+
+namespace {
+
+void accumulate(UringStats& total, const UringStats& part) {
+    total.enter_calls += part.enter_calls;
+    total.register_calls += part.register_calls;
+    total.submitted += part.submitted;
+    total.completed += part.completed;
+    total.fixed_reads += part.fixed_reads;
+    total.accepted += part.accepted;
+}
+
+using Registry = detail::StatsRegistry<RingCounters, UringStats, accumulate>;
+
+} // namespace
+
+// 提交到内核的一个请求，user_data 指向它；处理完最后一个 CQE 后由 Ring::retire 释放
+struct Request {
+    Request* prev = nullptr;
+    Request* next = nullptr;
+    bool linked = false;
+
+    virtual ~Request() = default;
+    virtual void on_cqe(Ring& ring, int result, uint32_t flags) = 0;
+
+    static void* operator new(std::size_t size) { return pool::allocate(size); }
+    static void operator delete(void* p, std::size_t size) noexcept { pool::deallocate(p, size); }
+};
+
+// 连接的固定文件槽位与关闭标记，由 Socket 与其在途请求共享
+struct SocketState {
+    Ring* ring = nullptr;
+    int fd = -1;
+    int index = -1;                     // 固定文件下标，-1 表示直接使用 fd
+    std::atomic<bool> closed{false};
+
+    void target(io_uring_sqe& sqe) const {
+        if (index >= 0) {
+            sqe.fd = index;
+            sqe.flags |= IOSQE_FIXED_FILE;
+        } else {
+            sqe.fd = fd;
+        }
+    }
+};
+
+// 每个 io_context 一个 ring。SQE 先在用户态累积，由投递到 io_context 的 flush 一次性提交；
+// ring fd 的可读事件经 Asio 反应器通知，完成队列在用户态直接读取，收割本身不需要系统调用。
+// 收割中产生的新请求在本轮结束时随同一次 io_uring_enter 提交
+class Ring {
+public:
+    explicit Ring(boost::asio::io_context& io) : io_(io), descriptor_(io) {}
+
+    ~Ring() {
+        close();
+    }
+
+    Ring(const Ring&) = delete;
+    Ring& operator=(const Ring&) = delete;
+
+    boost::asio::io_context& context() {
+        return io_;
+    }
+
+    bool open() {
+        io_uring_params params{};
+        int fd = sys_setup(RING_ENTRIES, &params);
+        if (fd < 0) {
+            return false;
+        }
+        fd_ = fd;
+        std::size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        std::size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        rings_size_ = std::max(sq_size, cq_size);
+        void* rings = mmap(nullptr, rings_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                           fd_, IORING_OFF_SQ_RING);
+        if (rings == MAP_FAILED) {
+            return false;
+        }
+        rings_ = static_cast<uint8_t*>(rings);
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          fd_, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) {
+            return false;
+        }
+        sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+        sq_head_ = reinterpret_cast<unsigned*>(rings_ + params.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned*>(rings_ + params.sq_off.tail);
+        sq_flags_ = reinterpret_cast<unsigned*>(rings_ + params.sq_off.flags);
+        sq_mask_ = *reinterpret_cast<unsigned*>(rings_ + params.sq_off.ring_mask);
+        sq_entries_ = params.sq_entries;
+        unsigned* array = reinterpret_cast<unsigned*>(rings_ + params.sq_off.array);
+        for (unsigned i = 0; i < sq_entries_; ++i) {
+            array[i] = i;
+        }
+        sq_tail_local_ = *sq_tail_;
+        cq_head_ = reinterpret_cast<unsigned*>(rings_ + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(rings_ + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(rings_ + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(rings_ + params.cq_off.cqes);
+
+        // 稀疏的固定文件表：-1 为空位，连接建立时填入
+        std::vector<int> files(FIXED_FILES, -1);
+        if (sys_register(fd_, IORING_REGISTER_FILES, files.data(), FIXED_FILES) == 0) {
+            for (unsigned i = FIXED_FILES; i > 0; --i) {
+                free_files_.push_back(static_cast<int>(i - 1));
+            }
+        }
+        // 帧头读取用的注册缓冲区：整块登记一次，按槽位分配
+        slab_ = static_cast<uint8_t*>(std::aligned_alloc(4096, SLOT_SIZE * SLOT_COUNT));
+        iovec slab{slab_, SLOT_SIZE * SLOT_COUNT};
+        if (slab_ && sys_register(fd_, IORING_REGISTER_BUFFERS, &slab, 1) == 0) {
+            for (std::size_t i = SLOT_COUNT; i > 0; --i) {
+                free_slots_.push_back(slab_ + (i - 1) * SLOT_SIZE);
+            }
+        }
+
+        boost::system::error_code ec;
+        descriptor_.assign(fd_, ec);
+        if (ec) {
+            return false;
+        }
+        Registry::instance().add(&counters_);
+        registered_ = true;
+        return true;
+    }
+
+    // io_context 关闭：释放所有在途请求（不调用回调），再关闭 ring，内核随之取消这些操作
+    void close() {
+        Request* outstanding = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+            outstanding = outstanding_;
+            outstanding_ = nullptr;
+            overflow_.clear();
+        }
+        while (outstanding) {
+            Request* next = outstanding->next;
+            delete outstanding;
+            outstanding = next;
+        }
+        if (descriptor_.is_open()) {
+            descriptor_.release();
+        }
+        if (sqes_) {
+            munmap(sqes_, sqes_size_);
+            sqes_ = nullptr;
+        }
+        if (rings_) {
+            munmap(rings_, rings_size_);
+            rings_ = nullptr;
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+        std::free(slab_);
+        slab_ = nullptr;
+        if (registered_) {
+            Registry::instance().remove(&counters_, counters_.stats());
+            registered_ = false;
+        }
+    }
+
+    // 准备一个 SQE 并放入待提交批次，fill 填写操作字段。
+    // 提交队列已满且内核暂不接受提交（EBUSY）时，SQE 暂存在用户态，腾出空间后按序移入。
+    // socket 已关闭（或 ring 已关闭）时不提交并返回 false，请求由调用方处理
+    template <typename Fill>
+    bool push(Request* request, const SocketState* socket, Fill&& fill) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (closed_ || (socket && socket->closed.load(std::memory_order_acquire))) {
+            return false;
+        }
+        io_uring_sqe sqe{};
+        fill(sqe);
+        sqe.user_data = reinterpret_cast<uint64_t>(request);
+        if (overflow_.empty() && sq_full()) {
+            submit_locked();
+        }
+        if (overflow_.empty() && !sq_full()) {
+            place_locked(sqe);
+        } else {
+            overflow_.push_back(sqe);
+        }
+        if (!request->linked) {
+            link(request);
+        }
+        bool post_flush = !flush_posted_;
+        flush_posted_ = true;
+        lock.unlock();
+
+        if (post_flush) {
+            boost::asio::post(io_, [this]() { flush(); });
+        }
+        arm();
+        return true;
+    }
+
+    // 提交本批次累积的全部 SQE：一次 io_uring_enter
+    void flush() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        flush_posted_ = false;
+        if (!closed_) {
+            submit_locked();
+        }
+    }
+
+    // 请求已处理完最后一个 CQE（或未能提交）：从在途链表摘除并释放
+    void retire(Request* request) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (request->linked) {
+                unlink(request);
+            }
+        }
+        delete request;
+    }
+
+    int register_file(int fd) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_files_.empty() || closed_) {
+            return -1;
+        }
+        int index = free_files_.back();
+        io_uring_files_update update{};
+        update.offset = static_cast<uint32_t>(index);
+        update.fds = reinterpret_cast<uint64_t>(&fd);
+        counters_.register_calls.add(1);
+        if (sys_register(fd_, IORING_REGISTER_FILES_UPDATE, &update, 1) != 1) {
+            return -1;
+        }
+        free_files_.pop_back();
+        return index;
+    }
+
+    void unregister_file(int index) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_) {
+            return;
+        }
+        int fd = -1;
+        io_uring_files_update update{};
+        update.offset = static_cast<uint32_t>(index);
+        update.fds = reinterpret_cast<uint64_t>(&fd);
+        counters_.register_calls.add(1);
+        sys_register(fd_, IORING_REGISTER_FILES_UPDATE, &update, 1);
+        free_files_.push_back(index);
+    }
+
+    // 同步取消 fd（index >= 0 时为固定文件下标）上的全部在途操作：
+    // 返回时它们的 CQE 都已产生，内核不再访问其缓冲区
+    void cancel(int fd, int index) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_) {
+            return;
+        }
+        // 尚未提交的 SQE 不在取消范围内，先提交；仍暂存在用户态的直接丢弃，
+        // 按取消完成（不在发起取消的调用内执行回调）
+        submit_locked();
+        for (auto it = overflow_.begin(); it != overflow_.end();) {
+            bool fixed = (it->flags & IOSQE_FIXED_FILE) != 0;
+            if (index >= 0 ? fixed && it->fd == index : !fixed && it->fd == fd) {
+                auto* request = reinterpret_cast<Request*>(it->user_data);
+                boost::asio::post(io_, [this, request]() { request->on_cqe(*this, -ECANCELED, 0); });
+                it = overflow_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        io_uring_sync_cancel_reg cancel{};
+        cancel.fd = index >= 0 ? index : fd;
+        cancel.flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL |
+                       (index >= 0 ? IORING_ASYNC_CANCEL_FD_FIXED : 0);
+        cancel.timeout.tv_sec = -1;
+        cancel.timeout.tv_nsec = -1;
+        counters_.register_calls.add(1);
+        while (sys_register(fd_, IORING_REGISTER_SYNC_CANCEL, &cancel, 1) < 0 && errno == EINTR) {
+        }
+    }
+
+    uint8_t* acquire_slot() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_slots_.empty() || !fixed_reads_) {
+            return nullptr;
+        }
+        uint8_t* slot = free_slots_.back();
+        free_slots_.pop_back();
+        counters_.fixed_reads.add(1);
+        return slot;
+    }
+
+    void release_slot(uint8_t* slot) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_slots_.push_back(slot);
+    }
+
+    // 内核拒绝对 socket 使用 READ_FIXED 时，之后的读一律使用 RECV
+    void disable_fixed_reads() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fixed_reads_ = false;
+    }
+
+    void count_accept() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        counters_.accepted.add(1);
+    }
+
+private:
+    struct Completion {
+        Request* request;
+        int result;
+        uint32_t flags;
+    };
+
+    bool sq_full() const {
+        return sq_tail_local_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_;
+    }
+
+    // 写入提交队列的下一个空位（调用方保证未满）
+    void place_locked(const io_uring_sqe& sqe) {
+        sqes_[sq_tail_local_ & sq_mask_] = sqe;
+        ++sq_tail_local_;
+        __atomic_store_n(sq_tail_, sq_tail_local_, __ATOMIC_RELEASE);
+        ++pending_;
+    }
+
+    // 提交队列中的全部 SQE，内核取走后腾出的空位依次填入暂存的 SQE
+    void submit_locked() {
+        for (;;) {
+            while (!overflow_.empty() && !sq_full()) {
+                place_locked(overflow_.front());
+                overflow_.pop_front();
+            }
+            if (pending_ == 0) {
+                return;
+            }
+            counters_.enter_calls.add(1);
+            int submitted = sys_enter(fd_, pending_, 0, 0);
+            if (submitted > 0) {
+                pending_ -= static_cast<unsigned>(submitted);
+                counters_.submitted.add(static_cast<uint64_t>(submitted));
+                continue;
+            }
+            if (submitted < 0 && errno == EINTR) {
+                continue;
+            }
+            // 完成队列积压（EBUSY）等：留到下一轮收割之后再提交
+            if (!flush_posted_) {
+                flush_posted_ = true;
+                boost::asio::post(io_, [this]() { flush(); });
+            }
+            return;
+        }
+    }
+
+    void link(Request* request) {
+        request->linked = true;
+        request->prev = nullptr;
+        request->next = outstanding_;
+        if (outstanding_) {
+            outstanding_->prev = request;
+        }
+        outstanding_ = request;
+    }
+
+    void unlink(Request* request) {
+        if (request->prev) {
+            request->prev->next = request->next;
+        } else {
+            outstanding_ = request->next;
+        }
+        if (request->next) {
+            request->next->prev = request->prev;
+        }
+        request->prev = request->next = nullptr;
+        request->linked = false;
+    }
+
+    bool cq_ready() const {
+        return __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE) != *cq_head_;
+    }
+
+    // 有在途请求时等待 ring fd 可读；没有时撤掉等待，io_context 可以正常退出。
+    // 反应器对 fd 采用边沿触发：挂上等待后再检查一次完成队列，
+    // 避免收割结束到挂上等待之间到达的完成被漏掉
+    void arm() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closed_) {
+                return;
+            }
+            if (!outstanding_) {
+                if (armed_) {
+                    boost::system::error_code ignored;
+                    descriptor_.cancel(ignored);
+                }
+                return;
+            }
+            if (armed_) {
+                return;
+            }
+            armed_ = true;
+        }
+        descriptor_.async_wait(boost::asio::posix::stream_descriptor::wait_read,
+            [this](boost::system::error_code ec) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    armed_ = false;
+                }
+                if (!ec) {
+                    run_completions();
+                } else {
+                    // 被撤掉的等待：撤销之后可能又有新请求
+                    arm();
+                }
+            });
+        if (cq_ready()) {
+            boost::asio::post(io_, [this]() { run_completions(); });
+        }
+    }
+
+    void run_completions() {
+        reap();
+        flush();
+        arm();
+    }
+
+    // 在用户态读取完成队列并执行回调；同一时刻只有一个线程收割
+    void reap() {
+        std::unique_lock<std::mutex> reaping(reap_mutex_, std::try_to_lock);
+        if (!reaping.owns_lock()) {
+            return;
+        }
+        for (;;) {
+            completions_.clear();
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (closed_) {
+                    return;
+                }
+                // 积压的完成暂存在内核中，需要一次 GETEVENTS 搬回完成队列
+                if (__atomic_load_n(sq_flags_, __ATOMIC_RELAXED) & IORING_SQ_CQ_OVERFLOW) {
+                    counters_.enter_calls.add(1);
+                    sys_enter(fd_, 0, 0, IORING_ENTER_GETEVENTS);
+                }
+                unsigned head = *cq_head_;
+                unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+                for (; head != tail; ++head) {
+                    const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+                    completions_.push_back(Completion{reinterpret_cast<Request*>(cqe.user_data), cqe.res, cqe.flags});
+                }
+                __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+                counters_.completed.add(completions_.size());
+            }
+            if (completions_.empty()) {
+                return;
+            }
+            for (const auto& completion : completions_) {
+                completion.request->on_cqe(*this, completion.result, completion.flags);
+            }
+        }
+    }
+
+    boost::asio::io_context& io_;
+    boost::asio::posix::stream_descriptor descriptor_;
+    std::mutex mutex_;
+    std::mutex reap_mutex_;
+    int fd_ = -1;
+
+    uint8_t* rings_ = nullptr;
+    std::size_t rings_size_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    std::size_t sqes_size_ = 0;
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_flags_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned sq_entries_ = 0;
+    unsigned sq_tail_local_ = 0;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+
+    unsigned pending_ = 0;              // 已写入 SQ、尚未提交的 SQE
+    std::deque<io_uring_sqe> overflow_; // SQ 已满时暂存、尚未写入 SQ 的 SQE（请求仍在在途链表中）
+    bool flush_posted_ = false;
+    bool armed_ = false;
+    bool closed_ = false;
+    bool fixed_reads_ = true;
+    bool registered_ = false;
+    Request* outstanding_ = nullptr;    // 在途请求，ring 关闭时统一释放
+    std::vector<int> free_files_;
+    uint8_t* slab_ = nullptr;
+    std::vector<uint8_t*> free_slots_;
+    std::vector<Completion> completions_;
+    RingCounters counters_;
+};
+
+namespace {
+
+// io_context 的服务：io_context 销毁时关闭 ring 并释放在途请求
+class RingService : public boost::asio::execution_context::service {
+public:
+    static boost::asio::execution_context::id id;
+
+    explicit RingService(boost::asio::execution_context& context)
+        : boost::asio::execution_context::service(context) {}
+
+    Ring* get(boost::asio::io_context& io) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!initialized_) {
+            initialized_ = true;
+            auto ring = std::make_unique<Ring>(io);
+            if (ring->open()) {
+                ring_ = std::move(ring);
+            }
+        }
+        return ring_.get();
+    }
+
+private:
+    void shutdown() override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (ring_) {
+            ring_->close();
+        }
+    }
+
+    std::mutex mutex_;
+    bool initialized_ = false;
+    std::unique_ptr<Ring> ring_;
+};
+
+boost::asio::execution_context::id RingService::id;
+
+// 未能提交（socket 已关闭）的操作：按 Asio 的约定不在发起函数内调用回调
+void abort_later(Ring& ring, Operation* op) {
+    boost::asio::post(ring.context(), [op]() {
+        op->complete(boost::asio::error::operation_aborted, 0);
+    });
+}
+
+class ReadRequest final : public Request {
+public:
+    ReadRequest(std::shared_ptr<SocketState> state, uint8_t* data, std::size_t size, bool exact, Operation* op)
+        : state_(std::move(state)), data_(data), size_(size), exact_(exact), op_(op) {}
+
+    ~ReadRequest() override {
+        if (op_) {
+            op_->destroy();
+        }
+        if (slot_) {
+            state_->ring->release_slot(slot_);
+        }
+    }
+
+    bool submit(Ring& ring) {
+        // 帧头这样的小定长读读入注册缓冲区，内核不必每次映射用户页
+        if (exact_ && !slot_ && size_ - done_ <= SLOT_SIZE) {
+            slot_ = ring.acquire_slot();
+        }
+        return ring.push(this, state_.get(), [this](io_uring_sqe& sqe) {
+            state_->target(sqe);
+            std::size_t remaining = size_ - done_;
+            if (slot_) {
+                sqe.opcode = IORING_OP_READ_FIXED;
+                sqe.addr = reinterpret_cast<uint64_t>(slot_);
+                sqe.len = static_cast<uint32_t>(remaining);
+                sqe.buf_index = 0;
+            } else {
+                sqe.opcode = IORING_OP_RECV;
+                sqe.addr = reinterpret_cast<uint64_t>(data_ + done_);
+                sqe.len = static_cast<uint32_t>(std::min<std::size_t>(remaining, 0x7ffff000));
+                sqe.msg_flags = exact_ ? MSG_WAITALL : 0;
+            }
+        });
+    }
+
+    void on_cqe(Ring& ring, int result, uint32_t /*flags*/) override {
+        boost::system::error_code ec;
+        if (state_->closed.load(std::memory_order_acquire)) {
+            ec = boost::asio::error::operation_aborted;
+        } else if (result == -EINVAL && slot_) {
+            // 内核不支持对 socket 使用 READ_FIXED：改用 RECV 重发
+            ring.disable_fixed_reads();
+            ring.release_slot(slot_);
+            slot_ = nullptr;
+            if (submit(ring)) {
+                return;
+            }
+            ec = boost::asio::error::operation_aborted;
+        } else if (result < 0) {
+            ec = errno_code(-result);
+        } else if (result == 0) {
+            ec = boost::asio::error::eof;
+        } else {
+            if (slot_) {
+                std::memcpy(data_ + done_, slot_, static_cast<std::size_t>(result));
+            }
+            done_ += static_cast<std::size_t>(result);
+            if (exact_ && done_ < size_) {
+                if (submit(ring)) {
+                    return;
+                }
+                ec = boost::asio::error::operation_aborted;
+            }
+        }
+        finish(ring, ec);
+    }
+
+    void finish(Ring& ring, const boost::system::error_code& ec) {
+        Operation* op = op_;
+        std::size_t done = done_;
+        op_ = nullptr;
+        ring.retire(this);
+        op->complete(ec, done);
+    }
+
+    Operation* release_operation() {
+        Operation* op = op_;
+        op_ = nullptr;
+        return op;
+    }
+
+private:
+    std::shared_ptr<SocketState> state_;
+    uint8_t* data_;
+    std::size_t size_;
+    std::size_t done_ = 0;
+    bool exact_;
+    uint8_t* slot_ = nullptr;
+    Operation* op_;
+};
+
+class WriteRequest final : public Request {
+public:
+    WriteRequest(std::shared_ptr<SocketState> state, const std::vector<boost::asio::const_buffer>& buffers,
+                 Operation* op)
+        : state_(std::move(state)), op_(op) {
+        iov_.reserve(buffers.size());
+        for (const auto& buffer : buffers) {
+            if (buffer.size() > 0) {
+                iov_.push_back(iovec{const_cast<void*>(buffer.data()), buffer.size()});
+                total_ += buffer.size();
+            }
+        }
+    }
+
+    ~WriteRequest() override {
+        if (op_) {
+            op_->destroy();
+        }
+    }
+
+    bool submit(Ring& ring) {
+        message_ = msghdr{};
+        message_.msg_iov = iov_.data() + first_;
+        message_.msg_iovlen = iov_.size() - first_;
+        return ring.push(this, state_.get(), [this](io_uring_sqe& sqe) {
+            state_->target(sqe);
+            sqe.opcode = IORING_OP_SENDMSG;
+            sqe.addr = reinterpret_cast<uint64_t>(&message_);
+            sqe.len = 1;
+            sqe.msg_flags = MSG_NOSIGNAL;
+        });
+    }
+
+    void on_cqe(Ring& ring, int result, uint32_t /*flags*/) override {
+        boost::system::error_code ec;
+        if (state_->closed.load(std::memory_order_acquire)) {
+            ec = boost::asio::error::operation_aborted;
+        } else if (result < 0) {
+            ec = errno_code(-result);
+        } else {
+            advance(static_cast<std::size_t>(result));
+            if (done_ < total_) {
+                if (submit(ring)) {
+                    return;
+                }
+                ec = boost::asio::error::operation_aborted;
+            }
+        }
+        Operation* op = op_;
+        std::size_t done = done_;
+        op_ = nullptr;
+        ring.retire(this);
+        op->complete(ec, done);
+    }
+
+    Operation* release_operation() {
+        Operation* op = op_;
+        op_ = nullptr;
+        return op;
+    }
+
+    bool empty() const {
+        return total_ == 0;
+    }
+
+private:
+    // 部分写出：跳过已写完的段，调整第一段的起点
+    void advance(std::size_t bytes) {
+        done_ += bytes;
+        while (bytes > 0 && first_ < iov_.size()) {
+            iovec& segment = iov_[first_];
+            if (bytes < segment.iov_len) {
+                segment.iov_base = static_cast<uint8_t*>(segment.iov_base) + bytes;
+                segment.iov_len -= bytes;
+                return;
+            }
+            bytes -= segment.iov_len;
+            ++first_;
+        }
+    }
+
+    std::shared_ptr<SocketState> state_;
+    std::vector<iovec, PoolAllocator<iovec>> iov_;
+    std::size_t first_ = 0;
+    std::size_t total_ = 0;
+    std::size_t done_ = 0;
+    msghdr message_{};
+    Operation* op_;
+};
+
+// 多发 accept：一个 SQE 持续产生 CQE，直到出错或被取消；
+// 内核不支持多发时（EINVAL）改为每次接受一个连接后重新提交
+class AcceptRequest final : public Request {
+public:
+    AcceptRequest(int listen_fd, std::function<void(int)> handler)
+        : listen_fd_(listen_fd), handler_(std::move(handler)) {}
+
+    bool submit(Ring& ring) {
+        return ring.push(this, nullptr, [this](io_uring_sqe& sqe) {
+            sqe.opcode = IORING_OP_ACCEPT;
+            sqe.fd = listen_fd_;
+            sqe.accept_flags = SOCK_CLOEXEC;
+            if (multishot_) {
+                sqe.ioprio = IORING_ACCEPT_MULTISHOT;
+            }
+        });
+    }
+
+    void on_cqe(Ring& ring, int result, uint32_t flags) override {
+        bool more = (flags & IORING_CQE_F_MORE) != 0;
+        if (result >= 0) {
+            accepted_ = true;
+            ring.count_accept();
+            handler_(result);
+        } else if (result == -EINVAL && multishot_ && !accepted_) {
+            multishot_ = false;
+        } else if (!transient(-result)) {
+            // 监听 socket 已关闭或 ring 正在关闭
+            if (!more) {
+                ring.retire(this);
+            }
+            return;
+        }
+        if (!more && !submit(ring)) {
+            ring.retire(this);
+        }
+    }
+
+private:
+    static bool transient(int error) {
+        return error == EAGAIN || error == EINTR || error == ECONNABORTED || error == EMFILE ||
+               error == ENFILE || error == ENOBUFS || error == ENOMEM || error == EPROTO || error == EPERM;
+    }
+
+    int listen_fd_;
+    std::function<void(int)> handler_;
+    bool multishot_ = true;
+    bool accepted_ = false;
+};
+
+} // namespace
+
+bool supported() {
+    static const bool result = probe();
+    return result;
+}
+
+UringStats stats() {
+    return Registry::instance().total();
+}
+
+Ring* ring_for(boost::asio::io_context& io) {
+    if (!supported()) {
+        return nullptr;
+    }
+    // 先让 io_context 创建反应器：服务按创建的逆序关闭，ring 须先于反应器关闭，
+    // 释放在途请求时连带销毁的 asio socket 仍可向反应器注销
+    boost::asio::posix::stream_descriptor reactor(io);
+    return boost::asio::use_service<RingService>(io).get(io);
+}
+
+Socket::Socket(Ring& ring, int fd) : state_(std::make_shared<SocketState>()) {
+    state_->ring = &ring;
+    state_->fd = fd;
+    state_->index = ring.register_file(fd);
+}
+
+Socket::~Socket() {
+    shutdown();
+}
+
+void Socket::shutdown() {
+    if (state_->closed.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    state_->ring->cancel(state_->fd, state_->index);
+    if (state_->index >= 0) {
+        state_->ring->unregister_file(state_->index);
+    }
+}
+
+void Socket::read(void* data, std::size_t size, bool exact, Operation* op) {
+    Ring& ring = *state_->ring;
+    auto* request = new ReadRequest(state_, static_cast<uint8_t*>(data), size, exact, op);
+    if (!request->submit(ring)) {
+        Operation* pending = request->release_operation();
+        ring.retire(request);
+        abort_later(ring, pending);
+    }
+}
+
+void Socket::write(const std::vector<boost::asio::const_buffer>& buffers, Operation* op) {
+    Ring& ring = *state_->ring;
+    auto* request = new WriteRequest(state_, buffers, op);
+    if (request->empty()) {
+        Operation* pending = request->release_operation();
+        ring.retire(request);
+        boost::asio::post(ring.context(), [pending]() { pending->complete(boost::system::error_code(), 0); });
+        return;
+    }
+    if (!request->submit(ring)) {
+        Operation* pending = request->release_operation();
+        ring.retire(request);
+        abort_later(ring, pending);
+    }
+}
+
+void async_accept(Ring& ring, int listen_fd, std::function<void(int fd)> handler) {
+    auto* request = new AcceptRequest(listen_fd, std::move(handler));
+    if (!request->submit(ring)) {
+        ring.retire(request);
+    }
+}
+
+void cancel(Ring& ring, int fd) {
+    ring.cancel(fd, -1);
+}
+
+#else // !HWP_HAS_IO_URING
+
+class Ring {};
+struct SocketState {};
+
+bool supported() {
+    return false;
+}
+
+UringStats stats() {
+    return UringStats();
+}
+
+Ring* ring_for(boost::asio::io_context& /*io*/) {
+    return nullptr;
+}
+
+Socket::Socket(Ring& /*ring*/, int /*fd*/) {}
+
+Socket::~Socket() = default;
+
+void Socket::shutdown() {}
+
+void Socket::read(void* /*data*/, std::size_t /*size*/, bool /*exact*/, Operation* op) {
+    op->destroy();
+}
+
+void Socket::write(const std::vector<boost::asio::const_buffer>& /*buffers*/, Operation* op) {
+    op->destroy();
+}
+
+void async_accept(Ring& /*ring*/, int /*listen_fd*/, std::function<void(int fd)> /*handler*/) {}
+
+void cancel(Ring& /*ring*/, int /*fd*/) {}
+
+#endif // HWP_HAS_IO_URING
+
+} // namespace uring
+} // namespace hwp
@@ -0,0 +1,107 @@
+// 抓包：多线程写入后按连接读回（连接内保持顺序）、max_bytes 丢弃与重新打开
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "../include/hwp/capture.hpp"
+#include "check.hpp"
+
+namespace {
+
+std::string temp_path(const char* name) {
+    return "/tmp/hwp_test_" + std::to_string(::getpid()) + "_" + name + ".cap";
+}
+
+hwp::Message frame(uint32_t seq, std::size_t size) {
+    hwp::Message msg = hwp::ProtocolHandler::create_message(hwp::MessageType::DATA, 1,
+                                                            std::vector<uint8_t>(size, static_cast<uint8_t>(seq)),
+                                                            static_cast<uint8_t>(hwp::Flags::BINARY_MODE));
+    msg.session_header.seq_num = seq;
+    return msg;
+}
+
+void record(hwp::capture::CaptureWriter& writer, uint64_t connection, uint32_t seq, std::size_t size) {
+    hwp::Message msg = frame(seq, size);
+    writer.record(connection, msg.base_header, msg.session_header, msg.payload.data(), msg.payload.size());
+}
+
+} // namespace
+
+TEST(threads_write_and_read_back_in_connection_order) {
+    std::string path = temp_path("threads");
+    hwp::capture::CaptureOptions options;
+    options.path = path;
+    options.buffer_size = 4096;     // 小缓冲区：每个线程多次交给后台线程
+    options.max_pending = 1 << 20;
+    hwp::capture::CaptureWriter writer;
+    CHECK(writer.open(options));
+
+    constexpr int THREADS = 4;
+    constexpr uint32_t FRAMES = 2000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&writer, t]() {
+            for (uint32_t seq = 1; seq <= FRAMES; ++seq) {
+                record(writer, static_cast<uint64_t>(t), seq, seq % 300);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    writer.close();
+    CHECK(writer.stats().records == THREADS * FRAMES);
+    CHECK(writer.stats().dropped == 0);
+
+    hwp::capture::CaptureReader reader;
+    CHECK(reader.open(path));
+    std::vector<uint32_t> last(THREADS, 0);
+    hwp::capture::CaptureRecord rec;
+    uint32_t count = 0;
+    while (reader.next(rec) == hwp::capture::CaptureReader::Status::OK) {
+        CHECK(rec.connection_id < THREADS);
+        CHECK(rec.session.seq_num == last[rec.connection_id] + 1);
+        CHECK(rec.session.payload_len == rec.session.seq_num % 300);
+        CHECK(!rec.truncated);
+        last[rec.connection_id] = rec.session.seq_num;
+        ++count;
+    }
+    CHECK(count == THREADS * FRAMES);
+    std::remove(path.c_str());
+}
+
+TEST(max_bytes_drops_and_reopen) {
+    std::string path = temp_path("limit");
+    hwp::capture::CaptureOptions options;
+    options.path = path;
+    options.max_bytes = hwp::capture::FILE_HEADER_SIZE + 10 * (hwp::capture::RECORD_HEADER_SIZE +
+                                                               hwp::FRAME_HEADER_SIZE + 100);
+    hwp::capture::CaptureWriter writer;
+    CHECK(writer.open(options));
+    for (uint32_t seq = 1; seq <= 15; ++seq) {
+        record(writer, 1, seq, 100);
+    }
+    writer.close();
+    CHECK(writer.stats().records == 10);
+    CHECK(writer.stats().dropped == 5);
+    // 关闭后的记录被忽略
+    record(writer, 1, 16, 100);
+    CHECK(writer.stats().records == 10);
+
+    // 同一写入器重新打开：线程缓冲区重新登记
+    CHECK(writer.open(options));
+    record(writer, 2, 1, 10);
+    writer.close();
+    CHECK(writer.stats().records == 1);
+    hwp::capture::CaptureReader reader;
+    CHECK(reader.open(path));
+    hwp::capture::CaptureRecord rec;
+    CHECK(reader.next(rec) == hwp::capture::CaptureReader::Status::OK);
+    CHECK(rec.connection_id == 2);
+    CHECK(reader.next(rec) == hwp::capture::CaptureReader::Status::END);
+    std::remove(path.c_str());
+}
+
+TEST_MAIN()
@@ -0,0 +1,62 @@
+// 单元测试共用：最小断言与用例登记，失败时打印位置，进程以失败数为退出码
+#ifndef HWP_TESTS_CHECK_HPP
+#define HWP_TESTS_CHECK_HPP
+
+#include <functional>
+#include <iostream>
+#include <vector>
+
+namespace test {
+
+struct Case {
+    const char* name;
+    std::function<void()> body;
+};
+
+inline std::vector<Case>& cases() {
+    static std::vector<Case> registry;
+    return registry;
+}
+
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+struct Register {
+    Register(const char* name, std::function<void()> body) { cases().push_back(Case{name, std::move(body)}); }
+};
+
+// 依次运行全部用例，返回失败的断言数
+inline int run_all() {
+    for (const Case& c : cases()) {
+        int before = failures();
+        c.body();
+        std::cout << (failures() == before ? "ok   " : "FAIL ") << c.name << "\n";
+    }
+    return failures();
+}
+
+} // namespace test
+
+#define TEST_CONCAT_INNER(a, b) a##b
+#define TEST_CONCAT(a, b) TEST_CONCAT_INNER(a, b)
+
+// TEST(name) { ... } 定义并登记一个用例
+#define TEST(name)                                                              \
+    static void test_##name();                                                  \
+    static test::Register TEST_CONCAT(register_, name)(#name, test_##name);     \
+    static void test_##name()
+
+#define CHECK(expr)                                                             \
+    do {                                                                        \
+        if (!(expr)) {                                                          \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #expr ") failed\n"; \
+            ++test::failures();                                                 \
+        }                                                                       \
+    } while (0)
+
+#define TEST_MAIN()                                                             \
+    int main() { return test::run_all() == 0 ? 0 : 1; }
+
+#endif // HWP_TESTS_CHECK_HPP
@@ -0,0 +1,73 @@
+// 压缩：往返解压，以及不可信前缀（原始长度、编码、字典）的拒绝
+#include <cstdint>
+#include <vector>
+#include "../include/hwp/compression.hpp"
+#include "check.hpp"
+
+namespace {
+
+hwp::Message data_message(std::vector<uint8_t> payload) {
+    return hwp::ProtocolHandler::create_message(hwp::MessageType::DATA, 1, std::move(payload),
+                                                static_cast<uint8_t>(hwp::Flags::BINARY_MODE));
+}
+
+// 手工构造的压缩消息：前缀 + deflate 数据
+hwp::Message compressed_message(uint8_t codec, uint32_t dictionary, uint32_t original, std::vector<uint8_t> body) {
+    std::vector<uint8_t> payload = {codec,
+                                    uint8_t(dictionary >> 24), uint8_t(dictionary >> 16), uint8_t(dictionary >> 8),
+                                    uint8_t(dictionary),
+                                    uint8_t(original >> 24), uint8_t(original >> 16), uint8_t(original >> 8),
+                                    uint8_t(original)};
+    payload.insert(payload.end(), body.begin(), body.end());
+    hwp::Message msg = data_message(std::move(payload));
+    msg.base_header.flags |= static_cast<uint8_t>(hwp::Flags::COMPRESSED);
+    return msg;
+}
+
+} // namespace
+
+TEST(round_trip) {
+    hwp::compress::CompressionOptions options;
+    options.enabled = true;
+    options.dictionary_size = 0;
+    hwp::compress::Compressor compressor(options);
+    hwp::compress::Decompressor decompressor;
+
+    for (std::size_t size : {std::size_t(100), std::size_t(20000), std::size_t(4) << 20}) {
+        std::vector<uint8_t> payload(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            payload[i] = static_cast<uint8_t>(i % 7);
+        }
+        hwp::Message msg = data_message(payload);
+        uint32_t announced = 0;
+        std::vector<hwp::Message> control;
+        compressor.compress(msg, announced, control);
+        CHECK((msg.base_header.flags & static_cast<uint8_t>(hwp::Flags::COMPRESSED)) != 0);
+        CHECK(msg.payload.size() < size);
+        CHECK(decompressor.decompress(msg));
+        CHECK(msg.payload == payload);
+        CHECK((msg.base_header.flags & static_cast<uint8_t>(hwp::Flags::COMPRESSED)) == 0);
+    }
+}
+
+TEST(untrusted_prefix_rejected) {
+    hwp::compress::Decompressor decompressor;
+    // 9 字节前缀声称 64 MiB：超出 deflate 的膨胀上限，不分配
+    hwp::Message bomb = compressed_message(0x02, 0, 64u << 20, {0x03, 0x00});
+    CHECK(!decompressor.decompress(bomb));
+    hwp::Message empty = compressed_message(0x02, 0, 64u << 20, {});
+    CHECK(!decompressor.decompress(empty));
+    // 未知编码、未通告的字典、截断的前缀
+    hwp::Message codec = compressed_message(0x09, 0, 1, {0x03, 0x00});
+    CHECK(!decompressor.decompress(codec));
+    hwp::Message dictionary = compressed_message(0x01, 42, 1, {0x03, 0x00});
+    CHECK(!decompressor.decompress(dictionary));
+    hwp::Message truncated = data_message({0x01, 0x00});
+    truncated.base_header.flags |= static_cast<uint8_t>(hwp::Flags::COMPRESSED);
+    CHECK(!decompressor.decompress(truncated));
+    // 原始长度与解出的长度不一致（空的 deflate 块声称 10 字节）
+    hwp::Message mismatch = compressed_message(0x01, 0, 10, {0x03, 0x00});
+    CHECK(!decompressor.decompress(mismatch));
+}
+
+TEST_MAIN()
@@ -0,0 +1,60 @@
+// EgressScheduler：优先级之间的先后，以及会话内提交顺序（文件传输的 START / DATA / END）
+#include <cstdint>
+#include <vector>
+#include "../include/hwp/egress.hpp"
+#include "check.hpp"
+
+namespace {
+
+hwp::OutgoingFrame frame(hwp::MessageType type, uint32_t session_id, std::size_t size = 16) {
+    return hwp::OutgoingFrame(hwp::ProtocolHandler::create_message(type, session_id, std::vector<uint8_t>(size),
+                                                                   static_cast<uint8_t>(hwp::Flags::BINARY_MODE)));
+}
+
+std::vector<hwp::MessageType> drain(hwp::EgressScheduler& scheduler) {
+    std::vector<hwp::MessageType> order;
+    hwp::OutgoingFrame out;
+    while (scheduler.pop(out)) {
+        order.push_back(out.msg_type());
+    }
+    return order;
+}
+
+} // namespace
+
+TEST(control_before_data_before_bulk) {
+    hwp::EgressScheduler scheduler;
+    scheduler.push(frame(hwp::MessageType::FILE_TRANSFER_DATA, 1));
+    scheduler.push(frame(hwp::MessageType::DATA, 1));
+    scheduler.push(frame(hwp::MessageType::CONTROL, 1));
+    std::vector<hwp::MessageType> order = drain(scheduler);
+    CHECK((order == std::vector<hwp::MessageType>{hwp::MessageType::CONTROL, hwp::MessageType::DATA,
+                                                 hwp::MessageType::FILE_TRANSFER_DATA}));
+}
+
+TEST(file_transfer_order_within_session) {
+    hwp::EgressScheduler scheduler;
+    scheduler.push(frame(hwp::MessageType::FILE_TRANSFER_START, 1));
+    scheduler.push(frame(hwp::MessageType::FILE_TRANSFER_DATA, 1, 4096));
+    scheduler.push(frame(hwp::MessageType::FILE_TRANSFER_DATA, 1, 4096));
+    scheduler.push(frame(hwp::MessageType::FILE_TRANSFER_END, 1));
+    // 其他会话的普通消息不影响本会话文件传输帧之间的顺序
+    scheduler.push(frame(hwp::MessageType::DATA, 2));
+    std::vector<hwp::MessageType> order = drain(scheduler);
+    CHECK((order == std::vector<hwp::MessageType>{hwp::MessageType::DATA, hwp::MessageType::FILE_TRANSFER_START,
+                                                 hwp::MessageType::FILE_TRANSFER_DATA,
+                                                 hwp::MessageType::FILE_TRANSFER_DATA,
+                                                 hwp::MessageType::FILE_TRANSFER_END}));
+}
+
+TEST(priority_off_keeps_submission_order) {
+    hwp::EgressOptions options;
+    options.priority = false;
+    hwp::EgressScheduler scheduler(options);
+    scheduler.push(frame(hwp::MessageType::FILE_TRANSFER_DATA, 1));
+    scheduler.push(frame(hwp::MessageType::CONTROL, 2));
+    std::vector<hwp::MessageType> order = drain(scheduler);
+    CHECK((order == std::vector<hwp::MessageType>{hwp::MessageType::FILE_TRANSFER_DATA, hwp::MessageType::CONTROL}));
+}
+
+TEST_MAIN()
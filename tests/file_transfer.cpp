@@ -0,0 +1,68 @@
+// FileSink：写入不得超过 START 声明的文件大小
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "../include/hwp/file_transfer.hpp"
+#include "check.hpp"
+
+namespace {
+
+const std::string DIR = "/tmp";
+
+std::string file_name(const char* name) {
+    return "hwp_test_" + std::to_string(::getpid()) + "_" + name;
+}
+
+void remove_files(const std::string& name) {
+    std::remove((DIR + "/" + name).c_str());
+    std::remove((DIR + "/" + name + ".part").c_str());
+}
+
+} // namespace
+
+TEST(write_past_total_size_rejected) {
+    std::string name = file_name("write");
+    remove_files(name);
+    {
+        hwp::transfer::FileSink sink;
+        CHECK(sink.open(DIR, name, 10) == hwp::transfer::TransferStatus::OK);
+        std::vector<uint8_t> data(8, 0x5a);
+        CHECK(sink.write(data.data(), data.size()));
+        errno = 0;
+        CHECK(!sink.write(data.data(), 3));
+        CHECK(errno == EFBIG);
+        CHECK(sink.state().bytes_transferred == 8);
+        CHECK(sink.write(data.data(), 2));
+        CHECK(sink.finish(10) == hwp::transfer::TransferStatus::OK);
+    }
+    remove_files(name);
+}
+
+TEST(splice_past_total_size_rejected_before_reading) {
+    std::string name = file_name("splice");
+    remove_files(name);
+    int fds[2];
+    CHECK(::pipe(fds) == 0);
+    std::vector<uint8_t> data(16, 0xa5);
+    CHECK(::write(fds[1], data.data(), data.size()) == static_cast<ssize_t>(data.size()));
+    {
+        hwp::transfer::FileSink sink;
+        CHECK(sink.open(DIR, name, 4) == hwp::transfer::TransferStatus::OK);
+        errno = 0;
+        CHECK(sink.splice_from(fds[0], data.size()) == -1);
+        CHECK(errno == EFBIG);
+        CHECK(sink.state().bytes_transferred == 0);
+        CHECK(sink.finish(4) == hwp::transfer::TransferStatus::SIZE_MISMATCH);
+        // 数据仍留在 socket 中，没有被读走
+        uint8_t byte = 0;
+        CHECK(::read(fds[0], &byte, 1) == 1 && byte == 0xa5);
+    }
+    ::close(fds[0]);
+    ::close(fds[1]);
+    remove_files(name);
+}
+
+TEST_MAIN()
@@ -0,0 +1,204 @@
+// RequestParser：增量与流水线解析、chunked 请求体、请求走私与头部上限
+#include <string>
+#include "../include/hwp/http.hpp"
+#include "check.hpp"
+
+namespace {
+
+using hwp::http::ParseStatus;
+
+struct Parsed {
+    ParseStatus status;
+    hwp::http::Request request;
+    std::size_t consumed = 0;
+};
+
+// 一次性解析整条报文（缓冲区由调用方保持）
+Parsed parse(std::string& buffer) {
+    hwp::http::RequestParser parser;
+    Parsed result;
+    result.status = parser.parse(buffer.data(), buffer.size(), result.request);
+    result.consumed = parser.consumed();
+    return result;
+}
+
+ParseStatus status_of(std::string text) {
+    return parse(text).status;
+}
+
+} // namespace
+
+TEST(simple_get) {
+    std::string text = "GET /index.html HTTP/1.1\r\nHost: example\r\nX-Empty:\r\n\r\n";
+    Parsed parsed = parse(text);
+    CHECK(parsed.status == ParseStatus::COMPLETE);
+    CHECK(parsed.consumed == text.size());
+    CHECK(parsed.request.method == "GET");
+    CHECK(parsed.request.target == "/index.html");
+    CHECK(parsed.request.version_minor == 1);
+    CHECK(parsed.request.keep_alive);
+    CHECK(parsed.request.header("host") == "example");
+    CHECK(parsed.request.header("x-empty").empty());
+    CHECK(parsed.request.body.empty());
+}
+
+TEST(connection_semantics) {
+    std::string http10 = "GET / HTTP/1.0\r\n\r\n";
+    CHECK(!parse(http10).request.keep_alive);
+    std::string http10_keep = "GET / HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n";
+    CHECK(parse(http10_keep).request.keep_alive);
+    std::string close = "GET / HTTP/1.1\r\nConnection: upgrade, close\r\n\r\n";
+    CHECK(!parse(close).request.keep_alive);
+}
+
+TEST(incremental_byte_by_byte) {
+    std::string text = "POST /submit HTTP/1.1\r\nContent-Length: 5\r\n\r\nhello";
+    hwp::http::RequestParser parser;
+    hwp::http::Request request;
+    for (std::size_t length = 0; length < text.size(); ++length) {
+        CHECK(parser.parse(text.data(), length, request) == ParseStatus::NEED_MORE);
+    }
+    CHECK(parser.parse(text.data(), text.size(), request) == ParseStatus::COMPLETE);
+    CHECK(request.body == "hello");
+    CHECK(parser.consumed() == text.size());
+}
+
+TEST(pipelined_requests) {
+    std::string text = "GET /a HTTP/1.1\r\n\r\nPOST /b HTTP/1.1\r\nContent-Length: 2\r\n\r\nokGET /c HTTP/1.1\r\n";
+    hwp::http::RequestParser parser;
+    hwp::http::Request request;
+    std::size_t offset = 0;
+
+    CHECK(parser.parse(text.data(), text.size(), request) == ParseStatus::COMPLETE);
+    CHECK(request.target == "/a");
+    offset += parser.consumed();
+    parser.reset();
+
+    CHECK(parser.parse(text.data() + offset, text.size() - offset, request) == ParseStatus::COMPLETE);
+    CHECK(request.target == "/b");
+    CHECK(request.body == "ok");
+    offset += parser.consumed();
+    parser.reset();
+
+    CHECK(parser.parse(text.data() + offset, text.size() - offset, request) == ParseStatus::NEED_MORE);
+}
+
+TEST(buffer_moved_between_calls) {
+    std::string first = "POST /m HTTP/1.1\r\nContent-Length: 4\r\n\r\nab";
+    hwp::http::RequestParser parser;
+    hwp::http::Request request;
+    CHECK(parser.parse(first.data(), first.size(), request) == ParseStatus::NEED_MORE);
+    // 连接缓冲区搬移到新位置后继续：头部字段须指向新缓冲区
+    std::string moved = first + "cd";
+    first.assign(first.size(), 'x');
+    CHECK(parser.parse(moved.data(), moved.size(), request) == ParseStatus::COMPLETE);
+    CHECK(request.target == "/m");
+    CHECK(request.body == "abcd");
+}
+
+TEST(chunked_body) {
+    std::string text = "POST /c HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+                       "5\r\nhello\r\n6;ext=1\r\n world\r\n0\r\nX-Trailer: t\r\n\r\n";
+    Parsed parsed = parse(text);
+    CHECK(parsed.status == ParseStatus::COMPLETE);
+    CHECK(parsed.request.body == "hello world");
+    CHECK(parsed.consumed == text.size());
+
+    // 逐字节到达，包括拆开 chunk 大小行与数据；原地解码只改动已到达的部分
+    std::string whole = "POST /c HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+                        "a\r\n0123456789\r\n0\r\n\r\nGET";
+    std::size_t end = whole.size() - 3;
+    hwp::http::RequestParser parser;
+    hwp::http::Request request;
+    for (std::size_t length = 0; length < end; ++length) {
+        CHECK(parser.parse(whole.data(), length, request) == ParseStatus::NEED_MORE);
+    }
+    CHECK(parser.parse(whole.data(), whole.size(), request) == ParseStatus::COMPLETE);
+    CHECK(request.body == "0123456789");
+    CHECK(parser.consumed() == end);
+}
+
+TEST(chunked_malformed) {
+    const std::string head = "POST /c HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n";
+    // 数据后缺少 CRLF
+    CHECK(status_of(head + "3\r\nabcX\r\n0\r\n\r\n") == ParseStatus::ERROR);
+    // 非十六进制与溢出的大小
+    CHECK(status_of(head + "zz\r\n") == ParseStatus::ERROR);
+    CHECK(status_of(head + "ffffffffffffffffff\r\n") == ParseStatus::ERROR);
+    // 超过请求体上限
+    CHECK(status_of(head + "8000000\r\n") == ParseStatus::ERROR);
+    // 大小行过长
+    CHECK(status_of(head + "1;" + std::string(2000, 'e')) == ParseStatus::ERROR);
+}
+
+TEST(request_smuggling_rejected) {
+    // 两种分帧方式同时出现
+    CHECK(status_of("POST / HTTP/1.1\r\nContent-Length: 3\r\nTransfer-Encoding: chunked\r\n\r\n") ==
+          ParseStatus::ERROR);
+    CHECK(status_of("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\nContent-Length: 3\r\n\r\n") ==
+          ParseStatus::ERROR);
+    // 互相矛盾的 Content-Length；相同的重复值可以接受
+    CHECK(status_of("POST / HTTP/1.1\r\nContent-Length: 3\r\nContent-Length: 4\r\n\r\nabcd") == ParseStatus::ERROR);
+    CHECK(status_of("POST / HTTP/1.1\r\nContent-Length: 3\r\nContent-Length: 3\r\n\r\nabc") ==
+          ParseStatus::COMPLETE);
+    // 非法的长度值
+    CHECK(status_of("POST / HTTP/1.1\r\nContent-Length: -1\r\n\r\n") == ParseStatus::ERROR);
+    CHECK(status_of("POST / HTTP/1.1\r\nContent-Length: 1x\r\n\r\n") == ParseStatus::ERROR);
+    CHECK(status_of("POST / HTTP/1.1\r\nContent-Length: 99999999999999999999999\r\n\r\n") == ParseStatus::ERROR);
+    // 不支持的传输编码
+    CHECK(status_of("POST / HTTP/1.1\r\nTransfer-Encoding: gzip\r\n\r\n") == ParseStatus::ERROR);
+    // chunked 之外还有其他编码，或 chunked 不是唯一的编码
+    CHECK(status_of("POST / HTTP/1.1\r\nTransfer-Encoding: gzip, chunked\r\n\r\n0\r\n\r\n") == ParseStatus::ERROR);
+    CHECK(status_of("POST / HTTP/1.1\r\nTransfer-Encoding: chunked, gzip\r\n\r\n0\r\n\r\n") == ParseStatus::ERROR);
+    CHECK(status_of("POST / HTTP/1.1\r\nTransfer-Encoding: chunked, chunked\r\n\r\n0\r\n\r\n") ==
+          ParseStatus::ERROR);
+    CHECK(status_of("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\nTransfer-Encoding: chunked\r\n\r\n"
+                    "0\r\n\r\n") == ParseStatus::ERROR);
+    CHECK(status_of("POST / HTTP/1.1\r\nTransfer-Encoding: Chunked\r\n\r\n0\r\n\r\n") == ParseStatus::COMPLETE);
+    // 头部名后有空白（代理可能与本端理解不同）
+    CHECK(status_of("POST / HTTP/1.1\r\nContent-Length : 3\r\n\r\nabc") == ParseStatus::ERROR);
+}
+
+TEST(malformed_request_line) {
+    CHECK(status_of("GET\r\n\r\n") == ParseStatus::ERROR);
+    CHECK(status_of(" / HTTP/1.1\r\n\r\n") == ParseStatus::ERROR);
+    CHECK(status_of("GET  HTTP/1.1\r\n\r\n") == ParseStatus::ERROR);
+    CHECK(status_of("GET / HTTP/2.0\r\n\r\n") == ParseStatus::ERROR);
+    CHECK(status_of("GET / HTTP/1.x\r\n\r\n") == ParseStatus::ERROR);
+    CHECK(status_of("GET / HTTP/1.1\r\nNoColon\r\n\r\n") == ParseStatus::ERROR);
+    CHECK(status_of("GET / HTTP/1.1\r\n: empty-name\r\n\r\n") == ParseStatus::ERROR);
+}
+
+TEST(header_limits) {
+    std::string many = "GET / HTTP/1.1\r\n";
+    for (std::size_t i = 0; i < hwp::http::MAX_HEADERS; ++i) {
+        many += "X-H" + std::to_string(i) + ": v\r\n";
+    }
+    std::string at_limit = many + "\r\n";
+    CHECK(parse(at_limit).status == ParseStatus::COMPLETE);
+    CHECK(parse(at_limit).request.header_count == hwp::http::MAX_HEADERS);
+    CHECK(status_of(many + "X-Extra: v\r\n\r\n") == ParseStatus::ERROR);
+
+    // 头部超过上限：无论是否已看到结束空行
+    std::string huge = "GET / HTTP/1.1\r\nX-Big: " + std::string(hwp::http::MAX_HEADER_BYTES, 'a');
+    CHECK(status_of(huge) == ParseStatus::ERROR);
+    CHECK(status_of(huge + "\r\n\r\n") == ParseStatus::ERROR);
+
+    // 请求体超过上限
+    CHECK(status_of("POST / HTTP/1.1\r\nContent-Length: " + std::to_string(hwp::http::MAX_BODY_BYTES + 1) +
+                    "\r\n\r\n") == ParseStatus::ERROR);
+}
+
+TEST(find_crlf_positions) {
+    // 覆盖向量化路径的各个偏移
+    for (std::size_t at = 0; at < 40; ++at) {
+        std::string text(48, 'a');
+        text[at] = '\r';
+        text[at + 1] = '\n';
+        CHECK(hwp::http::find_crlf(text.data(), text.data() + text.size()) == text.data() + at);
+    }
+    std::string lone = std::string(20, 'a') + "\r" + std::string(20, 'b') + "\n";
+    CHECK(hwp::http::find_crlf(lone.data(), lone.data() + lone.size()) == lone.data() + lone.size());
+}
+
+TEST_MAIN()
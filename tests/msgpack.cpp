@@ -0,0 +1,254 @@
+// msgpack：往返编码、字段增减的兼容、截断与长度字段越界、数值范围与嵌套深度
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../include/hwp/msgpack.hpp"
+#include "check.hpp"
+
+namespace {
+
+struct Order {
+    uint64_t id = 0;
+    int32_t delta = 0;
+    std::string_view symbol;
+    hwp::msgpack::Bytes blob;
+    std::span<const int32_t> fills;
+    std::optional<double> price;
+    bool urgent = false;
+    HWP_MSGPACK(id, delta, symbol, blob, fills, price, urgent)
+};
+
+// 旧版本：只有前两个字段
+struct OrderV1 {
+    uint64_t id = 0;
+    int32_t delta = 0;
+    HWP_MSGPACK(id, delta)
+};
+
+// 新版本：末尾追加字段
+struct OrderV3 {
+    uint64_t id = 0;
+    int32_t delta = 0;
+    std::string_view symbol;
+    hwp::msgpack::Bytes blob;
+    std::span<const int32_t> fills;
+    std::optional<double> price;
+    bool urgent = false;
+    uint32_t extra = 99;
+    HWP_MSGPACK(id, delta, symbol, blob, fills, price, urgent, extra)
+};
+
+struct Owned {
+    std::string name;
+    std::vector<uint16_t> values;
+    std::map<std::string, int64_t> counters;
+    HWP_MSGPACK(name, values, counters)
+};
+
+template <typename T>
+std::vector<uint8_t> encode(const T& value) {
+    std::vector<uint8_t> out(hwp::msgpack::encoded_size(value));
+    CHECK(hwp::msgpack::encode(value, out.data()) == out.size());
+    return out;
+}
+
+template <typename T>
+bool decode(const std::vector<uint8_t>& data, T& out) {
+    hwp::msgpack::Arena arena;
+    return hwp::msgpack::decode(data.data(), data.size(), out, arena);
+}
+
+const int32_t FILLS[] = {1, -2, 70000, -70000};
+const uint8_t BLOB[] = {0, 1, 2, 0xff};
+
+Order sample() {
+    Order order;
+    order.id = 0x123456789abcull;
+    order.delta = -300;
+    order.symbol = "HWP";
+    order.blob = hwp::msgpack::Bytes(BLOB, sizeof(BLOB));
+    order.fills = std::span<const int32_t>(FILLS, 4);
+    order.price = 12.5;
+    order.urgent = true;
+    return order;
+}
+
+} // namespace
+
+TEST(round_trip_views) {
+    std::vector<uint8_t> data = encode(sample());
+    hwp::msgpack::Arena arena;
+    Order out;
+    CHECK(hwp::msgpack::decode(data.data(), data.size(), out, arena));
+    CHECK(out.id == 0x123456789abcull);
+    CHECK(out.delta == -300);
+    CHECK(out.symbol == "HWP");
+    // 视图指向输入缓冲区
+    CHECK(out.symbol.data() >= reinterpret_cast<const char*>(data.data()) &&
+          out.symbol.data() < reinterpret_cast<const char*>(data.data() + data.size()));
+    CHECK(out.blob.size() == 4 && out.blob[3] == 0xff);
+    CHECK(out.fills.size() == 4 && out.fills[2] == 70000 && out.fills[3] == -70000);
+    CHECK(out.price && *out.price == 12.5);
+    CHECK(out.urgent);
+}
+
+TEST(round_trip_owned) {
+    Owned value;
+    value.name = std::string(40, 'n');
+    value.values = {0, 1, 65535};
+    value.counters = {{"a", -1}, {"b", INT64_MIN}, {"c", INT64_MAX}};
+    Owned out;
+    CHECK(decode(encode(value), out));
+    CHECK(out.name == value.name);
+    CHECK(out.values == value.values);
+    CHECK(out.counters == value.counters);
+}
+
+TEST(integer_widths) {
+    const int64_t values[] = {0, 1, 127, 128, 255, 256, 65535, 65536, -1, -32, -33, -128, -129,
+                              -32768, -32769, INT32_MIN, int64_t(INT32_MIN) - 1, INT64_MIN, INT64_MAX};
+    for (int64_t v : values) {
+        int64_t out = 0;
+        CHECK(decode(encode(v), out));
+        CHECK(out == v);
+    }
+    uint64_t big = UINT64_MAX;
+    uint64_t out = 0;
+    CHECK(decode(encode(big), out) && out == big);
+}
+
+TEST(integer_out_of_range) {
+    uint8_t small = 0;
+    CHECK(!decode(encode(uint32_t(300)), small));
+    uint32_t unsigned_value = 0;
+    CHECK(!decode(encode(int32_t(-1)), unsigned_value));
+    int8_t narrow = 0;
+    CHECK(!decode(encode(int32_t(-129)), narrow));
+    int64_t wide = 0;
+    CHECK(!decode(encode(UINT64_MAX), wide));
+    // 类型不符
+    bool flag = false;
+    CHECK(!decode(encode(uint32_t(1)), flag));
+    CHECK(!decode(encode(std::string("x")), unsigned_value));
+}
+
+TEST(schema_evolution) {
+    std::vector<uint8_t> data = encode(sample());
+    // 多出的字段跳过
+    OrderV1 v1;
+    CHECK(decode(data, v1));
+    CHECK(v1.id == 0x123456789abcull && v1.delta == -300);
+    // 缺少的字段保持默认值
+    OrderV3 v3;
+    CHECK(decode(data, v3));
+    CHECK(v3.symbol == "HWP" && v3.urgent && v3.extra == 99);
+}
+
+TEST(truncated_input_rejected) {
+    std::vector<uint8_t> data = encode(sample());
+    for (std::size_t length = 0; length < data.size(); ++length) {
+        std::vector<uint8_t> prefix(data.begin(), data.begin() + static_cast<std::ptrdiff_t>(length));
+        Order out;
+        CHECK(!decode(prefix, out));
+    }
+    // 多余的字节
+    data.push_back(0xc0);
+    Order out;
+    CHECK(!decode(data, out));
+}
+
+TEST(oversized_lengths_rejected) {
+    hwp::msgpack::Arena arena;
+    // array32 声称 2^32-1 个元素，实际只有一个：不按声称的长度分配
+    const uint8_t huge_array[] = {0xdd, 0xff, 0xff, 0xff, 0xff, 0x01};
+    std::span<const int32_t> fills;
+    CHECK(!hwp::msgpack::decode(huge_array, sizeof(huge_array), fills, arena));
+    CHECK(arena.heap_bytes() == 0);
+    std::vector<int32_t> values;
+    CHECK(!hwp::msgpack::decode(huge_array, sizeof(huge_array), values, arena));
+    CHECK(values.capacity() < 1024);
+
+    // str32 / bin32 的长度超出剩余字节
+    const uint8_t huge_str[] = {0xdb, 0x7f, 0xff, 0xff, 0xff, 'a'};
+    std::string_view text;
+    CHECK(!hwp::msgpack::decode(huge_str, sizeof(huge_str), text, arena));
+    const uint8_t huge_bin[] = {0xc6, 0x00, 0x00, 0x01, 0x00, 0x00};
+    hwp::msgpack::Bytes blob;
+    CHECK(!hwp::msgpack::decode(huge_bin, sizeof(huge_bin), blob, arena));
+
+    // map32 声称大量条目
+    const uint8_t huge_map[] = {0xdf, 0xff, 0xff, 0xff, 0xff, 0xa1, 'k', 0x01};
+    std::map<std::string, int64_t> counters;
+    CHECK(!hwp::msgpack::decode(huge_map, sizeof(huge_map), counters, arena));
+
+    // 声称的元素个数不超过剩余字节，但每个元素解码后远大于 1 字节：
+    // 第一个元素即失败时只分配了预留的一小段，不按声称的个数分配
+    std::vector<uint8_t> wide = {0xdc, 0xea, 0x60};
+    wide.insert(wide.end(), 60000, 0xc1);
+    std::span<const OrderV1> orders;
+    CHECK(!hwp::msgpack::decode(wide.data(), wide.size(), orders, arena));
+    CHECK(arena.heap_bytes() < 4096);
+    std::vector<OrderV1> owned;
+    CHECK(!hwp::msgpack::decode(wide.data(), wide.size(), owned, arena));
+    CHECK(owned.capacity() <= 64);
+
+    // 结构体数组头声称的字段数远多于实际，逐个跳过直到数据耗尽
+    const uint8_t huge_fields[] = {0xdd, 0xff, 0xff, 0xff, 0xff, 0x01, 0x02, 0x03};
+    OrderV1 v1;
+    CHECK(!hwp::msgpack::decode(huge_fields, sizeof(huge_fields), v1, arena));
+}
+
+TEST(skip_depth_limited) {
+    // 在 OrderV1 之后追加一个嵌套 n 层的数组作为多余字段
+    auto nested = [](int depth) {
+        std::vector<uint8_t> data(static_cast<std::size_t>(depth) + 4, 0x91);
+        data[0] = 0x93;
+        data[1] = 0x01;
+        data[2] = 0x02;
+        data.back() = 0xc0;
+        return data;
+    };
+    OrderV1 v1;
+    CHECK(decode(nested(10), v1));
+    CHECK(v1.id == 1 && v1.delta == 2);
+    CHECK(!decode(nested(10000), v1));
+
+    // 跳过各类值：扩展类型、浮点、map、nil
+    std::vector<uint8_t> data = {0x96, 0x05, 0x06,
+                                 0xd4, 0x01, 0x00,                         // fixext1
+                                 0xcb, 0, 0, 0, 0, 0, 0, 0, 0,              // float64
+                                 0x81, 0xa1, 'k', 0xc3,                     // {"k": true}
+                                 0xc7, 0x02, 0x05, 0xaa, 0xbb};             // ext8
+    CHECK(decode(data, v1));
+    CHECK(v1.id == 5 && v1.delta == 6);
+    // 扩展类型长度越界
+    data[data.size() - 4] = 0x10;
+    CHECK(!decode(data, v1));
+}
+
+TEST(arena_grows_and_resets) {
+    std::vector<int32_t> many(5000);
+    for (std::size_t i = 0; i < many.size(); ++i) {
+        many[i] = static_cast<int32_t>(i) - 2500;
+    }
+    std::vector<uint8_t> data = encode(many);
+    hwp::msgpack::Arena arena;
+    std::span<const int32_t> view;
+    CHECK(hwp::msgpack::decode(data.data(), data.size(), view, arena));
+    CHECK(view.size() == many.size() && view[0] == -2500 && view[4999] == 2499);
+    CHECK(arena.heap_bytes() >= many.size() * sizeof(int32_t));
+    arena.reset();
+    CHECK(arena.heap_bytes() == 0);
+
+    // 小消息只用内联块
+    std::vector<uint8_t> small = encode(sample());
+    Order out;
+    CHECK(hwp::msgpack::decode(small.data(), small.size(), out, arena));
+    CHECK(arena.heap_bytes() == 0);
+}
+
+TEST_MAIN()
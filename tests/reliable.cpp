@@ -0,0 +1,235 @@
+// ReliableChannel：接收端的乱序与去重、发送窗口、选择确认、断线补发与 FORWARD
+#include <utility>
+#include <vector>
+#include "../include/hwp.hpp"
+#include "check.hpp"
+
+namespace {
+
+constexpr uint32_t SESSION = 7;
+
+hwp::Message request(uint8_t tag) {
+    return hwp::ProtocolHandler::create_message(hwp::MessageType::DATA, SESSION, std::vector<uint8_t>{tag},
+                                                static_cast<uint8_t>(hwp::Flags::BINARY_MODE));
+}
+
+// 已编码帧头中的会话头
+hwp::SessionHeader header_of(const hwp::OutgoingFrame& frame, uint8_t* flags = nullptr) {
+    hwp::FrameView view{};
+    hwp::FrameDecoder::decode_header(frame.header_data(), view);
+    if (flags) {
+        *flags = view.base.flags;
+    }
+    return view.session;
+}
+
+hwp::AckInfo ack_of(uint32_t cumulative, std::vector<std::pair<uint32_t, uint32_t>> ranges = {}) {
+    hwp::AckInfo ack;
+    ack.session_id = SESSION;
+    ack.cumulative = cumulative;
+    ack.ranges = std::move(ranges);
+    return ack;
+}
+
+using Ranges = std::vector<std::pair<uint32_t, uint32_t>>;
+
+} // namespace
+
+TEST(receive_in_order_and_duplicates) {
+    hwp::ReliableChannel channel;
+    CHECK(channel.on_receive(1, true) == hwp::ReliableChannel::Receive::IN_ORDER);
+    CHECK(channel.on_receive(2, true) == hwp::ReliableChannel::Receive::IN_ORDER);
+    CHECK(channel.on_receive(2, true) == hwp::ReliableChannel::Receive::DUPLICATE);
+    CHECK(channel.on_receive(1, true) == hwp::ReliableChannel::Receive::DUPLICATE);
+    // 普通消息的序列号只推进累计确认号，不判重复
+    CHECK(channel.on_receive(2, false) != hwp::ReliableChannel::Receive::DUPLICATE);
+    CHECK(channel.ack_state().cumulative == 2);
+    CHECK(channel.stats().received == 2);
+    CHECK(channel.stats().duplicates == 2);
+}
+
+TEST(receive_reorder_builds_sack_ranges) {
+    hwp::ReliableChannel channel;
+    channel.on_receive(1, true);
+    CHECK(channel.on_receive(3, true) == hwp::ReliableChannel::Receive::OUT_OF_ORDER);
+    CHECK(channel.on_receive(5, true) == hwp::ReliableChannel::Receive::OUT_OF_ORDER);
+    CHECK(channel.on_receive(6, true) == hwp::ReliableChannel::Receive::OUT_OF_ORDER);
+    hwp::AckInfo ack = channel.ack_state();
+    CHECK(ack.cumulative == 1);
+    CHECK((ack.ranges == Ranges{{3, 3}, {5, 6}}));
+    // 区间内的重复
+    CHECK(channel.on_receive(5, true) == hwp::ReliableChannel::Receive::DUPLICATE);
+
+    // 填上空洞后区间并入累计确认号
+    CHECK(channel.on_receive(4, true) == hwp::ReliableChannel::Receive::OUT_OF_ORDER);
+    CHECK((channel.ack_state().ranges == Ranges{{3, 6}}));
+    CHECK(channel.on_receive(2, true) == hwp::ReliableChannel::Receive::IN_ORDER);
+    ack = channel.ack_state();
+    CHECK(ack.cumulative == 6);
+    CHECK(ack.ranges.empty());
+}
+
+TEST(receive_across_sequence_wrap) {
+    hwp::ReliableChannel channel;
+    channel.on_forward(0x7fffffffu);
+    channel.on_forward(0xfffffffdu);
+    // 发送方回绕时跳过 0：0xffffffff 之后是 1
+    CHECK(channel.on_receive(0xfffffffeu, true) == hwp::ReliableChannel::Receive::IN_ORDER);
+    CHECK(channel.on_receive(1, true) == hwp::ReliableChannel::Receive::OUT_OF_ORDER);
+    CHECK(channel.on_receive(2, true) == hwp::ReliableChannel::Receive::OUT_OF_ORDER);
+    CHECK((channel.ack_state().ranges == Ranges{{1, 2}}));
+    CHECK(channel.on_receive(0xffffffffu, true) == hwp::ReliableChannel::Receive::IN_ORDER);
+    CHECK(channel.ack_state().cumulative == 2);
+    CHECK(channel.ack_state().ranges.empty());
+    CHECK(channel.on_receive(3, true) == hwp::ReliableChannel::Receive::IN_ORDER);
+    CHECK(channel.on_receive(0xfffffffeu, true) == hwp::ReliableChannel::Receive::DUPLICATE);
+    CHECK(hwp::seq_after(1, 0xffffffffu));
+}
+
+TEST(forward_skips_holes) {
+    hwp::ReliableChannel channel;
+    channel.on_receive(3, true);
+    channel.on_receive(6, true);
+    channel.on_forward(2);
+    hwp::AckInfo ack = channel.ack_state();
+    CHECK(ack.cumulative == 3);
+    CHECK((ack.ranges == Ranges{{6, 6}}));
+    // 不会回退
+    channel.on_forward(1);
+    CHECK(channel.ack_state().cumulative == 3);
+}
+
+TEST(sack_ranges_limited_in_ack) {
+    hwp::ReliableOptions options;
+    options.max_sack_ranges = 2;
+    hwp::ReliableChannel channel(options);
+    for (uint32_t seq = 2; seq <= 10; seq += 2) {
+        channel.on_receive(seq, true);
+    }
+    hwp::AckInfo ack = channel.ack_state();
+    CHECK(ack.cumulative == 0);
+    CHECK((ack.ranges == Ranges{{2, 2}, {4, 4}}));
+}
+
+TEST(ack_encoding_round_trip) {
+    hwp::AckInfo ack = ack_of(41, {{43, 44}, {50, 60}});
+    hwp::Message msg = hwp::ReliableChannel::ack_message(SESSION, ack, 16);
+    hwp::AckInfo parsed;
+    CHECK(hwp::ReliableChannel::parse_ack(msg, parsed));
+    CHECK(parsed.session_id == SESSION);
+    CHECK(parsed.cumulative == 41);
+    CHECK(parsed.ranges == ack.ranges);
+
+    // 区间数与负载长度不一致
+    msg.payload.pop_back();
+    CHECK(!hwp::ReliableChannel::parse_ack(msg, parsed));
+    msg.payload.resize(5);
+    CHECK(!hwp::ReliableChannel::parse_ack(msg, parsed));
+
+    uint32_t seq = 0;
+    CHECK(hwp::ReliableChannel::parse_forward(hwp::ReliableChannel::forward_message(SESSION, 9), seq));
+    CHECK(seq == 9);
+    CHECK(!hwp::ReliableChannel::parse_forward(hwp::ReliableChannel::ack_message(SESSION, ack, 16), seq));
+}
+
+TEST(send_window_and_backlog) {
+    hwp::ReliableOptions options;
+    options.window = 4;
+    hwp::ReliableChannel channel(options);
+    std::vector<hwp::OutgoingFrame> out;
+    int acked = 0;
+    for (uint8_t i = 0; i < 6; ++i) {
+        channel.send(request(i), 1, [&acked](bool ok) { acked += ok; }, out);
+    }
+    CHECK(out.size() == 4);
+    CHECK(channel.unacked() == 6);
+    for (size_t i = 0; i < out.size(); ++i) {
+        uint8_t flags = 0;
+        hwp::SessionHeader header = header_of(out[i], &flags);
+        CHECK(header.seq_num == i + 1);
+        CHECK((flags & static_cast<uint8_t>(hwp::Flags::REQUIRES_ACK)) != 0);
+        // 只有填满窗口的那一条请求立即确认
+        CHECK(((flags & static_cast<uint8_t>(hwp::Flags::ACK_NOW)) != 0) == (i == 3));
+    }
+
+    // 确认前两条，窗口腾出后排队的两条发出
+    out.clear();
+    channel.on_ack(ack_of(2), 1, out);
+    CHECK(acked == 2);
+    CHECK(out.size() == 2);
+    CHECK(header_of(out[0]).seq_num == 5);
+    CHECK(header_of(out[1]).seq_num == 6);
+
+    // 选择确认释放中间的消息，累计确认随后越过它
+    out.clear();
+    channel.on_ack(ack_of(2, {{4, 5}}), 1, out);
+    CHECK(acked == 4);
+    CHECK(channel.stats().acked == 4);
+    channel.on_ack(ack_of(6), 1, out);
+    CHECK(acked == 6);
+    CHECK(channel.unacked() == 0);
+    CHECK(channel.stats().acked == 6);
+}
+
+TEST(resume_retransmits_only_unacked) {
+    hwp::ReliableChannel channel;
+    std::vector<hwp::OutgoingFrame> out;
+    for (uint8_t i = 0; i < 4; ++i) {
+        channel.send(request(i), 1, nullptr, out);
+    }
+    // 对端收到了 1 和 3，连接随即断开
+    channel.connection_lost(1);
+    CHECK(channel.has_lost());
+
+    // 重连后的首个 ACK 触发补发：只补 2 和 4，经新连接发出，负载不变
+    out.clear();
+    channel.on_ack(ack_of(1, {{3, 3}}), 2, out);
+    CHECK(!channel.has_lost());
+    CHECK(out.size() == 2);
+    CHECK(header_of(out[0]).seq_num == 2);
+    CHECK(header_of(out[1]).seq_num == 4);
+    CHECK(out[0].payload_size() == 1 && out[0].payload_data()[0] == 1);
+    CHECK(channel.stats().retransmitted == 2);
+
+    // 新连接断开只影响经它发出的消息
+    channel.connection_lost(1);
+    CHECK(!channel.has_lost());
+    channel.connection_lost(2);
+    CHECK(channel.has_lost());
+}
+
+TEST(stalled_cumulative_sends_forward) {
+    hwp::ReliableChannel channel;
+    std::vector<hwp::OutgoingFrame> out;
+    // 序列号 1 给了不需确认的消息且已丢失，对端累计确认号停在 0
+    CHECK(channel.next_seq() == 1);
+    channel.send(request(0), 1, nullptr, out);
+    CHECK(header_of(out[0]).seq_num == 2);
+
+    out.clear();
+    channel.on_ack(ack_of(0, {{2, 2}}), 1, out);
+    CHECK(out.size() == 1);
+    CHECK(out[0].msg_type() == hwp::MessageType::CONTROL);
+    CHECK(out[0].payload_data()[0] == static_cast<uint8_t>(hwp::ControlCode::FORWARD));
+
+    // 接收端据此越过空洞
+    hwp::ReliableChannel peer;
+    peer.on_receive(2, true);
+    peer.on_forward(2);
+    CHECK(peer.ack_state().cumulative == 2);
+}
+
+TEST(abandon_reports_failure) {
+    hwp::ReliableOptions options;
+    options.window = 1;
+    hwp::ReliableChannel channel(options);
+    std::vector<hwp::OutgoingFrame> out;
+    int failed = 0;
+    channel.send(request(0), 1, [&failed](bool ok) { failed += !ok; }, out);
+    channel.send(request(1), 1, [&failed](bool ok) { failed += !ok; }, out);
+    channel.abandon();
+    CHECK(failed == 2);
+    CHECK(channel.unacked() == 0);
+}
+
+TEST_MAIN()
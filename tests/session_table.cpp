@@ -0,0 +1,130 @@
+// SessionTable：时间轮 TTL（含跨层排期与访问续期）与 LRU 淘汰
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../include/hwp/session_table.hpp"
+#include "check.hpp"
+
+namespace {
+
+hwp::SessionState session(uint32_t id) {
+    hwp::SessionState state;
+    state.session_id = id;
+    std::string client_id = "c";
+    client_id += std::to_string(id);
+    state.client_id = std::move(client_id);
+    return state;
+}
+
+// 时间以构造前取得的时刻为起点；各检查点取在 tick 中间，起点的毫秒级偏差不影响结果
+struct Clock {
+    uint64_t start = hwp::ProtocolHandler::get_current_timestamp();
+    uint64_t at(uint64_t ms) const { return start + ms; }
+};
+
+} // namespace
+
+TEST(ttl_expires_idle_sessions) {
+    Clock clock;
+    hwp::SessionTableOptions options;
+    options.shards = 4;
+    options.ttl = std::chrono::milliseconds(1000);
+    options.tick = std::chrono::milliseconds(100);
+    hwp::SessionTable table(options);
+    table.insert(session(1));
+    table.insert(session(2));
+
+    CHECK(table.expire(clock.at(550)) == 0);
+    // 访问续期：1 的到期时间推后到 tick 15
+    CHECK(table.touch(1));
+    CHECK(table.expire(clock.at(1050)) == 1);
+    hwp::SessionState state;
+    CHECK(!table.find(2, state));
+    CHECK(table.find(1, state));
+    CHECK(state.client_id == "c1");
+
+    // find 同样续期（tick 10 + 10）
+    CHECK(table.expire(clock.at(1550)) == 0);
+    CHECK(table.expire(clock.at(2050)) == 1);
+    CHECK(table.size() == 0);
+    CHECK(table.stats().expired == 2);
+    // 时间不回退
+    CHECK(table.expire(clock.at(10)) == 0);
+}
+
+TEST(ttl_across_wheel_levels) {
+    Clock clock;
+    hwp::SessionTableOptions options;
+    options.shards = 2;
+    options.tick = std::chrono::milliseconds(1);
+    // 5000 tick 落在时间轮第 2 层（64^2 = 4096）
+    options.ttl = std::chrono::milliseconds(5000);
+    hwp::SessionTable table(options);
+    for (uint32_t id = 1; id <= 100; ++id) {
+        table.insert(session(id));
+    }
+    CHECK(table.expire(clock.at(4990)) == 0);
+    CHECK(table.size() == 100);
+    // 中途续期的会话在层间重新排期后仍按新的到期时间回收
+    CHECK(table.touch(7));
+    CHECK(table.expire(clock.at(5100)) == 99);
+    CHECK(table.size() == 1);
+    CHECK(table.expire(clock.at(9900)) == 0);
+    CHECK(table.expire(clock.at(10100)) == 1);
+}
+
+TEST(lru_eviction) {
+    hwp::SessionTableOptions options;
+    options.shards = 1;
+    options.max_sessions = 3;
+    hwp::SessionTable table(options);
+    table.insert(session(1));
+    table.insert(session(2));
+    table.insert(session(3));
+    CHECK(table.touch(1));
+    table.insert(session(4));
+    hwp::SessionState state;
+    CHECK(!table.find(2, state));
+    CHECK(table.find(1, state));
+    CHECK(table.find(3, state));
+    CHECK(table.find(4, state));
+    CHECK(table.stats().evicted == 1);
+    CHECK(table.erase(3));
+    CHECK(!table.erase(3));
+    CHECK(table.size() == 2);
+}
+
+TEST(create_assigns_unique_ids) {
+    hwp::SessionTable table;
+    std::vector<uint32_t> ids;
+    for (int i = 0; i < 1000; ++i) {
+        hwp::SessionState state = table.create("client");
+        CHECK(state.session_id != 0);
+        // 最高位留给代理分配的 id
+        CHECK((state.session_id & hwp::PROXY_SESSION_ID_BIT) == 0);
+        ids.push_back(state.session_id);
+    }
+    CHECK(table.size() == ids.size());
+}
+
+TEST(create_skips_existing_ids) {
+    hwp::SessionTable table;
+    // 分配序列的步长固定，预先占住下一个将要分配的 id（如快照恢复的会话）
+    uint32_t last = hwp::ProtocolHandler::create_session("probe").session_id;
+    uint32_t next = (last + 2654435761u) & ~hwp::PROXY_SESSION_ID_BIT;
+    hwp::SessionState restored = session(next);
+    CHECK(table.insert(restored));
+    CHECK(!table.insert(restored));
+
+    hwp::SessionState created = table.create("new");
+    CHECK(created.session_id != next);
+    hwp::SessionState state;
+    CHECK(table.find(next, state));
+    CHECK(state.client_id == restored.client_id);
+    CHECK(table.find(created.session_id, state));
+    CHECK(state.client_id == "new");
+    CHECK(table.size() == 2);
+}
+
+TEST_MAIN()
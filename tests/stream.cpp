@@ -0,0 +1,86 @@
+// StreamMux：接收端的流控检查，以及分片重组的流数、合计字节与预算计数
+#include <cstdint>
+#include <vector>
+#include "../include/hwp/stream.hpp"
+#include "check.hpp"
+
+namespace {
+
+hwp::Message fragment(uint16_t stream_id, std::size_t size, bool more) {
+    hwp::Message msg = hwp::ProtocolHandler::create_message(hwp::MessageType::DATA, 1, std::vector<uint8_t>(size, 0x5a),
+                                                            static_cast<uint8_t>(hwp::Flags::BINARY_MODE));
+    msg.session_header.stream_id = stream_id;
+    if (more) {
+        msg.base_header.flags |= static_cast<uint8_t>(hwp::Flags::MORE);
+    }
+    return msg;
+}
+
+using Inbound = hwp::StreamMux::Inbound;
+
+} // namespace
+
+TEST(reassembly_delivers_and_releases_budget) {
+    hwp::BufferBudget budget(0);
+    hwp::StreamMux mux(hwp::FlowControlOptions(), &budget);
+    std::vector<hwp::Message> updates;
+    hwp::Message first = fragment(1, 1000, true);
+    CHECK(mux.on_frame(first, updates) == Inbound::PARTIAL);
+    hwp::Message second = fragment(1, 500, true);
+    CHECK(mux.on_frame(second, updates) == Inbound::PARTIAL);
+    CHECK(budget.used() == 1500);
+    hwp::Message last = fragment(1, 100, false);
+    CHECK(mux.on_frame(last, updates) == Inbound::DELIVER);
+    CHECK(last.payload.size() == 1600);
+    CHECK(budget.used() == 0);
+    mux.consumed(last.session_header, updates);
+}
+
+TEST(assembling_streams_limited) {
+    hwp::FlowControlOptions options;
+    options.max_streams = 4;
+    hwp::StreamMux mux(options);
+    std::vector<hwp::Message> updates;
+    for (uint16_t id = 1; id <= 4; ++id) {
+        hwp::Message msg = fragment(id, 10, true);
+        CHECK(mux.on_frame(msg, updates) == Inbound::PARTIAL);
+    }
+    // 第 5 条同时重组的流被拒绝
+    hwp::Message extra = fragment(5, 10, true);
+    CHECK(mux.on_frame(extra, updates) == Inbound::VIOLATION);
+}
+
+TEST(reassembly_bytes_limited_and_returned_on_destruction) {
+    hwp::BufferBudget budget(0);
+    {
+        hwp::FlowControlOptions options;
+        options.max_reassembly = 64 * 1024;
+        hwp::StreamMux mux(options, &budget);
+        std::vector<hwp::Message> updates;
+        // 分片即时归还窗口，多条流合计仍受上限约束
+        for (uint16_t id = 1; id <= 4; ++id) {
+            hwp::Message msg = fragment(id, 16 * 1024, true);
+            CHECK(mux.on_frame(msg, updates) == Inbound::PARTIAL);
+        }
+        hwp::Message over = fragment(1, 1, true);
+        CHECK(mux.on_frame(over, updates) == Inbound::VIOLATION);
+        CHECK(budget.used() == 64 * 1024);
+
+        // 整体替换（重连）时归还
+        hwp::StreamMux replaced(options, &budget);
+        hwp::Message msg = fragment(1, 100, true);
+        CHECK(replaced.on_frame(msg, updates) == Inbound::PARTIAL);
+        mux = std::move(replaced);
+        CHECK(budget.used() == 100);
+    }
+    CHECK(budget.used() == 0);
+}
+
+TEST(window_violation) {
+    hwp::StreamMux mux;
+    std::vector<hwp::Message> updates;
+    hwp::Message big = fragment(1, hwp::INITIAL_STREAM_WINDOW + 1, false);
+    CHECK(mux.on_frame(big, updates) == Inbound::VIOLATION);
+}
+
+TEST_MAIN()
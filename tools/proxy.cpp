@@ -0,0 +1,60 @@
+// 会话亲和的转发代理
+//
+// 用法: hwp_proxy [-t threads] <port> <host:port>...
+// 运行中从标准输入读取命令：
+//     +host:port   加入后端
+//     -host:port   移除后端
+//     stats        打印后端与转发统计
+// 标准输入关闭时退出
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "../include/hwp.hpp"
+
+int main(int argc, char* argv[]) {
+    hwp::proxy::ProxyOptions options;
+    int arg = 1;
+    if (arg + 1 < argc && std::strcmp(argv[arg], "-t") == 0) {
+        options.threads = std::strtoul(argv[arg + 1], nullptr, 10);
+        arg += 2;
+    }
+    if (arg >= argc) {
+        std::cerr << "用法: " << argv[0] << " [-t threads] <port> <host:port>...\n";
+        return 1;
+    }
+    options.port = static_cast<unsigned short>(std::strtoul(argv[arg++], nullptr, 10));
+
+    try {
+        hwp::proxy::Proxy proxy(options);
+        for (; arg < argc; ++arg) {
+            if (!proxy.add_backend(argv[arg])) {
+                std::cerr << "无法加入后端 " << argv[arg] << "\n";
+            }
+        }
+        proxy.run();
+        std::cout << "代理启动在 " << proxy.port() << " 端口，后端 " << proxy.backends().size() << " 个\n";
+
+        std::string line;
+        while (std::getline(std::cin, line)) {
+            if (line.size() > 1 && line[0] == '+') {
+                std::cout << (proxy.add_backend(line.substr(1)) ? "已加入 " : "无法加入 ") << line.substr(1) << "\n";
+            } else if (line.size() > 1 && line[0] == '-') {
+                std::cout << (proxy.remove_backend(line.substr(1)) ? "已移除 " : "没有后端 ") << line.substr(1) << "\n";
+            } else if (line == "stats") {
+                for (const auto& backend : proxy.backends()) {
+                    std::cout << "  " << backend << "\n";
+                }
+                auto stats = proxy.stats();
+                std::cout << "wire " << stats.wire_connections << "  http " << stats.http_connections
+                          << "  connect failures " << stats.connect_failures
+                          << "  spliced " << stats.spliced_bytes << " B\n";
+            }
+        }
+        proxy.stop();
+    } catch (const std::exception& e) {
+        std::cerr << "错误: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
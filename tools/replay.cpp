@@ -0,0 +1,398 @@
+// 抓包回放：按记录的时间戳把每条连接的帧重新发给服务器，保持原有的连接划分与连接内顺序，
+// 各连接之间按时间交错。报告发送吞吐、发送滞后（实际发出晚于计划的时间）与回复延迟，
+// 回复按 (stream_id, ack_num) 与请求的 (stream_id, seq_num) 匹配
+//
+// 用法: hwp_replay [-s speed] [-w wait_ms] [-o result.json] [-b baseline.json] <capture> <host> <port>
+//     -s  回放速度倍数，默认 1；0 表示不按时间戳，尽快发送
+//     -w  一条连接发完后等待剩余回复的最长时间，默认 1000 毫秒
+//     -o  结果写为 JSON
+//     -b  与之前 -o 保存的结果比较，打印吞吐与延迟的变化
+//
+// 原会话的 HANDSHAKE（session_id 为 0）改为请求该连接之后使用的 session_id，
+// 服务器按该 id 新建会话，之后的帧无需改写
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <boost/asio.hpp>
+#include "../include/hwp.hpp"
+#include "../benchmarks/hdr_histogram.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using boost::asio::ip::tcp;
+
+constexpr size_t READ_CHUNK = 64 * 1024;
+
+struct ReplayStats {
+    uint64_t frames = 0;
+    uint64_t bytes = 0;
+    uint64_t replies = 0;
+    uint64_t connect_failures = 0;
+    Clock::time_point last_send;
+    bench::HdrHistogram lag;        // 纳秒
+    bench::HdrHistogram latency;    // 纳秒
+};
+
+struct Schedule {
+    Clock::time_point origin;
+    double speed = 1.0;
+    std::chrono::milliseconds wait{1000};
+    tcp::endpoint endpoint;
+
+    Clock::time_point due(uint64_t time_ns) const {
+        if (speed <= 0) {
+            return origin;
+        }
+        return origin + std::chrono::nanoseconds(static_cast<int64_t>(static_cast<double>(time_ns) / speed));
+    }
+};
+
+uint64_t request_key(uint16_t stream_id, uint32_t seq) {
+    return (static_cast<uint64_t>(stream_id) << 32) | seq;
+}
+
+// 一条被回放的连接：到第一帧的计划时刻才建立，逐帧按计划时刻写出，同时读取回复
+class ReplayConnection : public std::enable_shared_from_this<ReplayConnection> {
+public:
+    ReplayConnection(boost::asio::io_context& io, const Schedule& schedule, ReplayStats& stats,
+                     std::vector<const hwp::capture::CaptureRecord*> frames)
+        : socket_(io), timer_(io), schedule_(schedule), stats_(stats), frames_(std::move(frames)),
+          rx_(READ_CHUNK) {}
+
+    void start() {
+        auto self = shared_from_this();
+        timer_.expires_at(schedule_.due(frames_.front()->time_ns));
+        timer_.async_wait([self](boost::system::error_code ec) {
+            if (ec) {
+                return;
+            }
+            self->socket_.async_connect(self->schedule_.endpoint, [self](boost::system::error_code ec) {
+                if (ec) {
+                    ++self->stats_.connect_failures;
+                    self->close();
+                    return;
+                }
+                boost::system::error_code ignored;
+                self->socket_.set_option(tcp::no_delay(true), ignored);
+                self->read();
+                self->send_next();
+            });
+        });
+    }
+
+private:
+    void send_next() {
+        if (next_ == frames_.size()) {
+            sent_all_ = true;
+            if (pending_.empty()) {
+                close();
+                return;
+            }
+            // 等待剩余的回复，超时后关闭
+            auto self = shared_from_this();
+            timer_.expires_after(schedule_.wait);
+            timer_.async_wait([self](boost::system::error_code ec) {
+                if (!ec) {
+                    self->close();
+                }
+            });
+            return;
+        }
+        Clock::time_point due = schedule_.due(frames_[next_]->time_ns);
+        if (due > Clock::now()) {
+            auto self = shared_from_this();
+            timer_.expires_at(due);
+            timer_.async_wait([self](boost::system::error_code ec) {
+                if (!ec) {
+                    self->write(self->schedule_.due(self->frames_[self->next_]->time_ns));
+                }
+            });
+            return;
+        }
+        write(due);
+    }
+
+    void write(Clock::time_point due) {
+        const hwp::capture::CaptureRecord& record = *frames_[next_];
+        Clock::time_point now = Clock::now();
+        stats_.lag.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - due).count()));
+        if (record.session.msg_type != hwp::MessageType::CONTROL) {
+            pending_.emplace(request_key(record.session.stream_id, record.session.seq_num), now);
+        }
+        auto self = shared_from_this();
+        boost::asio::async_write(socket_, boost::asio::buffer(record.frame),
+            [self](boost::system::error_code ec, size_t bytes) {
+                if (ec) {
+                    self->close();
+                    return;
+                }
+                ++self->stats_.frames;
+                self->stats_.bytes += bytes;
+                self->stats_.last_send = Clock::now();
+                ++self->next_;
+                self->send_next();
+            });
+    }
+
+    void read() {
+        if (rx_.size() - rx_end_ < READ_CHUNK / 2) {
+            rx_.resize(rx_end_ + READ_CHUNK);
+        }
+        auto self = shared_from_this();
+        socket_.async_read_some(boost::asio::buffer(rx_.data() + rx_end_, rx_.size() - rx_end_),
+            [self](boost::system::error_code ec, size_t bytes) {
+                if (ec) {
+                    self->close();
+                    return;
+                }
+                self->rx_end_ += bytes;
+                self->on_data();
+            });
+    }
+
+    void on_data() {
+        auto status = decoder_.decode(rx_.data(), rx_end_);
+        Clock::time_point now = Clock::now();
+        for (const hwp::FrameView& frame : decoder_.frames()) {
+            if (frame.session.msg_type == hwp::MessageType::CONTROL) {
+                continue;
+            }
+            auto it = pending_.find(request_key(frame.session.stream_id, frame.session.ack_num));
+            if (it != pending_.end()) {
+                ++stats_.replies;
+                stats_.latency.record(static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(now - it->second).count()));
+                pending_.erase(it);
+            }
+        }
+        if (status == hwp::FrameDecoder::Status::ERROR) {
+            close();
+            return;
+        }
+        size_t consumed = decoder_.consumed();
+        std::memmove(rx_.data(), rx_.data() + consumed, rx_end_ - consumed);
+        rx_end_ -= consumed;
+        if (decoder_.required() > rx_.size()) {
+            rx_.resize(decoder_.required());
+        }
+        if (sent_all_ && pending_.empty()) {
+            close();
+            return;
+        }
+        read();
+    }
+
+    void close() {
+        boost::system::error_code ignored;
+        timer_.cancel();
+        socket_.close(ignored);
+    }
+
+    tcp::socket socket_;
+    boost::asio::steady_timer timer_;
+    const Schedule& schedule_;
+    ReplayStats& stats_;
+    std::vector<const hwp::capture::CaptureRecord*> frames_;
+    size_t next_ = 0;
+    bool sent_all_ = false;
+    std::vector<uint8_t> rx_;
+    size_t rx_end_ = 0;
+    hwp::FrameDecoder decoder_;
+    std::unordered_map<uint64_t, Clock::time_point> pending_;  // 请求 -> 发出时刻
+};
+
+// 从 -o 保存的结果中取一个数值字段，不存在时返回 false
+bool json_number(const std::string& text, const std::string& key, double& value) {
+    std::string pattern = "\"" + key + "\":";
+    size_t pos = text.find(pattern);
+    if (pos == std::string::npos) {
+        return false;
+    }
+    value = std::strtod(text.c_str() + pos + pattern.size(), nullptr);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Schedule schedule;
+    std::string output;
+    std::string baseline;
+    int arg = 1;
+    for (; arg + 1 < argc && argv[arg][0] == '-'; arg += 2) {
+        if (std::strcmp(argv[arg], "-s") == 0) {
+            schedule.speed = std::strtod(argv[arg + 1], nullptr);
+        } else if (std::strcmp(argv[arg], "-w") == 0) {
+            schedule.wait = std::chrono::milliseconds(std::strtoul(argv[arg + 1], nullptr, 10));
+        } else if (std::strcmp(argv[arg], "-o") == 0) {
+            output = argv[arg + 1];
+        } else if (std::strcmp(argv[arg], "-b") == 0) {
+            baseline = argv[arg + 1];
+        } else {
+            break;
+        }
+    }
+    if (argc - arg != 3) {
+        std::cerr << "用法: " << argv[0]
+                  << " [-s speed] [-w wait_ms] [-o result.json] [-b baseline.json] <capture> <host> <port>\n";
+        return 1;
+    }
+    std::string path = argv[arg];
+
+    // 读入全部记录，按连接分组（保持连接内顺序）
+    hwp::capture::CaptureReader reader;
+    if (!reader.open(path)) {
+        std::cerr << "无法读取抓包文件 " << path << "\n";
+        return 1;
+    }
+    std::vector<std::unique_ptr<hwp::capture::CaptureRecord>> records;
+    std::vector<std::vector<const hwp::capture::CaptureRecord*>> connections;
+    std::unordered_map<uint64_t, size_t> connection_index;
+    uint64_t truncated = 0;
+    auto record = std::make_unique<hwp::capture::CaptureRecord>();
+    hwp::capture::CaptureReader::Status status;
+    while ((status = reader.next(*record)) == hwp::capture::CaptureReader::Status::OK) {
+        truncated += record->truncated ? 1 : 0;
+        auto [it, inserted] = connection_index.emplace(record->connection_id, connections.size());
+        if (inserted) {
+            connections.emplace_back();
+        }
+        connections[it->second].push_back(record.get());
+        records.push_back(std::move(record));
+        record = std::make_unique<hwp::capture::CaptureRecord>();
+    }
+    if (status == hwp::capture::CaptureReader::Status::ERROR) {
+        std::cerr << "抓包文件在第 " << records.size() + 1 << " 条记录处损坏，只回放之前的记录\n";
+    }
+    if (records.empty()) {
+        std::cerr << "抓包文件中没有记录\n";
+        return 1;
+    }
+
+    // 新会话的握手改为请求该连接之后使用的 session_id
+    for (auto& frames : connections) {
+        for (size_t i = 0; i < frames.size(); ++i) {
+            auto* handshake = const_cast<hwp::capture::CaptureRecord*>(frames[i]);
+            if (handshake->session.msg_type != hwp::MessageType::HANDSHAKE || handshake->session.session_id != 0) {
+                continue;
+            }
+            for (size_t j = i + 1; j < frames.size(); ++j) {
+                if (uint32_t id = frames[j]->session.session_id; id != 0) {
+                    handshake->session.session_id = id;
+                    hwp::ProtocolHandler::encode_header(handshake->base, handshake->session,
+                                                        handshake->session.payload_len, handshake->frame.data());
+                    break;
+                }
+            }
+        }
+    }
+
+    boost::asio::io_context io;
+    ReplayStats stats;
+    try {
+        tcp::resolver resolver(io);
+        schedule.endpoint = *resolver.resolve(argv[arg + 1], argv[arg + 2]).begin();
+    } catch (const std::exception& e) {
+        std::cerr << "无法解析 " << argv[arg + 1] << ": " << e.what() << "\n";
+        return 1;
+    }
+    schedule.origin = Clock::now();
+    for (auto& frames : connections) {
+        std::make_shared<ReplayConnection>(io, schedule, stats, std::move(frames))->start();
+    }
+    io.run();
+
+    // 不同线程的记录成块写入，文件中最后一条不一定最晚
+    uint64_t last_ns = 0;
+    for (const auto& r : records) {
+        last_ns = std::max(last_ns, r->time_ns);
+    }
+    double captured = static_cast<double>(last_ns) / 1e9;
+    double seconds = std::chrono::duration<double>(stats.last_send - schedule.origin).count();
+    if (seconds <= 0) {
+        seconds = 1e-9;
+    }
+    double frames_per_s = static_cast<double>(stats.frames) / seconds;
+    double mib_per_s = static_cast<double>(stats.bytes) / (1 << 20) / seconds;
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "回放 " << stats.frames << "/" << records.size() << " 帧（"
+              << static_cast<double>(stats.bytes) / (1 << 20) << " MiB），" << connection_index.size() << " 条连接，"
+              << "用时 " << std::setprecision(3) << seconds << " s（抓包时长 " << captured << " s，速度 ";
+    if (schedule.speed > 0) {
+        std::cout << std::defaultfloat << schedule.speed << "x）\n";
+    } else {
+        std::cout << "不限）\n";
+    }
+    std::cout << std::setprecision(1);
+    if (truncated > 0) {
+        std::cout << "  " << truncated << " 帧的负载未完整记录，已补零\n";
+    }
+    if (stats.connect_failures > 0) {
+        std::cout << "  " << stats.connect_failures << " 条连接无法建立\n";
+    }
+    std::cout << "吞吐      " << frames_per_s << " 帧/s  " << mib_per_s << " MiB/s\n";
+    std::cout << "发送滞后  p50 " << stats.lag.percentile(50) / 1e3 << " us  p99 " << stats.lag.percentile(99) / 1e3
+              << " us  max " << stats.lag.max() / 1e3 << " us\n";
+    std::cout << "回复延迟  " << stats.replies << " 条  p50 " << stats.latency.percentile(50) / 1e3
+              << " us  p90 " << stats.latency.percentile(90) / 1e3
+              << " us  p99 " << stats.latency.percentile(99) / 1e3
+              << " us  max " << stats.latency.max() / 1e3 << " us\n";
+
+    std::ostringstream json;
+    json << "{\"capture\":" << bench::json_string(path)
+         << ",\"speed\":" << schedule.speed
+         << ",\"connections\":" << connection_index.size()
+         << ",\"frames\":" << stats.frames
+         << ",\"bytes\":" << stats.bytes
+         << ",\"seconds\":" << seconds
+         << ",\"frames_per_s\":" << frames_per_s
+         << ",\"mib_per_s\":" << mib_per_s
+         << ",\"lag_p99_us\":" << stats.lag.percentile(99) / 1e3
+         << ",\"replies\":" << stats.replies
+         << ",\"latency_mean_us\":" << stats.latency.mean() / 1e3
+         << ",\"latency_p50_us\":" << stats.latency.percentile(50) / 1e3
+         << ",\"latency_p90_us\":" << stats.latency.percentile(90) / 1e3
+         << ",\"latency_p99_us\":" << stats.latency.percentile(99) / 1e3
+         << ",\"latency_max_us\":" << stats.latency.max() / 1e3 << "}\n";
+    if (!output.empty()) {
+        std::ofstream(output) << json.str();
+    }
+
+    if (!baseline.empty()) {
+        std::ifstream in(baseline);
+        std::string previous((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        if (previous.empty()) {
+            std::cerr << "无法读取基线 " << baseline << "\n";
+            return 1;
+        }
+        std::cout << "相对基线 " << baseline << ":\n";
+        for (const char* key : {"frames_per_s", "mib_per_s", "lag_p99_us", "latency_mean_us", "latency_p50_us",
+                                "latency_p90_us", "latency_p99_us", "latency_max_us"}) {
+            double before;
+            double after;
+            if (!json_number(previous, key, before) || !json_number(json.str(), key, after)) {
+                continue;
+            }
+            std::cout << "  " << std::left << std::setw(16) << key << std::right << std::setw(12) << before
+                      << " -> " << std::setw(12) << after;
+            if (before != 0) {
+                std::cout << "  (" << std::showpos << (after - before) / before * 100.0 << std::noshowpos << "%)";
+            }
+            std::cout << "\n";
+        }
+    }
+    return 0;
+}